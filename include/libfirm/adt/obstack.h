@@ -192,6 +192,15 @@ FIRM_API int _obstack_begin_1 (struct obstack *, int, int,
                                void (*) (void *, void *), void *);
 FIRM_API ptrdiff_t _obstack_memory_used (struct obstack *);
 
+/* Size of the chunks currently allocated by all obstacks and the maximum
+   this size reached.  obstack_set_peak_memory_used sets the maximum and
+   returns the previous one, so the peak of a region can be measured by
+   setting it to the current size at the start and restoring the larger
+   of both values at the end.  */
+FIRM_API ptrdiff_t obstack_total_memory_used (void);
+FIRM_API ptrdiff_t obstack_peak_memory_used (void);
+FIRM_API ptrdiff_t obstack_set_peak_memory_used (ptrdiff_t peak);
+
 FIRM_API void obstack_free (struct obstack *obstack, void *block);
 
 /* Error handler called when `obstack_chunk_alloc' failed to allocate
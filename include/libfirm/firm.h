@@ -102,6 +102,7 @@
 #include "irprog.h"
 #include "irverify.h"
 #include "lowering.h"
+#include "passtiming.h"
 #include "target.h"
 #include "timing.h"
 #include "tv.h"
@@ -90,6 +90,25 @@ FIRM_API void dump_ir_graph_ext(ir_graph_dump_func func, ir_graph *graph,
  */
 FIRM_API void dump_all_ir_graphs(const char *suffix);
 
+/**
+ * Starts a binary trace.  Until ir_dump_trace_end() is called dump_ir_graph()
+ * appends a snapshot of the graph to the file @p filename instead of writing
+ * a vcg file.  A snapshot only contains the nodes which changed since the
+ * previous snapshot of the same graph and is flushed once it is complete, so
+ * the trace stays readable if the compiler crashes.
+ * scripts/irtrace.py converts a trace into vcg, dot or json.
+ *
+ * @param filename  name of the trace file
+ * @return 0 on success, -1 if the file could not be opened
+ */
+FIRM_API int ir_dump_trace_begin(const char *filename);
+
+/**
+ * Ends the binary trace started with ir_dump_trace_begin() and closes the
+ * trace file.
+ */
+FIRM_API void ir_dump_trace_end(void);
+
 /**
  * Specifies output path for the dump_ir_graph function
  */
@@ -99,6 +99,20 @@ FIRM_API ir_mode *new_float_mode(const char *name,
  */
 FIRM_API ir_mode *new_non_arithmetic_mode(const char *name, unsigned bit_size);
 
+/**
+ * Creates a new vector mode holding @p n_lanes values of mode @p element.
+ *
+ * Vector modes are non-arithmetic data modes, they are only used by the
+ * vector operations (VAdd, VSub, ...) and by Load, Store and Phi nodes.
+ * If a vector mode with the same name already exists, it is returned.
+ *
+ * @param name     the name of the mode to be created
+ * @param element  the mode of a single lane, must be an int or float mode
+ * @param n_lanes  number of lanes in the vector
+ */
+FIRM_API ir_mode *new_vector_mode(const char *name, ir_mode *element,
+                                  unsigned n_lanes);
+
 /** Returns the ident* of the mode */
 FIRM_API ident *get_mode_ident(const ir_mode *mode);
 
@@ -276,6 +290,15 @@ FIRM_API int mode_is_num(const ir_mode *mode);
  */
 FIRM_API int mode_is_data(const ir_mode *mode);
 
+/** Returns 1 if @p mode is a vector mode, 0 otherwise. */
+FIRM_API int mode_is_vector(const ir_mode *mode);
+
+/** Returns the mode of a single lane of the vector mode @p mode. */
+FIRM_API ir_mode *get_mode_vector_element(const ir_mode *mode);
+
+/** Returns the number of lanes of the vector mode @p mode. */
+FIRM_API unsigned get_mode_vector_lanes(const ir_mode *mode);
+
 /**
  * Returns true if a value of mode @p sm can be converted to mode @p lm without
  * loss.
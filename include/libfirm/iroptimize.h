@@ -39,6 +39,21 @@ FIRM_API void optimize_cf(ir_graph *irg);
  */
 FIRM_API void opt_jumpthreading(ir_graph* irg);
 
+/**
+ * Duplicates small join blocks into their hot predecessors to form
+ * superblocks along the frequently executed paths.
+ *
+ * The execution frequencies are taken from the profile if one was read and
+ * estimated otherwise. Run optimize_cf() and optimize_graph_df() afterwards
+ * to merge the copies into their predecessors and to simplify them.
+ *
+ * @param irg         the graph
+ * @param max_size    maximum number of nodes in a duplicated block
+ * @param max_growth  maximum growth of the graph in percent
+ */
+FIRM_API void opt_tail_duplication(ir_graph *irg, unsigned max_size,
+                                   unsigned max_growth);
+
 /**
  * Simplifies boolean expression in the given ir graph.
  * eg. x < 5 && x < 6 becomes x < 5
@@ -131,6 +146,13 @@ FIRM_API void opt_if_conv(ir_graph *irg);
  */
 FIRM_API void opt_if_conv_cb(ir_graph *irg, arch_allow_ifconv_func callback);
 
+/**
+ * This function is called to evaluate, if the vector operation @p op (one of
+ * VAdd, VSub, VMul, VAnd, VOr, VEor and VSplat) producing a value of vector
+ * mode @p mode is natively supported by the current architecture.
+ */
+typedef int (*arch_allow_vector_op_func)(ir_op const *op, ir_mode const *mode);
+
 /**
  * Tries to reduce dependencies for memory nodes where possible by parallelizing
  * them and synchronizing with Sync nodes
@@ -314,6 +336,11 @@ FIRM_API void proc_cloning(float threshold);
  *
  * See Muchnik 12.3.1 Algebraic Simplification and Reassociation of
  * Addressing Expressions.
+ *
+ * Finally chains of an associative operation like a + b + c + d are
+ * rebalanced into trees, if the target can issue several instructions per
+ * cycle and this shortens the critical path of a block. Floatingpoint chains
+ * are only rebalanced if imprecise float transformations are allowed.
  */
 FIRM_API void optimize_reassociation(ir_graph *irg);
 
@@ -414,6 +441,21 @@ typedef void (*opt_ptr)(ir_graph *irg);
 FIRM_API void inline_functions(unsigned maxsize, int inline_threshold,
                                opt_ptr after_inline_opt);
 
+/**
+ * Moves cold regions of a function into separate functions.
+ *
+ * A region is a block together with all blocks it dominates.  It is
+ * outlined if it is only left by leaving the function and it either leads
+ * to a noreturn call (e.g. a panic) or its execution frequency is low.  The
+ * frequencies are taken from the profile if one was read and estimated
+ * otherwise.  The region is copied into a new local function which is never
+ * inlined and replaced by a call to it, so that the remaining hot path
+ * becomes small enough for inline_functions().
+ *
+ * @param irg  the graph to run on
+ */
+FIRM_API void outline_cold_regions(ir_graph *irg);
+
 /**
  * Combines congruent blocks into one.
  *
@@ -444,6 +486,56 @@ FIRM_API void do_loop_unrolling(ir_graph *irg);
  */
 FIRM_API void unroll_loops(ir_graph *irg, unsigned factor, unsigned maxsize);
 
+/**
+ * Vectorizes counted innermost loops.
+ *
+ * A loop consisting of a header and a single body block, counting an
+ * induction variable by one up to a loop invariant bound and accessing
+ * memory only through consecutive elements indexed by the induction
+ * variable, is preceded by a vector loop processing several iterations at
+ * once. The original loop stays in place and processes the remaining
+ * iterations. Runtime checks fall back to the original loop if the accessed
+ * arrays overlap.
+ *
+ * The vector size and supported operations are taken from the current target,
+ * so this has no effect on targets without vector registers.
+ *
+ * @param irg  the IR-graph to optimize
+ */
+FIRM_API void vectorize_loops(ir_graph *irg);
+
+/**
+ * Packs straight-line code into vector operations.
+ *
+ * Stores to consecutive elements relative to the same base address, like the
+ * fields of a small vector struct, are combined into one vector Store if the
+ * stored values are computed by isomorphic, independent operations on
+ * consecutive Loads or on the same value. A group is only transformed if it
+ * needs fewer vector than scalar operations.
+ *
+ * The vector size and supported operations are taken from the current target,
+ * so this has no effect on targets without vector registers.
+ *
+ * @param irg  the IR-graph to optimize
+ */
+FIRM_API void slp_vectorize(ir_graph *irg);
+
+/**
+ * Moves loop invariant Loads and divisions out of loops.
+ *
+ * Loads from an invariant address, which no memory write in the loop may
+ * alias, and Div/Mod nodes on invariant operands are moved into a preheader
+ * block in front of the loop. Operations not executed in every iteration are
+ * only moved if they cannot trap. Hoisting stops once the estimated register
+ * pressure of the loop reaches the number of registers of the target.
+ *
+ * Floating operations are moved out of loops by place_code(), which should
+ * run afterwards.
+ *
+ * @param irg  the IR-graph to optimize
+ */
+FIRM_API void opt_licm(ir_graph *irg);
+
 /**
  * Perform loop peeling on a given graph.
  */
@@ -480,6 +572,46 @@ FIRM_API void garbage_collect_entities(void);
  */
 FIRM_API void dead_node_elimination(ir_graph *irg);
 
+/**
+ * Collects the nodes that are not reachable from the End node.
+ *
+ * Unlike dead_node_elimination() no nodes are copied: the memory of the
+ * unreachable nodes is reused for new nodes of the same size and the
+ * reachable nodes are renumbered densely, keeping their relative order.
+ * Side tables indexed by node index are updated if they are registered for
+ * renumbering, others become invalid. Out edges are rebuilt if they are
+ * active. Like dead_node_elimination() the outs, callee, loop, dominance and
+ * value range information is freed, as it may refer to the freed nodes.
+ *
+ * @param irg  The graph to be collected.
+ */
+FIRM_API void collect_dead_nodes(ir_graph *irg);
+
+/**
+ * Renumbers the nodes reachable from the End node densely, keeping their
+ * relative order, so that tables indexed by node index shrink.
+ *
+ * Unlike collect_dead_nodes() the unreachable nodes are not freed, but they
+ * get an invalid index and must not be used anymore. Analysis information is
+ * kept. This runs at the end of optimize_graph_df() and before the lowering
+ * for the target when less than the compaction threshold of the node indices
+ * belong to reachable nodes, so side tables indexed by node index that are
+ * kept across these points must be registered for renumbering.
+ *
+ * @param irg  The graph to be compacted.
+ */
+FIRM_API void compact_node_indices(ir_graph *irg);
+
+/**
+ * Sets the minimal share of reachable nodes among the node indices of a
+ * graph, below it the indices are compacted after optimize_graph_df() and
+ * before the lowering for the target.
+ *
+ * @param threshold  the share between 0 and 1, 0.5 by default, 0 disables the
+ *                   compaction
+ */
+FIRM_API void set_node_index_compaction_threshold(double threshold);
+
 /**
  * Code Placement.
  *
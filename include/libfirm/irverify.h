@@ -44,6 +44,47 @@ FIRM_API int irg_verify(ir_graph *irg);
  */
 FIRM_API void irg_assert_verify(ir_graph *irg);
 
+/**
+ * Sets the fraction of graph verifications performed by irg_verify_sampled(),
+ * irp_verify() and the backend verifiers.  The default of 1000 verifies
+ * everything, smaller values allow keeping verification enabled at a fraction
+ * of its cost.
+ *
+ * @param per_mille  fraction of verifications to perform in 1/1000
+ */
+FIRM_API void ir_set_verify_sampling(unsigned per_mille);
+
+/**
+ * Returns the fraction of verifications performed in 1/1000.
+ */
+FIRM_API unsigned ir_get_verify_sampling(void);
+
+/**
+ * Returns non-zero if the verification of @p irg after @p pass is selected by
+ * the current sampling fraction.  The decision is a hash of the names of the
+ * graph and the pass, so it is the same in every compiler run.
+ *
+ * @param irg   the graph to verify
+ * @param pass  name of the pass that has just run, may be NULL
+ */
+FIRM_API int ir_verify_selected(const ir_graph *irg, const char *pass);
+
+/**
+ * Calls irg_verify() if the verification of @p irg after @p pass is selected
+ * by ir_verify_selected().
+ *
+ * @return NON-zero if no problems were found or the graph was not verified
+ */
+FIRM_API int irg_verify_sampled(ir_graph *irg, const char *pass);
+
+/**
+ * Verifies the type system and all graphs of the program which are selected
+ * by ir_verify_selected() for @p pass.
+ *
+ * @return NON-zero if no problems were found
+ */
+FIRM_API int irp_verify(const char *pass);
+
 /** @} */
 
 #include "end.h"
@@ -79,7 +79,10 @@ FIRM_API void lower_CopyB(ir_graph *irg, unsigned max_small_size,
 
 /**
  * Lowers all Switches (Cond nodes with non-boolean mode) depending on spare_size.
- * They will either remain the same or be converted into if-cascades.
+ * Dense switches remain the same. Other switches are partitioned into jump
+ * table clusters, bit test clusters and single case compares which are
+ * arranged in a search tree weighted by the execution frequencies of the
+ * case targets.
  *
  * @param irg        The ir graph to be lowered.
  * @param small_switch  If switch has <= cases then change it to an if-cascade.
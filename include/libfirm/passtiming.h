@@ -0,0 +1,105 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief    Per pass timing and counters.
+ */
+#ifndef FIRM_PASSTIMING_H
+#define FIRM_PASSTIMING_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "firm_types.h"
+
+#include "begin.h"
+
+/**
+ * @defgroup passtiming Pass Timing
+ *
+ * Records the wallclock time, the number of created and replaced nodes, the
+ * growth of the graph obstack and the peak memory used by all obstacks for
+ * every run of a pass on a graph. Passes are nested:
+ * a pass started inside another pass is recorded as part of it.
+ * ir_pass_timing_begin() and ir_pass_timing_end() only start and stop the
+ * recording. The optimizations and the backend phases report themselves with
+ * ir_pass_timing_push() and ir_pass_timing_pop(), frontends can add their own
+ * passes the same way.
+ *
+ * The recorded data is either written as a summary with per pass aggregates
+ * and duration histograms or as a trace in the Chrome trace event format,
+ * which can be viewed in chrome://tracing or Perfetto.
+ * @{
+ */
+
+/** Output formats for ir_pass_timing_end(). */
+typedef enum ir_pass_timing_format_t {
+	ir_pass_timing_summary, /**< JSON object with aggregates per pass */
+	ir_pass_timing_trace,   /**< Chrome trace event format */
+} ir_pass_timing_format_t;
+
+/**
+ * A marker function, called when a pass starts (@p begin is non-zero) and
+ * ends. This allows external profilers to attribute samples to passes.
+ */
+typedef void (ir_pass_marker_func)(void *data, const char *name,
+                                   ir_graph *irg, int begin);
+
+/**
+ * Starts recording pass timings.
+ */
+FIRM_API void ir_pass_timing_begin(void);
+
+/**
+ * Stops recording pass timings and writes the recorded data.
+ *
+ * @param out     the output file, may be NULL to discard the data
+ * @param format  the output format
+ */
+FIRM_API void ir_pass_timing_end(FILE *out, ir_pass_timing_format_t format);
+
+/**
+ * Sets a function that is called at the start and end of every pass.
+ *
+ * @param func  the marker function or NULL
+ * @param data  passed to @p func
+ */
+FIRM_API void ir_pass_timing_set_marker(ir_pass_marker_func *func, void *data);
+
+/**
+ * Marks the start of a pass.
+ *
+ * @param name  the name of the pass, must stay valid until
+ *              ir_pass_timing_end()
+ * @param irg   the graph the pass runs on, NULL for the graph of the
+ *              enclosing pass
+ */
+FIRM_API void ir_pass_timing_push(const char *name, ir_graph *irg);
+
+/**
+ * Marks the end of the innermost pass.
+ */
+FIRM_API void ir_pass_timing_pop(void);
+
+/**
+ * Sets a budget for the memory used by all obstacks. Expensive algorithms
+ * fall back to cheaper ones while the budget is exceeded, for example the
+ * ILP copy minimization falls back to a heuristic.
+ *
+ * @param budget  the budget in bytes, 0 for no budget
+ */
+FIRM_API void ir_set_obstack_budget(size_t budget);
+
+/**
+ * Returns non-zero if the memory used by all obstacks exceeds the budget
+ * set with ir_set_obstack_budget().
+ */
+FIRM_API int ir_obstack_budget_exceeded(void);
+
+/** @} */
+
+#include "end.h"
+
+#endif
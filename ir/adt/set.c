@@ -9,36 +9,26 @@
  * @author      Markus Armbruster
  */
 
-/*  This code is derived from:
-
-    From: ejp@ausmelb.oz.AU (Esmond Pitt)
-    Date: Tue, 7 Mar 1989 22:06:26 GMT
-    Subject: v06i042: dynamic hashing version of hsearch(3)
-    Message-ID: <1821@basser.oz>
-    Newsgroups: comp.sources.misc
-    Sender: msgs@basser.oz
-
-    Posting-number: Volume 6, Issue 42
-    Submitted-By: Esmond Pitt <ejp@ausmelb.oz.AU>
-    Archive-name: dynamic-hash
-
-    * Dynamic hashing, after CACM April 1988 pp 446-457, by Per-Ake Larson.
-    * Coded into C, with minor code improvements, and with hsearch(3) interface,
-    * by ejp@ausmelb.oz, Jul 26, 1988: 13:16;
+/*
+ * The table is an open addressing hash table with triangular probing over a
+ * power of 2 number of slots.  Each slot caches the hash of its element, so
+ * probing and rehashing only touch the slot array.  The elements themselves
+ * are allocated on an obstack and never move, which keeps the pointers
+ * returned by insert valid while the table grows.
  */
 #ifdef PSET
 # define SET pset
 # define PMANGLE(pre) pre##_pset
 # define MANGLEP(post) pset_##post
 # define MANGLE(pre, post) pre##pset##post
-# define EQUAL(cmp, elt, key, siz) (!(cmp) ((elt)->entry.dptr, (key)))
+# define EQUAL(cmp, elt, key, siz) (!(cmp) ((elt)->dptr, (key)))
 #else
 # define SET set
 # define PMANGLE(pre) pre##_set
 # define MANGLEP(post) set_##post
 # define MANGLE(pre, post) pre##set##post
 # define EQUAL(cmp, elt, key, siz) \
-    (((elt)->entry.size == (siz)) && !(cmp) ((elt)->entry.dptr, (key), (siz)))
+    (((elt)->size == (siz)) && !(cmp) ((elt)->dptr, (key), (siz)))
 #endif
 
 #ifdef PSET
@@ -48,208 +38,170 @@
 #endif
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 
 #include "xmalloc.h"
-#include "lc_printf.h"
 #include "obst.h"
 
-#define SEGMENT_SIZE_SHIFT   8
-#define SEGMENT_SIZE         (1 << SEGMENT_SIZE_SHIFT)
-#define DIRECTORY_SIZE_SHIFT 8
-#define DIRECTORY_SIZE       (1 << DIRECTORY_SIZE_SHIFT)
-#define MAX_LOAD_FACTOR      4
+#define MIN_SLOTS_SHIFT 4
 
-typedef struct element {
-	struct element *chain;    /**< for chaining Elements */
-	MANGLEP(entry)  entry;
-} element_t, *segment_t;
+typedef struct slot_t {
+	unsigned         hash;  /**< cached hash of the element */
+	MANGLEP(entry)  *entry; /**< the element, NULL if the slot is empty */
+} slot_t;
 
 struct SET {
-	size_t p;             /**< Next bucket to be split */
-	size_t maxp;          /**< upper bound on p during expansion */
-	size_t nkey;          /**< current # keys */
-	size_t nseg;          /**< current # segments */
-	segment_t *dir[DIRECTORY_SIZE];
-	MANGLEP(cmp_fun) cmp;     /**< function comparing entries */
-	unsigned   iter_i;
-	unsigned   iter_j;
-	element_t *iter_tail;       /**< non-NULL while iterating over elts */
+	slot_t  *slots;       /**< the slot array */
+	size_t   n_slots;     /**< number of slots, a power of 2 */
+	unsigned shift;       /**< 32 - log2(n_slots) */
+	size_t   n_elements;  /**< current # keys */
+	size_t   n_deleted;   /**< number of slots containing a tombstone */
+	MANGLEP(cmp_fun) cmp; /**< function comparing entries */
+	size_t   iter_pos;    /**< slot of the current element while iterating */
+	bool     iterating;   /**< true while iterating over elements */
 #ifdef PSET
-	element_t *free_list;       /**< list of free Elements */
+	pset_entry *free_list; /**< list of free entries, linked by dptr */
 #endif
-	struct obstack obst;      /**< obstack for allocation all data */
+	struct obstack obst;  /**< obstack for allocation of the elements */
 };
 
+/** Marks a slot whose element was removed. */
+static MANGLEP(entry) deleted_entry;
+#define DELETED (&deleted_entry)
 
-SET *(PMANGLE(new))(MANGLEP(cmp_fun) cmp, size_t nslots)
+static inline bool slot_used(slot_t const *slot)
 {
-	if (nslots > SEGMENT_SIZE * DIRECTORY_SIZE) {
-		nslots = DIRECTORY_SIZE;
-	} else {
-		/* Adjust nslots up to next power of 2, minimum SEGMENT_SIZE */
-		size_t i = SEGMENT_SIZE;
-		while (i < nslots)
-			i <<= 1;
-		nslots = i >> SEGMENT_SIZE_SHIFT;
-	}
+	return slot->entry != NULL && slot->entry != DELETED;
+}
 
-	SET *table = XMALLOC(SET);
-	table->nseg      = table->p = table->nkey = 0;
-	table->maxp      = nslots << SEGMENT_SIZE_SHIFT;
-	table->cmp       = cmp;
-	table->iter_tail = NULL;
-#ifdef PSET
-	table->free_list = NULL;
-#endif
-	obstack_init(&table->obst);
+/**
+ * Allocates a slot array large enough for @p n_elements elements.
+ */
+static void alloc_slots(SET *table, size_t n_elements)
+{
+	unsigned log2_slots = MIN_SLOTS_SHIFT;
+	while (((size_t)1 << log2_slots) < n_elements * 2)
+		++log2_slots;
+	table->n_slots = (size_t)1 << log2_slots;
+	table->shift   = 32 - log2_slots;
+	table->slots   = XMALLOCNZ(slot_t, table->n_slots);
+}
 
-	/* Make segments */
-	for (size_t i = 0; i < nslots;  ++i) {
-		table->dir[i] = OALLOCNZ(&table->obst, segment_t, SEGMENT_SIZE);
-		table->nseg++;
-	}
+/**
+ * Returns the first slot of the probe sequence for @p hash.  The hash is
+ * multiplied with the golden ratio and the upper bits are used (Fibonacci
+ * hashing), so hash functions which only differ in some bits still spread
+ * over the whole table.
+ */
+static inline size_t first_slot(SET const *table, unsigned hash)
+{
+	return (unsigned)(hash * 2654435769U) >> table->shift;
+}
 
+SET *(PMANGLE(new))(MANGLEP(cmp_fun) cmp, size_t nslots)
+{
+	SET *table = XMALLOCZ(SET);
+	table->cmp = cmp;
+	alloc_slots(table, nslots);
+	obstack_init(&table->obst);
 	return table;
 }
 
 void PMANGLE(del)(SET *table)
 {
 	obstack_free(&table->obst, NULL);
+	free(table->slots);
 	free(table);
 }
 
 size_t MANGLEP(count)(SET const *table)
 {
-	return table->nkey;
+	return table->n_elements;
 }
 
-/**
- * do one iteration step, return 1
- * if still data in the set, 0 else
- */
-static inline bool iter_step(SET *table)
+/** Returns the first used slot at or after @p pos and starts iterating. */
+static void *iter_from(SET *table, size_t pos)
 {
-	if (++table->iter_j >= SEGMENT_SIZE) {
-		table->iter_j = 0;
-		if (++table->iter_i >= table->nseg) {
-			table->iter_i = 0;
-			return false;
+	for (size_t n_slots = table->n_slots; pos < n_slots; ++pos) {
+		slot_t const *slot = &table->slots[pos];
+		if (slot_used(slot)) {
+			table->iter_pos  = pos;
+			table->iterating = true;
+			return slot->entry->dptr;
 		}
 	}
-	return true;
+	table->iterating = false;
+	return NULL;
 }
 
 void *(MANGLEP(first))(SET *table)
 {
-	assert(!table->iter_tail);
-	table->iter_i = 0;
-	table->iter_j = 0;
-	while (!table->dir[table->iter_i][table->iter_j]) {
-		if (!iter_step(table))
-			return NULL;
-	}
-	table->iter_tail = table->dir[table->iter_i][table->iter_j];
-	assert(table->iter_tail->entry.dptr);
-	return table->iter_tail->entry.dptr;
+	assert(!table->iterating);
+	return iter_from(table, 0);
 }
 
 void *(MANGLEP(next))(SET *table)
 {
-	if (!table->iter_tail)
+	if (!table->iterating)
 		return NULL;
-
-	/* follow collision chain */
-	table->iter_tail = table->iter_tail->chain;
-	if (!table->iter_tail) {
-		/* go to next segment */
-		do {
-			if (!iter_step(table))
-				return NULL;
-		} while (!table->dir[table->iter_i][table->iter_j]);
-		table->iter_tail = table->dir[table->iter_i][table->iter_j];
-	}
-	assert(table->iter_tail->entry.dptr);
-	return table->iter_tail->entry.dptr;
+	return iter_from(table, table->iter_pos + 1);
 }
 
 void MANGLEP(break)(SET *table)
 {
-	table->iter_tail = NULL;
-}
-
-/** Limit the hash value */
-static inline unsigned limit_hash(SET const *table, unsigned const h)
-{
-	unsigned address = h & (table->maxp - 1);       /* h % table->maxp */
-	if (address < (unsigned)table->p)
-		address = h & ((table->maxp << 1) - 1); /* h % (2*table->maxp) */
-	return address;
+	table->iterating = false;
 }
 
 /**
- * Returns non-zero if the number of elements in
- * the set is greater then number of segments * MAX_LOAD_FACTOR
+ * Rehash all elements into a slot array sized for the current number of
+ * elements.  This also drops all tombstones.
  */
-static inline bool loaded(SET *table)
+static void resize(SET *table)
 {
-	return ++table->nkey > (table->nseg << SEGMENT_SIZE_SHIFT) * MAX_LOAD_FACTOR;
+	size_t  old_n_slots = table->n_slots;
+	slot_t *old_slots   = table->slots;
+	alloc_slots(table, table->n_elements * 2);
+	slot_t *slots       = table->slots;
+	size_t  mask        = table->n_slots - 1;
+
+	for (size_t i = 0; i < old_n_slots; ++i) {
+		slot_t const *old = &old_slots[i];
+		if (!slot_used(old))
+			continue;
+		size_t pos = first_slot(table, old->hash);
+		for (size_t n_probes = 1; slots[pos].entry != NULL; ++n_probes)
+			pos = (pos + n_probes) & mask;
+		slots[pos] = *old;
+	}
+
+	free(old_slots);
+	table->n_deleted = 0;
 }
 
 /**
- * Expand the hash-table: the algorithm is split, so on every
- * insert, only ONE segment is rehashed!
- *
- * table->p contains the current segment to split
- * after all segments were split, table->p is set to zero and
- * table->maxp is duplicated.
+ * Returns the slot containing an element equal to @p key or NULL.
  */
-static void expand_table(SET *table)
+static slot_t *find_slot(SET const *table, void const *key,
+#ifndef PSET
+		size_t size,
+#endif
+		unsigned hash)
 {
-	if (table->maxp + table->p >= (DIRECTORY_SIZE << SEGMENT_SIZE_SHIFT))
-		return;
-
-	/* Locate the bucket to be split */
-	size_t     OldSegmentDir   = table->p >> SEGMENT_SIZE_SHIFT;
-	segment_t *OldSegment      = table->dir[OldSegmentDir];
-	size_t     OldSegmentIndex = table->p & (SEGMENT_SIZE - 1);
-
-	/* Expand address space; if necessary create a new segment */
-	size_t NewAddress      = table->maxp + table->p;
-	size_t NewSegmentDir   = NewAddress >> SEGMENT_SIZE_SHIFT;
-	size_t NewSegmentIndex = NewAddress & (SEGMENT_SIZE - 1);
-	if (NewSegmentIndex == 0) {
-		table->dir[NewSegmentDir] = OALLOCNZ(&table->obst, segment_t, SEGMENT_SIZE);
-		table->nseg++;
-	}
-	segment_t *NewSegment = table->dir[NewSegmentDir];
-
-	/* Adjust state variables */
-	table->p++;
-	if (table->p == table->maxp) {
-		table->maxp <<= 1;  /* table->maxp *= 2 */
-		table->p      = 0;
-	}
-
-	/* Relocate records to the new bucket */
-	element_t **Previous  = &OldSegment[OldSegmentIndex];
-	element_t  *Current   = *Previous;
-	element_t **LastOfNew = &NewSegment[NewSegmentIndex];
-	*LastOfNew = NULL;
-	while (Current != NULL) {
-		if (limit_hash(table, Current->entry.hash) == NewAddress) {
-			/* Move to new chain */
-			*LastOfNew = Current;
-			*Previous  = Current->chain;
-			LastOfNew  = &Current->chain;
-			Current    = Current->chain;
-			*LastOfNew = NULL;
-		} else {
-			/* Leave on old chain */
-			Previous = &Current->chain;
-			Current  = Current->chain;
-		}
+	MANGLEP(cmp_fun) cmp   = table->cmp;
+	slot_t          *slots = table->slots;
+	size_t           mask  = table->n_slots - 1;
+	size_t           pos   = first_slot(table, hash);
+	for (size_t n_probes = 1;; ++n_probes) {
+		slot_t *slot = &slots[pos];
+		MANGLEP(entry) *entry = slot->entry;
+		if (entry == NULL)
+			return NULL;
+		if (slot->hash == hash && entry != DELETED
+		    && EQUAL(cmp, entry, key, size))
+			return slot;
+		pos = (pos + n_probes) & mask;
 	}
 }
 
@@ -262,59 +214,69 @@ void *MANGLE(_,_search)(SET *table, void const *key,
 	assert(table);
 	assert(key);
 
-	/* Find collision chain */
-	unsigned    h               = limit_hash(table, hash);
-	unsigned    segment_index   = h & (SEGMENT_SIZE-1);
-	segment_t  *current_segment = table->dir[h >> SEGMENT_SIZE_SHIFT];
-	assert(current_segment != NULL);
-	segment_t   q               = current_segment[segment_index];
-
-	/* Follow collision chain */
-	MANGLEP(cmp_fun) cmp = table->cmp;
-	while (q && !EQUAL(cmp, q, key, size)) {
-		q = q->chain;
-	}
+#ifdef PSET
+	slot_t *slot = find_slot(table, key, hash);
+#else
+	slot_t *slot = find_slot(table, key, size, hash);
+#endif
+	MANGLEP(entry) *entry;
+	if (slot != NULL) {
+		entry = slot->entry;
+	} else if (action == MANGLE(_,_find)) {
+		return NULL;
+	} else {
+		assert(!table->iterating && "insert an element into a set that is iterated");
 
-	if (!q && (action != MANGLE(_,_find))) { /* not found, insert */
-		assert(!table->iter_tail && "insert an element into a set that is iterated");
+		/* keep the load (including tombstones) at most 1/2 */
+		if ((table->n_elements + table->n_deleted + 1) * 2 > table->n_slots)
+			resize(table);
 
 #ifdef PSET
 		if (table->free_list) {
-			q                = table->free_list;
-			table->free_list = q->chain;
+			entry            = table->free_list;
+			table->free_list = (pset_entry*)entry->dptr;
 		} else {
-			q = OALLOC(&table->obst, element_t);
+			entry = OALLOC(&table->obst, pset_entry);
 		}
-		q->entry.dptr = (void *)key;
+		entry->dptr = (void*)key;
 #else
-		obstack_blank(&table->obst, offsetof(element_t, entry.dptr));
+		obstack_blank(&table->obst, offsetof(set_entry, dptr));
 		if (action == _set_hinsert0)
 			obstack_grow0(&table->obst, key, size);
 		else
 			obstack_grow(&table->obst, key, size);
-		q = (segment_t)obstack_finish(&table->obst);
-		q->entry.size = size;
+		entry       = (set_entry*)obstack_finish(&table->obst);
+		entry->size = size;
 #endif
-		q->chain                       = current_segment[segment_index];
-		q->entry.hash                  = hash;
-		current_segment[segment_index] = q;
-
-		if (loaded(table)) {
-			/* does not affect q */
-			expand_table(table);
+		entry->hash = hash;
+
+		/* insert into the first empty slot or tombstone of the probe
+		 * sequence */
+		size_t mask = table->n_slots - 1;
+		size_t pos  = first_slot(table, hash);
+		for (size_t n_probes = 1;; ++n_probes) {
+			slot = &table->slots[pos];
+			if (slot->entry == NULL)
+				break;
+			if (slot->entry == DELETED) {
+				--table->n_deleted;
+				break;
+			}
+			pos = (pos + n_probes) & mask;
 		}
+		slot->hash  = hash;
+		slot->entry = entry;
+		++table->n_elements;
 	}
 
-	if (!q)
-		return NULL;
 #ifdef PSET
 	if (action == _pset_hinsert)
-		return &q->entry;
+		return entry;
 #else
 	if (action == _set_hinsert || action == _set_hinsert0)
-		return &q->entry;
+		return entry;
 #endif
-	return q->entry.dptr;
+	return entry->dptr;
 }
 
 #ifdef PSET
@@ -326,42 +288,20 @@ int pset_default_ptr_cmp(void const *x, void const *y)
 
 void *pset_remove(SET *table, void const *key, unsigned hash)
 {
-	assert(table && !table->iter_tail);
-
-	/* Find collision chain */
-	unsigned    h               = limit_hash(table, hash);
-	unsigned    segment_index   = h & (SEGMENT_SIZE - 1);
-	segment_t  *current_segment = table->dir[h >> SEGMENT_SIZE_SHIFT];
-	assert(current_segment != NULL);
-	segment_t  *p               = &current_segment[segment_index];
-
-	/* Follow collision chain */
-	pset_cmp_fun cmp = table->cmp;
-	while (!EQUAL(cmp, *p, key, size)) {
-		p = &(*p)->chain;
-		assert(*p);
-	}
+	assert(table && !table->iterating);
 
-	segment_t q = *p;
-	if (q == table->iter_tail) {
-		/* removing current element */
-		table->iter_tail = q->chain;
-		if (!table->iter_tail) {
-			/* go to next segment */
-			do {
-				if (!iter_step(table))
-					break;
-			} while (!table->dir[table->iter_i][table->iter_j]);
-			table->iter_tail = table->dir[table->iter_i][table->iter_j];
-		}
-	}
+	slot_t *slot = find_slot(table, key, hash);
+	assert(slot != NULL);
 
-	*p               = (*p)->chain;
-	q->chain         = table->free_list;
-	table->free_list = q;
-	--table->nkey;
+	pset_entry *entry = slot->entry;
+	slot->entry = DELETED;
+	++table->n_deleted;
+	--table->n_elements;
 
-	return q->entry.dptr;
+	void *dptr       = entry->dptr;
+	entry->dptr      = table->free_list;
+	table->free_list = entry;
+	return dptr;
 }
 
 void *(pset_find)(SET *se, void const *key, unsigned hash)
@@ -10,6 +10,7 @@
  */
 #include "constbits.h"
 
+#include "dataflow.h"
 #include "debug.h"
 #include "iredges_t.h"
 #include "irgwalk.h"
@@ -168,42 +169,6 @@ static bitinfo *get_bitinfo_direct(ir_node const *const irn)
 	return b;
 }
 
-static void calc_bitinfo(ir_node const *irn, bitinfo *b);
-
-/**
- * Get analysis information for node @p irn.
- *
- * If it is not available, calculate it.
- */
-static bitinfo *get_bitinfo_recursive(ir_node const *const irn)
-{
-	ir_graph   *const irg = get_irn_irg(irn);
-	ir_nodemap *const map = &irg->bitinfo.map;
-	bitinfo          *b   = ir_nodemap_get(bitinfo, map, irn);
-	if (!b || b->state == BITINFO_INVALID || b->state == BITINFO_UNSTABLE) {
-		ir_mode *mode = get_irn_mode(irn);
-		if (mode == mode_BB || mode == mode_X) {
-			/* Blocks and jumps use a boolean domain. */
-			mode = mode_b;
-		} else if (!mode_is_intb(mode)) {
-			return NULL;
-		}
-
-		/* Insert bottom to break cycles. */
-		struct obstack *const obst = &irg->bitinfo.obst;
-		if (!b)
-			b = OALLOCZ(obst, bitinfo);
-		if (b->state == BITINFO_INVALID) {
-			b->z = get_mode_null(mode);
-			b->o = get_mode_all_one(mode);
-		}
-		ir_nodemap_insert(map, irn, b);
-
-		calc_bitinfo(irn, b);
-	}
-	return b;
-}
-
 static bitinfo *(*get_bitinfo_func)(ir_node const*) = &get_bitinfo_null;
 
 bitinfo *get_bitinfo(ir_node const *const irn)
@@ -222,7 +187,7 @@ static bool transfer(ir_node const *const irn)
 	if (m == mode_X) {
 		DB((dbg, LEVEL_3, "transfer %+F\n", irn));
 
-		bitinfo *const b = get_bitinfo_recursive(get_nodes_block(irn));
+		bitinfo *const b = get_bitinfo_direct(get_nodes_block(irn));
 		if (b->z == f) {
 unreachable_X:
 			z = f;
@@ -237,7 +202,7 @@ unreachable_X:
 					goto result_unknown_X;
 				} else if (is_Cond(pred)) {
 					ir_node   *const selector = get_Cond_selector(pred);
-					bitinfo   *const b        = get_bitinfo_recursive(selector);
+					bitinfo   *const b        = get_bitinfo_direct(selector);
 					if (is_undefined(b))
 						goto unreachable_X;
 					if (b->z == b->o) {
@@ -251,7 +216,7 @@ unreachable_X:
 					}
 				} else if (is_Switch(pred)) {
 					ir_node *const selector = get_Switch_selector(pred);
-					bitinfo *const b        = get_bitinfo_recursive(selector);
+					bitinfo *const b        = get_bitinfo_direct(selector);
 					if (is_undefined(b))
 						goto unreachable_X;
 					/* TODO */
@@ -277,7 +242,7 @@ result_unknown_X:
 		DB((dbg, LEVEL_3, "transfer %+F\n", irn));
 		bool reachable = false;
 		foreach_irn_in(irn, i, pred_block) {
-			bitinfo *const b = get_bitinfo_recursive(pred_block);
+			bitinfo *const b = get_bitinfo_direct(pred_block);
 			if (b->z == t) {
 				reachable = true;
 				/* We need to iterate all operands to reach a global fix point.
@@ -305,32 +270,20 @@ result_unknown_X:
 		if (is_Phi(irn)) {
 			ir_node *const block = get_nodes_block(irn);
 
-repeatphi:
 			z = get_mode_null(m);
 			o = get_mode_all_one(m);
 			foreach_irn_in(block, i, pred_block) {
-				bitinfo *const b_cfg = get_bitinfo_recursive(pred_block);
+				bitinfo *const b_cfg = get_bitinfo_direct(pred_block);
 				if (b_cfg->z != f) {
-					bitinfo *const b = get_bitinfo_recursive(get_Phi_pred(irn, i));
+					bitinfo *const b = get_bitinfo_direct(get_Phi_pred(irn, i));
 					z = tarval_or( z, b->z);
 					o = tarval_and(o, b->o);
 				}
 			}
-			/* Computing bitinfo for operand 1 might render operand 0 unstable.
-			 * Thus, evaluate the operands until all of them are stable. */
-			foreach_irn_in(block, i, pred_block) {
-				bitinfo *const b_cfg = get_bitinfo_recursive(pred_block);
-				if (b_cfg->z != f) {
-					bitinfo *const b = get_bitinfo_direct(get_Phi_pred(irn, i));
-					if (b->state == BITINFO_UNSTABLE) {
-						goto repeatphi;
-					}
-				}
-			}
 		} else {
 			/* Undefined if any input is undefined. */
 			foreach_irn_in(irn, i, pred) {
-				bitinfo *const pred_b = get_bitinfo_recursive(pred);
+				bitinfo *const pred_b = get_bitinfo_direct(pred);
 				if (pred_b != NULL && is_undefined(pred_b))
 					goto undefined;
 			}
@@ -349,12 +302,12 @@ undefined:
 
 				case iro_Confirm: {
 					ir_node *const v = get_Confirm_value(irn);
-					bitinfo *const b = get_bitinfo_recursive(v);
+					bitinfo *const b = get_bitinfo_direct(v);
 					/* TODO Use bound and relation. */
 					z = b->z;
 					o = b->o;
 					if ((get_Confirm_relation(irn) & ~ir_relation_unordered) == ir_relation_equal) {
-						bitinfo *const bound_b = get_bitinfo_recursive(get_Confirm_bound(irn));
+						bitinfo *const bound_b = get_bitinfo_direct(get_Confirm_bound(irn));
 						z = tarval_and(z, bound_b->z);
 						o = tarval_or( o, bound_b->o);
 					}
@@ -363,8 +316,8 @@ undefined:
 
 				case iro_Shl: {
 					ir_node   *const right = get_Shl_right(irn);
-					bitinfo   *const l     = get_bitinfo_recursive(get_Shl_left(irn));
-					bitinfo   *const r     = get_bitinfo_recursive(right);
+					bitinfo   *const l     = get_bitinfo_direct(get_Shl_left(irn));
+					bitinfo   *const r     = get_bitinfo_direct(right);
 					ir_tarval *const lo    = l->o;
 					ir_tarval *const lz    = l->z;
 					ir_tarval *const ro    = r->o;
@@ -407,8 +360,8 @@ undefined:
 
 				case iro_Shr: {
 					ir_node   *const right = get_Shr_right(irn);
-					bitinfo   *const l     = get_bitinfo_recursive(get_Shr_left(irn));
-					bitinfo   *const r     = get_bitinfo_recursive(right);
+					bitinfo   *const l     = get_bitinfo_direct(get_Shr_left(irn));
+					bitinfo   *const r     = get_bitinfo_direct(right);
 					ir_tarval *const lz    = l->z;
 					ir_tarval *const lo    = l->o;
 					ir_tarval *const rz    = r->z;
@@ -451,8 +404,8 @@ undefined:
 
 				case iro_Shrs: {
 					ir_node   *const right = get_Shrs_right(irn);
-					bitinfo   *const l     = get_bitinfo_recursive(get_Shrs_left(irn));
-					bitinfo   *const r     = get_bitinfo_recursive(right);
+					bitinfo   *const l     = get_bitinfo_direct(get_Shrs_left(irn));
+					bitinfo   *const r     = get_bitinfo_direct(right);
 					ir_tarval *const lz    = l->z;
 					ir_tarval *const lo    = l->o;
 					ir_tarval *const rz    = r->z;
@@ -494,8 +447,8 @@ undefined:
 				}
 
 				case iro_Add: {
-					bitinfo   *const l   = get_bitinfo_recursive(get_Add_left(irn));
-					bitinfo   *const r   = get_bitinfo_recursive(get_Add_right(irn));
+					bitinfo   *const l   = get_bitinfo_direct(get_Add_left(irn));
+					bitinfo   *const r   = get_bitinfo_direct(get_Add_right(irn));
 					ir_tarval *const lz  = l->z;
 					ir_tarval *const lo  = l->o;
 					ir_tarval *const rz  = r->z;
@@ -512,8 +465,8 @@ undefined:
 				}
 
 				case iro_Sub: {
-					bitinfo *const l = get_bitinfo_recursive(get_Sub_left(irn));
-					bitinfo *const r = get_bitinfo_recursive(get_Sub_right(irn));
+					bitinfo *const l = get_bitinfo_direct(get_Sub_left(irn));
+					bitinfo *const r = get_bitinfo_direct(get_Sub_right(irn));
 					// might subtract pointers
 					if (l == NULL || r == NULL)
 						goto cannot_analyse;
@@ -534,8 +487,8 @@ undefined:
 				}
 
 				case iro_Mul: {
-					bitinfo   *const l  = get_bitinfo_recursive(get_Mul_left(irn));
-					bitinfo   *const r  = get_bitinfo_recursive(get_Mul_right(irn));
+					bitinfo   *const l  = get_bitinfo_direct(get_Mul_left(irn));
+					bitinfo   *const r  = get_bitinfo_direct(get_Mul_right(irn));
 					ir_tarval *      lz = l->z;
 					ir_tarval *      lo = l->o;
 					ir_tarval *      rz = r->z;
@@ -575,7 +528,7 @@ undefined:
 
 				case iro_Minus: {
 					/* -a = 0 - a */
-					bitinfo   *const b   = get_bitinfo_recursive(get_Minus_op(irn));
+					bitinfo   *const b   = get_bitinfo_direct(get_Minus_op(irn));
 					ir_tarval *const bz  = b->z;
 					ir_tarval *const bo  = b->o;
 					ir_tarval *const vz  = tarval_neg(bz);
@@ -590,24 +543,24 @@ undefined:
 				}
 
 				case iro_And: {
-					bitinfo *const l = get_bitinfo_recursive(get_And_left(irn));
-					bitinfo *const r = get_bitinfo_recursive(get_And_right(irn));
+					bitinfo *const l = get_bitinfo_direct(get_And_left(irn));
+					bitinfo *const r = get_bitinfo_direct(get_And_right(irn));
 					z = tarval_and(l->z, r->z);
 					o = tarval_and(l->o, r->o);
 					break;
 				}
 
 				case iro_Or: {
-					bitinfo *const l = get_bitinfo_recursive(get_Or_left(irn));
-					bitinfo *const r = get_bitinfo_recursive(get_Or_right(irn));
+					bitinfo *const l = get_bitinfo_direct(get_Or_left(irn));
+					bitinfo *const r = get_bitinfo_direct(get_Or_right(irn));
 					z = tarval_or(l->z, r->z);
 					o = tarval_or(l->o, r->o);
 					break;
 				}
 
 				case iro_Eor: {
-					bitinfo   *const l  = get_bitinfo_recursive(get_Eor_left(irn));
-					bitinfo   *const r  = get_bitinfo_recursive(get_Eor_right(irn));
+					bitinfo   *const l  = get_bitinfo_direct(get_Eor_left(irn));
+					bitinfo   *const r  = get_bitinfo_direct(get_Eor_right(irn));
 					ir_tarval *const lz = l->z;
 					ir_tarval *const lo = l->o;
 					ir_tarval *const rz = r->z;
@@ -618,14 +571,14 @@ undefined:
 				}
 
 				case iro_Not: {
-					bitinfo *const b = get_bitinfo_recursive(get_Not_op(irn));
+					bitinfo *const b = get_bitinfo_direct(get_Not_op(irn));
 					z = tarval_not(b->o);
 					o = tarval_not(b->z);
 					break;
 				}
 
 				case iro_Conv: {
-					bitinfo *const b = get_bitinfo_recursive(get_Conv_op(irn));
+					bitinfo *const b = get_bitinfo_direct(get_Conv_op(irn));
 					if (b == NULL) // Happens when converting from float values.
 						goto result_unknown;
 					z = tarval_convert_to(b->z, m);
@@ -634,9 +587,9 @@ undefined:
 				}
 
 				case iro_Mux: {
-					bitinfo *const bf = get_bitinfo_recursive(get_Mux_false(irn));
-					bitinfo *const bt = get_bitinfo_recursive(get_Mux_true(irn));
-					bitinfo *const c  = get_bitinfo_recursive(get_Mux_sel(irn));
+					bitinfo *const bf = get_bitinfo_direct(get_Mux_false(irn));
+					bitinfo *const bt = get_bitinfo_direct(get_Mux_true(irn));
+					bitinfo *const c  = get_bitinfo_direct(get_Mux_sel(irn));
 					if (c->o == t) {
 						z = bt->z;
 						o = bt->o;
@@ -651,8 +604,8 @@ undefined:
 				}
 
 				case iro_Cmp: {
-					bitinfo *const l = get_bitinfo_recursive(get_Cmp_left(irn));
-					bitinfo *const r = get_bitinfo_recursive(get_Cmp_right(irn));
+					bitinfo *const l = get_bitinfo_direct(get_Cmp_left(irn));
+					bitinfo *const r = get_bitinfo_direct(get_Cmp_right(irn));
 					if (l == NULL || r == NULL)
 						goto result_unknown; // Cmp compares something we cannot evaluate.
 					ir_tarval  *const lz       = l->z;
@@ -732,7 +685,7 @@ undefined:
 					if (is_Tuple(pred)) {
 						unsigned       pn = get_Proj_num(irn);
 						ir_node *const op = get_Tuple_pred(pred, pn);
-						bitinfo *const b  = get_bitinfo_recursive(op);
+						bitinfo *const b  = get_bitinfo_direct(op);
 						z = b->z;
 						o = b->o;
 						goto set_info;
@@ -760,23 +713,25 @@ set_info:;
 	return changed;
 }
 
-static void trigger_users(ir_node const *irn);
+static bool constbits_transfer(ir_node *const irn, void *const env)
+{
+	(void)env;
+	return transfer(irn);
+}
 
-static void trigger(ir_node const *const irn, ir_node const *const operand)
+static void trigger(dataflow_t *const df, ir_node *const irn, ir_node const *const operand)
 {
 	(void)operand;
 
-	bitinfo *const b = get_bitinfo_direct(irn);
-	if (b && b->state == BITINFO_VALID) {
+	if (get_bitinfo_direct(irn)) {
 		DB((dbg, LEVEL_5, "%+F triggers %+F\n", operand, irn));
-		b->state = BITINFO_UNSTABLE;
-		trigger_users(irn);
+		dataflow_push(df, irn);
 	} else {
 		DB((dbg, LEVEL_5, "%+F does not trigger %+F\n", operand, irn));
 	}
 }
 
-static void trigger_users(ir_node const *const irn)
+static void trigger_users(dataflow_t *const df, ir_node *const irn, void *const env)
 {
 	if (is_Bad(irn))
 		return;
@@ -787,7 +742,7 @@ static void trigger_users(ir_node const *const irn)
 		foreach_out_edge(irn, e) {
 			ir_node *const src = get_edge_src_irn(e);
 			if (get_irn_mode(src) == mode_X)
-				trigger(src, irn);
+				trigger(df, src, irn);
 		}
 	} else if (get_irn_mode(irn) == mode_X) {
 		if (!is_End(irn)) {
@@ -797,11 +752,11 @@ static void trigger_users(ir_node const *const irn)
 			foreach_out_edge(irn, e) {
 				ir_node *const src = get_edge_src_irn(e);
 				if (is_Block(src)) {
-					trigger(src, irn);
+					trigger(df, src, irn);
 					foreach_out_edge(src, f) {
 						ir_node *const phi = get_edge_src_irn(f);
 						if (is_Phi(phi))
-							trigger(phi, irn);
+							trigger(df, phi, irn);
 					}
 				} else {
 					assert(is_Tuple(src) && get_nodes_block(src) == get_nodes_block(irn));
@@ -814,32 +769,34 @@ static void trigger_users(ir_node const *const irn)
 			if (get_irn_mode(src) == mode_T) {
 				/* Trigger Projs of tuple nodes.  They might contain analysis information,
 				 * but the tuple node does not. */
-				trigger_users(src);
+				trigger_users(df, src, env);
 			} else {
-				trigger(src, irn);
+				trigger(df, src, irn);
 			}
 		}
 	}
 }
 
-static void calc_bitinfo(ir_node const *const irn, bitinfo *const b)
-{
-	do {
-		b->state = BITINFO_IN_FLIGHT;
-		bool const changed = transfer(irn);
-		b->state = BITINFO_VALID;
-		if (changed)
-			trigger_users(irn);
-	} while (b->state != BITINFO_VALID);
-}
-
-static void calc_bitinfo_walker(ir_node *const n, void *const env)
+/** Start all nodes taking part in the analysis at bottom. */
+static void init_bitinfo_walker(ir_node *const n, void *const env)
 {
-	(void)env;
+	dataflow_t *const df   = (dataflow_t*)env;
+	ir_mode          *mode = get_irn_mode(n);
+	if (mode == mode_BB || mode == mode_X) {
+		/* Blocks and jumps use a boolean domain. */
+		mode = mode_b;
+	} else if (!mode_is_intb(mode)) {
+		return;
+	}
 
-	ir_mode *const mode = get_irn_mode(n);
-	if (mode_is_intb(mode) || mode == mode_BB || mode == mode_X)
-		get_bitinfo_recursive(n);
+	ir_graph       *const irg  = get_irn_irg(n);
+	struct obstack *const obst = &irg->bitinfo.obst;
+	bitinfo        *const b    = OALLOCZ(obst, bitinfo);
+	b->z     = get_mode_null(mode);
+	b->o     = get_mode_all_one(mode);
+	b->state = BITINFO_VALID;
+	ir_nodemap_insert(&irg->bitinfo.map, n, b);
+	dataflow_push(df, n);
 }
 
 #if VERIFY_CONSTBITS
@@ -879,8 +836,10 @@ void constbits_analyze(ir_graph *const irg)
 
 	obstack_init(&irg->bitinfo.obst);
 	ir_nodemap_init(&irg->bitinfo.map, irg);
-	get_bitinfo_func = &get_bitinfo_recursive;
-	irg_walk_graph(irg, NULL, calc_bitinfo_walker, NULL);
+	dataflow_t *const df = new_dataflow(irg, constbits_transfer, trigger_users, NULL);
+	irg_walk_graph(irg, NULL, init_bitinfo_walker, df);
+	dataflow_solve(df);
+	free_dataflow(df);
 	get_bitinfo_func = &get_bitinfo_direct;
 
 #if VERIFY_CONSTBITS
@@ -7,8 +7,6 @@
 typedef enum bitinfo_state {
 	BITINFO_INVALID,
 	BITINFO_VALID,
-	BITINFO_IN_FLIGHT,
-	BITINFO_UNSTABLE,
 } bitinfo_state;
 
 typedef struct bitinfo
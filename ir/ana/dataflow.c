@@ -0,0 +1,143 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Sparse dataflow solver shared by the lattice based analyses.
+ */
+#include "dataflow.h"
+
+#include "bitset.h"
+#include "debug.h"
+#include "iredges_t.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "pqueue.h"
+#include "statev_t.h"
+#include "xmalloc.h"
+#include <limits.h>
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+struct dataflow_t {
+	ir_graph               *irg;
+	dataflow_transfer_func *transfer;
+	dataflow_users_func    *users;
+	void                   *env;
+	ir_node               **nodes;        /**< nodes in postorder */
+	unsigned               *order;        /**< 1 + position in nodes per node
+	                                       *   index, 0 if not walked */
+	bitset_t               *queued;       /**< nodes currently on a worklist */
+	pqueue_t               *cfg_worklist; /**< Blocks and mode_X nodes */
+	pqueue_t               *ssa_worklist; /**< all other nodes */
+	unsigned                n_nodes;
+};
+
+static void number_node(ir_node *node, void *data)
+{
+	dataflow_t *df = (dataflow_t*)data;
+	df->nodes[df->n_nodes++]     = node;
+	df->order[get_irn_idx(node)] = df->n_nodes;
+}
+
+static void push_users_default(dataflow_t *df, ir_node *node, void *env)
+{
+	(void)env;
+	dataflow_push_users(df, node);
+}
+
+dataflow_t *new_dataflow(ir_graph *irg, dataflow_transfer_func *transfer,
+                         dataflow_users_func *users, void *env)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.ana.dataflow");
+
+	unsigned    n_idx = get_irg_last_idx(irg);
+	dataflow_t *df    = XMALLOCZ(dataflow_t);
+	df->irg          = irg;
+	df->transfer     = transfer;
+	df->users        = users != NULL ? users : push_users_default;
+	df->env          = env;
+	df->nodes        = XMALLOCN(ir_node*, n_idx);
+	df->order        = XMALLOCNZ(unsigned, n_idx);
+	df->queued       = bitset_malloc(n_idx);
+	df->cfg_worklist = new_pqueue();
+	df->ssa_worklist = new_pqueue();
+
+	/* A postorder walk visits operands before their users (except for
+	 * backedges), so the postorder number is our priority. */
+	irg_walk_graph(irg, NULL, number_node, df);
+	return df;
+}
+
+void free_dataflow(dataflow_t *df)
+{
+	del_pqueue(df->ssa_worklist);
+	del_pqueue(df->cfg_worklist);
+	free(df->queued);
+	free(df->order);
+	free(df->nodes);
+	free(df);
+}
+
+static bool is_cfg_node(ir_node const *node)
+{
+	return is_Block(node) || get_irn_mode(node) == mode_X;
+}
+
+void dataflow_push(dataflow_t *df, ir_node *node)
+{
+	unsigned idx = get_irn_idx(node);
+	assert(idx < bitset_size(df->queued));
+	if (bitset_is_set(df->queued, idx))
+		return;
+	bitset_set(df->queued, idx);
+
+	/* pqueue pops the highest priority first, nodes not reached by the walk
+	 * come last. */
+	unsigned  order    = df->order[idx];
+	int       priority = order != 0 ? -(int)order : INT_MIN;
+	pqueue_t *worklist = is_cfg_node(node) ? df->cfg_worklist : df->ssa_worklist;
+	pqueue_put(worklist, node, priority);
+}
+
+void dataflow_push_users(dataflow_t *df, ir_node *node)
+{
+	foreach_out_edge(node, edge) {
+		dataflow_push(df, get_edge_src_irn(edge));
+	}
+}
+
+void dataflow_push_all(dataflow_t *df)
+{
+	for (unsigned i = 0; i < df->n_nodes; ++i) {
+		dataflow_push(df, df->nodes[i]);
+	}
+}
+
+unsigned dataflow_solve(dataflow_t *df)
+{
+	unsigned iterations = 0;
+	for (;;) {
+		ir_node *node;
+		if (!pqueue_empty(df->cfg_worklist)) {
+			node = (ir_node*)pqueue_pop_front(df->cfg_worklist);
+		} else if (!pqueue_empty(df->ssa_worklist)) {
+			node = (ir_node*)pqueue_pop_front(df->ssa_worklist);
+		} else {
+			break;
+		}
+		bitset_clear(df->queued, get_irn_idx(node));
+
+		++iterations;
+		if (df->transfer(node, df->env))
+			df->users(df, node, df->env);
+	}
+
+	DB((dbg, LEVEL_1, "%+F: fixpoint after %u transfers for %u nodes\n",
+	    df->irg, iterations, df->n_nodes));
+	stat_ev_int("dataflow_iterations", iterations);
+	return iterations;
+}
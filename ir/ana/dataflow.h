@@ -0,0 +1,73 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Sparse dataflow solver shared by the lattice based analyses.
+ *
+ * The solver keeps two worklists: one for control flow (Blocks and mode_X
+ * nodes) and one for data flow (all other nodes). The control flow worklist
+ * is always drained first, so reachability information is stable before
+ * values depending on it are recomputed. Inside each worklist nodes are
+ * processed in the postorder of a walk along the operands, i.e. definitions
+ * before their users except along loop back edges.
+ *
+ * The lattice values themselves are stored by the client analysis (usually
+ * in an ir_nodemap); the solver only decides which transfer function to
+ * evaluate next.
+ */
+#ifndef FIRM_ANA_DATAFLOW_H
+#define FIRM_ANA_DATAFLOW_H
+
+#include <stdbool.h>
+#include "firm_types.h"
+
+typedef struct dataflow_t dataflow_t;
+
+/**
+ * Evaluate the transfer function of @p node.
+ *
+ * @return true if the lattice value of @p node changed
+ */
+typedef bool dataflow_transfer_func(ir_node *node, void *env);
+
+/**
+ * Push all nodes whose value depends on @p node, after the value of @p node
+ * changed.
+ */
+typedef void dataflow_users_func(dataflow_t *df, ir_node *node, void *env);
+
+/**
+ * Create a new solver for @p irg.
+ *
+ * @param transfer  the transfer function of the analysis
+ * @param users     callback pushing the dependent nodes of a changed node,
+ *                  NULL pushes all users along the out edges (the graph
+ *                  must have consistent out edges in this case)
+ * @param env       environment passed to the callbacks
+ */
+dataflow_t *new_dataflow(ir_graph *irg, dataflow_transfer_func *transfer,
+                         dataflow_users_func *users, void *env);
+
+/** Free all memory used by the solver @p df. */
+void free_dataflow(dataflow_t *df);
+
+/** Put @p node on its worklist unless it is already queued. */
+void dataflow_push(dataflow_t *df, ir_node *node);
+
+/** Push all users of @p node along its out edges. */
+void dataflow_push_users(dataflow_t *df, ir_node *node);
+
+/** Push all nodes of the graph. */
+void dataflow_push_all(dataflow_t *df);
+
+/**
+ * Evaluate transfer functions until both worklists are empty.
+ *
+ * @return the number of transfer function evaluations
+ */
+unsigned dataflow_solve(dataflow_t *df);
+
+#endif
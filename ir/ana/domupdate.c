@@ -0,0 +1,716 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Incremental update of the dominator tree after control flow changes.
+ *
+ * Implements the dynamic dominator tree algorithm of Georgiadis et al.
+ * ("An Experimental Study of Dynamic Dominators"): Inserting an edge makes
+ * the blocks found by a depth based search from its target children of the
+ * nearest common dominator of the edge.  Deleting an edge recomputes the
+ * dominator subtree below the nearest common dominator of the edge with
+ * Semi-NCA.  Blocks becoming reachable or unreachable are attached to or
+ * removed from the tree.
+ *
+ * The successors of blocks are found through the block out edges, so
+ * neither the outs nor a walk over the whole graph are needed.  A batch of
+ * updates is applied one by one, while applying an update the control flow
+ * graph is viewed as if the later updates had not happened yet.
+ */
+#include "irdom_t.h"
+
+#include "array.h"
+#include "iredges_t.h"
+#include "irgraph_t.h"
+#include "irnode_t.h"
+#include "irnodemap.h"
+#include "obst.h"
+#include "pqueue.h"
+#include "xmalloc.h"
+
+/** Per block information of a Semi-NCA run. */
+typedef struct snca_info_t snca_info_t;
+struct snca_info_t {
+	ir_node      *block;
+	unsigned      num;    /**< DFS number, 0 if not visited yet */
+	unsigned      parent; /**< DFS number of the spanning tree parent, later
+	                           the ancestor in the virtual forest */
+	unsigned      semi;   /**< DFS number of the semidominator */
+	snca_info_t  *label;
+	snca_info_t  *idom;
+	ir_node     **preds;  /**< predecessors found by the DFS */
+};
+
+/** A control flow edge leading from a newly reachable block into the tree. */
+typedef struct connecting_edge_t {
+	ir_node *from;
+	ir_node *to;
+} connecting_edge_t;
+
+typedef struct dom_updater_t {
+	ir_graph              *irg;
+	ir_node               *end_block;
+	ir_sparse_nodeset      kept;     /**< blocks kept alive by End */
+	ir_cfg_update_t const *pending;  /**< updates not applied yet */
+	size_t                 n_pending;
+	/* state of the current Semi-NCA run */
+	struct obstack         obst;
+	ir_sparse_nodemap      infos;
+	snca_info_t          **order;    /**< infos by DFS number, [0] is NULL */
+	ir_node              **affected;
+	connecting_edge_t     *connecting;
+} dom_updater_t;
+
+/** Decides whether the DFS of a Semi-NCA run descends from @p from into
+ * @p to. */
+typedef bool (*descend_func)(dom_updater_t *env, ir_node *from, ir_node *to,
+                             int level);
+
+static ir_node *pop_block(ir_node **stack)
+{
+	size_t   const len   = ARR_LEN(stack);
+	ir_node *const block = stack[len - 1];
+	ARR_SHRINKLEN(stack, len - 1);
+	return block;
+}
+
+static inline ir_dom_info *dom_info(ir_node *block)
+{
+	return &block->attr.block.dom;
+}
+
+static inline int depth(ir_node *block)
+{
+	return dom_info(block)->dom_depth;
+}
+
+/** Returns true if @p block is part of the dominator tree. */
+static inline bool in_tree(ir_node *block)
+{
+	return depth(block) > 0;
+}
+
+static inline ir_node *idom(ir_node *block)
+{
+	return dom_info(block)->idom;
+}
+
+/** Removes @p block from the children of its immediate dominator. */
+static void unlink_block(ir_node *block)
+{
+	ir_dom_info *const bi   = dom_info(block);
+	ir_node     *const dom  = bi->idom;
+	if (dom != NULL) {
+		ir_node **p = &dom_info(dom)->first;
+		while (*p != block)
+			p = &dom_info(*p)->next;
+		*p = bi->next;
+	}
+	bi->idom = NULL;
+	bi->next = NULL;
+}
+
+static void set_idom(ir_node *block, ir_node *dom)
+{
+	unlink_block(block);
+	set_Block_idom(block, dom);
+	set_Block_dom_depth(block, depth(dom) + 1);
+}
+
+/** Recomputes the depths in the subtree below @p block. */
+static void update_depths(ir_node *block)
+{
+	int const child_depth = depth(block) + 1;
+	dominates_for_each(block, child) {
+		if (depth(child) == child_depth)
+			continue;
+		set_Block_dom_depth(child, child_depth);
+		update_depths(child);
+	}
+}
+
+/** Returns the nearest common dominator of two blocks in the tree. */
+static ir_node *nca(ir_node *a, ir_node *b)
+{
+	while (a != b) {
+		int const depth_a = depth(a);
+		int const depth_b = depth(b);
+		if (depth_a >= depth_b)
+			a = idom(a);
+		if (depth_b >= depth_a)
+			b = idom(b);
+	}
+	return a;
+}
+
+static bool is_pending(dom_updater_t const *env, ir_node const *from,
+                       ir_node const *to, bool insert)
+{
+	for (size_t i = 0; i < env->n_pending; ++i) {
+		ir_cfg_update_t const *update = &env->pending[i];
+		if (update->from == from && update->to == to
+		 && update->insert == insert)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Collects the successors of @p block in the graph before the pending
+ * updates.
+ */
+static void get_succs(dom_updater_t const *env, ir_node *block,
+                      ir_node ***succs)
+{
+	ARR_SHRINKLEN(*succs, 0);
+	foreach_block_succ(block, edge) {
+		ir_node *const succ = get_edge_src_irn(edge);
+		if (!is_pending(env, block, succ, true))
+			ARR_APP1(ir_node*, *succs, succ);
+	}
+	if (block != env->end_block
+	 && ir_sparse_nodeset_contains(&env->kept, block)
+	 && !is_pending(env, block, env->end_block, true))
+		ARR_APP1(ir_node*, *succs, env->end_block);
+	for (size_t i = 0; i < env->n_pending; ++i) {
+		ir_cfg_update_t const *update = &env->pending[i];
+		if (update->from == block && !update->insert)
+			ARR_APP1(ir_node*, *succs, update->to);
+	}
+}
+
+/**
+ * Collects the predecessors of @p block in the graph before the pending
+ * updates.
+ */
+static void get_preds(dom_updater_t const *env, ir_node *block,
+                      ir_node ***preds)
+{
+	ARR_SHRINKLEN(*preds, 0);
+	for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+		ir_node *const pred = get_Block_cfgpred_block(block, i);
+		if (pred != NULL && !is_pending(env, pred, block, true))
+			ARR_APP1(ir_node*, *preds, pred);
+	}
+	if (block == env->end_block) {
+		foreach_ir_sparse_nodeset(&env->kept, kept) {
+			if (kept != block && !is_pending(env, kept, block, true))
+				ARR_APP1(ir_node*, *preds, kept);
+		}
+	}
+	for (size_t i = 0; i < env->n_pending; ++i) {
+		ir_cfg_update_t const *update = &env->pending[i];
+		if (update->to == block && !update->insert)
+			ARR_APP1(ir_node*, *preds, update->from);
+	}
+}
+
+static void snca_init(dom_updater_t *env)
+{
+	obstack_init(&env->obst);
+	ir_sparse_nodemap_init(&env->infos, env->irg);
+	env->order = NEW_ARR_F(snca_info_t*, 1);
+	env->order[0] = NULL;
+}
+
+static void snca_free(dom_updater_t *env)
+{
+	for (size_t i = 1, n = ARR_LEN(env->order); i < n; ++i)
+		DEL_ARR_F(env->order[i]->preds);
+	DEL_ARR_F(env->order);
+	ir_sparse_nodemap_destroy(&env->infos);
+	obstack_free(&env->obst, NULL);
+}
+
+static snca_info_t *get_info(dom_updater_t *env, ir_node *block)
+{
+	snca_info_t *info = ir_sparse_nodemap_get(snca_info_t, &env->infos, block);
+	if (info == NULL) {
+		info = OALLOCZ(&env->obst, snca_info_t);
+		info->block = block;
+		info->preds = NEW_ARR_F(ir_node*, 0);
+		ir_sparse_nodemap_insert(&env->infos, block, info);
+	}
+	return info;
+}
+
+/**
+ * Numbers the blocks reachable from @p root in depth first order, only
+ * descending into blocks accepted by @p descend.
+ */
+static void snca_dfs(dom_updater_t *env, ir_node *root, descend_func descend,
+                     int level)
+{
+	ir_node **worklist = NEW_ARR_F(ir_node*, 0);
+	ir_node **succs    = NEW_ARR_F(ir_node*, 0);
+	ARR_APP1(ir_node*, worklist, root);
+	get_info(env, root)->parent = 0;
+	while (ARR_LEN(worklist) > 0) {
+		ir_node     *const block = pop_block(worklist);
+		snca_info_t *const info  = get_info(env, block);
+		if (info->num != 0)
+			continue;
+
+		info->num   = ARR_LEN(env->order);
+		info->semi  = info->num;
+		info->label = info;
+		ARR_APP1(snca_info_t*, env->order, info);
+
+		get_succs(env, block, &succs);
+		for (size_t i = ARR_LEN(succs); i-- > 0;) {
+			ir_node     *const succ      = succs[i];
+			snca_info_t *const succ_info
+				= ir_sparse_nodemap_get(snca_info_t, &env->infos, succ);
+			/* remember the predecessors of visited blocks */
+			if (succ_info != NULL && succ_info->num != 0) {
+				if (succ != block)
+					ARR_APP1(ir_node*, succ_info->preds, block);
+				continue;
+			}
+			if (!descend(env, block, succ, level))
+				continue;
+
+			snca_info_t *const new_info = get_info(env, succ);
+			new_info->parent = info->num;
+			ARR_APP1(ir_node*, new_info->preds, block);
+			ARR_APP1(ir_node*, worklist, succ);
+		}
+	}
+	DEL_ARR_F(succs);
+	DEL_ARR_F(worklist);
+}
+
+/**
+ * Returns the block with the minimal semidominator on the path from @p info
+ * to the root of its tree in the virtual forest.  Compresses the path.
+ */
+static snca_info_t *snca_eval(dom_updater_t *env, snca_info_t *info,
+                              unsigned last_linked, snca_info_t ***stack)
+{
+	if (info->parent < last_linked)
+		return info->label;
+
+	do {
+		ARR_APP1(snca_info_t*, *stack, info);
+		info = env->order[info->parent];
+	} while (info->parent >= last_linked);
+
+	snca_info_t *p_info  = info;
+	snca_info_t *p_label = p_info->label;
+	do {
+		size_t const len = ARR_LEN(*stack);
+		info = (*stack)[len - 1];
+		ARR_SHRINKLEN(*stack, len - 1);
+		info->parent = p_info->parent;
+		if (p_label->semi < info->label->semi)
+			info->label = p_label;
+		else
+			p_label = info->label;
+		p_info = info;
+	} while (ARR_LEN(*stack) > 0);
+	return info->label;
+}
+
+/**
+ * Computes the immediate dominators of the blocks numbered by snca_dfs().
+ * Predecessors in the tree above @p min_depth are ignored.
+ */
+static void snca_run(dom_updater_t *env, int min_depth)
+{
+	size_t const n = ARR_LEN(env->order);
+	for (size_t i = 1; i < n; ++i) {
+		snca_info_t *const info = env->order[i];
+		info->idom = env->order[info->parent];
+	}
+
+	snca_info_t **stack = NEW_ARR_F(snca_info_t*, 0);
+	for (size_t i = n; i-- > 2;) {
+		snca_info_t *const w = env->order[i];
+		w->semi = w->parent;
+		for (size_t p = 0, n_preds = ARR_LEN(w->preds); p < n_preds; ++p) {
+			ir_node     *const pred      = w->preds[p];
+			snca_info_t *const pred_info
+				= ir_sparse_nodemap_get(snca_info_t, &env->infos, pred);
+			if (pred_info == NULL || pred_info->num == 0)
+				continue;
+			if (in_tree(pred) && depth(pred) < min_depth)
+				continue;
+			unsigned const semi
+				= snca_eval(env, pred_info, i + 1, &stack)->semi;
+			if (semi < w->semi)
+				w->semi = semi;
+		}
+	}
+	DEL_ARR_F(stack);
+
+	for (size_t i = 2; i < n; ++i) {
+		snca_info_t *const w    = env->order[i];
+		snca_info_t       *dom  = w->idom;
+		while (dom->num > w->semi)
+			dom = dom->idom;
+		w->idom = dom;
+	}
+}
+
+/**
+ * Makes the computed dominators of the blocks numbered by snca_dfs() part
+ * of the tree, the root of the DFS becomes a child of @p attach_to.
+ */
+static void snca_attach(dom_updater_t *env, ir_node *attach_to)
+{
+	for (size_t i = 1, n = ARR_LEN(env->order); i < n; ++i) {
+		snca_info_t *const info = env->order[i];
+		ir_node     *const dom  = i == 1 ? attach_to : info->idom->block;
+		set_idom(info->block, dom);
+	}
+}
+
+static void snca_clear(dom_updater_t *env)
+{
+	snca_free(env);
+	snca_init(env);
+}
+
+static bool descend_all(dom_updater_t *env, ir_node *from, ir_node *to,
+                        int level)
+{
+	(void)env; (void)from; (void)to; (void)level;
+	return true;
+}
+
+static bool descend_below(dom_updater_t *env, ir_node *from, ir_node *to,
+                          int level)
+{
+	(void)env; (void)from;
+	return in_tree(to) && depth(to) > level;
+}
+
+static bool descend_unreachable(dom_updater_t *env, ir_node *from, ir_node *to,
+                                int level)
+{
+	(void)level;
+	if (!in_tree(to))
+		return true;
+	connecting_edge_t const edge = { from, to };
+	ARR_APP1(connecting_edge_t, env->connecting, edge);
+	return false;
+}
+
+static bool descend_and_collect(dom_updater_t *env, ir_node *from,
+                                ir_node *to, int level)
+{
+	(void)from;
+	if (!in_tree(to))
+		return false;
+	if (depth(to) > level)
+		return true;
+	for (size_t i = 0, n = ARR_LEN(env->affected); i < n; ++i) {
+		if (env->affected[i] == to)
+			return false;
+	}
+	ARR_APP1(ir_node*, env->affected, to);
+	return false;
+}
+
+static void remove_from_tree(ir_node *block)
+{
+	unlink_block(block);
+	set_Block_dom_depth(block, -1);
+}
+
+static void collect_tree(ir_node *block, void *data)
+{
+	ir_node ***blocks = (ir_node***)data;
+	ARR_APP1(ir_node*, *blocks, block);
+}
+
+/** Rebuilds the whole dominator tree. */
+static void recompute(dom_updater_t *env)
+{
+	ir_node  *const start  = get_irg_start_block(env->irg);
+	ir_node **const blocks = NEW_ARR_F(ir_node*, 0);
+	dom_tree_walk(start, NULL, collect_tree, (void*)&blocks);
+	for (size_t i = 0, n = ARR_LEN(blocks); i < n; ++i)
+		remove_from_tree(blocks[i]);
+	DEL_ARR_F(blocks);
+
+	snca_clear(env);
+	snca_dfs(env, start, descend_all, 0);
+	snca_run(env, 0);
+	for (size_t i = 1, n = ARR_LEN(env->order); i < n; ++i) {
+		snca_info_t *const info = env->order[i];
+		if (i == 1) {
+			set_Block_idom(start, NULL);
+			set_Block_dom_depth(start, 1);
+		} else {
+			set_idom(info->block, info->idom->block);
+		}
+	}
+}
+
+/** Handles the insertion of an edge between two blocks of the tree. */
+static void insert_reachable(dom_updater_t *env, ir_node *from, ir_node *to)
+{
+	ir_node *const ncd       = nca(from, to);
+	int      const ncd_depth = depth(ncd);
+	/* Only blocks deeper than a child of the nearest common dominator are
+	 * affected, see Lemma 2.5 of Georgiadis et al. */
+	if (depth(to) <= ncd_depth + 1)
+		return;
+
+	ir_sparse_nodeset visited;
+	ir_sparse_nodeset_init(&visited, env->irg);
+	pqueue_t  *const bucket     = new_pqueue();
+	ir_node  **      affected   = NEW_ARR_F(ir_node*, 0);
+	ir_node  **      unaffected = NEW_ARR_F(ir_node*, 0);
+	ir_node  **      succs      = NEW_ARR_F(ir_node*, 0);
+
+	pqueue_put(bucket, to, depth(to));
+	ir_sparse_nodeset_insert(&visited, to);
+	while (!pqueue_empty(bucket)) {
+		ir_node *block = (ir_node*)pqueue_pop_front(bucket);
+		ARR_APP1(ir_node*, affected, block);
+
+		int const current_depth = depth(block);
+		for (;;) {
+			get_succs(env, block, &succs);
+			for (size_t i = 0, n = ARR_LEN(succs); i < n; ++i) {
+				ir_node *const succ       = succs[i];
+				int      const succ_depth = depth(succ);
+				if (succ_depth <= ncd_depth + 1
+				 || !ir_sparse_nodeset_insert(&visited, succ))
+					continue;
+				if (succ_depth > current_depth)
+					ARR_APP1(ir_node*, unaffected, succ);
+				else
+					pqueue_put(bucket, succ, succ_depth);
+			}
+			if (ARR_LEN(unaffected) == 0)
+				break;
+			block = pop_block(unaffected);
+		}
+	}
+
+	for (size_t i = 0, n = ARR_LEN(affected); i < n; ++i) {
+		set_idom(affected[i], ncd);
+		update_depths(affected[i]);
+	}
+
+	DEL_ARR_F(succs);
+	DEL_ARR_F(unaffected);
+	DEL_ARR_F(affected);
+	del_pqueue(bucket);
+	ir_sparse_nodeset_destroy(&visited);
+}
+
+/** Handles the insertion of an edge making @p to reachable. */
+static void insert_unreachable(dom_updater_t *env, ir_node *from, ir_node *to)
+{
+	env->connecting = NEW_ARR_F(connecting_edge_t, 0);
+	snca_clear(env);
+	snca_dfs(env, to, descend_unreachable, 0);
+	snca_run(env, 0);
+	snca_attach(env, from);
+
+	connecting_edge_t *const connecting = env->connecting;
+	env->connecting = NULL;
+	for (size_t i = 0, n = ARR_LEN(connecting); i < n; ++i)
+		insert_reachable(env, connecting[i].from, connecting[i].to);
+	DEL_ARR_F(connecting);
+}
+
+static void insert_edge(dom_updater_t *env, ir_node *from, ir_node *to)
+{
+	/* edges from unreachable code do not change anything */
+	if (!in_tree(from))
+		return;
+	if (in_tree(to))
+		insert_reachable(env, from, to);
+	else
+		insert_unreachable(env, from, to);
+}
+
+/**
+ * Returns true if a predecessor of @p block, which is not dominated by it,
+ * remains.
+ */
+static bool has_proper_support(dom_updater_t *env, ir_node *block)
+{
+	ir_node **preds = NEW_ARR_F(ir_node*, 0);
+	get_preds(env, block, &preds);
+	bool res = false;
+	for (size_t i = 0, n = ARR_LEN(preds); i < n; ++i) {
+		ir_node *const pred = preds[i];
+		if (in_tree(pred) && nca(block, pred) != block) {
+			res = true;
+			break;
+		}
+	}
+	DEL_ARR_F(preds);
+	return res;
+}
+
+/** Handles the deletion of an edge after which @p to stays reachable. */
+static void delete_reachable(dom_updater_t *env, ir_node *from, ir_node *to)
+{
+	ir_node *const top      = nca(from, to);
+	ir_node *const top_idom = idom(top);
+	if (top_idom == NULL) {
+		recompute(env);
+		return;
+	}
+
+	snca_clear(env);
+	snca_dfs(env, top, descend_below, depth(top));
+	snca_run(env, depth(top));
+	snca_attach(env, top_idom);
+}
+
+/** Handles the deletion of the last edge leading to @p to. */
+static void delete_unreachable(dom_updater_t *env, ir_node *to)
+{
+	int const level = depth(to);
+	env->affected = NEW_ARR_F(ir_node*, 0);
+	snca_clear(env);
+	snca_dfs(env, to, descend_and_collect, level);
+
+	/* The reachable blocks entered from the subtree of to lose a
+	 * predecessor, the dominators below their common dominator with to have
+	 * to be recomputed. */
+	ir_node *min_block = to;
+	for (size_t i = 0, n = ARR_LEN(env->affected); i < n; ++i) {
+		ir_node *const block = env->affected[i];
+		ir_node *const ncd   = nca(block, to);
+		if (ncd != block && depth(ncd) < depth(min_block))
+			min_block = ncd;
+	}
+	DEL_ARR_F(env->affected);
+	env->affected = NULL;
+
+	if (idom(min_block) == NULL) {
+		recompute(env);
+		return;
+	}
+
+	/* Remove the subtree in reverse preorder, so children go first. */
+	for (size_t i = ARR_LEN(env->order); i-- > 1;)
+		remove_from_tree(env->order[i]->block);
+	if (min_block == to)
+		return;
+
+	int      const min_depth = depth(min_block);
+	ir_node *const prev_idom = idom(min_block);
+	snca_clear(env);
+	snca_dfs(env, min_block, descend_below, min_depth);
+	snca_run(env, min_depth);
+	snca_attach(env, prev_idom);
+}
+
+static void delete_edge(dom_updater_t *env, ir_node *from, ir_node *to)
+{
+	if (!in_tree(from) || !in_tree(to))
+		return;
+	/* deleting an edge to a dominator of from changes nothing */
+	if (nca(from, to) == to)
+		return;
+	if (from != idom(to) || has_proper_support(env, to))
+		delete_reachable(env, from, to);
+	else
+		delete_unreachable(env, to);
+}
+
+/** Returns the number of control flow edges from @p from to @p to. */
+static int count_edges(dom_updater_t const *env, ir_node *from, ir_node *to)
+{
+	int n_edges = 0;
+	for (int i = 0, n = get_Block_n_cfgpreds(to); i < n; ++i) {
+		if (get_Block_cfgpred_block(to, i) == from)
+			++n_edges;
+	}
+	if (to == env->end_block) {
+		foreach_irn_in(get_irg_end(env->irg), i, kept) {
+			if (kept == from)
+				++n_edges;
+		}
+	}
+	return n_edges;
+}
+
+/**
+ * Merges the updates of edges between the same blocks and drops updates
+ * which only change the number of edges between two connected blocks.
+ */
+static ir_cfg_update_t *legalize_updates(dom_updater_t const *env,
+                                         size_t n_updates,
+                                         ir_cfg_update_t const *updates)
+{
+	ir_cfg_update_t *res = NEW_ARR_F(ir_cfg_update_t, 0);
+	for (size_t i = 0; i < n_updates; ++i) {
+		ir_cfg_update_t const *const update = &updates[i];
+		bool seen = false;
+		for (size_t j = 0; j < i; ++j) {
+			if (updates[j].from == update->from && updates[j].to == update->to) {
+				seen = true;
+				break;
+			}
+		}
+		if (seen)
+			continue;
+
+		int count = 0;
+		for (size_t j = i; j < n_updates; ++j) {
+			if (updates[j].from == update->from && updates[j].to == update->to)
+				count += updates[j].insert ? 1 : -1;
+		}
+		int const n_after  = count_edges(env, update->from, update->to);
+		int const n_before = n_after - count;
+		if ((n_before == 0) != (n_after == 0)) {
+			ir_cfg_update_t const legal = {
+				update->from, update->to, n_after > 0
+			};
+			ARR_APP1(ir_cfg_update_t, res, legal);
+		}
+	}
+	return res;
+}
+
+void dom_update_cfg(ir_graph *irg, size_t n_updates,
+                    ir_cfg_update_t const *updates)
+{
+	if (!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE))
+		return;
+	assert(edges_activated_kind(irg, EDGE_KIND_BLOCK));
+
+	dom_updater_t env;
+	memset(&env, 0, sizeof(env));
+	env.irg       = irg;
+	env.end_block = get_irg_end_block(irg);
+	ir_sparse_nodeset_init(&env.kept, irg);
+	foreach_irn_in(get_irg_end(irg), i, kept) {
+		if (is_Block(kept))
+			ir_sparse_nodeset_insert(&env.kept, kept);
+	}
+	snca_init(&env);
+
+	ir_cfg_update_t *const legal = legalize_updates(&env, n_updates, updates);
+	for (size_t i = 0, n = ARR_LEN(legal); i < n; ++i) {
+		env.pending   = &legal[i + 1];
+		env.n_pending = n - i - 1;
+		ir_cfg_update_t const *const update = &legal[i];
+		if (update->insert)
+			insert_edge(&env, update->from, update->to);
+		else
+			delete_edge(&env, update->from, update->to);
+	}
+	DEL_ARR_F(legal);
+
+	snca_free(&env);
+	ir_sparse_nodeset_destroy(&env.kept);
+
+	assign_tree_dom_pre_order(irg);
+	ir_free_dominance_frontiers(irg);
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE);
+}
@@ -286,7 +286,7 @@ void postdom_tree_walk_irg(ir_graph *irg, irg_walk_func *pre,
 }
 
 
-static void assign_tree_dom_pre_order(ir_node *block, void *data)
+static void assign_tree_dom_pre_order_walker(ir_node *block, void *data)
 {
 	unsigned    *num = (unsigned*)data;
 	ir_dom_info *bi  = get_dom_info(block);
@@ -311,6 +311,14 @@ static void assign_tree_dom_pre_order_max(ir_node *block, void *data)
 	assert(bi->max_subtree_pre_num >= bi->tree_pre_num);
 }
 
+void assign_tree_dom_pre_order(ir_graph *irg)
+{
+	/* Do a walk over the tree and assign the tree pre orders. */
+	unsigned tree_pre_order = 0;
+	dom_tree_walk(get_irg_start_block(irg), assign_tree_dom_pre_order_walker,
+	              assign_tree_dom_pre_order_max, &tree_pre_order);
+}
+
 static void assign_tree_postdom_pre_order(ir_node *block, void *data)
 {
 	unsigned    *num = (unsigned*)data;
@@ -598,11 +606,7 @@ void compute_doms(ir_graph *irg)
 	free(tdi_list);
 
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
-
-	/* Do a walk over the tree and assign the tree pre orders. */
-	unsigned tree_pre_order = 0;
-	dom_tree_walk(get_irg_start_block(irg), assign_tree_dom_pre_order,
-	              assign_tree_dom_pre_order_max, &tree_pre_order);
+	assign_tree_dom_pre_order(irg);
 }
 
 static void update_pdom_semi(tmp_dom_info *tdi_list, tmp_dom_info *w,
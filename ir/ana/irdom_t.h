@@ -15,6 +15,7 @@
 #include "irdom.h"
 #include "pmap.h"
 #include "obst.h"
+#include <stdbool.h>
 
 /** For dominator information */
 typedef struct ir_dom_info {
@@ -57,6 +58,36 @@ unsigned get_Block_pdom_max_subtree_pre_num(const ir_node *bl);
 
 void ir_free_dominance_frontiers(ir_graph *irg);
 
+/**
+ * Numbers the blocks in a preorder walk over the dominator tree, which is
+ * used by block_dominates().
+ */
+void assign_tree_dom_pre_order(ir_graph *irg);
+
+/** A change of the control flow graph, see dom_update_cfg(). */
+typedef struct ir_cfg_update_t {
+	ir_node *from;   /**< the predecessor block */
+	ir_node *to;     /**< the successor block */
+	bool     insert; /**< the edge was inserted, else it was deleted */
+} ir_cfg_update_t;
+
+/**
+ * Updates the dominator tree after changes of the control flow graph.
+ *
+ * @p updates lists every control flow edge inserted into and deleted from
+ * the graph since the dominance information was consistent, the graph must
+ * already contain the changes.  An edge is identified by its blocks, so
+ * several edges between the same blocks are listed as often as they were
+ * inserted or deleted.  Keep-alive edges of blocks are edges to the End
+ * block.  Blocks becoming reachable
+ * are added to the tree, blocks becoming unreachable get depth -1.
+ *
+ * Requires the block out edges.  Does nothing if the dominance information
+ * is not consistent.  Post dominance and dominance frontiers are invalidated.
+ */
+void dom_update_cfg(ir_graph *irg, size_t n_updates,
+                    ir_cfg_update_t const *updates);
+
 /**
  * Iterate over all nodes which are immediately dominated by a given
  * node.
@@ -21,66 +21,195 @@
  * - data obtained from a depth-first-search
  *
  * The precomputation remains valid as long as the CFG is not altered.
+ *
+ * The reachability sets of the reduced graph are indexed by DFS post number.
+ * A block only reaches blocks with smaller post numbers, so the set of a block
+ * with post number p has p + 1 bits and is computed by or-ing the sets of
+ * its successors word by word.  Small graphs compute all sets in the
+ * constructor.  Large graphs answer queries with a short search in the
+ * reduced graph and only compute the sets of blocks where that search does
+ * not terminate quickly.
  */
 #include "irlivechk.h"
 
 /* statev is expensive here, only enable when needed */
 #define DISABLE_STATEV
 
-#include "bitset.h"
+#include "array.h"
 #include "debug.h"
-#include "dfs_t.h"
 #include "irdom.h"
-#include "irdump.h"
 #include "iredges_t.h"
 #include "irgraph_t.h"
-#include "irgraph_t.h"
 #include "irnode_t.h"
 #include "irnodemap.h"
+#include "raw_bitset.h"
 #include "statev_t.h"
+#include "util.h"
 #include <stdio.h>
 
-typedef struct bl_info_t {
-	const ir_node *block;      /**< The block. */
+/**
+ * By default graphs with up to this many blocks compute the reachability sets
+ * of all blocks in the constructor (at most 1MiB).  Larger graphs compute them
+ * on demand.
+ */
+#define LV_CHK_EAGER_MAX_BLOCKS 4096
 
-	unsigned be_tgt_calc : 1;
-	unsigned id : 31;          /**< A tight number for the block.
-	                                we're just reusing the pre num from
-	                                the DFS. */
-	bitset_t *red_reachable;   /**< Holds all id's if blocks reachable
-	                                in the CFG modulo back edges. */
+/**
+ * Without a reachability set a query searches the reduced graph.  If the
+ * search visits more blocks than this, the set is computed instead.
+ */
+#define LV_CHK_SEARCH_LIMIT 32
 
-	bitset_t *be_tgt_reach;    /**< Target blocks of back edges whose
-	                                sources are reachable from this block
-	                                in the reduced graph. */
-} bl_info_t;
+static unsigned eager_max_blocks = LV_CHK_EAGER_MAX_BLOCKS;
+
+/** A set of blocks given by their sorted dominance pre numbers. */
+typedef struct id_set_t {
+	const unsigned *ids;
+	unsigned        n;
+} id_set_t;
+
+typedef struct bl_info_t bl_info_t;
+struct bl_info_t {
+	const ir_node *block;      /**< The block. */
+
+	unsigned id;               /**< The pre number in the dominance tree. */
+	unsigned pre_num;          /**< The DFS pre number. */
+	unsigned max_pre_num;      /**< The largest DFS pre number in the
+	                                DFS subtree of the block. */
+	unsigned post_num;         /**< The DFS post number. */
+	unsigned visited;          /**< Search number of the last visit. */
+	bool     be_src;           /**< The block is a back edge source. */
+	bool     be_tgt;           /**< The block is a back edge target. */
+
+	bl_info_t **red_succs;     /**< Successors in the reduced graph. */
+	unsigned    n_red_succs;
+	bl_info_t **be_tgts;       /**< Targets of back edges from this block. */
+	unsigned    n_be_tgts;
+
+	unsigned *red_reachable;   /**< Holds the post numbers of all blocks
+	                                reachable in the CFG modulo back edges.
+	                                NULL if not computed yet. */
+
+	id_set_t up;               /**< Back edge targets which are not
+	                                reachable in the reduced graph, but whose
+	                                back edge sources are. */
+
+	id_set_t be_tgt_reach;     /**< Back edge targets whose sources are
+	                                reachable from this block in the reduced
+	                                graph.  The block itself is implicitly
+	                                part of the set. */
+};
 
 struct lv_chk_t {
 	ir_nodemap     block_infos;
 	struct obstack obst;
-	dfs_t         *dfs;
-	int            n_blocks;
-	bitset_t      *back_edge_src;
-	bitset_t      *back_edge_tgt;
-	bl_info_t    **map;
+	unsigned       n_blocks;
+	bl_info_t    **map;            /**< maps dominance pre numbers to blocks */
+	bl_info_t    **post_order;     /**< maps post numbers to blocks */
+	unsigned      *uses;           /**< query scratch set, kept empty */
+	bl_info_t    **stack;          /**< scratch stack for the reduced DFS */
+	unsigned       n_searches;     /**< number of reduced searches */
 	DEBUG_ONLY(firm_dbg_module_t *dbg;)
 };
 
+typedef struct dfs_entry_t {
+	bl_info_t       *bi;
+	const ir_edge_t *edge;  /**< next successor edge to visit */
+} dfs_entry_t;
+
 static bl_info_t *get_block_info(lv_chk_t *lv, const ir_node *block)
 {
-	bl_info_t *info = ir_nodemap_get(bl_info_t, &lv->block_infos, block);
-	if (info == NULL) {
-		info                = OALLOC(&lv->obst, bl_info_t);
-		info->id            = get_Block_dom_tree_pre_num(block);
-		info->block         = block;
-		info->red_reachable = bitset_obstack_alloc(&lv->obst, lv->n_blocks);
-		info->be_tgt_reach  = bitset_obstack_alloc(&lv->obst, lv->n_blocks);
-		info->be_tgt_calc   = 0;
-		ir_nodemap_insert(&lv->block_infos, block, info);
-	}
+	return ir_nodemap_get(bl_info_t, &lv->block_infos, block);
+}
+
+static bl_info_t *new_block_info(lv_chk_t *lv, bl_info_t ***blocks,
+                                 const ir_node *block)
+{
+	bl_info_t *info = OALLOCZ(&lv->obst, bl_info_t);
+	info->block   = block;
+	info->id      = get_Block_dom_tree_pre_num(block);
+	info->pre_num = ARR_LEN(*blocks);
+	ir_nodemap_insert(&lv->block_infos, block, info);
+	ARR_APP1(bl_info_t*, *blocks, info);
 	return info;
 }
 
+/**
+ * Numbers the blocks in depth first order and returns them in pre order.
+ * This visits the successors in the same order as a recursive search but
+ * does not need a deep C stack on large graphs.
+ */
+static bl_info_t **number_blocks(lv_chk_t *lv, ir_graph *irg)
+{
+	bl_info_t  **blocks   = NEW_ARR_F(bl_info_t*, 0);
+	unsigned     post_num = 0;
+	dfs_entry_t *stack    = NEW_ARR_F(dfs_entry_t, 0);
+
+	ir_node    *start = get_irg_start_block(irg);
+	dfs_entry_t entry = { new_block_info(lv, &blocks, start),
+	                      get_block_succ_first(start) };
+	ARR_APP1(dfs_entry_t, stack, entry);
+	while (ARR_LEN(stack) > 0) {
+		dfs_entry_t *top  = &stack[ARR_LEN(stack) - 1];
+		const ir_edge_t *edge = top->edge;
+		if (edge == NULL) {
+			top->bi->max_pre_num = ARR_LEN(blocks) - 1;
+			top->bi->post_num    = post_num++;
+			ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+			continue;
+		}
+
+		top->edge = get_block_succ_next(top->bi->block, edge);
+		ir_node *succ = get_edge_src_irn(edge);
+		if (get_block_info(lv, succ) == NULL) {
+			entry.bi   = new_block_info(lv, &blocks, succ);
+			entry.edge = get_block_succ_first(succ);
+			ARR_APP1(dfs_entry_t, stack, entry);
+		}
+	}
+	DEL_ARR_F(stack);
+
+	/* the end block may only be reached through keep-alive edges */
+	ir_node *end = get_irg_end_block(irg);
+	if (get_block_info(lv, end) == NULL && get_Block_dom_depth(end) > 0) {
+		bl_info_t *bi   = new_block_info(lv, &blocks, end);
+		bi->max_pre_num = bi->pre_num;
+		bi->post_num    = post_num++;
+	}
+	assert(ARR_LEN(blocks) == post_num);
+	return blocks;
+}
+
+/**
+ * Splits the successors of a block into the successors in the reduced graph
+ * and targets of back edges.  An edge is a back edge if its target is a DFS
+ * ancestor of its source (or the source itself).
+ */
+static void classify_succs(lv_chk_t *lv, bl_info_t *bi)
+{
+	foreach_block_succ(bi->block, edge) {
+		bl_info_t *si = get_block_info(lv, get_edge_src_irn(edge));
+		if (si->pre_num > bi->pre_num || bi->pre_num > si->max_pre_num) {
+			assert(si->post_num < bi->post_num);
+			obstack_ptr_grow(&lv->obst, si);
+		}
+	}
+	bi->n_red_succs = obstack_object_size(&lv->obst) / sizeof(bl_info_t*);
+	bi->red_succs   = (bl_info_t**)obstack_finish(&lv->obst);
+
+	foreach_block_succ(bi->block, edge) {
+		bl_info_t *si = get_block_info(lv, get_edge_src_irn(edge));
+		if (si->pre_num <= bi->pre_num && bi->pre_num <= si->max_pre_num) {
+			/* mark block as a back edge src and succ as back edge tgt. */
+			bi->be_src = true;
+			si->be_tgt = true;
+			obstack_ptr_grow(&lv->obst, si);
+		}
+	}
+	bi->n_be_tgts = obstack_object_size(&lv->obst) / sizeof(bl_info_t*);
+	bi->be_tgts   = (bl_info_t**)obstack_finish(&lv->obst);
+}
+
 /**
  * Compute the transitive closure on the reduced graph.
  * The reduced graph is the original graph without back edges.
@@ -92,100 +221,172 @@ static bl_info_t *get_block_info(lv_chk_t *lv, const ir_node *block)
  */
 static void red_trans_closure(lv_chk_t *lv)
 {
-	for (int i = 0, n = dfs_get_n_nodes(lv->dfs); i < n; ++i) {
-		ir_node   *const bl = dfs_get_post_num_node(lv->dfs, i);
-		bl_info_t *const bi = get_block_info(lv, bl);
-
-		bitset_set(bi->red_reachable, bi->id);
-		foreach_block_succ(bl, edge) {
-			ir_node        *succ = get_edge_src_irn(edge);
-			bl_info_t      *si   = get_block_info(lv, succ);
-			dfs_edge_kind_t kind = dfs_get_edge_kind(lv->dfs, bl, succ);
-
-			/*
-			 * if the successor is no back edge, include all reachable
-			 * blocks from there into the reachable set of the current node
-			 */
-			if (kind != DFS_EDGE_BACK) {
-				assert(dfs_get_post_num(lv->dfs, bl) > dfs_get_post_num(lv->dfs, succ));
-				bitset_or(bi->red_reachable, si->red_reachable);
-			} else {
-				/* mark block as a back edge src and succ as back edge tgt. */
-				bitset_set(lv->back_edge_src, bi->id);
-				bitset_set(lv->back_edge_tgt, si->id);
-			}
+	for (unsigned i = 0, n = lv->n_blocks; i < n; ++i) {
+		bl_info_t *const bi  = lv->post_order[i];
+		unsigned  *const red = rbitset_obstack_alloc(&lv->obst, i + 1);
+
+		rbitset_set(red, i);
+		for (unsigned s = 0; s < bi->n_red_succs; ++s) {
+			const bl_info_t *si = bi->red_succs[s];
+			rbitset_or(red, si->red_reachable, si->post_num + 1);
 		}
-
+		bi->red_reachable = red;
 	}
-
 }
 
-static void compute_back_edge_chain(lv_chk_t *lv, const ir_node *bl)
+/**
+ * Returns the reduced reachability set of a block, computes it by a search
+ * on the reduced graph if necessary.  The search does not descend into
+ * blocks whose set is already known.
+ */
+static const unsigned *get_red_reachable(lv_chk_t *lv, bl_info_t *bi)
 {
-	bl_info_t *bi = get_block_info(lv, bl);
-	DBG((lv->dbg, LEVEL_2, "computing T_%d\n", bi->id));
-
-	/* put all back edge sources reachable (reduced) from here in tmp */
-	bitset_t *tmp = bitset_alloca(lv->n_blocks);
-	bitset_copy(tmp, bi->red_reachable);
-	bitset_set(tmp, bi->id);
-	bitset_and(tmp, lv->back_edge_src);
-	bi->be_tgt_calc = true;
-
-	DBG((lv->dbg, LEVEL_2, "\treachable be src: %B\n", tmp));
-
-	/* iterate over them ... */
-	bitset_foreach(tmp, elm) {
-		bl_info_t *si = lv->map[elm];
-
-		/* and find back edge targets which are not reduced reachable from bl */
-		foreach_block_succ(si->block, edge) {
-			ir_node        *tgt  = get_edge_src_irn(edge);
-			bl_info_t      *ti   = get_block_info(lv, tgt);
-			dfs_edge_kind_t kind = dfs_get_edge_kind(lv->dfs, si->block, tgt);
-
-			if (kind == DFS_EDGE_BACK && !bitset_is_set(bi->red_reachable, ti->id)) {
-				if (!ti->be_tgt_calc)
-					compute_back_edge_chain(lv, tgt);
-				bitset_set(bi->be_tgt_reach, ti->id);
-				bitset_or(bi->be_tgt_reach, ti->be_tgt_reach);
+	if (bi->red_reachable != NULL)
+		return bi->red_reachable;
+
+	unsigned   *red   = rbitset_obstack_alloc(&lv->obst, bi->post_num + 1);
+	bl_info_t **stack = lv->stack;
+	rbitset_set(red, bi->post_num);
+	ARR_APP1(bl_info_t*, stack, bi);
+	while (ARR_LEN(stack) > 0) {
+		const bl_info_t *cur = stack[ARR_LEN(stack) - 1];
+		ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+		for (unsigned s = 0; s < cur->n_red_succs; ++s) {
+			bl_info_t *si = cur->red_succs[s];
+			if (rbitset_is_set(red, si->post_num))
+				continue;
+			if (si->red_reachable != NULL) {
+				rbitset_or(red, si->red_reachable, si->post_num + 1);
+			} else {
+				rbitset_set(red, si->post_num);
+				ARR_APP1(bl_info_t*, stack, si);
 			}
 		}
-		bitset_clear(bi->be_tgt_reach, bi->id);
 	}
+	lv->stack         = stack;
+	bi->red_reachable = red;
+	return red;
+}
+
+static bool is_red_reachable(lv_chk_t *lv, bl_info_t *from,
+                             const bl_info_t *to)
+{
+	return to->post_num <= from->post_num
+	    && rbitset_is_set(get_red_reachable(lv, from), to->post_num);
 }
 
+static int cmp_id(const void *a, const void *b)
+{
+	unsigned const ia = *(unsigned const*)a;
+	unsigned const ib = *(unsigned const*)b;
+	return QSORT_CMP(ia, ib);
+}
 
-static inline void compute_back_edge_chains(lv_chk_t *lv)
+/**
+ * Sorts @p ids and removes duplicates.  Returns @p cand if it has the same
+ * elements, a copy of the ids otherwise.
+ */
+static id_set_t make_id_set(lv_chk_t *lv, unsigned *ids, const id_set_t *cand)
 {
-	DBG((lv->dbg, LEVEL_2, "back edge sources: %B\n", lv->back_edge_src));
-	bitset_foreach(lv->back_edge_src, elm) {
-		compute_back_edge_chain(lv, lv->map[elm]->block);
+	QSORT_ARR(ids, cmp_id);
+	unsigned n = 0;
+	for (size_t i = 0, n_ids = ARR_LEN(ids); i < n_ids; ++i) {
+		if (n == 0 || ids[n - 1] != ids[i])
+			ids[n++] = ids[i];
 	}
 
-	for (int i = 0, n = dfs_get_n_nodes(lv->dfs); i < n; ++i) {
-		ir_node   *const bl = dfs_get_post_num_node(lv->dfs, i);
-		bl_info_t *const bi = get_block_info(lv, bl);
+	id_set_t res = { NULL, n };
+	if (n == 0)
+		return res;
+	if (cand != NULL && cand->n == n && memcmp(cand->ids, ids, n * sizeof(*ids)) == 0)
+		return *cand;
+	unsigned *copy = OALLOCN(&lv->obst, unsigned, n);
+	MEMCPY(copy, ids, n);
+	res.ids = copy;
+	return res;
+}
 
-		if (!bitset_is_set(lv->back_edge_tgt, bi->id)) {
-			foreach_block_succ(bl, edge) {
-				ir_node   *succ = get_edge_src_irn(edge);
-				bl_info_t *si   = get_block_info(lv, succ);
-				dfs_edge_kind_t kind = dfs_get_edge_kind(lv->dfs, bl, succ);
+static void append_ids(unsigned **ids, const id_set_t *set)
+{
+	for (unsigned i = 0; i < set->n; ++i)
+		ARR_APP1(unsigned, *ids, set->ids[i]);
+}
 
-				if (kind != DFS_EDGE_BACK) {
-					assert(dfs_get_post_num(lv->dfs, bl) > dfs_get_post_num(lv->dfs, succ));
-					bitset_or(bi->be_tgt_reach, si->be_tgt_reach);
-				}
-			}
+static void compute_back_edge_chains(lv_chk_t *lv)
+{
+	/* A back edge target is seen from a block if it is seen from one of its
+	 * successors in the reduced graph or the block has a back edge to it and
+	 * it is not reduced reachable from the block.  Without irreducible loops
+	 * the targets are loop headers dominating the block and the reduced
+	 * reachability sets are only needed for the headers themselves. */
+	unsigned *ids = NEW_ARR_F(unsigned, 0);
+	for (unsigned i = 0, n = lv->n_blocks; i < n; ++i) {
+		bl_info_t *const bi = lv->post_order[i];
+
+		ARR_SHRINKLEN(ids, 0);
+		for (unsigned t = 0; t < bi->n_be_tgts; ++t)
+			ARR_APP1(unsigned, ids, bi->be_tgts[t]->id);
+		for (unsigned s = 0; s < bi->n_red_succs; ++s)
+			append_ids(&ids, &bi->red_succs[s]->up);
+
+		size_t n_ids = 0;
+		for (size_t t = 0, n_tgts = ARR_LEN(ids); t < n_tgts; ++t) {
+			const bl_info_t *ti = lv->map[ids[t]];
+			if (ti != bi && !is_red_reachable(lv, bi, ti))
+				ids[n_ids++] = ids[t];
 		}
+		ARR_SHRINKLEN(ids, n_ids);
+		bi->up = make_id_set(lv, ids,
+		                     bi->n_red_succs > 0 ? &bi->red_succs[0]->up : NULL);
 	}
 
-	for (int i = 0, n = dfs_get_n_nodes(lv->dfs); i < n; ++i) {
-		ir_node const *bl = dfs_get_post_num_node(lv->dfs, i);
-		bl_info_t     *bi = get_block_info(lv, bl);
-		bitset_set(bi->be_tgt_reach, bi->id);
+	/* the chain of a back edge source or target contains all targets
+	 * transitively seen from it */
+	unsigned *visited = rbitset_malloc(lv->n_blocks);
+	for (unsigned i = 0, n = lv->n_blocks; i < n; ++i) {
+		bl_info_t *bi = lv->map[i];
+		if (!bi->be_src && !bi->be_tgt)
+			continue;
+
+		ARR_SHRINKLEN(ids, 0);
+		rbitset_set(visited, i);
+		append_ids(&ids, &bi->up);
+		for (size_t c = 0; c < ARR_LEN(ids); ++c) {
+			const bl_info_t *ci = lv->map[ids[c]];
+			if (rbitset_is_set(visited, ci->id))
+				continue;
+			rbitset_set(visited, ci->id);
+			append_ids(&ids, &ci->up);
+		}
+		rbitset_clear(visited, i);
+		size_t n_ids = 0;
+		for (size_t c = 0, n_chain = ARR_LEN(ids); c < n_chain; ++c) {
+			rbitset_clear(visited, ids[c]);
+			if (ids[c] != i)
+				ids[n_ids++] = ids[c];
+		}
+		ARR_SHRINKLEN(ids, n_ids);
+
+		bi->be_tgt_reach = make_id_set(lv, ids, &bi->up);
+		DBG((lv->dbg, LEVEL_2, "T_%d has %u targets\n", bi->id,
+		     bi->be_tgt_reach.n));
 	}
+	free(visited);
+
+	/* the other blocks see what their successors in the reduced graph see */
+	for (unsigned i = 0, n = lv->n_blocks; i < n; ++i) {
+		bl_info_t *const bi = lv->post_order[i];
+		if (bi->be_tgt)
+			continue;
+
+		ARR_SHRINKLEN(ids, 0);
+		append_ids(&ids, &bi->be_tgt_reach);
+		for (unsigned s = 0; s < bi->n_red_succs; ++s)
+			append_ids(&ids, &bi->red_succs[s]->be_tgt_reach);
+		bi->be_tgt_reach = make_id_set(lv, ids, bi->n_red_succs > 0
+			? &bi->red_succs[0]->be_tgt_reach : NULL);
+	}
+	DEL_ARR_F(ids);
 }
 
 lv_chk_t *lv_chk_new(ir_graph *irg)
@@ -197,53 +398,136 @@ lv_chk_t *lv_chk_new(ir_graph *irg)
 	FIRM_DBG_REGISTER(res->dbg, "ir.ana.lvchk");
 	ir_nodemap_init(&res->block_infos, irg);
 	obstack_init(&res->obst);
-	res->dfs           = dfs_new(irg);
-	res->n_blocks      = dfs_get_n_nodes(res->dfs);
-	res->back_edge_src = bitset_obstack_alloc(&res->obst, res->n_blocks);
-	res->back_edge_tgt = bitset_obstack_alloc(&res->obst, res->n_blocks);
-	res->map           = OALLOCNZ(&res->obst, bl_info_t*, res->n_blocks);
-
-	/* fill the map which maps pre_num to block infos */
-	for (int i = res->n_blocks; i-- > 0; ) {
-		ir_node   *irn = dfs_get_pre_num_node(res->dfs, i);
-		bl_info_t *bi  = get_block_info(res, irn);
-		assert(bi->id < res->n_blocks);
+	bl_info_t **blocks = number_blocks(res, irg);
+
+	unsigned n_blocks = ARR_LEN(blocks);
+	res->n_blocks      = n_blocks;
+	res->uses          = rbitset_obstack_alloc(&res->obst, n_blocks);
+	res->map           = OALLOCNZ(&res->obst, bl_info_t*, n_blocks);
+	res->post_order    = OALLOCNZ(&res->obst, bl_info_t*, n_blocks);
+	res->stack         = NEW_ARR_F(bl_info_t*, 0);
+	res->n_searches    = 0;
+
+	/* fill the maps from pre_num and post_num to block infos */
+	for (unsigned i = 0; i < n_blocks; ++i) {
+		bl_info_t *bi = blocks[i];
+		assert(bi->id < n_blocks);
 		assert(res->map[bi->id] == NULL);
-		res->map[bi->id] = bi;
+		res->map[bi->id]              = bi;
+		res->post_order[bi->post_num] = bi;
 	}
+	DEL_ARR_F(blocks);
+
+	for (unsigned i = 0; i < n_blocks; ++i)
+		classify_succs(res, res->map[i]);
 
 	/* first of all, compute the transitive closure of the CFG *without* back edges */
-	red_trans_closure(res);
+	if (n_blocks <= eager_max_blocks)
+		red_trans_closure(res);
 
 	/* compute back edge chains */
 	compute_back_edge_chains(res);
 
-#ifdef DEBUG_libfirm
-	DBG((res->dbg, LEVEL_1, "liveness chk in %+F\n", irg));
-	for (int i = res->n_blocks; i-- > 0; ) {
-		const ir_node   *irn = dfs_get_pre_num_node(res->dfs, i);
-		const bl_info_t *bi  = get_block_info(res, irn);
-		DBG((res->dbg, LEVEL_1, "lv_chk for %d -> %+F\n", i, irn));
-		DBG((res->dbg, LEVEL_1, "\tred reach: %B\n", bi->red_reachable));
-		DBG((res->dbg, LEVEL_1, "\ttgt reach: %B\n", bi->be_tgt_reach));
-	}
-#endif
-
-	DBG((res->dbg, LEVEL_1, "back edge src: %B\n", res->back_edge_src));
-	DBG((res->dbg, LEVEL_1, "back edge tgt: %B\n", res->back_edge_tgt));
+	DBG((res->dbg, LEVEL_1, "liveness chk in %+F with %u blocks\n", irg,
+	     n_blocks));
 
 	stat_ev_tim_pop("lv_chk_cons_time");
 	return res;
 }
 
+void lv_chk_set_eager_max_blocks(unsigned n_blocks)
+{
+	eager_max_blocks = n_blocks;
+}
+
 void lv_chk_free(lv_chk_t *lv)
 {
-	dfs_free(lv->dfs);
+	DEL_ARR_F(lv->stack);
 	obstack_free(&lv->obst, NULL);
 	ir_nodemap_destroy(&lv->block_infos);
 	free(lv);
 }
 
+static bool red_reachable_has_use(const lv_chk_t *lv, const bl_info_t *bi,
+                                  unsigned lo, unsigned hi)
+{
+	const unsigned *red  = bi->red_reachable;
+	const unsigned *uses = lv->uses;
+	unsigned        last = MIN(hi, bi->post_num) / BITS_PER_ELEM;
+	for (unsigned w = lo / BITS_PER_ELEM; w <= last; ++w) {
+		if (red[w] & uses[w])
+			return true;
+	}
+	return false;
+}
+
+typedef enum search_result_t {
+	search_not_found,
+	search_found,
+	search_aborted,
+} search_result_t;
+
+/**
+ * Searches a use in the reduced graph starting at @p bi.  Blocks with a post
+ * number below @p lo cannot reach a use and are skipped.
+ */
+static search_result_t search_reduced(lv_chk_t *lv, bl_info_t *bi,
+                                      unsigned lo, unsigned hi)
+{
+	unsigned         search    = ++lv->n_searches;
+	unsigned         n_visited = 0;
+	bl_info_t      **stack     = lv->stack;
+	search_result_t  res       = search_not_found;
+	bi->visited = search;
+	ARR_APP1(bl_info_t*, stack, bi);
+	while (ARR_LEN(stack) > 0) {
+		const bl_info_t *cur = stack[ARR_LEN(stack) - 1];
+		ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+		if (rbitset_is_set(lv->uses, cur->post_num)) {
+			res = search_found;
+			break;
+		}
+		if (++n_visited > LV_CHK_SEARCH_LIMIT) {
+			res = search_aborted;
+			break;
+		}
+		for (unsigned s = 0; s < cur->n_red_succs; ++s) {
+			bl_info_t *si = cur->red_succs[s];
+			if (si->post_num < lo || si->visited == search)
+				continue;
+			si->visited = search;
+			if (si->red_reachable == NULL) {
+				ARR_APP1(bl_info_t*, stack, si);
+			} else if (red_reachable_has_use(lv, si, lo, hi)) {
+				res = search_found;
+				goto end;
+			}
+		}
+	}
+end:
+	ARR_SHRINKLEN(stack, 0);
+	lv->stack = stack;
+	return res;
+}
+
+/**
+ * Checks whether a block in the reduced reachability set of @p bi is in the
+ * use set, which only contains post numbers from @p lo to @p hi.
+ */
+static bool reaches_use(lv_chk_t *lv, bl_info_t *bi, unsigned lo, unsigned hi)
+{
+	if (lo > bi->post_num)
+		return false;
+
+	if (bi->red_reachable == NULL) {
+		search_result_t res = search_reduced(lv, bi, lo, hi);
+		if (res != search_aborted)
+			return res == search_found;
+		get_red_reachable(lv, bi);
+	}
+	return red_reachable_has_use(lv, bi, lo, hi);
+}
+
 unsigned lv_chk_bl_xxx(lv_chk_t *lv, const ir_node *bl, const ir_node *var)
 {
 	assert(is_Block(bl));
@@ -302,14 +586,17 @@ unsigned lv_chk_bl_xxx(lv_chk_t *lv, const ir_node *bl, const ir_node *var)
 		 * Note that we know for sure that bl != def_bl. That is sometimes
 		 * silently exploited below.
 		 */
-		const bl_info_t *bli = get_block_info(lv, bl);
-		const bl_info_t *def = get_block_info(lv, def_bl);
-		(void)def;
+		bl_info_t *bli = get_block_info(lv, bl);
+		if (bli == NULL)
+			goto end;
 		DBG((lv->dbg, LEVEL_2,
-		     "lv check %+F (def in %+F #%d) in different block %+F #%d\n",
-		     var, def_bl, def->id, bl, bli->id));
+		     "lv check %+F (def in %+F) in different block %+F #%d\n",
+		     var, def_bl, bl, bli->id));
 
-		bitset_t *uses = bitset_alloca(lv->n_blocks);
+		/* the use set only has bits between lo and hi */
+		unsigned *uses = lv->uses;
+		unsigned  lo   = lv->n_blocks;
+		unsigned  hi   = 0;
 		foreach_out_edge(var, edge) {
 			ir_node *user = get_edge_src_irn(edge);
 
@@ -341,10 +628,16 @@ unsigned lv_chk_bl_xxx(lv_chk_t *lv, const ir_node *bl, const ir_node *var)
 			if (use_bl == bl)
 				res |= mask;
 
+			/* uses in unreachable blocks are never reached */
 			const bl_info_t *bi = get_block_info(lv, use_bl);
-			bitset_set(uses, bi->id);
+			if (bi == NULL)
+				continue;
+			rbitset_set(uses, bi->post_num);
+			lo = MIN(lo, bi->post_num);
+			hi = MAX(hi, bi->post_num);
 		}
-		DBG((lv->dbg, LEVEL_2, "\tuses: %B\n", uses));
+		if (lo > hi)
+			goto end;
 
 		/* get the dominance range which really matters. all uses outside
 		 * the definition's dominance range are not to consider. note,
@@ -356,18 +649,28 @@ unsigned lv_chk_bl_xxx(lv_chk_t *lv, const ir_node *bl, const ir_node *var)
 		/* prepare a set with all reachable back edge targets.
 		 * this will determine our "looking points" from where
 		 * we will search/find the calculated uses. */
-		const bitset_t *Tq = bli->be_tgt_reach;
-
-		/* now, visit all viewing points in the temporary bitset lying
+		const id_set_t *reach = &bli->be_tgt_reach;
+		unsigned        n_tq  = reach->n + 1;
+		unsigned       *Tq    = ALLOCAN(unsigned, n_tq);
+		unsigned        k     = 0;
+		unsigned        t     = 0;
+		while (t < reach->n && reach->ids[t] < bli->id)
+			Tq[k++] = reach->ids[t++];
+		Tq[k++] = bli->id;
+		while (t < reach->n)
+			Tq[k++] = reach->ids[t++];
+
+		/* now, visit all viewing points in the temporary set lying
 		 * in the dominance range of the variable. Note that for reducible
 		 * flow-graphs the first iteration is sufficient and the loop
 		 * will be left. */
-		DBG((lv->dbg, LEVEL_2, "\tbe tgt reach: %B, dom span: [%u, %u]\n", Tq,
-		     min_dom, max_dom));
-		size_t i = bitset_next_set(Tq, min_dom);
-		while (i <= max_dom) {
-			const bl_info_t *ti                   = lv->map[i];
-			bool             use_in_current_block = bitset_is_set(uses, ti->id);
+		DBG((lv->dbg, LEVEL_2, "\t%u view points, dom span: [%u, %u]\n",
+		     n_tq, min_dom, max_dom));
+		for (k = 0; k < n_tq && Tq[k] < min_dom; ++k) {
+		}
+		while (k < n_tq && Tq[k] <= max_dom) {
+			bl_info_t *ti                   = lv->map[Tq[k]];
+			bool       use_in_current_block = rbitset_is_set(uses, ti->post_num);
 
 			stat_ev_cnt_inc(iter);
 
@@ -390,17 +693,16 @@ unsigned lv_chk_bl_xxx(lv_chk_t *lv, const ir_node *bl, const ir_node *var)
 			 * Note that the live in information has been calculated by the
 			 * uses iteration above.
 			 */
-			if (ti == bli && !bitset_is_set(lv->back_edge_tgt, ti->id)) {
+			if (ti == bli && !ti->be_tgt) {
 				DBG((lv->dbg, LEVEL_2, "\tlooking not from a back edge target and q == t. removing use: %d\n", ti->id));
-				bitset_clear(uses, ti->id);
+				rbitset_clear(uses, ti->post_num);
 			}
 
 			/* If we can reach a use, the variable is live there and we say goodbye */
-			DBG((lv->dbg, LEVEL_2, "\tlooking from %d: seeing %B\n",
-			     ti->id, ti->red_reachable));
-			if (bitset_intersect(ti->red_reachable, uses)) {
+			DBG((lv->dbg, LEVEL_2, "\tlooking from %d\n", ti->id));
+			if (reaches_use(lv, ti, lo, hi)) {
 				res |= lv_chk_state_in | lv_chk_state_out | lv_chk_state_end;
-				goto end;
+				break;
 			}
 
 			/*
@@ -409,11 +711,15 @@ unsigned lv_chk_bl_xxx(lv_chk_t *lv, const ir_node *bl, const ir_node *var)
 			 * (we only need that in the non-reducible case).
 			 */
 			if (use_in_current_block)
-				bitset_set(uses, ti->id);
+				rbitset_set(uses, ti->post_num);
 
-			i = bitset_next_set(Tq, get_Block_dom_max_subtree_pre_num(ti->block) + 1);
+			unsigned max_sub = get_Block_dom_max_subtree_pre_num(ti->block);
+			while (k < n_tq && Tq[k] <= max_sub)
+				++k;
 		}
 
+		memset(&uses[lo / BITS_PER_ELEM], 0,
+		       (hi / BITS_PER_ELEM - lo / BITS_PER_ELEM + 1) * sizeof(*uses));
 	}
 
 end:
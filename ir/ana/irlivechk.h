@@ -55,6 +55,14 @@ static inline bool is_liveness_node(const ir_node *irn)
  */
 extern lv_chk_t *lv_chk_new(ir_graph *irg);
 
+/**
+ * Sets the maximum number of blocks for which lv_chk_new() computes the
+ * reachability sets of all blocks at once.  Larger graphs compute them on
+ * demand.  Allows testing both modes on small graphs.
+ * @param n_blocks  The maximum number of blocks.
+ */
+extern void lv_chk_set_eager_max_blocks(unsigned n_blocks);
+
 /**
  * Free liveness check information.
  * @param lv The liveness check information.
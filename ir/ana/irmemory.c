@@ -294,6 +294,42 @@ follow_ptr:
 	}
 }
 
+ir_node *get_base_address(ir_node *addr, long *const offset)
+{
+	long off = 0;
+	for (;;) {
+		if (is_Add(addr)) {
+			ir_node *const left  = get_Add_left(addr);
+			ir_node *const right = get_Add_right(addr);
+			if (!is_Const(right) || !mode_is_reference(get_irn_mode(left)))
+				break;
+			ir_tarval *const tv = get_Const_tarval(right);
+			if (!tarval_is_long(tv))
+				break;
+			off += get_tarval_long(tv);
+			addr = left;
+		} else if (is_Member(addr)) {
+			ir_entity *const entity = get_Member_entity(addr);
+			if (get_entity_bitfield_size(entity) != 0
+			    || get_type_state(get_entity_owner(entity)) != layout_fixed)
+				break;
+			off += get_entity_offset(entity);
+			addr = get_Member_ptr(addr);
+		} else if (is_Sel(addr) && is_Const(get_Sel_index(addr))) {
+			ir_tarval *const tv = get_Const_tarval(get_Sel_index(addr));
+			if (!tarval_is_long(tv))
+				break;
+			ir_type *const element = get_array_element_type(get_Sel_type(addr));
+			off += get_tarval_long(tv) * (long)get_type_size(element);
+			addr = get_Sel_ptr(addr);
+		} else {
+			break;
+		}
+	}
+	*offset = off;
+	return addr;
+}
+
 static ir_alias_relation _get_alias_relation(const ir_node *addr1, const ir_type *const objt1, unsigned size1,
                                              const ir_node *addr2, const ir_type *const objt2, unsigned size2)
 {
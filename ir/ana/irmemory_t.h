@@ -60,4 +60,15 @@ ir_storage_class_class_t get_base_sc(ir_storage_class_class_t x);
 ir_storage_class_class_t classify_pointer(const ir_node *addr,
                                           const ir_node *base);
 
+/**
+ * Split an address into a base address and a constant offset in bytes.
+ * Constant additions and Member and Sel nodes with a fixed layout are
+ * skipped, so two addresses with the same base are adjacent if their
+ * offsets differ by the size of the first access.
+ *
+ * @param addr    the address
+ * @param offset  receives the offset of @p addr from the returned base
+ */
+ir_node *get_base_address(ir_node *addr, long *offset);
+
 #endif
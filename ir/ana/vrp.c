@@ -10,7 +10,7 @@
  */
 #include "vrp.h"
 
-#include "bitset.h"
+#include "dataflow.h"
 #include "debug.h"
 #include "iredges_t.h"
 #include "irgopt.h"
@@ -19,19 +19,11 @@
 #include "irhooks.h"
 #include "irnodemap.h"
 #include "iroptimize.h"
-#include "irouts_t.h"
 #include "irprintf.h"
-#include "pdeq.h"
 #include "tv.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
-typedef struct vrp_env_t {
-	deq_t        workqueue;
-	bitset_t    *visited;
-	ir_vrp_info *info;
-} vrp_env_t;
-
 static vrp_attr *vrp_get_or_set_info(ir_vrp_info *info, const ir_node *node)
 {
 	vrp_attr *attr = ir_nodemap_get(vrp_attr, &info->infos, node);
@@ -459,22 +451,13 @@ static int vrp_update_node(ir_vrp_info *info, ir_node *node)
 	return something_changed;
 }
 
-static void vrp_first_pass(ir_node *n, void *e)
+static bool vrp_transfer(ir_node *node, void *env)
 {
-	if (is_Block(n))
-		return;
-
-	vrp_env_t *env = (vrp_env_t*) e;
-	bitset_set(env->visited, get_irn_idx(n));
+	if (is_Block(node))
+		return false;
 
-	vrp_update_node(env->info, n);
-
-	foreach_irn_out_r(n, i, succ) {
-		if (bitset_is_set(env->visited, get_irn_idx(succ))) {
-			/* we found a loop*/
-			deq_push_pointer_right(&env->workqueue, succ);
-		}
-	}
+	ir_vrp_info *info = (ir_vrp_info*)env;
+	return vrp_update_node(info, node);
 }
 
 static void dump_vrp_info(void *ctx, FILE *F, const ir_node *node)
@@ -505,8 +488,9 @@ void set_vrp_data(ir_graph *irg)
 
 	FIRM_DBG_REGISTER(dbg, "ir.ana.vrp");
 
-	assure_irg_outs(irg); /* ensure that out edges are consistent*/
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
 	ir_nodemap_init(&irg->vrp.infos, irg);
+	irg_add_renumber_listener(irg, ir_nodemap_renumber, &irg->vrp.infos);
 	obstack_init(&irg->vrp.obst);
 	ir_vrp_info *info = &irg->vrp;
 
@@ -515,26 +499,10 @@ void set_vrp_data(ir_graph *irg)
 		register_hook(hook_node_info, &dump_hook);
 	}
 
-	vrp_env_t *env = OALLOCZ(&irg->vrp.obst, vrp_env_t);
-	env->info      = info;
-	deq_init(&env->workqueue);
-
-	env->visited = bitset_malloc(get_irg_last_idx(irg));
-	irg_walk_graph(irg, NULL, vrp_first_pass, env);
-	free(env->visited);
-
-	/* while there are entries in the worklist, continue*/
-	while (!deq_empty(&env->workqueue)) {
-		ir_node *node = deq_pop_pointer_left(ir_node, &env->workqueue);
-
-		if (vrp_update_node(info, node)) {
-			/* if something changed, add successors to worklist*/
-			foreach_irn_out_r(node, i, succ) {
-				deq_push_pointer_right(&env->workqueue, succ);
-			}
-		}
-	}
-	deq_free(&env->workqueue);
+	dataflow_t *df = new_dataflow(irg, vrp_transfer, NULL, info);
+	dataflow_push_all(df);
+	dataflow_solve(df);
+	free_dataflow(df);
 }
 
 void free_vrp_data(ir_graph *irg)
@@ -542,6 +510,7 @@ void free_vrp_data(ir_graph *irg)
 	if (irg->vrp.infos.data == NULL)
 		return;
 	obstack_free(&irg->vrp.obst, NULL);
+	irg_remove_renumber_listener(irg, ir_nodemap_renumber, &irg->vrp.infos);
 	ir_nodemap_destroy(&irg->vrp.infos);
 }
 
@@ -687,6 +687,40 @@ static void amd64_generate_code(FILE *output, const char *cup_name)
 	pmap_destroy(amd64_constants);
 }
 
+/**
+ * Evaluates the costs of an instruction replacing a multiplication or
+ * division by a constant. The costs are latencies of current cores, where
+ * imul takes 3 cycles for 32 and 64 bit. The decomposition only creates lea
+ * with a base and a scaled index, which take a single cycle unlike the three
+ * operand lea with displacement.
+ */
+static int amd64_evaluate_insn(insn_kind kind, const ir_mode *mode,
+                               ir_tarval *tv)
+{
+	switch (kind) {
+	case MUL:
+		/* in 64 bit modes a constant that is no sign extended 32 bit
+		 * immediate needs a movabs */
+		if (get_mode_size_bits(mode) > 32 && (!tarval_is_long(tv)
+		    || get_tarval_long(tv) != (int32_t)get_tarval_long(tv)))
+			return 4;
+		return 3;
+	case MULH:
+		/* the one operand mul needs rax and rdx */
+		return 5;
+	case DIV:
+		return get_mode_size_bits(mode) <= 32 ? 26 : 40;
+	case LEA:
+	case SHIFT:
+	case ADD:
+	case SUB:
+	case ZERO:
+	case ROOT:
+		return 1;
+	}
+	panic("invalid instruction kind");
+}
+
 static const ir_settings_arch_dep_t amd64_arch_dep = {
 	.replace_muls         = true,
 	.replace_divs         = true,
@@ -695,9 +729,10 @@ static const ir_settings_arch_dep_t amd64_arch_dep = {
 	.allow_mulhu          = true,
 	.also_use_subs        = true,
 	.maximum_shifts       = 4,
+	.max_lea_shift        = 3,
 	.highest_shift_amount = 63,
-	.evaluate             = NULL,
-	.max_bits_for_mulh    = 32,
+	.evaluate             = amd64_evaluate_insn,
+	.max_bits_for_mulh    = 64,
 };
 
 static void amd64_lower_for_target(void)
@@ -768,6 +803,23 @@ static void amd64_init_types(void)
 	ir_platform.va_list_type = amd64_build_va_list_type();
 }
 
+static int amd64_allow_vector_op(ir_op const *const op,
+                                 ir_mode const *const mode)
+{
+	ir_mode const *const element = get_mode_vector_element(mode);
+	unsigned       const bits    = get_mode_size_bits(element);
+	if (op == op_VSplat)
+		return bits == 32 || bits == 64;
+	if (mode_is_float(element)) {
+		return op == op_VAdd || op == op_VSub || op == op_VMul;
+	}
+	/* SSE2 has no 8, 32 or 64bit lane-wise integer multiplication */
+	if (op == op_VMul)
+		return bits == 16;
+	return op == op_VAdd || op == op_VSub || op == op_VAnd || op == op_VOr
+	    || op == op_VEor;
+}
+
 static void amd64_init(void)
 {
 	amd64_setup_cg_config();
@@ -780,6 +832,9 @@ static void amd64_init(void)
 	ir_target.experimental = "the amd64 backend is experimental and unfinished (consider the ia32 backend)";
 	ir_target.fast_unaligned_memaccess = true;
 	ir_target.float_int_overflow       = ir_overflow_indefinite;
+	ir_target.allow_vector_op          = amd64_allow_vector_op;
+	ir_target.vector_size              = 16;
+	ir_target.issue_width              = 4;
 }
 
 static unsigned amd64_get_op_estimated_cost(const ir_node *node)
@@ -233,6 +233,17 @@ my $binopx_commutative = {
 	emit      => "{name}%MX %AM",
 };
 
+my $binopv_commutative = {
+	irn_flags => [ "rematerializable", "commutative" ],
+	state     => "exc_pinned",
+	in_reqs   => "...",
+	out_reqs  => [ "xmm", "none", "mem" ],
+	outs      => [ "res", "none", "M" ],
+	attr_type => "amd64_binop_addr_attr_t",
+	attr      => "const amd64_binop_addr_attr_t *attr_init",
+	emit      => "{name} %AM",
+};
+
 my $cvtop2x = {
 	state     => "exc_pinned",
 	in_reqs   => "...",
@@ -758,6 +769,66 @@ subpd => { template => $binopx },
 
 haddpd => { template => $binopx },
 
+# Packed SSE2 operations on vector modes
+
+addpd => { template => $binopv_commutative },
+
+addps => { template => $binopv_commutative },
+
+mulpd => { template => $binopv_commutative },
+
+mulps => { template => $binopv_commutative },
+
+subps => { template => $binopx },
+
+paddb => { template => $binopv_commutative },
+
+paddw => { template => $binopv_commutative },
+
+paddd => { template => $binopv_commutative },
+
+paddq => { template => $binopv_commutative },
+
+pand => { template => $binopv_commutative },
+
+pmullw => { template => $binopv_commutative },
+
+por => { template => $binopv_commutative },
+
+psubb => { template => $binopx },
+
+psubw => { template => $binopx },
+
+psubd => { template => $binopx },
+
+psubq => { template => $binopx },
+
+pxor => { template => $binopv_commutative },
+
+# broadcast the low 32bit lane
+pshufd_0 => {
+	irn_flags => [ "rematerializable" ],
+	in_reqs   => [ "xmm" ],
+	out_reqs  => [ "xmm" ],
+	ins       => [ "val" ],
+	outs      => [ "res" ],
+	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n"
+	            ."x86_insn_size_t size    = X86_SIZE_128;\n",
+	emit      => 'pshufd $0x00, %^S0, %^D0',
+},
+
+# broadcast the low 64bit lane
+pshufd_44 => {
+	irn_flags => [ "rematerializable" ],
+	in_reqs   => [ "xmm" ],
+	out_reqs  => [ "xmm" ],
+	ins       => [ "val" ],
+	outs      => [ "res" ],
+	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n"
+	            ."x86_insn_size_t size    = X86_SIZE_128;\n",
+	emit      => 'pshufd $0x44, %^S0, %^D0',
+},
+
 fldz => { template => $x87const },
 
 fld1 => { template => $x87const },
@@ -1886,7 +1886,10 @@ static ir_node *make_store_for_mode(ir_mode *const mode, dbg_info *const dbgi, i
 {
 	construct_binop_func               cons;
 	arch_register_req_t const **const *reqs;
-	if (!mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		cons = &new_bd_amd64_movdqu_store;
+		reqs = xmm_am_reqs;
+	} else if (!mode_is_float(mode)) {
 		cons = &new_bd_amd64_mov_store;
 		reqs = gp_am_reqs;
 	} else if (mode == x86_mode_E) {
@@ -2290,6 +2293,8 @@ static ir_node *gen_Phi(ir_node *const node)
 		req = mode == x86_mode_E
 		    ? &amd64_class_reg_req_x87
 		    : &amd64_class_reg_req_xmm;
+	} else if (mode_is_vector(mode)) {
+		req = &amd64_class_reg_req_xmm;
 	} else {
 		req = arch_memory_req;
 	}
@@ -2808,11 +2813,11 @@ ir_node *amd64_new_spill(ir_node *const value, ir_node *const after)
 	return store;
 }
 
-static ir_node *create_sse_spill(dbg_info *const dbgi, ir_node *const block,
-                                 int const arity, ir_node *const *const in,
-                                 arch_register_req_t const **const in_reqs,
-                                 x86_insn_size_t const size, amd64_op_mode_t const op_mode,
-                                 x86_addr_t const addr)
+static ir_node *create_movdqu(dbg_info *const dbgi, ir_node *const block,
+                              int const arity, ir_node *const *const in,
+                              arch_register_req_t const **const in_reqs,
+                              x86_insn_size_t const size, amd64_op_mode_t const op_mode,
+                              x86_addr_t const addr)
 {
 	(void)size; /* TODO */
 	return new_bd_amd64_movdqu(dbgi, block, arity, in, in_reqs, op_mode, addr);
@@ -2846,7 +2851,7 @@ ir_node *amd64_new_reload(ir_node *value, ir_node *spill, ir_node *before)
 		pn_res = pn_amd64_fld_res;
 	} else {
 		size   = X86_SIZE_128;
-		cons   = &create_sse_spill;
+		cons   = &create_movdqu;
 		pn_res = pn_amd64_movdqu_res;
 	}
 	ir_node *const load = cons(NULL, block, ARRAY_SIZE(in), in, reg_mem_reqs,
@@ -2881,6 +2886,7 @@ static ir_node *gen_Load(ir_node *const node)
 	assert((size_t)arity <= ARRAY_SIZE(in));
 
 	create_mov_func   const cons      =
+		mode_is_vector(mode)                                  ? &create_movdqu :
 		mode_is_float(mode)                                   ?
 			(mode == x86_mode_E ? new_bd_amd64_fld : &new_bd_amd64_movs_xmm) :
 		get_mode_size_bits(mode) < 64 && mode_is_signed(mode) ? &new_bd_amd64_movs     :
@@ -2892,6 +2898,113 @@ static ir_node *gen_Load(ir_node *const node)
 	return new_load;
 }
 
+/**
+ * Transforms a vector operation into the packed SSE instruction for its
+ * element mode. @p int_cons is indexed by log2 of the element size in bytes
+ * and contains NULL for unsupported sizes.
+ */
+static ir_node *gen_vector_binop(ir_node *const node,
+                                 construct_binop_func const int_cons[4],
+                                 construct_binop_func const float_cons,
+                                 construct_binop_func const double_cons)
+{
+	ir_mode *const element = get_mode_vector_element(get_irn_mode(node));
+	construct_binop_func cons;
+	if (mode_is_float(element)) {
+		cons = get_mode_size_bits(element) == 32 ? float_cons : double_cons;
+	} else {
+		cons = int_cons[log2_floor(get_mode_size_bytes(element))];
+	}
+	if (cons == NULL)
+		panic("unsupported vector operation %+F", node);
+
+	/* packed memory operands must be aligned, so no address mode matching */
+	ir_node *const op0 = get_binop_left(node);
+	ir_node *const op1 = get_binop_right(node);
+	return gen_binop_xmm(node, op0, op1, cons, 0);
+}
+
+static ir_node *gen_VAdd(ir_node *const node)
+{
+	static construct_binop_func const int_cons[] = {
+		new_bd_amd64_paddb, new_bd_amd64_paddw,
+		new_bd_amd64_paddd, new_bd_amd64_paddq,
+	};
+	return gen_vector_binop(node, int_cons, new_bd_amd64_addps,
+	                        new_bd_amd64_addpd);
+}
+
+static ir_node *gen_VAnd(ir_node *const node)
+{
+	static construct_binop_func const int_cons[] = {
+		new_bd_amd64_pand, new_bd_amd64_pand,
+		new_bd_amd64_pand, new_bd_amd64_pand,
+	};
+	return gen_vector_binop(node, int_cons, NULL, NULL);
+}
+
+static ir_node *gen_VEor(ir_node *const node)
+{
+	static construct_binop_func const int_cons[] = {
+		new_bd_amd64_pxor, new_bd_amd64_pxor,
+		new_bd_amd64_pxor, new_bd_amd64_pxor,
+	};
+	return gen_vector_binop(node, int_cons, NULL, NULL);
+}
+
+static ir_node *gen_VMul(ir_node *const node)
+{
+	/* SSE2 only has a lane-wise multiplication for 16bit integers */
+	static construct_binop_func const int_cons[] = {
+		NULL, new_bd_amd64_pmullw, NULL, NULL,
+	};
+	return gen_vector_binop(node, int_cons, new_bd_amd64_mulps,
+	                        new_bd_amd64_mulpd);
+}
+
+static ir_node *gen_VOr(ir_node *const node)
+{
+	static construct_binop_func const int_cons[] = {
+		new_bd_amd64_por, new_bd_amd64_por,
+		new_bd_amd64_por, new_bd_amd64_por,
+	};
+	return gen_vector_binop(node, int_cons, NULL, NULL);
+}
+
+static ir_node *gen_VSub(ir_node *const node)
+{
+	static construct_binop_func const int_cons[] = {
+		new_bd_amd64_psubb, new_bd_amd64_psubw,
+		new_bd_amd64_psubd, new_bd_amd64_psubq,
+	};
+	return gen_vector_binop(node, int_cons, new_bd_amd64_subps,
+	                        new_bd_amd64_subpd);
+}
+
+static ir_node *gen_VSplat(ir_node *const node)
+{
+	dbg_info *const dbgi    = get_irn_dbg_info(node);
+	ir_node  *const block   = be_transform_nodes_block(node);
+	ir_node  *const op      = get_VSplat_op(node);
+	ir_mode  *const element = get_irn_mode(op);
+	unsigned  const bits    = get_mode_size_bits(element);
+	ir_node        *val     = be_transform_node(op);
+	if (!mode_is_float(element)) {
+		x86_addr_t const addr = {
+			.base_input = 0,
+			.variant    = X86_ADDR_REG,
+		};
+		x86_insn_size_t const size = x86_size_from_mode(element);
+		val = new_bd_amd64_movd_gp_xmm(dbgi, block, val, size, AMD64_OP_REG,
+		                               addr);
+	}
+	if (bits == 32)
+		return new_bd_amd64_pshufd_0(dbgi, block, val);
+	if (bits == 64)
+		return new_bd_amd64_pshufd_44(dbgi, block, val);
+	panic("unsupported vector operation %+F", node);
+}
+
 static ir_node *gen_Unknown(ir_node *const node)
 {
 	ir_node *const block = be_transform_nodes_block(node);
@@ -2928,6 +3041,13 @@ static ir_node *gen_Proj_Load(ir_node *const node)
 
 	/* renumber the proj */
 	switch (get_amd64_irn_opcode(new_load)) {
+	case iro_amd64_movdqu:
+		if (pn == pn_Load_res) {
+			return be_new_Proj(new_load, pn_amd64_movdqu_res);
+		} else if (pn == pn_Load_M) {
+			return be_new_Proj(new_load, pn_amd64_movdqu_M);
+		}
+		break;
 	case iro_amd64_movs_xmm:
 		if (pn == pn_Load_res) {
 			return be_new_Proj(new_load, pn_amd64_movs_xmm_res);
@@ -3412,6 +3532,13 @@ static void amd64_register_transformers(void)
 	be_set_transform_function(op_Sub,               gen_Sub);
 	be_set_transform_function(op_Switch,            gen_Switch);
 	be_set_transform_function(op_Unknown,           gen_Unknown);
+	be_set_transform_function(op_VAdd,              gen_VAdd);
+	be_set_transform_function(op_VAnd,              gen_VAnd);
+	be_set_transform_function(op_VEor,              gen_VEor);
+	be_set_transform_function(op_VMul,              gen_VMul);
+	be_set_transform_function(op_VOr,               gen_VOr);
+	be_set_transform_function(op_VSplat,            gen_VSplat);
+	be_set_transform_function(op_VSub,              gen_VSub);
 	be_set_transform_function(op_amd64_l_punpckldq, gen_amd64_l_punpckldq);
 	be_set_transform_function(op_amd64_l_haddpd,    gen_amd64_l_haddpd);
 	be_set_transform_function(op_amd64_l_subpd,     gen_amd64_l_subpd);
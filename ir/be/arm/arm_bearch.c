@@ -34,6 +34,7 @@
 #include "lower_calls.h"
 #include "lower_softfloat.h"
 #include "lowering.h"
+#include "panic.h"
 #include "target_t.h"
 #include "util.h"
 
@@ -206,6 +207,37 @@ static void arm_generate_code(FILE *output, const char *cup_name)
 	be_finish();
 }
 
+/**
+ * Evaluates the costs of an instruction replacing a multiplication by a
+ * constant. Add and sub take their second operand shifted by any amount, so
+ * a shift feeding them is free.
+ */
+static int arm_evaluate_insn(insn_kind kind, const ir_mode *mode,
+                             ir_tarval *tv)
+{
+	(void)tv;
+	/* 64bit operations are lowered to several instructions */
+	int const factor = get_mode_size_bits(mode) > ARM_MACHINE_SIZE ? 3 : 1;
+	switch (kind) {
+	case MUL:
+		/* mul takes the constant in a register */
+		return factor * 4;
+	case MULH:
+		return 4;
+	case DIV:
+		/* there is no division instruction, it is a library call */
+		return factor * 40;
+	case LEA:
+	case SHIFT:
+	case ADD:
+	case SUB:
+	case ZERO:
+	case ROOT:
+		return factor;
+	}
+	panic("invalid instruction kind");
+}
+
 static const ir_settings_arch_dep_t arm_arch_dep = {
 	.replace_muls         = true,
 	.replace_divs         = true,
@@ -214,8 +246,9 @@ static const ir_settings_arch_dep_t arm_arch_dep = {
 	.allow_mulhu          = false,
 	.also_use_subs        = true,
 	.maximum_shifts       = 1,
+	.max_lea_shift        = 31,
 	.highest_shift_amount = 63,
-	.evaluate             = NULL,
+	.evaluate             = arm_evaluate_insn,
 	.max_bits_for_mulh    = ARM_MACHINE_SIZE,
 };
 
@@ -290,6 +323,7 @@ static void arm_init(void)
 	ir_target.fast_unaligned_memaccess = false;
 	ir_target.allow_ifconv             = arm_ifconv;
 	ir_target.float_int_overflow       = ir_overflow_min_max;
+	ir_target.issue_width              = 2;
 }
 
 static void arm_finish(void)
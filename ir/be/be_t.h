@@ -17,6 +17,7 @@
 #include "be.h"
 #include "be_types.h"
 #include "firm_types.h"
+#include "passtiming.h"
 #include "pmap.h"
 #include "timing.h"
 #include "irdump.h"
@@ -39,12 +40,17 @@ struct be_options_t {
 	bool opt_profile_use;      /**< use existing profile data */
 	bool omit_fp;              /**< try to omit the frame pointer */
 	bool do_verify;            /**< backend verify option */
+	bool verify_lower;         /**< verify the graphs after each lowering */
 	char ilp_solver[128];      /**< the ilp solver name */
 	bool verbose_asm;          /**< dump verbose assembler */
 };
 extern be_options_t be_options;
 
-extern after_transform_func be_after_transform;
+/**
+ * Called after each transformation step of be_lower_for_target(). Verifies
+ * @p irg if selected and calls the callback of the user.
+ */
+void be_after_transform(ir_graph *irg, const char *name);
 
 extern asm_constraint_flags_t be_asm_constraint_flags[256];
 
@@ -104,9 +110,15 @@ typedef enum {
 ENUM_COUNTABLE(be_timer_id_t)
 extern ir_timer_t *be_timers[T_LAST+1];
 
+/**
+ * Returns the name of a backend timer.
+ */
+const char *be_get_timer_name(be_timer_id_t id);
+
 static inline void be_timer_push(be_timer_id_t id)
 {
 	assert(id <= T_LAST);
+	ir_pass_timing_push(be_get_timer_name(id), NULL);
 	if (!be_timing)
 		return;
 	ir_timer_push(be_timers[id]);
@@ -115,6 +127,7 @@ static inline void be_timer_push(be_timer_id_t id)
 static inline void be_timer_pop(be_timer_id_t id)
 {
 	assert(id <= T_LAST);
+	ir_pass_timing_pop();
 	if (!be_timing)
 		return;
 	ir_timer_pop(be_timers[id]);
@@ -43,6 +43,7 @@
 #include "irmode_t.h"
 #include "irnode_t.h"
 #include "irtools.h"
+#include "irverify.h"
 #include "lc_opts.h"
 #include "lc_opts_enum.h"
 #include "obst.h"
@@ -178,7 +179,7 @@ static void post_spill(be_chordal_env_t *const chordal_env, ir_graph *const irg,
 	be_timer_pop(T_RA_SPILL_APPLY);
 
 	/* verify schedule and register pressure */
-	if (be_options.do_verify) {
+	if (be_options.do_verify && ir_verify_selected(irg, "be-chordal")) {
 		be_timer_push(T_VERIFY);
 		bool check_schedule = be_verify_schedule(irg);
 		be_check_verify_result(check_schedule, irg);
@@ -103,6 +103,7 @@ typedef struct co_mst_env_t {
 	col_cost_t     **single_cols;
 	unsigned         n_regs;           /**< number of regs in class */
 	unsigned         chunk_visited;
+	unsigned         node_visited;     /**< visited counter for chunk expansion */
 } co_mst_env_t;
 
 /* stores coalescing related information for a node */
@@ -111,11 +112,13 @@ typedef struct co_mst_irn_t {
 	aff_chunk_t       *chunk;         /**< the chunk this irn belongs to */
 	bitset_t          *adm_colors;    /**< set of admissible colors for this irn */
 	ir_node          **int_neighs;    /**< array of all interfering neighbours (cached for speed reasons) */
+	struct co_mst_irn_t **mst_neighs; /**< coalescing info of int_neighs, see get_mst_neighs() */
 	unsigned           n_neighs;      /**< length of the interfering neighbours array. */
 	int                int_aff_neigh; /**< number of interfering affinity neighbours */
 	unsigned           col;           /**< color currently assigned */
 	unsigned           init_col;      /**< the initial color */
 	int                tmp_col;       /**< a temporary assigned color */
+	unsigned           visited;       /**< visited mark for chunk expansion */
 	struct list_head   list;          /**< Queue for coloring undo. */
 	real_t             constr_factor;
 	bool               fixed:1;       /**< the color is fixed */
@@ -131,7 +134,9 @@ static co_mst_irn_t *co_mst_irn_init(co_mst_env_t *env, const ir_node *irn)
 	res->chunk         = NULL;
 	res->fixed         = 0;
 	res->tmp_col       = -1;
+	res->visited       = 0;
 	res->int_neighs    = NULL;
+	res->mst_neighs    = NULL;
 	/* set the number of interfering affinity neighbours to -1, they are calculated later */
 	res->int_aff_neigh = -1;
 	res->col           = arch_get_irn_register(irn)->index;
@@ -178,6 +183,21 @@ static co_mst_irn_t *get_co_mst_irn(co_mst_env_t *env, const ir_node *node)
 	return res;
 }
 
+/**
+ * Returns the coalescing information of the interfering neighbours of
+ * @p node, so recoloring does not need to look them up in the node map.
+ */
+static co_mst_irn_t **get_mst_neighs(co_mst_env_t *env, co_mst_irn_t *node)
+{
+	if (node->mst_neighs == NULL) {
+		co_mst_irn_t **neighs = OALLOCN(&env->obst, co_mst_irn_t*, node->n_neighs);
+		for (unsigned i = 0, n = node->n_neighs; i < n; ++i)
+			neighs[i] = get_co_mst_irn(env, node->int_neighs[i]);
+		node->mst_neighs = neighs;
+	}
+	return node->mst_neighs;
+}
+
 typedef bool decide_func_t(const co_mst_irn_t *node, unsigned col);
 
 #ifdef DEBUG_libfirm
@@ -286,6 +306,21 @@ static int cmp_col_cost_gt(const void *a, const void *b)
 	return QSORT_CMP(c1->col, c2->col);
 }
 
+/**
+ * Sorts @p costs by cmp_col_cost_gt().  The arrays only have one entry per
+ * register, so insertion sort beats calling qsort() in the recoloring loop.
+ */
+static void sort_col_costs(col_cost_t *costs, unsigned n)
+{
+	for (unsigned i = 1; i < n; ++i) {
+		col_cost_t cc = costs[i];
+		unsigned   j  = i;
+		for (; j > 0 && cmp_col_cost_gt(&costs[j - 1], &cc) > 0; --j)
+			costs[j] = costs[j - 1];
+		costs[j] = cc;
+	}
+}
+
 /**
  * Creates a new affinity chunk
  */
@@ -666,9 +701,10 @@ static void build_affinity_chunks(co_mst_env_t *env)
 
 /**
  * Greedy collect affinity neighbours into thew new chunk @p chunk starting at node @p node.
+ * Nodes are marked with the current env->node_visited.
  */
 static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node,
-                              bitset_t *visited, aff_chunk_t *chunk,
+                              aff_chunk_t *chunk,
                               aff_chunk_t *orig_chunk, decide_func_t *decider,
                               unsigned col)
 {
@@ -680,7 +716,7 @@ static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node,
 
 	/* init queue and chunk */
 	deq_push_pointer_right(&nodes, node);
-	bitset_set(visited, get_irn_idx(node->irn));
+	node->visited = env->node_visited;
 	aff_chunk_add_node(chunk, node);
 	DB((dbg, LEVEL_1, " %+F", node->irn));
 
@@ -692,10 +728,9 @@ static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node,
 		/* check all affinity neighbors */
 		if (an != NULL) {
 			co_gs_foreach_neighb(an, neigh) {
-				const ir_node *m     = neigh->irn;
-				co_mst_irn_t  *n2    = get_co_mst_irn(env, m);
-				unsigned       m_idx = get_irn_idx(m);
-				if (!bitset_is_set(visited, m_idx)
+				const ir_node *m  = neigh->irn;
+				co_mst_irn_t  *n2 = get_co_mst_irn(env, m);
+				if (n2->visited != env->node_visited
 				  && decider(n2, col)
 				  && !n2->fixed
 				  && !aff_chunk_interferes(chunk, m)
@@ -708,7 +743,7 @@ static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node,
 						- the new chunk doesn't interfere with the neighbour
 						- neighbour belongs or belonged once to the original chunk
 					*/
-					bitset_set(visited, m_idx);
+					n2->visited = env->node_visited;
 					aff_chunk_add_node(chunk, n2);
 					DB((dbg, LEVEL_1, " %+F", n2->irn));
 					/* enqueue for further search */
@@ -729,14 +764,14 @@ static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node,
 static aff_chunk_t *fragment_chunk(co_mst_env_t *env, unsigned col,
                                    aff_chunk_t *c, deq_t *tmp)
 {
-	bitset_t    *visited = bitset_malloc(get_irg_last_idx(env->co->irg));
-	aff_chunk_t *best    = NULL;
+	aff_chunk_t *best = NULL;
+	++env->node_visited;
 	for (unsigned idx = 0, len = ARR_LEN(c->n); idx < len; ++idx) {
-		const ir_node *irn = c->n[idx];
-		if (bitset_is_set(visited, get_irn_idx(irn)))
+		const ir_node *irn  = c->n[idx];
+		co_mst_irn_t  *node = get_co_mst_irn(env, irn);
+		if (node->visited == env->node_visited)
 			continue;
 
-		co_mst_irn_t  *node = get_co_mst_irn(env, irn);
 		decide_func_t *decider;
 		bool           check_for_best;
 		if (get_mst_irn_col(node) == col) {
@@ -752,7 +787,7 @@ static aff_chunk_t *fragment_chunk(co_mst_env_t *env, unsigned col,
 		/* create a new chunk starting at current node */
 		aff_chunk_t *tmp_chunk = new_aff_chunk(env);
 		deq_push_pointer_right(tmp, tmp_chunk);
-		expand_chunk_from(env, node, visited, tmp_chunk, c, decider, col);
+		expand_chunk_from(env, node, tmp_chunk, c, decider, col);
 		assert(ARR_LEN(tmp_chunk->n) > 0 && "No nodes added to chunk");
 
 		/* remember the local best */
@@ -762,7 +797,6 @@ static aff_chunk_t *fragment_chunk(co_mst_env_t *env, unsigned col,
 	}
 
 	assert(best && "No chunk found?");
-	free(visited);
 	return best;
 }
 
@@ -825,8 +859,9 @@ static void determine_color_costs(co_mst_env_t *env, co_mst_irn_t *node,
 		costs[i].cost = bitset_is_set(node->adm_colors, i) ? node->constr_factor : REAL(0.0);
 	}
 
+	co_mst_irn_t **neighs = get_mst_neighs(env, node);
 	for (unsigned i = node->n_neighs; i-- != 0;) {
-		co_mst_irn_t *n = get_co_mst_irn(env, node->int_neighs[i]);
+		co_mst_irn_t *n = neighs[i];
 		unsigned col = get_mst_irn_col(n);
 		assert(col < n_regs);
 		if (is_loose(n)) {
@@ -877,7 +912,7 @@ static bool change_node_color_excluded(co_mst_env_t *env, co_mst_irn_t *node,
 		costs[exclude_col].cost = REAL(0.0);
 
 		/* sort the colors according costs, cheapest first. */
-		QSORT(costs, env->n_regs, cmp_col_cost_gt);
+		sort_col_costs(costs, env->n_regs);
 
 		/* Try recoloring the node using the color list. */
 		return recolor_nodes(env, node, costs, changed, depth + 1, max_depth, trip);
@@ -909,6 +944,7 @@ static bool recolor_nodes(co_mst_env_t *env, co_mst_irn_t *node,
 		return false;
 	}
 
+	co_mst_irn_t   **neighs = get_mst_neighs(env, node);
 	struct list_head local_changed;
 	for (unsigned i = 0, n = env->n_regs; i < n; ++i) {
 		unsigned tgt_col = costs[i].col;
@@ -928,10 +964,9 @@ static bool recolor_nodes(co_mst_env_t *env, co_mst_irn_t *node,
 		/* try to color all interfering neighbours with current color forbidden */
 		bool neigh_ok = true;
 		for (unsigned j = node->n_neighs; j-- != 0;) {
-			ir_node      *neigh = node->int_neighs[j];
-			co_mst_irn_t *nn    = get_co_mst_irn(env, neigh);
+			co_mst_irn_t *nn = neighs[j];
 			DB((dbg, LEVEL_4, "\tHandling neighbour %+F, at position %d (fixed: %d, tmp_col: %d, col: %d)\n",
-				neigh, j, nn->fixed, nn->tmp_col, nn->col));
+				nn->irn, j, nn->fixed, nn->tmp_col, nn->col));
 
 			/*
 				Try to change the color of the neighbor and record all nodes which
@@ -1054,7 +1089,7 @@ static void color_aff_chunk(co_mst_env_t *env, aff_chunk_t *c)
 		order[i].cost = (REAL(1.0) - dislike_influence) * c->color_affinity[i].cost + dislike_influence * dislike;
 	}
 
-	QSORT(order, env->n_regs, cmp_col_cost_gt);
+	sort_col_costs(order, env->n_regs);
 
 	DBG_COL_COST(env, LEVEL_2, order);
 	DB((dbg, LEVEL_2, "\n"));
@@ -1201,17 +1236,17 @@ static void color_aff_chunk(co_mst_env_t *env, aff_chunk_t *c)
 	}
 
 	/* fragment the remaining chunk */
-	bitset_t *visited = bitset_malloc(get_irg_last_idx(env->co->irg));
+	++env->node_visited;
 	for (size_t idx = 0, len = ARR_LEN(best_chunk->n); idx < len; ++idx)
-		bitset_set(visited, get_irn_idx(best_chunk->n[idx]));
+		get_co_mst_irn(env, best_chunk->n[idx])->visited = env->node_visited;
 
 	for (size_t idx = 0, len = ARR_LEN(c->n); idx < len; ++idx) {
-		const ir_node *irn = c->n[idx];
-		if (!bitset_is_set(visited, get_irn_idx(irn))) {
-			aff_chunk_t  *new_chunk = new_aff_chunk(env);
-			co_mst_irn_t *node      = get_co_mst_irn(env, irn);
+		const ir_node *irn  = c->n[idx];
+		co_mst_irn_t  *node = get_co_mst_irn(env, irn);
+		if (node->visited != env->node_visited) {
+			aff_chunk_t *new_chunk = new_aff_chunk(env);
 
-			expand_chunk_from(env, node, visited, new_chunk, c, decider_always_yes, 0);
+			expand_chunk_from(env, node, new_chunk, c, decider_always_yes, 0);
 			aff_chunk_assure_weight(env, new_chunk);
 			pqueue_put(env->chunks, new_chunk, new_chunk->weight);
 		}
@@ -1225,7 +1260,6 @@ static void color_aff_chunk(co_mst_env_t *env, aff_chunk_t *c)
 
 	/* clear obsolete chunks and free some memory */
 	delete_aff_chunk(best_chunk);
-	free(visited);
 
 	stat_ev_ctx_pop("heur4_color_chunk");
 }
@@ -1253,6 +1287,7 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 	mst_env.ifg              = co->cenv->ifg;
 	INIT_LIST_HEAD(&mst_env.chunklist);
 	mst_env.chunk_visited    = 0;
+	mst_env.node_visited     = 0;
 	mst_env.single_cols      = OALLOCN(&mst_env.obst, col_cost_t*, n_regs);
 
 	for (unsigned i = 0; i < n_regs; ++i) {
@@ -1324,7 +1359,8 @@ void be_init_copyheur4(void)
 	lc_opt_entry_t *heur4_grp   = lc_opt_get_grp(co_grp, "heur4");
 
 	static co_algo_info copyheur = {
-		co_solve_heuristic_mst
+		.copyopt   = co_solve_heuristic_mst,
+		.expensive = false,
 	};
 
 	lc_opt_add_table(heur4_grp, options);
@@ -37,6 +37,7 @@
 #include "lc_opts.h"
 #include "lc_opts_enum.h"
 #include "panic.h"
+#include "passtiming.h"
 #include "pmap.h"
 #include "raw_bitset.h"
 #include "statev_t.h"
@@ -133,11 +134,17 @@ static const lc_opt_table_entry_t options[] = {
 
 static be_module_list_entry_t *copyopts = NULL;
 static const co_algo_info *selected_copyopt = NULL;
+static const co_algo_info *cheap_copyopt    = NULL;
+
+static int void_algo(copy_opt_t *co);
 
 void be_register_copyopt(const char *name, co_algo_info *copyopt)
 {
 	if (selected_copyopt == NULL)
 		selected_copyopt = copyopt;
+	if (cheap_copyopt == NULL && !copyopt->expensive
+	 && copyopt->copyopt != void_algo)
+		cheap_copyopt = copyopt;
 	be_add_module_to_list(&copyopts, name, copyopt);
 }
 
@@ -164,7 +171,8 @@ BE_REGISTER_MODULE_CONSTRUCTOR(be_init_copynone)
 void be_init_copynone(void)
 {
 	static co_algo_info copyheur = {
-		void_algo
+		.copyopt   = void_algo,
+		.expensive = false,
 	};
 
 	be_register_copyopt("none", &copyheur);
@@ -813,8 +821,15 @@ void co_driver(be_chordal_env_t *cenv)
 	}
 
 	/* perform actual copy minimization */
+	co_algo_info const *algo = selected_copyopt;
+	if (algo->expensive && cheap_copyopt != NULL
+	 && ir_obstack_budget_exceeded()) {
+		DBG((dbg, LEVEL_1, "obstack budget exceeded, using cheap copyopt\n"));
+		stat_ev("co_budget_fallback");
+		algo = cheap_copyopt;
+	}
 	ir_timer_reset_and_start(timer);
-	int was_optimal = selected_copyopt->copyopt(co);
+	int was_optimal = algo->copyopt(co);
 	ir_timer_stop(timer);
 
 	stat_ev_dbl("co_time", ir_timer_elapsed_msec(timer));
@@ -26,6 +26,8 @@ typedef int(*cost_fct_t)(const ir_node *node, int input);
 
 typedef struct {
 	int (*copyopt)(copy_opt_t *co); /**< function ptr to run copyopt */
+	bool expensive; /**< replaced by a cheap algorithm if the obstack budget
+	                     is exceeded */
 } co_algo_info;
 
 /**
@@ -17,7 +17,7 @@
 #include "irgwalk.h"
 #include "irprintf.h"
 #include "irdump_t.h"
-#include "irnodeset.h"
+#include "irnodemap.h"
 
 #include "statev_t.h"
 #include "be_t.h"
@@ -356,34 +356,34 @@ void be_liveness_update(be_lv_t *lv, ir_node *irn)
 }
 
 void be_liveness_transfer(const arch_register_class_t *cls,
-                          ir_node *node, ir_nodeset_t *nodeset)
+                          ir_node *node, ir_sparse_nodeset *nodeset)
 {
 	/* The arguments of phi functions are not live at the beginning of the block
 	 * so calling liveness_transfer on a Phi doesn't make sense. */
 	assert(!is_Phi(node));
 
 	be_foreach_definition(node, cls, value, req,
-		ir_nodeset_remove(nodeset, value);
+		ir_sparse_nodeset_remove(nodeset, value);
 	);
 
 	be_foreach_use(node, cls, in_req, op, op_req,
-		ir_nodeset_insert(nodeset, op);
+		ir_sparse_nodeset_insert(nodeset, op);
 	);
 }
 
 void be_liveness_end_of_block(const be_lv_t *lv,
                               const arch_register_class_t *cls,
-                              const ir_node *block, ir_nodeset_t *live)
+                              const ir_node *block, ir_sparse_nodeset *live)
 {
 	be_lv_foreach_cls(lv, block, be_lv_state_end, cls, node) {
-		ir_nodeset_insert(live, node);
+		ir_sparse_nodeset_insert(live, node);
 	}
 }
 
 void be_liveness_nodes_live_before(be_lv_t const *const lv,
                                    arch_register_class_t const *const cls,
                                    ir_node const *const pos,
-                                   ir_nodeset_t *const live)
+                                   ir_sparse_nodeset *const live)
 {
 	ir_node *const bl = get_nodes_block(pos);
 	be_liveness_end_of_block(lv, cls, bl, live);
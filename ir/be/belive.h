@@ -13,6 +13,7 @@
 #define FIRM_BE_BELIVE_H
 
 #include "be_types.h"
+#include "irnodemap.h"
 #include "irnodeset.h"
 #include "irnodehashmap.h"
 #include "irlivechk.h"
@@ -87,7 +88,7 @@ void be_liveness_introduce(be_lv_t *lv, ir_node *irn);
  * @return live.
  */
 void be_liveness_transfer(const arch_register_class_t *cls, ir_node *node,
-                          ir_nodeset_t *nodeset);
+                          ir_sparse_nodeset *nodeset);
 
 /**
  * Put all node live at the end of a block into a set.
@@ -98,7 +99,7 @@ void be_liveness_transfer(const arch_register_class_t *cls, ir_node *node,
  */
 void be_liveness_end_of_block(const be_lv_t *lv,
                               const arch_register_class_t *cls,
-                              const ir_node *bl, ir_nodeset_t *nodeset);
+                              const ir_node *bl, ir_sparse_nodeset *nodeset);
 
 /**
  * Check if value @p value is live after instruction @p after.
@@ -127,7 +128,8 @@ bool be_memory_values_interfere(const ir_node *a, const ir_node *b);
  */
 void be_liveness_nodes_live_before(be_lv_t const *lv,
                                    arch_register_class_t const *cls,
-                                   ir_node const *pos, ir_nodeset_t *live);
+                                   ir_node const *pos,
+                                   ir_sparse_nodeset *live);
 
 struct be_lv_t {
 	ir_nodehashmap_t map;
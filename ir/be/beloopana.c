@@ -56,22 +56,22 @@ static unsigned be_compute_block_pressure(ir_node *const block, arch_register_cl
 	DBG((dbg, LEVEL_1, "Processing Block %+F\n", block));
 
 	/* determine largest pressure with this block */
-	ir_nodeset_t live_nodes;
-	ir_nodeset_init(&live_nodes);
+	ir_sparse_nodeset live_nodes;
+	ir_sparse_nodeset_init(&live_nodes, get_irn_irg(block));
 	be_lv_t *const lv = be_get_irg_liveness(get_irn_irg(block));
 	be_liveness_end_of_block(lv, cls, block, &live_nodes);
-	unsigned max_live = (unsigned)ir_nodeset_size(&live_nodes);
+	unsigned max_live = (unsigned)ir_sparse_nodeset_size(&live_nodes);
 
 	sched_foreach_non_phi_reverse(block, irn) {
 		be_liveness_transfer(cls, irn, &live_nodes);
-		unsigned cnt = (unsigned)ir_nodeset_size(&live_nodes);
+		unsigned cnt = (unsigned)ir_sparse_nodeset_size(&live_nodes);
 		max_live = MAX(cnt, max_live);
 	}
 
 	DBG((dbg, LEVEL_1, "Finished with Block %+F (%s %zu)\n", block, cls->name,
 	     max_live));
 
-	ir_nodeset_destroy(&live_nodes);
+	ir_sparse_nodeset_destroy(&live_nodes);
 	return max_live;
 }
 
@@ -38,6 +38,7 @@
 #include "iredges_t.h"
 #include "irgopt.h"
 #include "irloop_t.h"
+#include "iropt_t.h"
 #include "iroptimize.h"
 #include "irprofile.h"
 #include "irprog.h"
@@ -62,6 +63,7 @@ be_options_t be_options = {
 	.opt_profile_use      = false,
 	.omit_fp              = false,
 	.do_verify            = true,
+	.verify_lower         = false,
 	.ilp_solver           = "",
 	.verbose_asm          = true,
 };
@@ -87,6 +89,7 @@ static const lc_opt_table_entry_t be_main_options[] = {
 	LC_OPT_ENT_ENUM_MASK("dump",       "dump irg on several occasions",                       &dump_var),
 	LC_OPT_ENT_BOOL     ("omitfp",     "omit frame pointer",                                  &be_options.omit_fp),
 	LC_OPT_ENT_BOOL     ("verify",     "verify the backend irg",                              &be_options.do_verify),
+	LC_OPT_ENT_BOOL     ("verifylower", "verify the irg after each lowering step",            &be_options.verify_lower),
 	LC_OPT_ENT_BOOL     ("time",       "get backend timing statistics",                       &be_options.timing),
 	LC_OPT_ENT_BOOL     ("profilegenerate", "instrument the code for execution count profiling", &be_options.opt_profile_generate),
 	LC_OPT_ENT_BOOL     ("profileuse",      "use existing profile data",                         &be_options.opt_profile_use),
@@ -221,7 +224,7 @@ void be_check_verify_result(bool fine, ir_graph *irg)
 /* Perform schedule verification if requested. */
 static void be_sched_verify(ir_graph *irg)
 {
-	if (be_options.do_verify) {
+	if (be_options.do_verify && ir_verify_selected(irg, "be-sched")) {
 		be_timer_push(T_VERIFY);
 		bool fine = be_verify_schedule(irg);
 		be_check_verify_result(fine, irg);
@@ -231,7 +234,7 @@ static void be_sched_verify(ir_graph *irg)
 
 static void be_regalloc_verify(ir_graph *const irg)
 {
-	if (be_options.do_verify) {
+	if (be_options.do_verify && ir_verify_selected(irg, "be-ra")) {
 		be_timer_push(T_VERIFY);
 		bool const fine = be_verify_register_allocation(irg);
 		be_check_verify_result(fine, irg);
@@ -273,7 +276,7 @@ static void initialize_birg(be_irg_t *birg, ir_graph *irg, be_main_env_t *env)
 	birg->lv = be_liveness_new(irg);
 
 	/* Verify the initial graph */
-	if (be_options.do_verify) {
+	if (be_options.do_verify && ir_verify_selected(irg, "be-initial")) {
 		be_timer_push(T_VERIFY);
 		bool fine = irg_verify(irg);
 		be_check_verify_result(fine, irg);
@@ -393,7 +396,7 @@ void firm_be_finish(void)
 
 int be_timing;
 
-static const char *get_timer_name(be_timer_id_t id)
+const char *be_get_timer_name(be_timer_id_t id)
 {
 	switch (id) {
 	case T_ABI:            return "abi";
@@ -423,24 +426,25 @@ static const char *get_timer_name(be_timer_id_t id)
 }
 ir_timer_t *be_timers[T_LAST+1];
 
-static void dummy_after_transform(ir_graph *irg, const char *name)
+static after_transform_func after_transform_callback;
+
+void be_set_after_transform_func(after_transform_func after_transform)
 {
-	(void)irg;
-	(void)name;
+	after_transform_callback = after_transform;
 }
 
-after_transform_func be_after_transform = dummy_after_transform;
-
-void be_set_after_transform_func(after_transform_func after_transform)
+void be_after_transform(ir_graph *irg, const char *name)
 {
-	be_after_transform = after_transform;
+	if (be_options.verify_lower && ir_verify_selected(irg, name)) {
+		bool fine = irg_verify(irg);
+		be_check_verify_result(fine, irg);
+	}
+	if (after_transform_callback != NULL)
+		after_transform_callback(irg, name);
 }
 
 void be_after_irp_transform(const char *name)
 {
-	if (be_after_transform == NULL)
-		return;
-
 	foreach_irp_irg_r(i, irg) {
 		be_after_transform(irg, name);
 	}
@@ -449,6 +453,10 @@ void be_after_irp_transform(const char *name)
 void be_lower_for_target(void)
 {
 	assert(ir_target.isa_initialized);
+	/* no pass holds node indices here */
+	foreach_irp_irg(i, irg) {
+		maybe_compact_node_indices(irg);
+	}
 	ir_target.isa->lower_for_target();
 	/* set the phase to low */
 	foreach_irp_irg_r(i, irg) {
@@ -457,7 +465,9 @@ void be_lower_for_target(void)
 	}
 }
 
-static int cse_setting;
+static int       cse_setting;
+static ptrdiff_t obstack_start;
+static ptrdiff_t obstack_outer_peak;
 
 bool be_step_first(ir_graph *irg)
 {
@@ -465,11 +475,14 @@ bool be_step_first(ir_graph *irg)
 	if (get_entity_linkage(entity) & IR_LINKAGE_NO_CODEGEN)
 		return false;
 
+	ir_pass_timing_push("backend", irg);
 	be_timer_push(T_OTHER);
 	if (stat_ev_enabled) {
 		stat_ev_ctx_push_fmt("bemain_irg", "%+F", irg);
 		stat_ev_ull("bemain_insns_start", be_count_insns(irg));
 		stat_ev_ull("bemain_blocks_start", be_count_blocks(irg));
+		obstack_start      = obstack_total_memory_used();
+		obstack_outer_peak = obstack_set_peak_memory_used(obstack_start);
 	}
 	cse_setting = get_opt_cse();
 	return true;
@@ -516,26 +529,32 @@ void be_step_last(ir_graph *irg)
 	if (stat_ev_enabled) {
 		stat_ev_ull("bemain_insns_finish", be_count_insns(irg));
 		stat_ev_ull("bemain_blocks_finish", be_count_blocks(irg));
+		ptrdiff_t const peak = obstack_peak_memory_used();
+		stat_ev_ull("bemain_obstack_peak", peak - obstack_start);
+		stat_ev_ull("bemain_obstack_end",
+		            obstack_total_memory_used() - obstack_start);
+		obstack_set_peak_memory_used(MAX(peak, obstack_outer_peak));
 	}
 
 	be_dump(DUMP_FINAL, irg, "final");
 	be_regalloc_verify(irg);
 
 	be_timer_pop(T_OTHER);
+	ir_pass_timing_pop();
 
 	if (be_timing) {
 		if (stat_ev_enabled) {
 			for (be_timer_id_t t = T_FIRST; t < T_LAST+1; ++t) {
 				char buf[128];
 				snprintf(buf, sizeof(buf), "bemain_time_%s",
-				         get_timer_name(t));
+				         be_get_timer_name(t));
 				stat_ev_dbl(buf, ir_timer_elapsed_usec(be_timers[t]));
 			}
 		} else {
 			printf("==>> IRG %s <<==\n", get_entity_name(get_irg_entity(irg)));
 			for (be_timer_id_t t = T_FIRST; t < T_LAST+1; ++t) {
 				double val = ir_timer_elapsed_usec(be_timers[t]) / 1000.0;
-				printf("%-20s: %10.3f msec\n", get_timer_name(t), val);
+				printf("%-20s: %10.3f msec\n", be_get_timer_name(t), val);
 			}
 		}
 		for (be_timer_id_t t = T_FIRST; t < T_LAST+1; ++t) {
@@ -22,6 +22,9 @@
 #include "time.h"
 #include "execfreq_t.h"
 #include "bipartite.h"
+#include "debug.h"
+#include "unionfind.h"
+#include "util.h"
 
 /* libfirm/ir/be includes */
 #include "bearch.h"
@@ -61,6 +64,8 @@
 static bool use_exec_freq     = true;
 static bool use_late_decision = false;
 
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
 typedef struct be_pbqp_alloc_env_t {
 	pbqp_t                      *pbqp_inst;         /**< PBQP instance for register allocation */
 	ir_graph                    *irg;               /**< The graph under examination. */
@@ -281,7 +286,7 @@ static void create_pbqp_coloring_instance(ir_node *block, void *data)
 	deq_t                       *rpeo               = &pbqp_alloc_env->rpeo;
 	pbqp_t                      *pbqp_inst          = pbqp_alloc_env->pbqp_inst;
 	pbqp_node_t                **temp_list          = NEW_ARR_F(pbqp_node_t*, 0);
-	ir_nodeset_t                 live_nodes;
+	ir_sparse_nodeset            live_nodes;
 #if USE_BIPARTITE_MATCHING
 	int                         *assignment         = ALLOCAN(int, cls->n_regs);
 #else
@@ -297,7 +302,7 @@ static void create_pbqp_coloring_instance(ir_node *block, void *data)
 	create_borders(block, pbqp_alloc_env->env);
 
 	/* calculate living nodes for the first step */
-	ir_nodeset_init(&live_nodes);
+	ir_sparse_nodeset_init(&live_nodes, get_irn_irg(block));
 	be_liveness_end_of_block(lv, cls, block, &live_nodes);
 
 	/* create pbqp nodes, interference edges and reverse perfect elimination order */
@@ -311,7 +316,7 @@ static void create_pbqp_coloring_instance(ir_node *block, void *data)
 				create_pbqp_node(pbqp_alloc_env, value);
 
 			/* create nodes and interference edges */
-			foreach_ir_nodeset(&live_nodes, live, iter) {
+			foreach_ir_sparse_nodeset(&live_nodes, live) {
 				/* create pbqp source node if it doesn't exist */
 				if (!get_node(pbqp_inst, get_irn_idx(live)))
 					create_pbqp_node(pbqp_alloc_env, live);
@@ -511,7 +516,7 @@ static void create_pbqp_coloring_instance(ir_node *block, void *data)
 	}
 
 	/* free reserved memory */
-	ir_nodeset_destroy(&live_nodes);
+	ir_sparse_nodeset_destroy(&live_nodes);
 	DEL_ARR_F(temp_list);
 #if USE_BIPARTITE_MATCHING
 #else
@@ -521,6 +526,143 @@ static void create_pbqp_coloring_instance(ir_node *block, void *data)
 #endif
 }
 
+static int cmp_node_index(const void *a, const void *b)
+{
+	pbqp_node_t const *const n0 = *(pbqp_node_t const**)a;
+	pbqp_node_t const *const n1 = *(pbqp_node_t const**)b;
+	return QSORT_CMP(n0->index, n1->index);
+}
+
+/**
+ * Solves the PBQP problem of one connected component and assigns the
+ * registers.
+ *
+ * @param nodes    the nodes of the component in reverse perfect elimination
+ *                 order
+ * @param n_nodes  the number of nodes
+ */
+static void solve_component(be_pbqp_alloc_env_t *pbqp_alloc_env,
+                            pbqp_node_t **nodes, size_t n_nodes)
+{
+	ir_graph *const irg = pbqp_alloc_env->irg;
+
+	/* an isolated node simply gets its cheapest register */
+	if (n_nodes == 1) {
+		pbqp_node_t *const node  = nodes[0];
+		unsigned     const color = vector_get_min_index(node->costs);
+		if (node->costs->entries[color].data == INF_COSTS)
+			panic("no PBQP solution found");
+		arch_set_irn_register_idx(get_idx_irn(irg, node->index), color);
+		return;
+	}
+
+	/* The solver works on dense node indices. Renumber the nodes in the
+	 * order of their old indices as edges point from the lower to the higher
+	 * index. */
+	pbqp_node_t **const sorted = XMALLOCN(pbqp_node_t*, n_nodes);
+	ir_node     **const irns   = XMALLOCN(ir_node*, n_nodes);
+	MEMCPY(sorted, nodes, n_nodes);
+	QSORT(sorted, n_nodes, cmp_node_index);
+
+	pbqp_t *const pbqp = alloc_pbqp(n_nodes);
+	for (size_t i = 0; i < n_nodes; ++i) {
+		irns[i]          = get_idx_irn(irg, sorted[i]->index);
+		sorted[i]->index = i;
+		pbqp->nodes[i]   = sorted[i];
+	}
+#if KAPS_DUMP
+	set_dumpfile(pbqp, pbqp_alloc_env->pbqp_inst->dump_file);
+#endif
+
+	deq_t rpeo;
+	deq_init(&rpeo);
+	for (size_t i = 0; i < n_nodes; ++i)
+		deq_push_pointer_right(&rpeo, nodes[i]);
+
+	if (use_late_decision) {
+		solve_pbqp_heuristical_co_ld(pbqp, &rpeo);
+	} else {
+		solve_pbqp_heuristical_co(pbqp, &rpeo);
+	}
+
+	num const solution = get_solution(pbqp);
+	if (solution == INF_COSTS)
+		panic("no PBQP solution found");
+
+	/* assign colors, back propagation may have replaced the nodes */
+	for (size_t i = 0; i < n_nodes; ++i) {
+		num const color = get_node_solution(pbqp, i);
+		arch_set_irn_register_idx(irns[i], color);
+	}
+
+	deq_free(&rpeo);
+	free_pbqp(pbqp);
+	free(irns);
+	free(sorted);
+}
+
+/**
+ * Splits the PBQP instance into the connected components of its interference
+ * and affinity edges and solves them one after another. The components are
+ * independent, so this yields the same solution as solving the whole instance
+ * while the solver only ever sees a small problem.
+ */
+static void solve_components(be_pbqp_alloc_env_t *pbqp_alloc_env)
+{
+	ir_graph *const irg     = pbqp_alloc_env->irg;
+	unsigned  const n_idx   = get_irg_last_idx(irg);
+	int      *const uf      = XMALLOCN(int, n_idx);
+	size_t   *const start   = XMALLOCNZ(size_t, n_idx + 1);
+	size_t          n_nodes = 0;
+
+	uf_init(uf, n_idx);
+	deq_foreach_pointer(&pbqp_alloc_env->rpeo, pbqp_node_t, node) {
+		for (size_t i = 0, n = ARR_LEN(node->edges); i < n; ++i) {
+			pbqp_edge_t const *const edge = node->edges[i];
+			if (edge->src != node)
+				continue;
+			int const src = uf_find(uf, edge->src->index);
+			int const tgt = uf_find(uf, edge->tgt->index);
+			uf_union(uf, src, tgt);
+		}
+		++n_nodes;
+	}
+
+	/* sort the nodes by component, keeping the reverse perfect elimination
+	 * order inside of each component */
+	deq_foreach_pointer(&pbqp_alloc_env->rpeo, pbqp_node_t, node) {
+		++start[uf_find(uf, node->index) + 1];
+	}
+	for (unsigned i = 0; i < n_idx; ++i)
+		start[i + 1] += start[i];
+	pbqp_node_t **const by_component = XMALLOCN(pbqp_node_t*, n_nodes);
+	deq_foreach_pointer(&pbqp_alloc_env->rpeo, pbqp_node_t, node) {
+		by_component[start[uf_find(uf, node->index)]++] = node;
+	}
+
+	/* start[i] now is the end of component i */
+	unsigned n_components = 0;
+	size_t   largest      = 0;
+	for (size_t i = 0, begin = 0; i < n_idx; ++i) {
+		size_t const end = start[i];
+		if (end == begin)
+			continue;
+		size_t const n = end - begin;
+		largest = MAX(largest, n);
+		++n_components;
+		solve_component(pbqp_alloc_env, by_component + begin, n);
+		begin = end;
+	}
+	DB((dbg, LEVEL_1, "%+F %s: %zu nodes in %u components, largest %zu\n",
+	    irg, pbqp_alloc_env->cls->name, n_nodes, n_components, largest));
+	(void)n_components;
+	(void)largest;
+
+	free(by_component);
+	free(start);
+	free(uf);
+}
+
 static void insert_perms(ir_node *block, void *data)
 {
 	be_chordal_env_t *env    = (be_chordal_env_t*)data;
@@ -632,31 +774,12 @@ static void be_pbqp_coloring(be_chordal_env_t *env)
 #if TIMER
 	ir_timer_reset_and_start(t_ra_pbqp_alloc_solve);
 #endif
-	if (use_late_decision) {
-		solve_pbqp_heuristical_co_ld(pbqp_alloc_env.pbqp_inst,
-		                             &pbqp_alloc_env.rpeo);
-	} else {
-		solve_pbqp_heuristical_co(pbqp_alloc_env.pbqp_inst,
-		                          &pbqp_alloc_env.rpeo);
-	}
+	solve_components(&pbqp_alloc_env);
 #if TIMER
 	ir_timer_stop(t_ra_pbqp_alloc_solve);
 #endif
 
 
-	num const solution = get_solution(pbqp_alloc_env.pbqp_inst);
-	if (solution == INF_COSTS)
-		panic("no PBQP solution found");
-
-
-	/* assign colors */
-	deq_foreach_pointer(&pbqp_alloc_env.rpeo, pbqp_node_t, node) {
-		ir_node *const irn   = get_idx_irn(irg, node->index);
-		num      const color = get_node_solution(pbqp_alloc_env.pbqp_inst, node->index);
-		arch_set_irn_register_idx(irn, color);
-	}
-
-
 #if TIMER
 	printf("PBQP alloc create:     %10.3lf msec\n",
 	       (double)ir_timer_elapsed_usec(t_ra_pbqp_alloc_create) / 1000.0);
@@ -696,4 +819,5 @@ void be_init_pbqp_coloring(void)
 
 	lc_opt_add_table(pbqp_grp, options);
 	be_register_chordal_coloring("pbqp", &coloring);
+	FIRM_DBG_REGISTER(dbg, "firm.be.pbqp");
 }
@@ -45,7 +45,9 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodemap.h"
 #include "irtools.h"
+#include "irverify.h"
 #include "lpp.h"
 #include "obst.h"
 #include "panic.h"
@@ -83,6 +85,11 @@ static size_t                       n_block_order;
  * maps registers to values(their current copies) */
 static ir_node **assignments;
 
+/** allocation infos of the values, see get_allocation_info() */
+static ir_nodemap        allocation_infos;
+/** per block information, see get_block_info() */
+static ir_sparse_nodemap block_infos;
+
 /**
  * allocation information: last_uses, register preferences
  * the information is per firm-node.
@@ -115,12 +122,13 @@ typedef struct block_info_t block_info_t;
  */
 static allocation_info_t *get_allocation_info(ir_node *node)
 {
-	allocation_info_t *info = (allocation_info_t*)get_irn_link(node);
+	allocation_info_t *info
+		= ir_nodemap_get(allocation_info_t, &allocation_infos, node);
 	if (info == NULL) {
 		info = OALLOCFZ(&obst, allocation_info_t, prefs, n_regs);
 		info->current_value  = node;
 		info->original_value = node;
-		set_irn_link(node, info);
+		ir_nodemap_insert(&allocation_infos, node, info);
 	}
 
 	return info;
@@ -128,7 +136,7 @@ static allocation_info_t *get_allocation_info(ir_node *node)
 
 static allocation_info_t *try_get_allocation_info(const ir_node *node)
 {
-	return (allocation_info_t*) get_irn_link(node);
+	return ir_nodemap_get(allocation_info_t, &allocation_infos, node);
 }
 
 /**
@@ -136,12 +144,13 @@ static allocation_info_t *try_get_allocation_info(const ir_node *node)
  */
 static block_info_t *get_block_info(ir_node *block)
 {
-	block_info_t *info = (block_info_t*)get_irn_link(block);
+	block_info_t *info
+		= ir_sparse_nodemap_get(block_info_t, &block_infos, block);
 
 	assert(is_Block(block));
 	if (info == NULL) {
 		info = OALLOCFZ(&obst, block_info_t, assignments, n_regs);
-		set_irn_link(block, info);
+		ir_sparse_nodemap_insert(&block_infos, block, info);
 	}
 
 	return info;
@@ -185,7 +194,7 @@ static void mark_as_copy_of(ir_node *copy, ir_node *value)
  * @param limited     a raw bitset containing the limited set for the node
  * @param node        the node
  */
-static void give_penalties_for_limits(const ir_nodeset_t *live_nodes,
+static void give_penalties_for_limits(const ir_sparse_nodeset *live_nodes,
                                       float penalty, const unsigned* limited,
                                       ir_node *node)
 {
@@ -209,7 +218,7 @@ static void give_penalties_for_limits(const ir_nodeset_t *live_nodes,
 		/* only create a very weak penalty if multiple regs are allowed */
 		penalty = (penalty * 0.8f) / n_allowed;
 	}
-	foreach_ir_nodeset(live_nodes, neighbor, iter) {
+	foreach_ir_sparse_nodeset(live_nodes, neighbor) {
 		allocation_info_t *neighbor_info;
 
 		/* TODO: if op is used on multiple inputs we might not do a
@@ -236,7 +245,7 @@ static void give_penalties_for_limits(const ir_nodeset_t *live_nodes,
  * @param weight      the weight
  * @param node        the current node
  */
-static void check_defs(ir_nodeset_t const *const live_nodes, float const weight, ir_node *const node, arch_register_req_t const *const req)
+static void check_defs(ir_sparse_nodeset const *const live_nodes, float const weight, ir_node *const node, arch_register_req_t const *const req)
 {
 	if (req->limited != NULL) {
 		const unsigned *limited = req->limited;
@@ -257,7 +266,7 @@ static void check_defs(ir_nodeset_t const *const live_nodes, float const weight,
 			/* if we the value at the should_be_same input doesn't die at the
 			 * node, then it is no use to propagate the constraints (since a
 			 * copy will emerge anyway) */
-			if (ir_nodeset_contains(live_nodes, op))
+			if (ir_sparse_nodeset_contains(live_nodes, op))
 				continue;
 
 			allocation_info_t *op_info = get_allocation_info(op);
@@ -274,16 +283,15 @@ static void check_defs(ir_nodeset_t const *const live_nodes, float const weight,
  */
 static void analyze_block(ir_node *block, void *data)
 {
-	float        weight = (float)get_block_execfreq(block);
-	ir_nodeset_t live_nodes;
-	(void) data;
+	ir_sparse_nodeset *live_nodes = (ir_sparse_nodeset*)data;
+	float              weight     = (float)get_block_execfreq(block);
 
-	ir_nodeset_init(&live_nodes);
-	be_liveness_end_of_block(lv, cls, block, &live_nodes);
+	ir_sparse_nodeset_clear(live_nodes);
+	be_liveness_end_of_block(lv, cls, block, live_nodes);
 
 	sched_foreach_non_phi_reverse(block, node) {
 		be_foreach_definition(node, cls, value, req,
-			check_defs(&live_nodes, weight, value, req);
+			check_defs(live_nodes, weight, value, req);
 		);
 
 		allocation_info_t *info = get_allocation_info(node);
@@ -299,26 +307,24 @@ static void analyze_block(ir_node *block, void *data)
 				continue;
 
 			/* last usage of a value? */
-			if (!ir_nodeset_contains(&live_nodes, op)) {
+			if (!ir_sparse_nodeset_contains(live_nodes, op)) {
 				rbitset_set(info->last_uses, i);
 			}
 		}
 
-		be_liveness_transfer(cls, node, &live_nodes);
+		be_liveness_transfer(cls, node, live_nodes);
 
 		/* update weights based on usage constraints */
 		be_foreach_use(node, cls, req, op, op_req,
 			if (req->limited == NULL)
 				continue;
 
-			give_penalties_for_limits(&live_nodes, weight * USE_FACTOR, req->limited, op);
+			give_penalties_for_limits(live_nodes, weight * USE_FACTOR, req->limited, op);
 		);
 	}
-
-	ir_nodeset_destroy(&live_nodes);
 }
 
-static void congruence_def(ir_nodeset_t *const live_nodes, ir_node const *const node, arch_register_req_t const *const req)
+static void congruence_def(ir_sparse_nodeset *const live_nodes, ir_node const *const node, arch_register_req_t const *const req)
 {
 	/* should be same constraint? */
 	if (req->should_be_same != 0) {
@@ -335,7 +341,7 @@ static void congruence_def(ir_nodeset_t *const live_nodes, ir_node const *const
 
 			/* do we interfere with the value */
 			bool interferes = false;
-			foreach_ir_nodeset(live_nodes, live, iter) {
+			foreach_ir_sparse_nodeset(live_nodes, live) {
 				int lv_idx = get_irn_idx(live);
 				lv_idx     = uf_find(congruence_classes, lv_idx);
 				if (lv_idx == op_idx) {
@@ -358,18 +364,16 @@ static void congruence_def(ir_nodeset_t *const live_nodes, ir_node const *const
 
 static void create_congruence_class(ir_node *block, void *data)
 {
-	ir_nodeset_t live_nodes;
-
-	(void) data;
-	ir_nodeset_init(&live_nodes);
-	be_liveness_end_of_block(lv, cls, block, &live_nodes);
+	ir_sparse_nodeset *live_nodes = (ir_sparse_nodeset*)data;
+	ir_sparse_nodeset_clear(live_nodes);
+	be_liveness_end_of_block(lv, cls, block, live_nodes);
 
 	/* check should be same constraints */
 	sched_foreach_non_phi_reverse(block, node) {
 		be_foreach_definition(node, cls, value, req,
-			congruence_def(&live_nodes, value, req);
+			congruence_def(live_nodes, value, req);
 		);
-		be_liveness_transfer(cls, node, &live_nodes);
+		be_liveness_transfer(cls, node, live_nodes);
 	}
 
 	/* check phi congruence classes */
@@ -388,7 +392,7 @@ static void create_congruence_class(ir_node *block, void *data)
 
 			/* do we interfere with the value */
 			bool interferes = false;
-			foreach_ir_nodeset(&live_nodes, live, iter) {
+			foreach_ir_sparse_nodeset(live_nodes, live) {
 				int lv_idx = get_irn_idx(live);
 				lv_idx     = uf_find(congruence_classes, lv_idx);
 				if (lv_idx == op_idx) {
@@ -434,7 +438,6 @@ static void create_congruence_class(ir_node *block, void *data)
 			}
 		}
 	}
-	ir_nodeset_destroy(&live_nodes);
 }
 
 static void set_congruence_prefs(ir_node *node, void *data)
@@ -457,14 +460,14 @@ static void set_congruence_prefs(ir_node *node, void *data)
 	MEMCPY(info->prefs, head_info->prefs, n_regs);
 }
 
-static void combine_congruence_classes(void)
+static void combine_congruence_classes(ir_sparse_nodeset *live_nodes)
 {
 	size_t n = get_irg_last_idx(irg);
 	congruence_classes = XMALLOCN(int, n);
 	uf_init(congruence_classes, n);
 
 	/* create congruence classes */
-	irg_block_walk_graph(irg, create_congruence_class, NULL, NULL);
+	irg_block_walk_graph(irg, create_congruence_class, NULL, live_nodes);
 	/* merge preferences */
 	irg_walk_graph(irg, set_congruence_prefs, NULL, NULL);
 	free(congruence_classes);
@@ -765,7 +768,7 @@ static void assign_reg(ir_node const *const block, ir_node *const node, arch_reg
  *                     registers, the values in the array are the source
  *                     registers.
  */
-static void permute_values(ir_nodeset_t *live_nodes, ir_node *before,
+static void permute_values(ir_sparse_nodeset *live_nodes, ir_node *before,
                            unsigned *permutation)
 {
 	unsigned *n_used = ALLOCANZ(unsigned, n_regs);
@@ -809,7 +812,7 @@ static void permute_values(ir_nodeset_t *live_nodes, ir_node *before,
 		DB((dbg, LEVEL_2, "Copy %+F (from %+F, before %+F) -> %s\n", copy, src, before, arch_get_irn_register(copy)->name));
 
 		if (live_nodes != NULL) {
-			ir_nodeset_insert(live_nodes, copy);
+			ir_sparse_nodeset_insert(live_nodes, copy);
 		}
 
 		/* old register has 1 user less, permutation is resolved */
@@ -820,7 +823,7 @@ static void permute_values(ir_nodeset_t *live_nodes, ir_node *before,
 		--n_used[old_r];
 		if (n_used[old_r] == 0) {
 			if (live_nodes != NULL) {
-				ir_nodeset_remove(live_nodes, src);
+				ir_sparse_nodeset_remove(live_nodes, src);
 			}
 			free_reg_of_value(src);
 		}
@@ -878,10 +881,10 @@ static void permute_values(ir_nodeset_t *live_nodes, ir_node *before,
 
 		/* if we have reached a fixpoint update data structures */
 		if (live_nodes != NULL) {
-			ir_nodeset_remove(live_nodes, in[0]);
-			ir_nodeset_remove(live_nodes, in[1]);
-			ir_nodeset_remove(live_nodes, proj0);
-			ir_nodeset_insert(live_nodes, proj1);
+			ir_sparse_nodeset_remove(live_nodes, in[0]);
+			ir_sparse_nodeset_remove(live_nodes, in[1]);
+			ir_sparse_nodeset_remove(live_nodes, proj0);
+			ir_sparse_nodeset_insert(live_nodes, proj1);
 		}
 	}
 
@@ -899,7 +902,7 @@ static void permute_values(ir_nodeset_t *live_nodes, ir_node *before,
  * @param live_nodes   set of live nodes, will be updated
  * @param node         the node to consider
  */
-static void free_last_uses(ir_nodeset_t *live_nodes, ir_node *node)
+static void free_last_uses(ir_sparse_nodeset *live_nodes, ir_node *node)
 {
 	allocation_info_t *info      = get_allocation_info(node);
 	const unsigned    *last_uses = info->last_uses;
@@ -910,7 +913,7 @@ static void free_last_uses(ir_nodeset_t *live_nodes, ir_node *node)
 			continue;
 
 		free_reg_of_value(op);
-		ir_nodeset_remove(live_nodes, op);
+		ir_sparse_nodeset_remove(live_nodes, op);
 	}
 }
 
@@ -960,7 +963,7 @@ static void determine_live_through_regs(unsigned *bitset, ir_node *node)
 	}
 }
 
-static void solve_lpp(ir_nodeset_t *live_nodes, ir_node *node,
+static void solve_lpp(ir_sparse_nodeset *live_nodes, ir_node *node,
                       unsigned *forbidden_regs, unsigned *live_through_regs)
 {
 	unsigned *forbidden_edges = rbitset_malloc(n_regs * n_regs);
@@ -1098,7 +1101,7 @@ static bool is_aligned(unsigned num, unsigned alignment)
  * @param  live_nodes  the set of live nodes, might be changed
  * @param  node        the current node
  */
-static void enforce_constraints(ir_nodeset_t *live_nodes, ir_node *node,
+static void enforce_constraints(ir_sparse_nodeset *live_nodes, ir_node *node,
                                 unsigned *forbidden_regs)
 {
 	/* see if any use constraints are not met and whether double-width
@@ -1445,15 +1448,14 @@ static void assign_phi_registers(ir_node *block)
  */
 static void allocate_coalesce_block(ir_node *block, void *data)
 {
-	(void) data;
+	ir_sparse_nodeset *live_nodes = (ir_sparse_nodeset*)data;
 	DB((dbg, LEVEL_2, "* Block %+F\n", block));
 
 	/* clear assignments */
 	block_info_t *block_info  = get_block_info(block);
 	assignments = block_info->assignments;
 
-	ir_nodeset_t live_nodes;
-	ir_nodeset_init(&live_nodes);
+	ir_sparse_nodeset_clear(live_nodes);
 
 	/* gather regalloc infos of predecessor blocks */
 	int            n_preds          = get_Block_n_cfgpreds(block);
@@ -1540,7 +1542,7 @@ static void allocate_coalesce_block(ir_node *block, void *data)
 		}
 
 		/* remember that this node is live at the beginning of the block */
-		ir_nodeset_insert(&live_nodes, node);
+		ir_sparse_nodeset_insert(live_nodes, node);
 	}
 
 	/** Collects registers which must not be used for optimistic splits. */
@@ -1551,7 +1553,7 @@ static void allocate_coalesce_block(ir_node *block, void *data)
 
 	/* all live-ins must have a register */
 #ifndef NDEBUG
-	foreach_ir_nodeset(&live_nodes, node, iter) {
+	foreach_ir_sparse_nodeset(live_nodes, node) {
 		const arch_register_t *reg = arch_get_irn_register(node);
 		assert(reg != NULL);
 	}
@@ -1563,7 +1565,7 @@ static void allocate_coalesce_block(ir_node *block, void *data)
 
 		/* enforce use constraints */
 		rbitset_clear_all(forbidden_regs, n_regs);
-		enforce_constraints(&live_nodes, node, forbidden_regs);
+		enforce_constraints(live_nodes, node, forbidden_regs);
 
 		rewire_inputs(node);
 
@@ -1574,7 +1576,7 @@ static void allocate_coalesce_block(ir_node *block, void *data)
 		);
 
 		/* free registers of values last used at this instruction */
-		free_last_uses(&live_nodes, node);
+		free_last_uses(live_nodes, node);
 
 		/* assign output registers */
 		be_foreach_definition_(node, cls, value, req,
@@ -1582,7 +1584,6 @@ static void allocate_coalesce_block(ir_node *block, void *data)
 		);
 	}
 
-	ir_nodeset_destroy(&live_nodes);
 	assignments = NULL;
 
 	block_info->processed = true;
@@ -1737,21 +1738,24 @@ static void be_pref_alloc_cls(void)
 	be_assure_live_sets(irg);
 	lv = be_get_irg_liveness(irg);
 
-	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
-
 	DB((dbg, LEVEL_2, "=== Allocating registers of %s ===\n", cls->name));
 
-	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
+	ir_nodemap_init(&allocation_infos, irg);
+	ir_sparse_nodemap_init(&block_infos, irg);
+	ir_sparse_nodeset live_nodes;
+	ir_sparse_nodeset_init(&live_nodes, irg);
 
-	irg_block_walk_graph(irg, NULL, analyze_block, NULL);
-	combine_congruence_classes();
+	irg_block_walk_graph(irg, NULL, analyze_block, &live_nodes);
+	combine_congruence_classes(&live_nodes);
 
 	for (size_t i = 0; i < n_block_order; ++i) {
 		ir_node *block = block_order[i];
-		allocate_coalesce_block(block, NULL);
+		allocate_coalesce_block(block, &live_nodes);
 	}
 
-	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	ir_sparse_nodeset_destroy(&live_nodes);
+	ir_sparse_nodemap_destroy(&block_infos);
+	ir_nodemap_destroy(&allocation_infos);
 }
 
 /**
@@ -1805,7 +1809,7 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 		spill(regif);
 
 		/* verify schedule and register pressure */
-		if (be_options.do_verify) {
+		if (be_options.do_verify && ir_verify_selected(irg, "be-prefalloc")) {
 			be_timer_push(T_VERIFY);
 			bool check_schedule = be_verify_schedule(irg);
 			be_check_verify_result(check_schedule, irg);
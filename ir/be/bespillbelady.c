@@ -28,6 +28,7 @@
 #include "irloop.h"
 #include "irmode_t.h"
 #include "irnode_t.h"
+#include "irnodemap.h"
 #include "irtools.h"
 #include "obst.h"
 #include "statev_t.h"
@@ -71,6 +72,7 @@ static be_uses_t                   *uses;   /**< env for the next-use magic */
 static spill_env_t                 *senv;   /**< see bespill.h */
 static ir_node                    **blocklist;
 static workset_t                   *temp_workset;
+static ir_sparse_nodemap            block_infos;
 
 static bool                         move_spills      = true;
 static bool                         respectloopdepth = true;
@@ -243,13 +245,13 @@ typedef struct block_info_t {
 static block_info_t *new_block_info(ir_node *block)
 {
 	block_info_t *info = OALLOCZ(&obst, block_info_t);
-	set_irn_link(block, info);
+	ir_sparse_nodemap_insert(&block_infos, block, info);
 	return info;
 }
 
 static inline block_info_t *get_block_info(const ir_node *block)
 {
-	return (block_info_t*)get_irn_link(block);
+	return ir_sparse_nodemap_get(block_info_t, &block_infos, block);
 }
 
 /**
@@ -798,19 +800,18 @@ static void be_spill_belady(ir_graph *irg, const arch_register_class_t *rcls,
 	assure_loopinfo(irg);
 	stat_ev_tim_pop("belady_time_backedges");
 
+	/* the uses environment stores schedule steps in the links */
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
-	stat_ev_tim_push();
-	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
-	stat_ev_tim_pop("belady_time_clear_links");
 
 	/* init belady env */
 	stat_ev_tim_push();
 	obstack_init(&obst);
+	ir_sparse_nodemap_init(&block_infos, irg);
 	cls          = rcls;
 	lv           = be_get_irg_liveness(irg);
 	n_regs       = be_get_n_allocatable_regs(irg, cls);
 	ws           = new_workset();
-	uses         = be_begin_uses(irg, lv);
+	uses         = be_begin_uses(irg, lv, cls);
 	loop_ana     = be_new_loop_pressure(irg, cls);
 	senv         = be_new_spill_env(irg, regif);
 	blocklist    = be_get_cfgpostorder(irg);
@@ -831,6 +832,7 @@ static void be_spill_belady(ir_graph *irg, const arch_register_class_t *rcls,
 	irg_block_walk_graph(irg, fix_block_borders, NULL, NULL);
 	stat_ev_tim_pop("belady_time_fix_borders");
 
+	ir_sparse_nodemap_destroy(&block_infos);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 
 	/* Insert spill/reload nodes into the graph and fix usages */
@@ -30,7 +30,7 @@
 #include "debug.h"
 #include "iredges_t.h"
 #include "irgwalk.h"
-#include "irnodeset.h"
+#include "irnodemap.h"
 #include "irprintf.h"
 #include "panic.h"
 #include "util.h"
@@ -121,7 +121,7 @@ static unsigned get_value_width(const ir_node *node)
  * spill @p n nodes from a nodeset. Removes the nodes from the nodeset and
  * sets the spilled bits in spilled_nodes.
  */
-static void do_spilling(ir_nodeset_t *live_nodes, ir_node *node)
+static void do_spilling(ir_sparse_nodeset *live_nodes, ir_node *node)
 {
 	size_t values_defined = 0;
 	be_foreach_definition(node, cls, value, req,
@@ -133,7 +133,7 @@ static void do_spilling(ir_nodeset_t *live_nodes, ir_node *node)
 	/* we need registers for the non-live argument values */
 	size_t free_regs_needed = 0;
 	be_foreach_use(node, cls, in_req_, use, pred_req_,
-		if (!ir_nodeset_contains(live_nodes, use)) {
+		if (!ir_sparse_nodeset_contains(live_nodes, use)) {
 			free_regs_needed += get_value_width(use);
 		}
 	);
@@ -147,7 +147,7 @@ static void do_spilling(ir_nodeset_t *live_nodes, ir_node *node)
 	 * need even more registers */
 	free_regs_needed = MAX(free_regs_needed, values_defined);
 
-	size_t n_live_nodes  = ir_nodeset_size(live_nodes);
+	size_t n_live_nodes  = ir_sparse_nodeset_size(live_nodes);
 	int    spills_needed = (n_live_nodes + free_regs_needed) - n_regs;
 	if (spills_needed <= 0)
 		return;
@@ -157,7 +157,7 @@ static void do_spilling(ir_nodeset_t *live_nodes, ir_node *node)
 
 	/* construct array with spill candidates and calculate their costs */
 	size_t c = 0;
-	foreach_ir_nodeset(live_nodes, n, iter) {
+	foreach_ir_sparse_nodeset(live_nodes, n) {
 		assert(!bitset_is_set(spilled_nodes, get_irn_idx(n)));
 
 		spill_candidate_t *candidate = &candidates[c++];
@@ -194,7 +194,7 @@ static void do_spilling(ir_nodeset_t *live_nodes, ir_node *node)
 			continue;
 
 		spill_node(cand_node);
-		ir_nodeset_remove(live_nodes, cand_node);
+		ir_sparse_nodeset_remove(live_nodes, cand_node);
 		spills_needed -= get_value_width(cand_node);
 	}
 }
@@ -202,29 +202,29 @@ static void do_spilling(ir_nodeset_t *live_nodes, ir_node *node)
 /**
  * removes all values from the nodeset that are defined by node
  */
-static void remove_defs(ir_node *node, ir_nodeset_t *nodeset)
+static void remove_defs(ir_node *node, ir_sparse_nodeset *nodeset)
 {
 	/* You must break out of your loop when hitting the first phi function. */
 	assert(!is_Phi(node));
 
 	be_foreach_definition(node, cls, value, req,
-		ir_nodeset_remove(nodeset, value);
+		ir_sparse_nodeset_remove(nodeset, value);
 	);
 }
 
-static void add_uses(ir_node *node, ir_nodeset_t *nodeset)
+static void add_uses(ir_node *node, ir_sparse_nodeset *nodeset)
 {
 	foreach_irn_in(node, i, op) {
 		if (arch_irn_consider_in_reg_alloc(cls, op)
 		    && !bitset_is_set(spilled_nodes, get_irn_idx(op)))
-			ir_nodeset_insert(nodeset, op);
+			ir_sparse_nodeset_insert(nodeset, op);
 	}
 }
 
 static __attribute__((unused))
-void print_nodeset(ir_nodeset_t *nodeset)
+void print_nodeset(ir_sparse_nodeset *nodeset)
 {
-	foreach_ir_nodeset(nodeset, node, iter) {
+	foreach_ir_sparse_nodeset(nodeset, node) {
 		ir_fprintf(stderr, "%+F ", node);
 	}
 	fprintf(stderr, "\n");
@@ -240,16 +240,18 @@ static void spill_block(ir_node *block, void *data)
 	DBG((dbg, LEVEL_1, "spilling block %+F\n", block));
 
 	/* construct set of live nodes at end of block */
-	ir_nodeset_t live_nodes;
-	ir_nodeset_init(&live_nodes);
+	ir_sparse_nodeset live_nodes;
+	ir_sparse_nodeset_init(&live_nodes, get_irn_irg(block));
 	be_liveness_end_of_block(lv, cls, block, &live_nodes);
 
-	/* remove already spilled nodes from liveset */
-	foreach_ir_nodeset(&live_nodes, node, iter) {
+	/* remove already spilled nodes from liveset, backwards as removing moves
+	 * the last element */
+	for (size_t i = ir_sparse_nodeset_size(&live_nodes); i-- > 0;) {
+		ir_node *const node = live_nodes.nodes[i];
 		DBG((dbg, LEVEL_2, "\t%+F is live-end... ", node));
 		if (bitset_is_set(spilled_nodes, get_irn_idx(node))) {
 			DBG((dbg, LEVEL_2, "but spilled; removing.\n"));
-			ir_nodeset_remove_iterator(&live_nodes, &iter);
+			ir_sparse_nodeset_remove(&live_nodes, node);
 		} else {
 			DBG((dbg, LEVEL_2, "keeping.\n"));
 		}
@@ -273,7 +275,7 @@ static void spill_block(ir_node *block, void *data)
 	}
 
 	int live_nodes_pressure = 0;
-	foreach_ir_nodeset(&live_nodes, node, iter) {
+	foreach_ir_sparse_nodeset(&live_nodes, node) {
 		live_nodes_pressure += get_value_width(node);
 	}
 
@@ -298,7 +300,7 @@ static void spill_block(ir_node *block, void *data)
 	}
 	assert(phi_spills_needed <= 0);
 
-	ir_nodeset_destroy(&live_nodes);
+	ir_sparse_nodeset_destroy(&live_nodes);
 }
 
 static void be_spill_daemel(ir_graph *irg, const arch_register_class_t *new_cls,
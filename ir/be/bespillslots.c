@@ -24,6 +24,7 @@
 #include "execfreq.h"
 #include "ircons.h"
 #include "irdump_t.h"
+#include "iredges_t.h"
 #include "irgwalk.h"
 #include "set.h"
 #include "statev_t.h"
@@ -186,11 +187,13 @@ static spill_t *collect_spill(be_fec_env_t *env, ir_node *node, spillweb_t *web)
 			if (arg == node)
 				continue;
 			spill_t *arg_spill = collect_spill(env, arg, web);
-			ir_node *block     = get_nodes_block(arg);
+			ir_node *block     = get_nodes_block(node);
 
-			/* add an affinity edge */
+			/* add an affinity edge weighted by the frequency of the MemPerm
+			 * needed if the slots are not merged */
 			affinity_edge_t *affinity_edge = OALLOC(&env->obst, affinity_edge_t);
-			affinity_edge->affinity = get_block_execfreq(block);
+			affinity_edge->affinity
+				= get_block_execfreq(get_Block_cfgpred_block(block, i));
 			affinity_edge->slot1    = spill->spillslot;
 			affinity_edge->slot2    = arg_spill->spillslot;
 			ARR_APP1(affinity_edge_t*, env->affinity_edges, affinity_edge);
@@ -224,27 +227,268 @@ void be_load_needs_frame_entity(be_fec_env_t *const env, ir_node *const node,
 	merge_slotsizes(spill->web, slot_size, slot_po2align);
 }
 
-static int merge_interferences(be_fec_env_t *env, bitset_t** interferences,
-                               int* spillslot_unionfind, int s1, int s2)
+/** A definition or use of a spill value inside a block. */
+typedef struct spill_event_t {
+	sched_timestep_t step;
+	int              spill;
+	bool             is_def;
+} spill_event_t;
+
+/** Per block information for the interference sweep. */
+typedef struct spill_block_t {
+	int           *live_end;      /**< spills live at the end of the block */
+	spill_event_t *events;        /**< definitions and uses in the block */
+	int            live_end_mark; /**< last spill added to live_end */
+	int            live_in_mark;  /**< last spill found live at the begin */
+} spill_block_t;
+
+typedef struct interference_env_t {
+	struct obstack   obst;
+	spill_block_t  **blocks;    /**< all block infos */
+	ir_node        **worklist;
+	int             *edges;     /**< pairs of interfering spills */
+} interference_env_t;
+
+static void init_spill_block(ir_node *block, void *data)
 {
-	/* merge spillslots and interferences */
-	int res = uf_union(spillslot_unionfind, s1, s2);
-	/* we assume that we always merge s2 to s1 so swap s1, s2 if necessary */
-	if (res != s1) {
-		int t = s1;
-		s1 = s2;
-		s2 = t;
+	interference_env_t *ienv = (interference_env_t*)data;
+	spill_block_t      *info = OALLOC(&ienv->obst, spill_block_t);
+	info->live_end      = NEW_ARR_F(int, 0);
+	info->events        = NEW_ARR_F(spill_event_t, 0);
+	info->live_end_mark = -1;
+	info->live_in_mark  = -1;
+	ARR_APP1(spill_block_t*, ienv->blocks, info);
+	set_irn_link(block, info);
+}
+
+static spill_block_t *get_spill_block(const ir_node *block)
+{
+	return (spill_block_t*)get_irn_link(block);
+}
+
+static void add_event(ir_node const *node, int spill, bool is_def)
+{
+	spill_block_t *const info  = get_spill_block(get_nodes_block(node));
+	spill_event_t  const event = { sched_get_time_step(node), spill, is_def };
+	ARR_APP1(spill_event_t, info->events, event);
+}
+
+/**
+ * Marks @p spill live at the begin of the blocks on the worklist and
+ * propagates the liveness upwards to the block defining the spill.
+ */
+static void propagate_live_in(interference_env_t *ienv, int spill,
+                              ir_node const *def_block)
+{
+	while (ARR_LEN(ienv->worklist) > 0) {
+		ir_node       *const block = ienv->worklist[ARR_LEN(ienv->worklist) - 1];
+		spill_block_t *const info  = get_spill_block(block);
+		ARR_SHRINKLEN(ienv->worklist, ARR_LEN(ienv->worklist) - 1);
+		if (info->live_in_mark == spill)
+			continue;
+		info->live_in_mark = spill;
+
+		for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+			ir_node *const pred = get_Block_cfgpred_block(block, i);
+			if (pred == NULL)
+				continue;
+			spill_block_t *const pred_info = get_spill_block(pred);
+			if (pred_info->live_end_mark == spill)
+				continue;
+			pred_info->live_end_mark = spill;
+			ARR_APP1(int, pred_info->live_end, spill);
+			if (pred != def_block)
+				ARR_APP1(ir_node*, ienv->worklist, pred);
+		}
+	}
+}
+
+static void make_live_end(interference_env_t *ienv, ir_node *block, int spill,
+                          ir_node const *def_block)
+{
+	spill_block_t *const info = get_spill_block(block);
+	if (info->live_end_mark == spill)
+		return;
+	info->live_end_mark = spill;
+	ARR_APP1(int, info->live_end, spill);
+	if (block != def_block) {
+		ARR_APP1(ir_node*, ienv->worklist, block);
+		propagate_live_in(ienv, spill, def_block);
 	}
+}
 
-	bitset_or(interferences[s1], interferences[s2]);
+/**
+ * Records the uses of @p value as uses of @p spill. Memory only passes
+ * through Syncs, so their users are the real users.
+ */
+static void collect_uses(interference_env_t *ienv, ir_node const *value,
+                         int spill, ir_node const *def_block)
+{
+	foreach_out_edge(value, edge) {
+		ir_node *const user  = get_edge_src_irn(edge);
+		ir_node *const block = get_nodes_block(user);
+		if (is_Sync(user)) {
+			collect_uses(ienv, user, spill, def_block);
+		} else if (is_Phi(user)) {
+			ir_node *const pred
+				= get_Block_cfgpred_block(block, get_edge_src_pos(edge));
+			if (pred != NULL)
+				make_live_end(ienv, pred, spill, def_block);
+		} else if (!sched_is_scheduled(user)) {
+			make_live_end(ienv, block, spill, def_block);
+		} else {
+			add_event(user, spill, false);
+			if (block != def_block) {
+				ARR_APP1(ir_node*, ienv->worklist, block);
+				propagate_live_in(ienv, spill, def_block);
+			}
+		}
+	}
+}
 
-	/* update other interferences */
-	for (size_t i = 0, n = ARR_LEN(env->spills); i < n; ++i) {
-		bitset_t *intfs = interferences[i];
-		if (bitset_is_set(intfs, s2))
-			bitset_set(intfs, s1);
+/** Returns the store which is executed last among the operands of a Sync. */
+static ir_node *get_last_sync_op(ir_node const *const sync)
+{
+	ir_node *best = NULL;
+	foreach_irn_in(sync, i, in) {
+		ir_node *const op = is_Sync(in) ? get_last_sync_op(in) : skip_Proj(in);
+		if (best == NULL || value_strictly_dominates(best, op))
+			best = op;
 	}
+	return best;
+}
 
+static int cmp_spill_event(const void *d1, const void *d2)
+{
+	spill_event_t const *const e1 = (spill_event_t const*)d1;
+	spill_event_t const *const e2 = (spill_event_t const*)d2;
+	/* backwards through the schedule, a definition kills the value before
+	 * the uses of the same instruction become live */
+	if (e1->step != e2->step)
+		return e1->step < e2->step ? 1 : -1;
+	return (int)e2->is_def - (int)e1->is_def;
+}
+
+/**
+ * Computes the interferences of the spills by sweeping backwards over the
+ * schedule of every block: A spill interferes with all spills live at its
+ * definition. Returns pairs of interfering spill numbers.
+ */
+static int *compute_interferences(be_fec_env_t *env)
+{
+	spill_t **const spills     = env->spills;
+	int       const spillcount = (int)ARR_LEN(spills);
+
+	interference_env_t ienv;
+	obstack_init(&ienv.obst);
+	ienv.blocks   = NEW_ARR_F(spill_block_t*, 0);
+	ienv.worklist = NEW_ARR_F(ir_node*, 0);
+	ienv.edges    = NEW_ARR_F(int, 0);
+	irg_block_walk_graph(env->irg, init_spill_block, NULL, &ienv);
+
+	/* collect definitions and uses, compute liveness at the block ends */
+	for (int s = 0; s < spillcount; ++s) {
+		ir_node *const value = spills[s]->spill;
+		if (is_NoMem(value))
+			continue;
+		ir_node *const def = is_Sync(value) ? get_last_sync_op(value)
+		                                    : skip_Proj(value);
+		add_event(def, s, true);
+		collect_uses(&ienv, value, s, get_nodes_block(def));
+	}
+
+	int *const live_pos = OALLOCN(&ienv.obst, int, spillcount);
+	int       *live     = NEW_ARR_F(int, 0);
+	for (int s = 0; s < spillcount; ++s)
+		live_pos[s] = -1;
+
+	for (size_t b = 0, n_blocks = ARR_LEN(ienv.blocks); b < n_blocks; ++b) {
+		spill_block_t *const info = ienv.blocks[b];
+		for (size_t i = 0, n = ARR_LEN(info->live_end); i < n; ++i) {
+			int const s = info->live_end[i];
+			live_pos[s] = (int)ARR_LEN(live);
+			ARR_APP1(int, live, s);
+		}
+
+		QSORT_ARR(info->events, cmp_spill_event);
+		for (size_t i = 0, n = ARR_LEN(info->events); i < n; ++i) {
+			spill_event_t const *const event = &info->events[i];
+			int                  const s     = event->spill;
+			if (!event->is_def) {
+				if (live_pos[s] < 0) {
+					live_pos[s] = (int)ARR_LEN(live);
+					ARR_APP1(int, live, s);
+				}
+				continue;
+			}
+
+			/* remove the spill from the live set */
+			int const pos = live_pos[s];
+			if (pos >= 0) {
+				int const last = live[ARR_LEN(live) - 1];
+				live[pos]      = last;
+				live_pos[last] = pos;
+				live_pos[s]    = -1;
+				ARR_SHRINKLEN(live, ARR_LEN(live) - 1);
+			}
+
+			for (size_t l = 0, n_live = ARR_LEN(live); l < n_live; ++l) {
+				DB((dbg, LEVEL_1, "Slot %d and %d interfere\n", s, live[l]));
+				ARR_APP1(int, ienv.edges, s);
+				ARR_APP1(int, ienv.edges, live[l]);
+			}
+		}
+
+		for (size_t l = 0, n_live = ARR_LEN(live); l < n_live; ++l)
+			live_pos[live[l]] = -1;
+		ARR_SHRINKLEN(live, 0);
+	}
+
+	for (size_t b = 0, n_blocks = ARR_LEN(ienv.blocks); b < n_blocks; ++b) {
+		DEL_ARR_F(ienv.blocks[b]->live_end);
+		DEL_ARR_F(ienv.blocks[b]->events);
+	}
+	DEL_ARR_F(live);
+	DEL_ARR_F(ienv.worklist);
+	DEL_ARR_F(ienv.blocks);
+	obstack_free(&ienv.obst, NULL);
+	return ienv.edges;
+}
+
+/** Spillslots (sets of spills) during coalescing. */
+typedef struct coalesce_env_t {
+	int  *unionfind;
+	int  *next_member; /**< next spill in the same slot, -1 at the end */
+	int  *last_member; /**< last spill of a slot, valid for representatives */
+	int  *n_members;   /**< number of spills, valid for representatives */
+	int  *adj_begin;   /**< interfering spills of spill i are */
+	int  *adj;         /**< adj[adj_begin[i]] to adj[adj_begin[i + 1]] */
+} coalesce_env_t;
+
+static bool slots_interfere(coalesce_env_t const *const cenv, int s1, int s2)
+{
+	/* interferences are symmetric, walk the members of the smaller slot */
+	if (cenv->n_members[s2] < cenv->n_members[s1]) {
+		int const t = s1;
+		s1 = s2;
+		s2 = t;
+	}
+	for (int m = s1; m >= 0; m = cenv->next_member[m]) {
+		for (int i = cenv->adj_begin[m], e = cenv->adj_begin[m + 1]; i < e; ++i) {
+			if (uf_find(cenv->unionfind, cenv->adj[i]) == s2)
+				return true;
+		}
+	}
+	return false;
+}
+
+static int merge_slots(coalesce_env_t *const cenv, int s1, int s2)
+{
+	int const res   = uf_union(cenv->unionfind, s1, s2);
+	int const other = res == s1 ? s2 : s1;
+	cenv->next_member[cenv->last_member[res]] = other;
+	cenv->last_member[res] = cenv->last_member[other];
+	cenv->n_members[res]  += cenv->n_members[other];
 	return res;
 }
 
@@ -252,48 +496,48 @@ static int merge_interferences(be_fec_env_t *env, bitset_t** interferences,
  * A greedy coalescing algorithm for spillslots:
  *  1. Sort the list of affinity edges
  *  2. Try to merge slots with affinity edges (most expensive slots first)
- *  3. Try to merge everything else that is possible
+ *  3. Color the remaining slots greedily, slots with the same color are merged
  */
 static void do_greedy_coalescing(be_fec_env_t *env)
 {
 	spill_t **spills     = env->spills;
-	size_t    spillcount = ARR_LEN(spills);
+	int       spillcount = (int)ARR_LEN(spills);
 	if (spillcount == 0)
 		return;
 
 	DB((dbg, LEVEL_1, "Coalescing %d spillslots\n", spillcount));
 
+	int *const edges   = compute_interferences(env);
+	int  const n_edges = (int)ARR_LEN(edges);
+
 	struct obstack data;
 	obstack_init(&data);
 
-	bitset_t **interferences       = OALLOCN(&data, bitset_t*, spillcount);
-	int       *spillslot_unionfind = OALLOCN(&data, int,       spillcount);
-
-	uf_init(spillslot_unionfind, spillcount);
-
-	for (size_t i = 0; i < spillcount; ++i) {
-		interferences[i] = bitset_obstack_alloc(&data, spillcount);
+	/* build the adjacency arrays */
+	coalesce_env_t cenv;
+	cenv.unionfind   = OALLOCN(&data, int, spillcount);
+	cenv.next_member = OALLOCN(&data, int, spillcount);
+	cenv.last_member = OALLOCN(&data, int, spillcount);
+	cenv.n_members   = OALLOCN(&data, int, spillcount);
+	cenv.adj_begin   = OALLOCNZ(&data, int, spillcount + 1);
+	cenv.adj         = OALLOCN(&data, int, n_edges);
+	uf_init(cenv.unionfind, spillcount);
+	for (int s = 0; s < spillcount; ++s) {
+		cenv.next_member[s] = -1;
+		cenv.last_member[s] = s;
+		cenv.n_members[s]   = 1;
 	}
-
-	/* construct interferences */
-	for (size_t i = 0; i < spillcount; ++i) {
-		ir_node *spill1 = spills[i]->spill;
-		if (is_NoMem(spill1))
-			continue;
-
-		for (size_t i2 = i+1; i2 < spillcount; ++i2) {
-			ir_node *spill2 = spills[i2]->spill;
-			if (is_NoMem(spill2))
-				continue;
-
-			if (be_memory_values_interfere(spill1, spill2)) {
-				DB((dbg, LEVEL_1, "Slot %d and %d interfere\n", i, i2));
-
-				bitset_set(interferences[i], i2);
-				bitset_set(interferences[i2], i);
-			}
-		}
+	for (int i = 0; i < n_edges; ++i)
+		++cenv.adj_begin[edges[i] + 1];
+	for (int s = 0; s < spillcount; ++s)
+		cenv.adj_begin[s + 1] += cenv.adj_begin[s];
+	int *const fill = OALLOCN(&data, int, spillcount);
+	MEMCPY(fill, cenv.adj_begin, spillcount);
+	for (int i = 0; i < n_edges; i += 2) {
+		cenv.adj[fill[edges[i]]++]     = edges[i + 1];
+		cenv.adj[fill[edges[i + 1]]++] = edges[i];
 	}
+	DEL_ARR_F(edges);
 
 	/* sort affinity edges */
 	QSORT_ARR(env->affinity_edges, cmp_affinity);
@@ -301,54 +545,62 @@ static void do_greedy_coalescing(be_fec_env_t *env)
 	/* try to merge affine nodes */
 	for (size_t i = 0, n = ARR_LEN(env->affinity_edges); i < n; ++i) {
 		const affinity_edge_t *edge = env->affinity_edges[i];
-		int s1 = uf_find(spillslot_unionfind, edge->slot1);
-		int s2 = uf_find(spillslot_unionfind, edge->slot2);
+		int s1 = uf_find(cenv.unionfind, edge->slot1);
+		int s2 = uf_find(cenv.unionfind, edge->slot2);
+		if (s1 == s2)
+			continue;
 
 		/* test if values interfere */
-		if (bitset_is_set(interferences[s1], s2)) {
-			assert(bitset_is_set(interferences[s2], s1));
+		if (slots_interfere(&cenv, s1, s2))
 			continue;
-		}
 
 		DB((dbg, LEVEL_1,
 		    "Merging %d and %d because of affinity edge\n", s1, s2));
 
-		merge_interferences(env, interferences, spillslot_unionfind, s1, s2);
+		merge_slots(&cenv, s1, s2);
 	}
 
-	/* Try to merge as much remaining spillslots as possible */
-	for (size_t i = 0; i < spillcount; ++i) {
-		int s1 = uf_find(spillslot_unionfind, i);
-		if (s1 != (int)i)
+	/* Color the remaining slots: each slot takes the first color not used by
+	 * an interfering slot colored before. */
+	int *const color       = OALLOCN(&data, int, spillcount);
+	int *const color_slot  = OALLOCN(&data, int, spillcount);
+	int *const color_taken = OALLOCN(&data, int, spillcount);
+	for (int s = 0; s < spillcount; ++s) {
+		color[s]       = -1;
+		color_taken[s] = -1;
+	}
+	int n_colors = 0;
+	for (int s = 0; s < spillcount; ++s) {
+		if (uf_find(cenv.unionfind, s) != s)
 			continue;
 
-		for (size_t i2 = i+1; i2 < spillcount; ++i2) {
-			int s2 = uf_find(spillslot_unionfind, i2);
-			if (s2 != (int)i2)
-				continue;
-
-			/* Test if values interfere, we have to test n1-n2 and n2-n1,
-			 * because only 1 side gets updated when node merging occurs */
-			if (bitset_is_set(interferences[s1], s2)) {
-				assert(bitset_is_set(interferences[s2], s1));
-				continue;
+		for (int m = s; m >= 0; m = cenv.next_member[m]) {
+			for (int i = cenv.adj_begin[m], e = cenv.adj_begin[m + 1]; i < e; ++i) {
+				int const c = color[uf_find(cenv.unionfind, cenv.adj[i])];
+				if (c >= 0)
+					color_taken[c] = s;
 			}
+		}
 
-			DB((dbg, LEVEL_1,
-			    "Merging %d and %d because it is possible\n", s1, s2));
-
-			if (merge_interferences(env, interferences, spillslot_unionfind,
-			                        s1, s2) != 0) {
-				/* We can break the loop here, because s2 is the new supernode
-				 * now and we'll test s2 again later anyway */
-				break;
-			}
+		int c = 0;
+		while (c < n_colors && color_taken[c] == s)
+			++c;
+		if (c == n_colors) {
+			color_slot[n_colors++] = s;
+			color[s] = c;
+			continue;
 		}
+
+		DB((dbg, LEVEL_1,
+		    "Merging %d and %d because it is possible\n", color_slot[c], s));
+		int const res = merge_slots(&cenv, color_slot[c], s);
+		color_slot[c] = res;
+		color[res]    = c;
 	}
 
 	/* Assign spillslots to spills */
-	for (size_t i = 0; i < spillcount; ++i) {
-		spills[i]->spillslot = uf_find(spillslot_unionfind, i);
+	for (int s = 0; s < spillcount; ++s) {
+		spills[s]->spillslot = uf_find(cenv.unionfind, s);
 	}
 
 	obstack_free(&data, 0);
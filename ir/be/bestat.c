@@ -40,15 +40,15 @@ static void check_reg_pressure_class(pressure_walker_env_t *env,
                                      ir_node *block,
                                      const arch_register_class_t *cls)
 {
-	ir_nodeset_t live_nodes;
-	ir_nodeset_init(&live_nodes);
+	ir_sparse_nodeset live_nodes;
+	ir_sparse_nodeset_init(&live_nodes, env->irg);
 	be_liveness_end_of_block(env->lv, cls, block, &live_nodes);
-	unsigned max_live = ir_nodeset_size(&live_nodes);
+	unsigned max_live = ir_sparse_nodeset_size(&live_nodes);
 	env->regpressure += max_live;
 
 	sched_foreach_non_phi_reverse(block, irn) {
 		be_liveness_transfer(cls, irn, &live_nodes);
-		size_t const cnt = ir_nodeset_size(&live_nodes);
+		size_t const cnt = ir_sparse_nodeset_size(&live_nodes);
 		max_live = MAX(max_live, cnt);
 		env->regpressure += cnt;
 		env->insn_count++;
@@ -57,7 +57,7 @@ static void check_reg_pressure_class(pressure_walker_env_t *env,
 	if (max_live > env->max_pressure)
 		env->max_pressure = max_live;
 
-	ir_nodeset_destroy(&live_nodes);
+	ir_sparse_nodeset_destroy(&live_nodes);
 }
 
 static void stat_reg_pressure_block(ir_node *block, void *data)
@@ -320,6 +320,7 @@ static void transform_nodes(ir_graph *irg, arch_pretrans_nodes *pre_transform)
 void be_transform_graph(ir_graph *irg, arch_pretrans_nodes *func)
 {
 	/* create a new obstack */
+	irg_clear_free_nodes(irg);
 	struct obstack old_obst = irg->obst;
 	obstack_init(&irg->obst);
 	irg->last_node_idx = 0;
@@ -334,7 +335,8 @@ void be_transform_graph(ir_graph *irg, arch_pretrans_nodes *func)
 	transform_nodes(irg, func);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 
-	/* free the old obstack */
+	/* free the old obstack, buffered hook events may refer to its nodes */
+	hook_flush_batches();
 	obstack_free(&old_obst, 0);
 
 	/* most analysis info is wrong after transformation */
@@ -8,13 +8,21 @@
  * @brief       Methods to compute when a value will be used again.
  * @author      Sebastian Hack, Matthias Braun
  * @date        27.06.2005
+ *
+ * The distances from the start of every block to the next uses of its
+ * live-in values of one register class are computed once by a backward
+ * dataflow analysis in be_begin_uses(). Queries then only scan the uses
+ * inside the current block and look up the precomputed distances of the
+ * successor blocks.
  */
 #include "beuses.h"
 
 #include "be_t.h"
+#include "bearch.h"
 #include "belive.h"
 #include "benode.h"
 #include "besched.h"
+#include "beutil.h"
 #include "debug.h"
 #include "ircons_t.h"
 #include "irdom_t.h"
@@ -22,89 +30,43 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irnodemap.h"
 #include "obst.h"
-#include "pmap.h"
 #include "util.h"
 #include <limits.h>
 #include <stdlib.h>
 
-#define UNKNOWN_OUTERMOST_LOOP  ((unsigned)-1)
-
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
 typedef struct be_use_t {
-	const ir_node *block;
-	const ir_node *node;
-	unsigned       outermost_loop;
-	unsigned       next_use;
-	ir_visited_t   visited;
+	unsigned next_use;       /**< distance from the block start */
+	unsigned outermost_loop;
 } be_use_t;
 
 /**
- * The "uses" environment.
- */
-struct be_uses_t {
-	set           *uses; /**< cache: contains all computed uses so far. */
-	const be_lv_t *lv;   /**< the liveness for the graph. */
-	ir_visited_t   visited_counter; /**< current search counter. */
-};
-
-/**
- * Set-compare two uses.
+ * Next use information for the live-in values of a block.
  */
-static int cmp_use(const void *a, const void *b, size_t n)
-{
-	(void)n;
-	const be_use_t *p = (const be_use_t*)a;
-	const be_use_t *q = (const be_use_t*)b;
-	return p->block != q->block || p->node != q->node;
-}
-
-static be_next_use_t get_next_use(be_uses_t *env, ir_node *from,
-                                  const ir_node *def, bool skip_from_uses);
+typedef struct uses_block_t {
+	const ir_node  *block;
+	unsigned        n_steps;   /**< number of schedule steps in the block */
+	unsigned        loopdepth; /**< loop depth of the block */
+	unsigned        n_live_in; /**< number of live-in values */
+	const ir_node **live_in;   /**< live-in values sorted by address */
+	be_use_t       *uses;      /**< next use of each live-in value */
+	bool           *through;   /**< value is not used in the block itself */
+	bool            dirty;     /**< a successor changed since the last update */
+} uses_block_t;
 
 /**
- * Return the use for the given definition in the given block if exists,
- * else create it.
- *
- * @param env    the uses environment
- * @param block  the block we search the use in
- * @param def    the definition of the value we are searching
+ * The "uses" environment.
  */
-static const be_use_t *get_or_set_use_block(be_uses_t *env,
-                                            const ir_node *block,
-                                            const ir_node *def)
-{
-	be_use_t temp;
-	temp.block = block;
-	temp.node  = def;
-
-	unsigned  hash   = hash_combine(hash_irn(block), hash_irn(def));
-	be_use_t *result = set_find(be_use_t, env->uses, &temp, sizeof(temp), hash);
-
-	if (result == NULL) {
-		// insert templ first as we might end in a loop in the get_next_use
-		// call otherwise
-		temp.next_use       = USES_INFINITY;
-		temp.outermost_loop = UNKNOWN_OUTERMOST_LOOP;
-		temp.visited        = 0;
-		result = set_insert(be_use_t, env->uses, &temp, sizeof(temp), hash);
-	}
-
-	if (result->outermost_loop == UNKNOWN_OUTERMOST_LOOP
-	 && result->visited < env->visited_counter) {
-		result->visited = env->visited_counter;
-		be_next_use_t next_use = get_next_use(env, sched_first(block), def, 0);
-		if (next_use.outermost_loop != UNKNOWN_OUTERMOST_LOOP) {
-			result->next_use       = next_use.time;
-			result->outermost_loop = next_use.outermost_loop;
-			DBG((dbg, LEVEL_5, "Setting nextuse of %+F in block %+F to %u (outermostloop %d)\n",
-				def, block, result->next_use, result->outermost_loop));
-		}
-	}
-
-	return result;
-}
+struct be_uses_t {
+	struct obstack               obst;
+	ir_nodemap                   blocks;   /**< maps blocks to uses_block_t */
+	const ir_node              **live_in;  /**< scratch array */
+	const be_lv_t               *lv;       /**< the liveness for the graph. */
+	const arch_register_class_t *cls;      /**< the register class to handle */
+};
 
 /**
  * Check if a value of the given definition is used in the given block
@@ -158,16 +120,83 @@ static inline void set_step(ir_node *node, unsigned step)
 	set_irn_link(node, INT_TO_PTR(step));
 }
 
+static uses_block_t *get_uses_block(const be_uses_t *env, const ir_node *block)
+{
+	return ir_nodemap_get(uses_block_t, &env->blocks, block);
+}
+
 /**
- * Find the next use of a value defined by def, starting at node from.
- *
- * @param env             the uses environment
- * @param from            the node at which we should start the search
- * @param def             the definition of the value
- * @param skip_from_uses  if non-zero, ignore from uses
+ * Return the index of @p def in the live-in values of @p info or -1 if the
+ * value is not live-in.
+ */
+static int find_live_in(const uses_block_t *info, const ir_node *def)
+{
+	unsigned lo = 0;
+	unsigned hi = info->n_live_in;
+	while (lo < hi) {
+		unsigned       const mid      = lo + (hi - lo) / 2;
+		const ir_node *const mid_node = info->live_in[mid];
+		if (mid_node == def)
+			return (int)mid;
+		if (mid_node < def)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return -1;
+}
+
+/**
+ * Return the precomputed next use of @p def at the start of @p block or NULL
+ * if the value is not live-in there.
+ */
+static const be_use_t *get_use_block(const be_uses_t *env,
+                                     const ir_node *block, const ir_node *def)
+{
+	const uses_block_t *info = get_uses_block(env, block);
+	if (info == NULL)
+		return NULL;
+	int const pos = find_live_in(info, def);
+	return pos < 0 ? NULL : &info->uses[pos];
+}
+
+/**
+ * Compute the next use of @p def after the end of @p block from the
+ * distances at the start of the successor blocks.
  */
-static be_next_use_t get_next_use(be_uses_t *const env, ir_node *const from,
-                                  const ir_node *def, bool skip_from_uses)
+static be_use_t get_next_use_succs(const be_uses_t *env, const ir_node *block,
+                                   unsigned loopdepth, const ir_node *def)
+{
+	unsigned outermost_loop = loopdepth;
+	unsigned next_use       = USES_INFINITY;
+	foreach_block_succ(block, edge) {
+		const ir_node  *succ_block = get_edge_src_irn(edge);
+		const be_use_t *use        = get_use_block(env, succ_block, def);
+		if (use == NULL || USES_IS_INFINITE(use->next_use))
+			continue;
+
+		unsigned use_dist = use->next_use;
+		unsigned succ_depth = get_uses_block(env, succ_block)->loopdepth;
+		if (succ_depth < loopdepth) {
+			// TODO we should use the number of nodes in the loop or so...
+			use_dist += (loopdepth - succ_depth) * 5000;
+		}
+
+		if (use_dist < next_use) {
+			next_use       = use_dist;
+			outermost_loop = use->outermost_loop;
+		}
+	}
+
+	if (loopdepth < outermost_loop)
+		outermost_loop = loopdepth;
+
+	be_use_t result = { next_use, outermost_loop };
+	return result;
+}
+
+be_next_use_t be_get_next_use(be_uses_t *env, ir_node *from,
+                              const ir_node *def, bool skip_from_uses)
 {
 	ir_node *next_use_node = NULL;
 	unsigned next_use_step = INT_MAX;
@@ -191,16 +220,17 @@ static be_next_use_t get_next_use(be_uses_t *const env, ir_node *const from,
 		}
 	}
 
+	const uses_block_t *info      = get_uses_block(env, block);
+	unsigned     const  loopdepth = info->loopdepth;
 	if (next_use_node != NULL) {
 		be_next_use_t result;
 		result.time           = next_use_step - timestep;
-		result.outermost_loop = get_loop_depth(get_irn_loop(block));
+		result.outermost_loop = loopdepth;
 		result.before         = next_use_node;
 		return result;
 	}
 
-	ir_node *node = sched_last(block);
-	unsigned step = get_step(node) + 1 - timestep;
+	unsigned step = info->n_steps - timestep;
 
 	if (be_is_phi_argument(block, def)) {
 		// TODO we really should continue searching the uses of the phi,
@@ -209,93 +239,33 @@ static be_next_use_t get_next_use(be_uses_t *const env, ir_node *const from,
 
 		be_next_use_t result;
 		result.time           = step;
-		result.outermost_loop = get_loop_depth(get_irn_loop(block));
+		result.outermost_loop = loopdepth;
 		result.before         = block;
 		return result;
 	}
 
-	be_next_use_t result;
-	result.before = NULL;
-	ir_loop  *loop           = get_irn_loop(block);
-	unsigned  loopdepth      = get_loop_depth(loop);
-	bool      found_visited  = false;
-	bool      found_use      = false;
-	unsigned  outermost_loop = loopdepth;
-	unsigned  next_use       = USES_INFINITY;
-	foreach_block_succ(block, edge) {
-		const ir_node *succ_block = get_edge_src_irn(edge);
-		DBG((dbg, LEVEL_5, "Checking succ of block %+F: %+F (for use of %+F)\n",
-		     block, succ_block, def));
-		if (!be_is_live_in(env->lv, succ_block, def)) {
-			//next_use = USES_INFINITY;
-			DBG((dbg, LEVEL_5, "   not live in\n"));
-			continue;
-		}
-
-		const be_use_t *use = get_or_set_use_block(env, succ_block, def);
-		DBG((dbg, LEVEL_5, "Found %u (loopdepth %u) (we're in block %+F)\n",
-		     use->next_use, use->outermost_loop, block));
-		if (USES_IS_INFINITE(use->next_use)) {
-			if (use->outermost_loop == UNKNOWN_OUTERMOST_LOOP) {
-				found_visited = true;
-			}
-			continue;
-		}
-
-		found_use = true;
-		unsigned use_dist = use->next_use;
-
-		ir_loop *succ_loop = get_irn_loop(succ_block);
-		if (get_loop_depth(succ_loop) < loopdepth) {
-			unsigned factor = (loopdepth - get_loop_depth(succ_loop)) * 5000;
-			DBG((dbg, LEVEL_5,
-			     "Increase usestep because of loop out edge %d -> %d (%u)\n",
-			     factor));
-			// TODO we should use the number of nodes in the loop or so...
-			use_dist += factor;
-		}
-
-		if (use_dist < next_use) {
-			next_use       = use_dist;
-			outermost_loop = use->outermost_loop;
-			result.before  = use->node;
-		}
-	}
-
-	if (loopdepth < outermost_loop)
-		outermost_loop = loopdepth;
-
-	result.time           = next_use + step;
-	result.outermost_loop = outermost_loop;
+	be_use_t const use = get_next_use_succs(env, block, loopdepth, def);
 
-	if (!found_use && found_visited) {
-		// the current result is correct for the current search, but isn't
-		// generally correct, so mark it
-		result.outermost_loop = UNKNOWN_OUTERMOST_LOOP;
-	}
-	DBG((dbg, LEVEL_5, "Result: %d (outerloop: %u)\n", result.time,
-	     result.outermost_loop));
+	be_next_use_t result;
+	result.time           = use.next_use + step;
+	result.outermost_loop = use.outermost_loop;
+	result.before         = USES_IS_INFINITE(use.next_use) ? NULL : def;
+	DBG((dbg, LEVEL_5, "Next use of %+F after %+F: %u (outerloop: %u)\n", def,
+	     from, result.time, result.outermost_loop));
 	return result;
 }
 
-be_next_use_t be_get_next_use(be_uses_t *env, ir_node *from,
-                              const ir_node *def, bool skip_from_uses)
-{
-	++env->visited_counter;
-	return get_next_use(env, from, def, skip_from_uses);
-}
-
 /**
- * Pre-block walker, set the step number for every scheduled node
- * in increasing order.
+ * Block walker: set the step number for every scheduled node in increasing
+ * order and collect the uses of the live-in values inside the block.
  *
  * After this, two scheduled nodes can be easily compared for the
  * "scheduled earlier in block" property.
  */
-static void set_sched_step_walker(ir_node *block, void *data)
+static void init_block_walker(ir_node *block, void *data)
 {
-	(void)data;
-	unsigned step = 0;
+	be_uses_t *env  = (be_uses_t*)data;
+	unsigned   step = 0;
 
 	sched_foreach(block, node) {
 		set_step(node, step);
@@ -303,26 +273,194 @@ static void set_sched_step_walker(ir_node *block, void *data)
 			continue;
 		++step;
 	}
+
+	uses_block_t *info = OALLOCZ(&env->obst, uses_block_t);
+	info->block     = block;
+	info->n_steps   = step;
+	info->loopdepth = get_loop_depth(get_irn_loop(block));
+	ir_nodemap_insert(&env->blocks, block, info);
+
+	const ir_node **live_in = env->live_in;
+	ARR_SHRINKLEN(live_in, 0);
+	be_lv_foreach(env->lv, block, be_lv_state_in, node) {
+		if (arch_get_irn_register_req(node)->cls == env->cls)
+			ARR_APP1(const ir_node*, live_in, node);
+	}
+	unsigned const n_live_in = ARR_LEN(live_in);
+	info->n_live_in = n_live_in;
+	info->live_in   = OALLOCN(&env->obst, const ir_node*, n_live_in);
+	info->uses      = OALLOCN(&env->obst, be_use_t, n_live_in);
+	info->through   = OALLOCN(&env->obst, bool, n_live_in);
+	for (unsigned i = 0; i < n_live_in; ++i) {
+		/* the liveness iterates over its values by decreasing address */
+		info->live_in[i] = live_in[n_live_in - i - 1];
+		assert(i == 0 || info->live_in[i - 1] < info->live_in[i]);
+		info->uses[i].next_use       = USES_INFINITY;
+		info->uses[i].outermost_loop = info->loopdepth;
+		info->through[i]             = true;
+	}
+	env->live_in = live_in;
+	if (n_live_in == 0)
+		return;
+
+	/* the first use inside the block determines the distance */
+	sched_foreach_non_phi(block, node) {
+		foreach_irn_in(node, i, op) {
+			int const pos = find_live_in(info, op);
+			if (pos < 0 || !info->through[pos])
+				continue;
+			info->uses[pos].next_use = get_step(node);
+			info->through[pos]       = false;
+		}
+	}
+
+	/* Phi arguments are used at the end of the block, see
+	 * be_is_phi_argument() */
+	if (get_irn_n_edges_kind(block, EDGE_KIND_BLOCK) > 0) {
+		const ir_edge_t *edge = get_irn_out_edge_first_kind(block, EDGE_KIND_BLOCK);
+		ir_node   *const succ_block = get_edge_src_irn(edge);
+		int        const pos        = get_edge_src_pos(edge);
+		if (get_Block_n_cfgpreds(succ_block) > 1) {
+			sched_foreach_phi(succ_block, phi) {
+				int const arg = find_live_in(info, get_irn_n(phi, pos));
+				if (arg < 0 || !info->through[arg])
+					continue;
+				info->uses[arg].next_use = info->n_steps;
+				info->through[arg]       = false;
+			}
+		}
+	}
+	info->dirty = true;
 }
 
-be_uses_t *be_begin_uses(ir_graph *irg, const be_lv_t *lv)
+/**
+ * Recompute the next uses of the values live through a block from the
+ * distances at the start of its successors.
+ *
+ * @param best  scratch array with room for the live-in values of the block
+ * @return true if a distance changed
+ */
+static bool update_block_uses(const be_uses_t *env, uses_block_t *info,
+                              be_use_t *best)
+{
+	unsigned const n_live_in = info->n_live_in;
+	unsigned const loopdepth = info->loopdepth;
+	for (unsigned i = 0; i < n_live_in; ++i) {
+		best[i].next_use       = USES_INFINITY;
+		best[i].outermost_loop = loopdepth;
+	}
+
+	foreach_block_succ(info->block, edge) {
+		const ir_node      *succ_block = get_edge_src_irn(edge);
+		const uses_block_t *succ_info  = get_uses_block(env, succ_block);
+		if (succ_info == NULL)
+			continue;
+		unsigned const penalty = succ_info->loopdepth < loopdepth
+			? (loopdepth - succ_info->loopdepth) * 5000 : 0;
+
+		/* both live-in arrays are sorted by address */
+		unsigned const n_succ = succ_info->n_live_in;
+		for (unsigned i = 0, j = 0; i < n_live_in && j < n_succ;) {
+			const ir_node *const node      = info->live_in[i];
+			const ir_node *const succ_node = succ_info->live_in[j];
+			if (node < succ_node) {
+				++i;
+			} else if (node > succ_node) {
+				++j;
+			} else {
+				const be_use_t *use = &succ_info->uses[j];
+				if (info->through[i] && !USES_IS_INFINITE(use->next_use)
+				 && use->next_use + penalty < best[i].next_use) {
+					best[i].next_use       = use->next_use + penalty;
+					best[i].outermost_loop = use->outermost_loop;
+				}
+				++i;
+				++j;
+			}
+		}
+	}
+
+	bool changed = false;
+	for (unsigned i = 0; i < n_live_in; ++i) {
+		if (!info->through[i])
+			continue;
+		be_use_t use = best[i];
+		if (loopdepth < use.outermost_loop)
+			use.outermost_loop = loopdepth;
+		use.next_use = USES_IS_INFINITE(use.next_use) ? USES_INFINITY
+		             : use.next_use + info->n_steps;
+		be_use_t *const old = &info->uses[i];
+		if (use.next_use != old->next_use
+		 || use.outermost_loop != old->outermost_loop) {
+			*old    = use;
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+/**
+ * Propagate the next uses of the values live through blocks backwards over
+ * the control flow graph until a fixpoint is reached.
+ */
+static void compute_global_uses(be_uses_t *env, ir_graph *irg)
+{
+	/* successors come before their predecessors in postorder, so only loops
+	 * need further iterations */
+	ir_node **const blocks   = be_get_cfgpostorder(irg);
+	size_t    const n_blocks = ARR_LEN(blocks);
+	be_use_t       *best     = NEW_ARR_F(be_use_t, 0);
+	bool changed;
+	do {
+		changed = false;
+		for (size_t b = 0; b < n_blocks; ++b) {
+			ir_node      *block = blocks[b];
+			uses_block_t *info  = get_uses_block(env, block);
+			if (!info->dirty)
+				continue;
+			info->dirty = false;
+
+			ARR_RESIZE(be_use_t, best, info->n_live_in);
+			if (!update_block_uses(env, info, best))
+				continue;
+
+			changed = true;
+			for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+				ir_node      *pred_block = get_Block_cfgpred_block(block, i);
+				uses_block_t *pred_info  = get_uses_block(env, pred_block);
+				if (pred_info != NULL)
+					pred_info->dirty = true;
+			}
+		}
+	} while (changed);
+	DEL_ARR_F(best);
+	DEL_ARR_F(blocks);
+}
+
+be_uses_t *be_begin_uses(ir_graph *irg, const be_lv_t *lv,
+                         const arch_register_class_t *cls)
 {
 	FIRM_DBG_REGISTER(dbg, "firm.be.uses");
 
 	assure_edges(irg);
 
-	/* precalculate sched steps */
-	irg_block_walk_graph(irg, set_sched_step_walker, NULL, NULL);
-
 	be_uses_t *env = XMALLOCZ(be_uses_t);
-	env->uses = new_set(cmp_use, 512);
-	env->lv   = lv;
+	obstack_init(&env->obst);
+	ir_nodemap_init(&env->blocks, irg);
+	env->live_in = NEW_ARR_F(const ir_node*, 0);
+	env->lv      = lv;
+	env->cls     = cls;
+
+	irg_block_walk_graph(irg, init_block_walker, NULL, env);
+	compute_global_uses(env, irg);
+	DEL_ARR_F(env->live_in);
 
 	return env;
 }
 
 void be_end_uses(be_uses_t *env)
 {
-	del_set(env->uses);
+	ir_nodemap_destroy(&env->blocks);
+	obstack_free(&env->obst, NULL);
 	free(env);
 }
@@ -47,10 +47,14 @@ be_next_use_t be_get_next_use(be_uses_t *uses, ir_node *from,
 /**
  * Creates a new uses environment for a graph.
  *
+ * Only the values of register class @p cls may be queried.
+ *
  * @param irg  the graph
  * @param lv   liveness information for the graph
+ * @param cls  the register class of the queried values
  */
-be_uses_t *be_begin_uses(ir_graph *irg, const be_lv_t *lv);
+be_uses_t *be_begin_uses(ir_graph *irg, const be_lv_t *lv,
+                         const arch_register_class_t *cls);
 
 /**
  * Destroys the given uses environment.
@@ -21,7 +21,7 @@
 #include "irgmod.h"
 #include "irgopt.h"
 #include "irgwalk.h"
-#include "irnodeset.h"
+#include "irnodemap.h"
 #include "iropt.h"
 #include "irtools.h"
 #include "util.h"
@@ -64,23 +64,23 @@ static int cmp_node_nr(const void *a, const void *b)
 ir_node *insert_Perm_before(ir_graph *irg, const arch_register_class_t *cls,
                             ir_node *const pos)
 {
-	ir_nodeset_t live;
-	ir_nodeset_init(&live);
+	ir_sparse_nodeset live;
+	ir_sparse_nodeset_init(&live, irg);
 	be_lv_t *lv = be_get_irg_liveness(irg);
 	be_liveness_nodes_live_before(lv, cls, pos, &live);
 
-	size_t n = ir_nodeset_size(&live);
+	size_t n = ir_sparse_nodeset_size(&live);
 	if (n == 0) {
-		ir_nodeset_destroy(&live);
+		ir_sparse_nodeset_destroy(&live);
 		return NULL;
 	}
 
 	ir_node **nodes = XMALLOCN(ir_node*, n);
 	size_t    p     = 0;
-	foreach_ir_nodeset(&live, irn, iter) {
+	foreach_ir_sparse_nodeset(&live, irn) {
 		nodes[p++] = irn;
 	}
-	ir_nodeset_destroy(&live);
+	ir_sparse_nodeset_destroy(&live);
 	/* make the input order deterministic */
 	QSORT(nodes, n, cmp_node_nr);
 
@@ -38,10 +38,10 @@ typedef struct be_verify_register_pressure_env_t_ {
 /**
  * Print all nodes of a pset into a file.
  */
-static void print_living_values(FILE *F, const ir_nodeset_t *live_nodes)
+static void print_living_values(FILE *F, const ir_sparse_nodeset *live_nodes)
 {
 	ir_fprintf(F, "\t");
-	foreach_ir_nodeset(live_nodes, node, iter) {
+	foreach_ir_sparse_nodeset(live_nodes, node) {
 		ir_fprintf(F, "%+F ", node);
 	}
 	ir_fprintf(F, "\n");
@@ -69,14 +69,14 @@ static void verify_warnf(ir_node const *const node, char const *const fmt, ...)
 static void verify_liveness_walker(ir_node *block, void *data)
 {
 	be_verify_register_pressure_env_t *env = (be_verify_register_pressure_env_t *)data;
-	ir_nodeset_t live_nodes;
+	ir_sparse_nodeset live_nodes;
 
 	/* collect register pressure info, start with end of a block */
-	ir_nodeset_init(&live_nodes);
+	ir_sparse_nodeset_init(&live_nodes, get_irn_irg(block));
 	be_liveness_end_of_block(env->lv, env->cls, block,
 	                         &live_nodes);
 
-	unsigned pressure = ir_nodeset_size(&live_nodes);
+	unsigned pressure = ir_sparse_nodeset_size(&live_nodes);
 	if (pressure > env->registers_available) {
 		verify_warnf(block, "register pressure too high at end of block (%d/%d):",
 			pressure, env->registers_available);
@@ -88,7 +88,7 @@ static void verify_liveness_walker(ir_node *block, void *data)
 		// print_living_values(stderr, &live_nodes);
 		be_liveness_transfer(env->cls, irn, &live_nodes);
 
-		pressure = ir_nodeset_size(&live_nodes);
+		pressure = ir_sparse_nodeset_size(&live_nodes);
 
 		if (pressure > env->registers_available) {
 			verify_warnf(block, "register pressure too high before %+F (%d/%d):",
@@ -97,7 +97,7 @@ static void verify_liveness_walker(ir_node *block, void *data)
 			env->problem_found = true;
 		}
 	}
-	ir_nodeset_destroy(&live_nodes);
+	ir_sparse_nodeset_destroy(&live_nodes);
 }
 
 bool be_verify_register_pressure(ir_graph *irg, const arch_register_class_t *cls)
@@ -195,6 +195,7 @@ typedef struct insn_const {
 	int      const_shf_cost;           /**< cost of a constant shift instruction */
 	int      cost_mul_start;           /**< starting cost of a multiply instruction */
 	int      cost_mul_bit;             /**< cost of multiply for every set bit */
+	int      div_cost;                 /**< cost of a division instruction */
 	unsigned function_alignment;       /**< logarithm for alignment of function labels */
 	unsigned label_alignment;          /**< logarithm for alignment of loops labels */
 	unsigned label_alignment_max_skip; /**< maximum skip for alignment of loops labels */
@@ -207,6 +208,7 @@ static const insn_const size_cost = {
 	3,   /* cost of a constant shift instruction */
 	4,   /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	4,   /* cost of a division instruction */
 	0,   /* logarithm for alignment of function labels */
 	0,   /* logarithm for alignment of loops labels */
 	0,   /* maximum skip for alignment of loops labels */
@@ -219,6 +221,7 @@ static const insn_const i386_cost = {
 	3,   /* cost of a constant shift instruction */
 	9,   /* starting cost of a multiply instruction */
 	1,   /* cost of multiply for every set bit */
+	38,  /* cost of a division instruction */
 	2,   /* logarithm for alignment of function labels */
 	2,   /* logarithm for alignment of loops labels */
 	3,   /* maximum skip for alignment of loops labels */
@@ -231,6 +234,7 @@ static const insn_const i486_cost = {
 	2,   /* cost of a constant shift instruction */
 	12,  /* starting cost of a multiply instruction */
 	1,   /* cost of multiply for every set bit */
+	40,  /* cost of a division instruction */
 	4,   /* logarithm for alignment of function labels */
 	4,   /* logarithm for alignment of loops labels */
 	15,  /* maximum skip for alignment of loops labels */
@@ -243,6 +247,7 @@ static const insn_const pentium_cost = {
 	1,   /* cost of a constant shift instruction */
 	11,  /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	46,  /* cost of a division instruction */
 	4,   /* logarithm for alignment of function labels */
 	4,   /* logarithm for alignment of loops labels */
 	7,   /* maximum skip for alignment of loops labels */
@@ -255,6 +260,7 @@ static const insn_const pentiumpro_cost = {
 	1,   /* cost of a constant shift instruction */
 	4,   /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	39,  /* cost of a division instruction */
 	4,   /* logarithm for alignment of function labels */
 	4,   /* logarithm for alignment of loops labels */
 	10,  /* maximum skip for alignment of loops labels */
@@ -267,6 +273,7 @@ static const insn_const k6_cost = {
 	1,   /* cost of a constant shift instruction */
 	3,   /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	18,  /* cost of a division instruction */
 	5,   /* logarithm for alignment of function labels */
 	5,   /* logarithm for alignment of loops labels */
 	7,   /* maximum skip for alignment of loops labels */
@@ -279,6 +286,7 @@ static const insn_const geode_cost = {
 	1,   /* cost of a constant shift instruction */
 	7,   /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	40,  /* cost of a division instruction */
 	0,   /* logarithm for alignment of function labels */
 	0,   /* logarithm for alignment of loops labels */
 	0,   /* maximum skip for alignment of loops labels */
@@ -291,6 +299,7 @@ static const insn_const athlon_cost = {
 	1,   /* cost of a constant shift instruction */
 	5,   /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	40,  /* cost of a division instruction */
 	4,   /* logarithm for alignment of function labels */
 	4,   /* logarithm for alignment of loops labels */
 	7,   /* maximum skip for alignment of loops labels */
@@ -303,6 +312,7 @@ static const insn_const k8_cost = {
 	1,   /* cost of a constant shift instruction */
 	3,   /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	40,  /* cost of a division instruction */
 	4,   /* logarithm for alignment of function labels */
 	4,   /* logarithm for alignment of loops labels */
 	7,   /* maximum skip for alignment of loops labels */
@@ -315,6 +325,7 @@ static const insn_const k10_cost = {
 	1,   /* cost of a constant shift instruction */
 	3,   /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	26,  /* cost of a division instruction */
 	5,   /* logarithm for alignment of function labels */
 	5,   /* logarithm for alignment of loops labels */
 	7,   /* maximum skip for alignment of loops labels */
@@ -327,6 +338,7 @@ static const insn_const netburst_cost = {
 	4,   /* cost of a constant shift instruction */
 	15,  /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	56,  /* cost of a division instruction */
 	4,   /* logarithm for alignment of function labels */
 	4,   /* logarithm for alignment of loops labels */
 	7,   /* maximum skip for alignment of loops labels */
@@ -339,6 +351,7 @@ static const insn_const nocona_cost = {
 	1,   /* cost of a constant shift instruction */
 	10,  /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	40,  /* cost of a division instruction */
 	4,   /* logarithm for alignment of function labels */
 	4,   /* logarithm for alignment of loops labels */
 	7,   /* maximum skip for alignment of loops labels */
@@ -351,6 +364,7 @@ static const insn_const core2_cost = {
 	1,   /* cost of a constant shift instruction */
 	3,   /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	26,  /* cost of a division instruction */
 	4,   /* logarithm for alignment of function labels */
 	4,   /* logarithm for alignment of loops labels */
 	10,  /* maximum skip for alignment of loops labels */
@@ -363,6 +377,7 @@ static const insn_const generic32_cost = {
 	1,   /* cost of a constant shift instruction */
 	4,   /* starting cost of a multiply instruction */
 	0,   /* cost of multiply for every set bit */
+	26,  /* cost of a division instruction */
 	4,   /* logarithm for alignment of function labels */
 	4,   /* logarithm for alignment of loops labels */
 	7,   /* maximum skip for alignment of loops labels */
@@ -408,6 +423,14 @@ int ia32_evaluate_insn(insn_kind kind, const ir_mode *mode, ir_tarval *tv)
 			return cost;
 		/* 64bit mul supported, approx 4times of a 32bit mul*/
 		return 4 * cost;
+	case MULH:
+		/* the one operand mul needs eax and edx */
+		return arch_costs->cost_mul_start + 2 * arch_costs->add_cost;
+	case DIV:
+		if (get_mode_size_bits(mode) <= 32)
+			return arch_costs->div_cost;
+		/* 64bit divisions are library calls */
+		return 4 * arch_costs->div_cost;
 	case LEA:
 		/* lea is only supported for 32 bit */
 		if (get_mode_size_bits(mode) <= 32)
@@ -491,6 +514,12 @@ void ia32_setup_cg_config(void)
 	c->label_alignment          = arch_costs->label_alignment;
 	c->label_alignment_max_skip = arch_costs->label_alignment_max_skip;
 
+	c->issue_width =
+		arch_flags(opt_arch, arch_i386 | arch_i486) || opt_size ? 1 :
+		arch_flags(opt_arch, arch_pentium | arch_k6 | arch_geode | arch_atom_plus) ? 2 :
+		arch_flags(opt_arch, arch_core2_plus) ? 4 :
+		3;
+
 	c->label_alignment_factor =
 		arch_flags(opt_arch, arch_i386 | arch_i486) || opt_size ? 0 :
 		arch_flags(opt_arch, arch_all_amd) ? 3 :
@@ -90,6 +90,8 @@ typedef struct {
 	/** maximum skip alignment for labels (which are expected to be frequent
 	 * jump targets) */
 	unsigned label_alignment_max_skip;
+	/** number of instructions the cpu issues per cycle */
+	unsigned issue_width;
 	/** if a blocks execfreq is factor higher than its predecessor then align
 	 *  the blocks label (0 switches off label alignment) */
 	double label_alignment_factor;
@@ -1331,6 +1331,28 @@ static int ia32_is_mux_allowed(ir_node const *const sel,
 	return ia32_cg_config.use_cmov;
 }
 
+static int ia32_allow_vector_op(ir_op const *const op,
+                                ir_mode const *const mode)
+{
+	ir_mode const *const element = get_mode_vector_element(mode);
+	unsigned       const bits    = get_mode_size_bits(element);
+	if (mode_is_float(element)) {
+		return op == op_VAdd || op == op_VSub || op == op_VMul
+		    || op == op_VSplat;
+	}
+	/* 64bit integers are split into register pairs before we see them */
+	if (bits > 32)
+		return false;
+	/* only 32bit lanes can be broadcast from a general purpose register */
+	if (op == op_VSplat)
+		return bits == 32;
+	/* SSE2 has no 8 or 32bit lane-wise integer multiplication */
+	if (op == op_VMul)
+		return bits == 16;
+	return op == op_VAdd || op == op_VSub || op == op_VAnd || op == op_VOr
+	    || op == op_VEor;
+}
+
 /**
  * Initializes the backend ISA.
  */
@@ -1352,8 +1374,14 @@ static void ia32_init(void)
 	ir_target.fast_unaligned_memaccess = true;
 	ir_target.allow_ifconv             = ia32_is_mux_allowed;
 	ir_target.float_int_overflow       = ir_overflow_indefinite;
+	ir_target.issue_width              = ia32_cg_config.issue_width;
 	ir_platform_set_va_list_type_pointer();
 
+	if (ia32_cg_config.use_sse2) {
+		ir_target.allow_vector_op = ia32_allow_vector_op;
+		ir_target.vector_size     = 16;
+	}
+
 	if (!ia32_cg_config.use_sse2 && !ia32_cg_config.use_softfloat) {
 		ir_type *const type_f80 = x86_init_x87_type();
 		ir_target.mode_float_arithmetic = get_type_mode(type_f80);
@@ -1556,6 +1584,7 @@ static const ir_settings_arch_dep_t ia32_arch_dep = {
 	.allow_mulhu          = true,
 	.also_use_subs        = true,
 	.maximum_shifts       = 4,
+	.max_lea_shift        = 3,
 	.highest_shift_amount = 63,
 	.evaluate             = ia32_evaluate_insn,
 	.max_bits_for_mulh    = 32,
@@ -132,8 +132,12 @@ static const char *get_register_name_size(arch_register_t const *const reg,
 	case X86_SIZE_16: return get_register_name_16bit(reg);
 	case X86_SIZE_32: return reg->name;
 	case X86_SIZE_64:
-	case X86_SIZE_80:
 	case X86_SIZE_128:
+		/* only SSE registers hold double and vector values */
+		if (reg->cls == &ia32_reg_classes[CLASS_ia32_xmm])
+			return reg->name;
+		break;
+	case X86_SIZE_80:
 		break;
 	}
 	panic("Unexpected size");
@@ -902,7 +906,11 @@ static void Copy_emitter(const ir_node *node, const ir_node *op)
 	if (in->cls == &ia32_reg_classes[CLASS_ia32_fp])
 		return;
 
-	ia32_emitf(node, "movl %#R, %#R", in, out);
+	if (in->cls == &ia32_reg_classes[CLASS_ia32_xmm]) {
+		ia32_emitf(node, "movapd %#R, %#R", in, out);
+	} else {
+		ia32_emitf(node, "movl %#R, %#R", in, out);
+	}
 }
 
 static void emit_be_Copy(const ir_node *node)
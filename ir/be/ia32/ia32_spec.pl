@@ -406,6 +406,15 @@ my $xshiftop = {
 	emit      => "{name} %S1, %D0",
 };
 
+my $xvbinop = {
+	irn_flags => [ "rematerializable" ],
+	in_reqs   => [ "xmm", "xmm" ],
+	out_reqs  => [ "in_r0 !in_r1" ],
+	ins       => [ "left", "right" ],
+	fixed     => "x86_insn_size_t const size = X86_SIZE_128;",
+	emit      => "{name} %S1, %D0",
+};
+
 my $xvalueop = {
 	op_flags  => [ "constlike" ],
 	irn_flags => [ "rematerializable" ],
@@ -1479,6 +1488,119 @@ Divs => {
 	mode     => "mode_T"
 },
 
+# packed operations on all lanes of a vector
+Addpd => {
+	template => $xvbinop,
+	latency  => 4,
+},
+
+Addps => {
+	template => $xvbinop,
+	latency  => 4,
+},
+
+Mulpd => {
+	template => $xvbinop,
+	latency  => 4,
+},
+
+Mulps => {
+	template => $xvbinop,
+	latency  => 4,
+},
+
+Subpd => {
+	template => $xvbinop,
+	latency  => 4,
+},
+
+Subps => {
+	template => $xvbinop,
+	latency  => 4,
+},
+
+Paddb => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+Paddw => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+Paddd => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+Paddq => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+Pand => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+Pmullw => {
+	template => $xvbinop,
+	latency  => 5,
+},
+
+Por => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+Psubb => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+Psubw => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+Psubd => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+Psubq => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+Pxor => {
+	template => $xvbinop,
+	latency  => 1,
+},
+
+# broadcast the lowest 32bit lane
+Pshufd_0 => {
+	irn_flags => [ "rematerializable" ],
+	in_reqs   => [ "xmm" ],
+	out_reqs  => [ "xmm" ],
+	ins       => [ "val" ],
+	fixed     => "x86_insn_size_t const size = X86_SIZE_128;",
+	emit      => 'pshufd $0x00, %S0, %D0',
+	latency   => 1,
+},
+
+# broadcast the lowest 64bit lane
+Pshufd_44 => {
+	irn_flags => [ "rematerializable" ],
+	in_reqs   => [ "xmm" ],
+	out_reqs  => [ "xmm" ],
+	ins       => [ "val" ],
+	fixed     => "x86_insn_size_t const size = X86_SIZE_128;",
+	emit      => 'pshufd $0x44, %S0, %D0',
+	latency   => 1,
+},
+
 Ucomis => {
 	irn_flags => [ "modify_flags", "rematerializable" ],
 	state     => "exc_pinned",
@@ -1878,10 +2000,10 @@ femms => {
 
 xxLoad => {
 	template => $loadop,
-	out_reqs  => [ "xmm", "mem", "exec", "exec" ],
+	out_reqs  => [ "xmm", "none", "mem", "exec", "exec" ],
 	attr      => "x86_insn_size_t size",
-	emit      => "movdqu %D0, %AM",
-	outs      => [ "res", "M", "X_regular", "X_except" ],
+	emit      => "movdqu %AM, %D0",
+	outs      => [ "res", "unused", "M", "X_regular", "X_except" ],
 	latency   => 1,
 },
 
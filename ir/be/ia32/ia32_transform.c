@@ -132,6 +132,9 @@ typedef ir_node *construct_binop_float_func(dbg_info *db, ir_node *block,
 typedef ir_node *construct_unop_func(dbg_info *db, ir_node *block, ir_node *op,
                                      x86_insn_size_t size);
 
+typedef ir_node *construct_vector_binop_func(dbg_info *db, ir_node *block,
+        ir_node *op1, ir_node *op2);
+
 static ir_node *create_immediate_or_transform(ir_node *node, char immediate_mode);
 
 static ir_node *create_I2I_Conv(ir_mode *src_mode, dbg_info *dbgi, ir_node *block, ir_node *op);
@@ -2192,7 +2195,9 @@ static ir_node *gen_Load(ir_node *node)
 
 	x86_insn_size_t const size = x86_size_from_mode(mode);
 	ir_node *new_node;
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		new_node = new_bd_ia32_xxLoad(dbgi, block, base, idx, new_mem, size);
+	} else if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2) {
 			new_node = new_bd_ia32_xLoad(dbgi, block, base, idx, new_mem, size);
 		} else {
@@ -2220,7 +2225,8 @@ static ir_node *gen_Load(ir_node *node)
 	set_address(new_node, &addr);
 
 	if (!get_irn_pinned(node)) {
-		assert((int)pn_ia32_xLoad_res == (int)pn_ia32_fld_res
+		assert((int)pn_ia32_xxLoad_res == (int)pn_ia32_xLoad_res
+		       && (int)pn_ia32_xLoad_res == (int)pn_ia32_fld_res
 		       && (int)pn_ia32_fld_res == (int)pn_ia32_Load_res
 		       && (int)pn_ia32_Load_res == (int)pn_ia32_res);
 		arch_add_irn_flags(new_node, arch_irn_flag_rematerializable);
@@ -2688,7 +2694,11 @@ static ir_node *create_store(dbg_info *dbgi, ir_node *new_block,
 	ir_mode        *const mode = get_irn_mode(value);
 	x86_insn_size_t const size = x86_size_from_mode(mode);
 	ir_node *store;
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		ir_node *new_val = be_transform_node(value);
+		store = new_bd_ia32_xxStore(dbgi, new_block, addr->base, addr->index,
+		                            addr->mem, new_val, size);
+	} else if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2) {
 			ir_node *new_val = be_transform_node(value);
 			store = new_bd_ia32_xStore(dbgi, new_block, addr->base, addr->index,
@@ -2768,6 +2778,110 @@ static ir_node *gen_Store(ir_node *node)
 	return store;
 }
 
+/**
+ * Transforms a vector operation into the packed SSE instruction for its
+ * element mode. @p int_cons is indexed by log2 of the element size in bytes
+ * and contains NULL for unsupported sizes.
+ */
+static ir_node *gen_vector_binop(ir_node *const node,
+                                 construct_vector_binop_func *const int_cons[4],
+                                 construct_vector_binop_func *const float_cons,
+                                 construct_vector_binop_func *const double_cons)
+{
+	ir_mode *const element = get_mode_vector_element(get_irn_mode(node));
+	construct_vector_binop_func *cons;
+	if (mode_is_float(element)) {
+		cons = get_mode_size_bits(element) == 32 ? float_cons : double_cons;
+	} else {
+		cons = int_cons[log2_floor(get_mode_size_bytes(element))];
+	}
+	if (cons == NULL)
+		panic("unsupported vector operation %+F", node);
+
+	/* packed memory operands must be aligned, so no address mode matching */
+	dbg_info *const dbgi    = get_irn_dbg_info(node);
+	ir_node  *const block   = be_transform_nodes_block(node);
+	ir_node  *const new_op1 = be_transform_node(get_binop_left(node));
+	ir_node  *const new_op2 = be_transform_node(get_binop_right(node));
+	return cons(dbgi, block, new_op1, new_op2);
+}
+
+static ir_node *gen_VAdd(ir_node *const node)
+{
+	static construct_vector_binop_func *const int_cons[] = {
+		new_bd_ia32_Paddb, new_bd_ia32_Paddw,
+		new_bd_ia32_Paddd, new_bd_ia32_Paddq,
+	};
+	return gen_vector_binop(node, int_cons, new_bd_ia32_Addps,
+	                        new_bd_ia32_Addpd);
+}
+
+static ir_node *gen_VAnd(ir_node *const node)
+{
+	static construct_vector_binop_func *const int_cons[] = {
+		new_bd_ia32_Pand, new_bd_ia32_Pand,
+		new_bd_ia32_Pand, new_bd_ia32_Pand,
+	};
+	return gen_vector_binop(node, int_cons, NULL, NULL);
+}
+
+static ir_node *gen_VEor(ir_node *const node)
+{
+	static construct_vector_binop_func *const int_cons[] = {
+		new_bd_ia32_Pxor, new_bd_ia32_Pxor,
+		new_bd_ia32_Pxor, new_bd_ia32_Pxor,
+	};
+	return gen_vector_binop(node, int_cons, NULL, NULL);
+}
+
+static ir_node *gen_VMul(ir_node *const node)
+{
+	/* SSE2 only has a lane-wise multiplication for 16bit integers */
+	static construct_vector_binop_func *const int_cons[] = {
+		NULL, new_bd_ia32_Pmullw, NULL, NULL,
+	};
+	return gen_vector_binop(node, int_cons, new_bd_ia32_Mulps,
+	                        new_bd_ia32_Mulpd);
+}
+
+static ir_node *gen_VOr(ir_node *const node)
+{
+	static construct_vector_binop_func *const int_cons[] = {
+		new_bd_ia32_Por, new_bd_ia32_Por,
+		new_bd_ia32_Por, new_bd_ia32_Por,
+	};
+	return gen_vector_binop(node, int_cons, NULL, NULL);
+}
+
+static ir_node *gen_VSub(ir_node *const node)
+{
+	static construct_vector_binop_func *const int_cons[] = {
+		new_bd_ia32_Psubb, new_bd_ia32_Psubw,
+		new_bd_ia32_Psubd, new_bd_ia32_Psubq,
+	};
+	return gen_vector_binop(node, int_cons, new_bd_ia32_Subps,
+	                        new_bd_ia32_Subpd);
+}
+
+static ir_node *gen_VSplat(ir_node *const node)
+{
+	dbg_info *const dbgi    = get_irn_dbg_info(node);
+	ir_node  *const block   = be_transform_nodes_block(node);
+	ir_node  *const op      = get_VSplat_op(node);
+	ir_mode  *const element = get_irn_mode(op);
+	unsigned  const bits    = get_mode_size_bits(element);
+	ir_node        *val     = be_transform_node(op);
+	if (!mode_is_float(element)) {
+		assert(bits == 32);
+		val = new_bd_ia32_Movd(dbgi, block, val);
+	}
+	if (bits == 32)
+		return new_bd_ia32_Pshufd_0(dbgi, block, val);
+	if (bits == 64)
+		return new_bd_ia32_Pshufd_44(dbgi, block, val);
+	panic("unsupported vector operation %+F", node);
+}
+
 /**
  * Transforms a Switch.
  *
@@ -4143,6 +4257,8 @@ static ir_node *gen_Phi(ir_node *node)
 		} else {
 			req = &ia32_class_reg_req_fp;
 		}
+	} else if (mode_is_vector(mode)) {
+		req = &ia32_class_reg_req_xmm;
 	} else {
 		req = arch_memory_req;
 	}
@@ -4406,7 +4522,7 @@ static ir_node *gen_Proj_Load(ir_node *node)
 
 	/* renumber the proj */
 	ir_node *const new_pred = be_transform_node(pred);
-	assert(is_ia32_Conv_I2I(new_pred) || is_ia32_Load(new_pred) || is_ia32_fld(new_pred) || is_ia32_xLoad(new_pred));
+	assert(is_ia32_Conv_I2I(new_pred) || is_ia32_Load(new_pred) || is_ia32_fld(new_pred) || is_ia32_xLoad(new_pred) || is_ia32_xxLoad(new_pred));
 
 	switch ((pn_Load)pn) {
 	case pn_Load_res:
@@ -4429,7 +4545,7 @@ static ir_node *create_proj_for_store(ir_node *store, pn_Store pn)
 	if (get_irn_mode(store) == mode_M) {
 		if (pn == pn_Store_M)
 			return store;
-	} else if (is_ia32_Store(store) || is_ia32_fist(store) || is_ia32_fistp(store) || is_ia32_fisttp(store) || is_ia32_xStore(store) || is_ia32_fst(store) || is_ia32_fstp(store)) {
+	} else if (is_ia32_Store(store) || is_ia32_fist(store) || is_ia32_fistp(store) || is_ia32_fisttp(store) || is_ia32_xStore(store) || is_ia32_xxStore(store) || is_ia32_fst(store) || is_ia32_fstp(store)) {
 		switch (pn) {
 		case pn_Store_M:         return be_new_Proj(store, pn_ia32_st_M);
 		case pn_Store_X_except:  return be_new_Proj(store, pn_ia32_st_X_except);
@@ -5364,6 +5480,13 @@ static void register_transformers(void)
 	be_set_transform_function(op_Sub,              gen_Sub);
 	be_set_transform_function(op_Switch,           gen_Switch);
 	be_set_transform_function(op_Unknown,          gen_Unknown);
+	be_set_transform_function(op_VAdd,             gen_VAdd);
+	be_set_transform_function(op_VAnd,             gen_VAnd);
+	be_set_transform_function(op_VEor,             gen_VEor);
+	be_set_transform_function(op_VMul,             gen_VMul);
+	be_set_transform_function(op_VOr,              gen_VOr);
+	be_set_transform_function(op_VSplat,           gen_VSplat);
+	be_set_transform_function(op_VSub,             gen_VSub);
 	be_set_transform_function(op_be_Relocation,    gen_be_Relocation);
 	be_set_transform_proj_function(op_Alloc,            gen_Proj_Alloc);
 	be_set_transform_proj_function(op_Builtin,          gen_Proj_Builtin);
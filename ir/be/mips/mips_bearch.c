@@ -38,6 +38,7 @@ static ir_settings_arch_dep_t const mips_arch_dep = {
 	.allow_mulhu          = true,
 	.also_use_subs        = true,
 	.maximum_shifts       = 4,
+	.max_lea_shift        = 3,
 	.highest_shift_amount = 63,
 	.evaluate             = NULL,
 	.max_bits_for_mulh    = MIPS_MACHINE_SIZE,
@@ -31,6 +31,7 @@
 #include "lower_calls.h"
 #include "lower_softfloat.h"
 #include "lowering.h"
+#include "panic.h"
 #include "platform_t.h"
 #include "riscv_abi.h"
 #include "riscv_emitter.h"
@@ -70,14 +71,46 @@ static lc_opt_enum_int_var_t isa_var = {
 		&isa, isa_items
 };
 
+bool riscv_use_zba;
+
 static const lc_opt_table_entry_t riscv_options[] = {
 		LC_OPT_ENT_ENUM_INT("arch", "Generate code for given RISC-V ISA", &isa_var),
 		LC_OPT_ENT_ENUM_INT("abi",  "Specify integer and floating-point calling convention",  &abi_var),
+		LC_OPT_ENT_BOOL    ("zba",  "Use the address generation instructions of the Zba extension", &riscv_use_zba),
 		LC_OPT_LAST
 };
 
 static bool use_softfloat;
 
+/**
+ * Evaluates the costs of an instruction replacing a multiplication or
+ * division by a constant. Without Zba an add of a shifted operand needs a
+ * separate shift, with Zba sh1add, sh2add and sh3add do it at once.
+ */
+static int riscv_evaluate_insn(insn_kind const kind, ir_mode const *const mode,
+                               ir_tarval *const tv)
+{
+	/* 64 bit operations are lowered to several instructions */
+	int const factor = get_mode_size_bits(mode) > RISCV_MACHINE_SIZE ? 3 : 1;
+	switch (kind) {
+	case MUL: {
+		/* mul takes the constant in a register, loaded by li */
+		bool const small = tarval_is_long(tv) && is_simm12(get_tarval_long(tv));
+		return factor * (small ? 4 : 5);
+	}
+	case MULH: return 4;
+	case DIV:  return factor * 34;
+	case LEA:  return factor * (riscv_use_zba ? 1 : 2);
+	case SHIFT:
+	case ADD:
+	case SUB:
+	case ZERO:
+	case ROOT:
+		return factor;
+	}
+	panic("invalid instruction kind");
+}
+
 static ir_settings_arch_dep_t const riscv_arch_dep = {
 	.replace_muls         = true,
 	.replace_divs         = true,
@@ -86,8 +119,9 @@ static ir_settings_arch_dep_t const riscv_arch_dep = {
 	.allow_mulhu          = true,
 	.also_use_subs        = true,
 	.maximum_shifts       = 4,
+	.max_lea_shift        = 3,
 	.highest_shift_amount = 63,
-	.evaluate             = NULL,
+	.evaluate             = riscv_evaluate_insn,
 	.max_bits_for_mulh    = RISCV_MACHINE_SIZE,
 };
 
@@ -130,6 +164,7 @@ static void riscv_init(void)
 
 	ir_target.allow_ifconv       = riscv_ifconv;
 	ir_target.float_int_overflow = ir_overflow_min_max;
+	ir_target.issue_width        = 2;
 	ir_platform_set_va_list_type_pointer();
 
 	use_softfloat = ((riscv_isa_t)isa == rv32ima);
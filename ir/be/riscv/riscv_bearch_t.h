@@ -18,6 +18,8 @@
 #include "beirg.h"
 #include "firm_types.h"
 
+extern bool riscv_use_zba;
+
 typedef struct riscv_irg_data_t {
 	bool     omit_fp;        /**< No frame pointer is used. */
 } riscv_irg_data_t;
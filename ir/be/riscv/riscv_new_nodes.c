@@ -138,6 +138,9 @@ void riscv_dump_node(FILE *const F, ir_node const *const n, dump_reason_t const
 			case iro_riscv_rem:
 			case iro_riscv_remu:
 			case iro_riscv_ret:
+			case iro_riscv_sh1add:
+			case iro_riscv_sh2add:
+			case iro_riscv_sh3add:
 			case iro_riscv_sll:
 			case iro_riscv_slt:
 			case iro_riscv_sltu:
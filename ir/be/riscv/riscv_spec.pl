@@ -202,6 +202,13 @@ sb => { template => $storeOp },
 
 sh => { template => $storeOp },
 
+# Zba: res = (left << n) + right
+sh1add => { template => $binOp },
+
+sh2add => { template => $binOp },
+
+sh3add => { template => $binOp },
+
 sll => { template => $binOp },
 
 slli => { template => $immediateOp },
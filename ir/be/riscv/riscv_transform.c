@@ -279,6 +279,35 @@ static ir_node *gen_ASM(ir_node *const node)
 	return be_make_asm(node, &info, operands);
 }
 
+typedef ir_node *cons_binop(dbg_info*, ir_node*, ir_node*, ir_node*);
+typedef ir_node *cons_binop_imm(dbg_info*, ir_node*, ir_node*, ir_entity*, int32_t);
+
+/**
+ * Matches l + (x << 1..3) for the sh1add, sh2add and sh3add instructions of
+ * the Zba extension.
+ */
+static ir_node *match_shift_add(ir_node *const node, ir_node *const l,
+                                ir_node *const r)
+{
+	if (!is_Shl(r))
+		return NULL;
+	ir_node *const amount = get_Shl_right(r);
+	if (!is_Const(amount))
+		return NULL;
+	static cons_binop *const cons[] = {
+		&new_bd_riscv_sh1add, &new_bd_riscv_sh2add, &new_bd_riscv_sh3add
+	};
+	long const val = get_Const_long(amount);
+	if (val < 1 || (unsigned long)val > ARRAY_SIZE(cons))
+		return NULL;
+
+	dbg_info *const dbgi  = get_irn_dbg_info(node);
+	ir_node  *const block = be_transform_nodes_block(node);
+	ir_node  *const new_x = be_transform_node(get_Shl_left(r));
+	ir_node  *const new_l = be_transform_node(l);
+	return cons[val - 1](dbgi, block, new_x, new_l);
+}
+
 static ir_node *gen_Add(ir_node *const node)
 {
 	ir_tarval *tv;
@@ -294,6 +323,14 @@ static ir_node *gen_Add(ir_node *const node)
 	ir_node *const r    = get_Add_right(node);
 	ir_mode *const mode = get_irn_mode(node);
 	if (be_mode_needs_gp_reg(mode)) {
+		if (riscv_use_zba) {
+			ir_node *res = match_shift_add(node, l, r);
+			if (res == NULL)
+				res = match_shift_add(node, r, l);
+			if (res != NULL)
+				return res;
+		}
+
 		dbg_info *const dbgi  = get_irn_dbg_info(node);
 		ir_node  *const block = be_transform_nodes_block(node);
 		ir_node  *const new_l = be_transform_node(l);
@@ -354,9 +391,6 @@ static ir_node *gen_Proj_Alloc(ir_node *node)
 	panic("invalid Proj->Alloc");
 }
 
-typedef ir_node *cons_binop(dbg_info*, ir_node*, ir_node*, ir_node*);
-typedef ir_node *cons_binop_imm(dbg_info*, ir_node*, ir_node*, ir_entity*, int32_t);
-
 static ir_node *gen_logic_op(ir_node *const node, cons_binop *const cons, cons_binop_imm *const cons_imm)
 {
 	dbg_info *const dbgi  = get_irn_dbg_info(node);
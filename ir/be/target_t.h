@@ -20,6 +20,12 @@ typedef struct target_info_t {
 	arch_isa_if_t   const *isa;
 	char const            *experimental;
 	arch_allow_ifconv_func allow_ifconv;
+	/** Decides which vector operations the target supports natively. */
+	arch_allow_vector_op_func allow_vector_op;
+	/** Size of the vector registers in bytes, 0 if there are none. */
+	unsigned               vector_size;
+	/** Number of instructions issued per cycle, 0 if unknown. */
+	unsigned               issue_width;
 	ir_mode               *mode_float_arithmetic;
 	bool isa_initialized          : 1;
 	bool fast_unaligned_memaccess : 1;
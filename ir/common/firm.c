@@ -88,6 +88,7 @@ void ir_finish(void)
 #ifdef DEBUG_libfirm
 	firm_finish_debugger();
 #endif
+	ir_dump_trace_end();
 	exit_execfreq();
 	firm_be_finish();
 
@@ -93,9 +93,20 @@ static int default_evaluate(insn_kind kind, const ir_mode *mode, ir_tarval *tv)
 {
 	(void)mode;
 	(void)tv;
-	if (kind == MUL)
+	switch (kind) {
+	case MUL:
+	case MULH:
 		return 13;
-	return 1;
+	case DIV:
+		return 36;
+	default:
+		return 1;
+	}
+}
+
+static evaluate_costs_func get_evaluate(void)
+{
+	return settings.evaluate != NULL ? settings.evaluate : default_evaluate;
 }
 
 /**
@@ -341,9 +352,11 @@ static instruction *decompose_mul(mul_env *env, unsigned char *R, int r,
 	if (N == NULL)
 		N = condensed_to_value(env, R, r);
 
-	for (unsigned i = env->max_S; i > 0; --i) {
+	/* 2^i + 1 must not overflow */
+	ir_tarval *const one = get_mode_one(env->mode);
+	for (unsigned i = MIN(env->max_S, env->bits - 2); i > 0; --i) {
 		ir_tarval *div_res, *mod_res;
-		ir_tarval *tv = new_tarval_from_long((1 << i) + 1, env->mode);
+		ir_tarval *tv = tarval_add(tarval_shl_unsigned(one, i), one);
 
 		div_res = tarval_divmod(N, tv, &mod_res);
 		if (mod_res == get_mode_null(env->mode)) {
@@ -423,6 +436,8 @@ static ir_node *build_graph(mul_env *env, instruction *inst)
 		return inst->irn = new_r_Const_null(irg, env->mode);
 	case ROOT:
 	case MUL:
+	case MULH:
+	case DIV:
 		break;
 	}
 	panic("unsupported instruction kind");
@@ -468,6 +483,8 @@ static int evaluate_insn(mul_env *env, instruction *inst)
 	}
 	case MUL:
 	case ROOT:
+	case MULH:
+	case DIV:
 		break;
 	}
 	panic("unsupported instruction kind");
@@ -490,12 +507,11 @@ static ir_node *do_decomposition(ir_node *irn, ir_node *operand, ir_tarval *tv)
 	obstack_init(&env.obst);
 	env.mode     = get_tarval_mode(tv);
 	env.bits     = (unsigned)get_mode_size_bits(env.mode);
-	env.max_S    = 3;
+	env.max_S    = settings.max_lea_shift;
 	env.root     = emit_ROOT(&env, operand);
 	env.fail     = false;
 	env.n_shift  = settings.maximum_shifts;
-	env.evaluate = settings.evaluate != NULL ? settings.evaluate
-	                                         : default_evaluate;
+	env.evaluate = get_evaluate();
 	env.irg      = get_irn_irg(irn);
 
 	int            r;
@@ -809,11 +825,23 @@ static struct magicu_info get_magic_info(ir_tarval *d)
 }
 
 /**
- * Build the Mulh replacement code for n / tv.
+ * Checks whether the Mulh sequence plus @p costs is cheaper than the
+ * division by @p tv.
+ */
+static bool mulh_is_cheaper(ir_mode *mode, ir_tarval *tv, int costs)
+{
+	evaluate_costs_func const evaluate = get_evaluate();
+	costs += evaluate(MULH, mode, NULL);
+	return costs < evaluate(DIV, mode, tv);
+}
+
+/**
+ * Build the Mulh replacement code for n / tv, if it is cheaper than the
+ * division.
  *
- * Note that 'div' might be a Mod operation as well
+ * @param is_mod  the result is used to calculate the remainder of a Mod
  */
-static ir_node *replace_div_by_mulh(ir_node *div, ir_tarval *tv)
+static ir_node *replace_div_by_mulh(ir_node *div, ir_tarval *tv, bool is_mod)
 {
 	/* Beware: do not transform bad code */
 	ir_node *n     = get_binop_left(div);
@@ -821,14 +849,29 @@ static ir_node *replace_div_by_mulh(ir_node *div, ir_tarval *tv)
 	if (is_Bad(n) || is_Bad(block))
 		return div;
 
-	dbg_info *dbg   = get_irn_dbg_info(div);
-	ir_mode  *mode  = get_irn_mode(n);
-	int       bits  = get_mode_size_bits(mode);
-	ir_node  *res;
+	dbg_info           *dbg      = get_irn_dbg_info(div);
+	ir_mode            *mode     = get_irn_mode(n);
+	int                 bits     = get_mode_size_bits(mode);
+	evaluate_costs_func evaluate = get_evaluate();
+	int                 costs    = 0;
+	if (is_mod) {
+		costs += evaluate(MUL, mode, tv);
+		costs += evaluate(SUB, mode, NULL);
+	}
+
+	ir_node *res;
 	if (mode_is_signed(mode)) {
 		ir_graph *irg = get_irn_irg(div);
 		struct ms mag = magic(tv);
 
+		if (mag.need_add || mag.need_sub)
+			costs += evaluate(ADD, mode, NULL);
+		if (mag.s > 0)
+			costs += evaluate(SHIFT, mode, NULL);
+		costs += evaluate(SHIFT, mode, NULL) + evaluate(ADD, mode, NULL);
+		if (!mulh_is_cheaper(mode, tv, costs))
+			return div;
+
 		/* generate the Mulh instruction */
 		ir_node *c = new_r_Const(irg, mag.M);
 		ir_node *q = new_rd_Mulh(dbg, block, n, c);
@@ -853,6 +896,15 @@ static ir_node *replace_div_by_mulh(ir_node *div, ir_tarval *tv)
 		struct magicu_info mafo = get_magic_info(tv);
 		ir_graph          *irg  = get_irn_irg(div);
 
+		if (mafo.pre_shift > 0)
+			costs += evaluate(SHIFT, mode, NULL);
+		if (mafo.increment)
+			costs += 2 * evaluate(ADD, mode, NULL);
+		if (mafo.post_shift > 0)
+			costs += evaluate(SHIFT, mode, NULL);
+		if (!mulh_is_cheaper(mode, tv, costs))
+			return div;
+
 		if (mafo.pre_shift > 0) {
 			ir_node *c = new_r_Const_long(irg, mode_Iu, mafo.pre_shift);
 			n = new_rd_Shr(dbg, block, n, c);
@@ -865,7 +917,7 @@ static ir_node *replace_div_by_mulh(ir_node *div, ir_tarval *tv)
 			ir_node *increment = new_rd_Builtin(dbg, block, no_mem, 1, in,
 			                                    ir_bk_saturating_increment, utype);
 
-			n = new_r_Proj(increment, mode_Iu, pn_Builtin_max + 1);
+			n = new_r_Proj(increment, mode, pn_Builtin_max + 1);
 		}
 
 		/* generate the Mulh instruction */
@@ -964,7 +1016,7 @@ ir_node *arch_dep_replace_div_by_const(ir_node *irn)
 	} else if (k != 0) {
 		/* other constant */
 		if (allow_Mulh(mode))
-			res = replace_div_by_mulh(irn, tv);
+			res = replace_div_by_mulh(irn, tv, false);
 	} else { /* k == 0  i.e. division by 1 */
 		res = left;
 	}
@@ -1044,9 +1096,11 @@ ir_node *arch_dep_replace_mod_by_const(ir_node *irn)
 		}
 	/* other constant */
 	} else if (allow_Mulh(mode)) {
-		res = replace_div_by_mulh(irn, tv);
-		res = new_rd_Mul(dbg, block, res, c);
-		res = new_rd_Sub(dbg, block, left, res);
+		ir_node *const q = replace_div_by_mulh(irn, tv, true);
+		if (q != irn) {
+			res = new_rd_Mul(dbg, block, q, c);
+			res = new_rd_Sub(dbg, block, left, res);
+		}
 	}
 
 	return res;
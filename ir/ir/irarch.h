@@ -24,7 +24,9 @@ typedef enum insn_kind {
 	ADD,   /**< the ADD instruction */
 	ZERO,  /**< creates a ZERO constant */
 	MUL,   /**< the original MUL instruction */
-	ROOT   /**< the ROOT value that is multiplied */
+	ROOT,  /**< the ROOT value that is multiplied */
+	MULH,  /**< the high part of a multiplication */
+	DIV,   /**< the original DIV or MOD instruction */
 } insn_kind;
 
 /**
@@ -32,7 +34,8 @@ typedef enum insn_kind {
  *
  * @param kind   the instruction
  * @param mode   the mode of the instruction
- * @param tv     for MUL instruction, the multiplication constant
+ * @param tv     for MUL instruction, the multiplication constant,
+ *               for DIV instruction, the divisor
  *
  * @return the costs of this instruction
  */
@@ -50,6 +53,9 @@ typedef struct ir_settings_arch_dep_t {
 	bool allow_mulhu   : 1;  /**< Use Mulhu for division by constant */
 	bool also_use_subs : 1;  /**< Use Subs when resolving Muls to shifts */
 	unsigned maximum_shifts;       /**< The maximum number of shifts that shall be inserted for a mul. */
+	unsigned max_lea_shift;        /**< The highest shift amount of an
+	                                    instruction adding a shifted operand
+	                                    (LEA), 0 if there is none. */
 	unsigned highest_shift_amount; /**< The highest shift amount you want to
 	                                    tolerate. Muls which would require a higher
 	                                    shift constant are left. */
@@ -75,6 +81,7 @@ ir_node *arch_dep_replace_mul_with_shifts(ir_node *irn);
  * - allow_mulhu
  * - allow_mulhs
  * - max_bits_for_mulh
+ * and by the costs of the Mulh sequence compared to the DIV instruction.
  *
  * If irn is a Div with a Const, the constant is inspected if it meets the
  * requirements of the variables stated above. If a Shl/Add/Sub/Mulh
@@ -92,6 +99,7 @@ ir_node *arch_dep_replace_div_by_const(ir_node *irn);
  * - allow_mulhu
  * - allow_mulhs
  * - max_bits_for_mulh
+ * and by the costs of the Mulh sequence compared to the DIV instruction.
  *
  * If irn is a Mod with a Const, the constant is inspected if it meets the
  * requirements of the variables stated above. If a Shl/Add/Sub/Mulh
@@ -2190,8 +2190,13 @@ void dump_ir_prog_ext(ir_prog_dump_func func, const char *suffix)
 
 void dump_ir_graph(ir_graph *graph, const char *suffix)
 {
-	char buf[256];
+	if (ir_dump_trace_active()) {
+		if (ir_should_dump(get_irg_dump_name(graph)))
+			dump_ir_graph_trace(graph, suffix);
+		return;
+	}
 
+	char buf[256];
 	snprintf(buf, sizeof(buf), "%s.vcg", suffix);
 	dump_ir_graph_ext(dump_ir_graph_file, graph, buf);
 }
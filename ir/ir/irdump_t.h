@@ -33,6 +33,12 @@ void dump_type_node(FILE *out, ir_type *tp);
 void dump_vcg_header_colors(FILE *out);
 void dump_vcg_infonames(FILE *out);
 
+/** Returns true if a binary trace was started with ir_dump_trace_begin(). */
+bool ir_dump_trace_active(void);
+
+/** Appends a snapshot of @p irg to the binary trace. */
+void dump_ir_graph_trace(ir_graph *irg, const char *suffix);
+
 /** Write the irnode and all its attributes to the file passed.
  * (plain text format) */
 void dump_irnode_to_file(FILE *out, const ir_node *node);
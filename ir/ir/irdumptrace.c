@@ -0,0 +1,300 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Write graph snapshots into a compact binary trace.
+ *
+ * The trace starts with the 8 byte magic "FIRMTRC1" followed by records.
+ * Every record is a tag byte followed by unsigned LEB128 numbers:
+ *
+ *   STRING   id, length, bytes       defines string id (ids start at 1)
+ *   SNAPSHOT graph, name, suffix, nr starts a snapshot of a graph
+ *   NODE     idx, op, mode, block+1, n_ins, ins..., attr
+ *   DELETE   idx                     node is not part of the graph anymore
+ *   END                              ends the snapshot
+ *
+ * String references use 0 for "none".  A snapshot only contains the nodes
+ * that changed or appeared since the previous snapshot of the same graph,
+ * readers have to keep the state of each graph.  scripts/irtrace.py converts
+ * a trace into vcg, dot or json.
+ */
+#include "array.h"
+#include "entity_t.h"
+#include "ident.h"
+#include "irdump_t.h"
+#include "irgwalk.h"
+#include "irmode_t.h"
+#include "irnode_t.h"
+#include "irprintf.h"
+#include "obst.h"
+#include "pmap.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <errno.h>
+#include <string.h>
+
+#define TRACE_MAGIC       "FIRMTRC1"
+#define TRACE_BUFFER_SIZE (1 << 16)
+
+typedef enum trace_tag_t {
+	TRACE_STRING   = 1,
+	TRACE_SNAPSHOT = 2,
+	TRACE_NODE     = 3,
+	TRACE_DELETE   = 4,
+	TRACE_END      = 5,
+} trace_tag_t;
+
+/** Encoded node record of the previous snapshot. */
+typedef struct trace_record_t {
+	unsigned      snapshot; /**< last snapshot containing the node */
+	size_t        size;
+	unsigned char data[];
+} trace_record_t;
+
+/** Per graph state of the trace. */
+typedef struct trace_graph_t {
+	unsigned         id;
+	unsigned         snapshot; /**< number of the current snapshot */
+	trace_record_t **records;  /**< ARR_F indexed by node index */
+} trace_graph_t;
+
+static FILE           *trace_file;
+static unsigned char  *buffer;
+static size_t          buffer_len;
+static pmap           *strings;   /**< maps idents to string ids */
+static pmap           *graphs;    /**< maps graphs to trace_graph_t */
+static unsigned        n_strings;
+static unsigned        n_graphs;
+static struct obstack  record_obst;
+
+static void flush_buffer(void)
+{
+	if (buffer_len > 0) {
+		fwrite(buffer, 1, buffer_len, trace_file);
+		buffer_len = 0;
+	}
+}
+
+static void write_bytes(void const *data, size_t size)
+{
+	if (buffer_len + size > TRACE_BUFFER_SIZE) {
+		flush_buffer();
+		if (size > TRACE_BUFFER_SIZE) {
+			fwrite(data, 1, size, trace_file);
+			return;
+		}
+	}
+	memcpy(buffer + buffer_len, data, size);
+	buffer_len += size;
+}
+
+static void write_byte(unsigned char byte)
+{
+	if (buffer_len == TRACE_BUFFER_SIZE)
+		flush_buffer();
+	buffer[buffer_len++] = byte;
+}
+
+static void write_number(size_t value)
+{
+	while (value >= 0x80) {
+		write_byte((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	write_byte((unsigned char)value);
+}
+
+static void record_number(size_t value)
+{
+	while (value >= 0x80) {
+		obstack_1grow(&record_obst, (char)(value | 0x80));
+		value >>= 7;
+	}
+	obstack_1grow(&record_obst, (char)value);
+}
+
+/**
+ * Returns the id of string @p str, writes a STRING record the first time the
+ * string is seen.
+ */
+static unsigned get_string_id(char const *str)
+{
+	if (str == NULL)
+		return 0;
+
+	ident   *id  = new_id_from_str(str);
+	unsigned res = PTR_TO_INT(pmap_get(void, strings, id));
+	if (res == 0) {
+		res = ++n_strings;
+		pmap_insert(strings, id, INT_TO_PTR(res));
+
+		size_t len = strlen(str);
+		write_byte(TRACE_STRING);
+		write_number(res);
+		write_number(len);
+		write_bytes(str, len);
+	}
+	return res;
+}
+
+/**
+ * Returns a short description of the attributes of @p node or NULL.
+ */
+static char const *get_node_attr(ir_node const *node, char *buf, size_t size)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Const:
+		ir_snprintf(buf, size, "%T", get_Const_tarval(node));
+		return buf;
+	case iro_Proj:
+		snprintf(buf, size, "%u", get_Proj_num(node));
+		return buf;
+	case iro_Cmp:
+		return get_relation_string(get_Cmp_relation(node));
+	case iro_Address:
+		return get_entity_ld_name(get_Address_entity(node));
+	case iro_Member:
+		return get_entity_ld_name(get_Member_entity(node));
+	case iro_Offset:
+		return get_entity_ld_name(get_Offset_entity(node));
+	default:
+		return NULL;
+	}
+}
+
+static void trace_node(ir_node *node, void *data)
+{
+	trace_graph_t *graph = (trace_graph_t*)data;
+
+	char        buf[128];
+	char const *attr = get_node_attr(node, buf, sizeof(buf));
+	ir_mode    *mode = get_irn_mode(node);
+	unsigned    op   = get_string_id(get_irn_opname(node));
+	unsigned    m    = get_string_id(mode != NULL ? get_mode_name(mode) : NULL);
+	unsigned    a    = get_string_id(attr);
+
+	unsigned idx = get_irn_idx(node);
+	record_number(idx);
+	record_number(op);
+	record_number(m);
+	record_number(is_Block(node) ? 0 : get_irn_idx(get_nodes_block(node)) + 1);
+	int arity = get_irn_arity(node);
+	record_number(arity);
+	for (int i = 0; i < arity; ++i)
+		record_number(get_irn_idx(get_irn_n(node, i)));
+	record_number(a);
+
+	size_t         size = obstack_object_size(&record_obst);
+	unsigned char *rec  = (unsigned char*)obstack_finish(&record_obst);
+
+	size_t len = ARR_LEN(graph->records);
+	if (idx >= len) {
+		ARR_RESIZE(trace_record_t*, graph->records, idx + 1);
+		memset(graph->records + len, 0,
+		       (idx + 1 - len) * sizeof(graph->records[0]));
+	}
+	trace_record_t *old = graph->records[idx];
+	if (old == NULL || old->size != size || memcmp(old->data, rec, size) != 0) {
+		write_byte(TRACE_NODE);
+		write_bytes(rec, size);
+
+		free(old);
+		old = XMALLOCF(trace_record_t, data, size);
+		old->size = size;
+		memcpy(old->data, rec, size);
+		graph->records[idx] = old;
+	}
+	old->snapshot = graph->snapshot;
+
+	obstack_free(&record_obst, rec);
+}
+
+void dump_ir_graph_trace(ir_graph *irg, const char *suffix)
+{
+	trace_graph_t *graph = pmap_get(trace_graph_t, graphs, irg);
+	if (graph == NULL) {
+		graph          = XMALLOCZ(trace_graph_t);
+		graph->id      = n_graphs++;
+		graph->records = NEW_ARR_F(trace_record_t*, 0);
+		pmap_insert(graphs, irg, graph);
+	}
+	++graph->snapshot;
+
+	unsigned name = get_string_id(get_irg_dump_name(irg));
+	unsigned suff = get_string_id(suffix);
+	write_byte(TRACE_SNAPSHOT);
+	write_number(graph->id);
+	write_number(name);
+	write_number(suff);
+	write_number(irg->dump_nr++);
+
+	irg_walk_graph(irg, trace_node, NULL, graph);
+
+	/* report nodes of the previous snapshot which are gone */
+	for (size_t i = 0, n = ARR_LEN(graph->records); i < n; ++i) {
+		trace_record_t *record = graph->records[i];
+		if (record == NULL || record->snapshot == graph->snapshot)
+			continue;
+		write_byte(TRACE_DELETE);
+		write_number(i);
+		free(record);
+		graph->records[i] = NULL;
+	}
+
+	write_byte(TRACE_END);
+	/* complete snapshots must survive a crash of the compiler */
+	flush_buffer();
+	fflush(trace_file);
+}
+
+bool ir_dump_trace_active(void)
+{
+	return trace_file != NULL;
+}
+
+int ir_dump_trace_begin(const char *filename)
+{
+	assert(trace_file == NULL);
+	FILE *out = fopen(filename, "wb");
+	if (out == NULL) {
+		fprintf(stderr, "Couldn't open '%s': %s\n", filename, strerror(errno));
+		return -1;
+	}
+
+	trace_file = out;
+	buffer     = XMALLOCN(unsigned char, TRACE_BUFFER_SIZE);
+	buffer_len = 0;
+	strings    = pmap_create();
+	graphs     = pmap_create();
+	n_strings  = 0;
+	n_graphs   = 0;
+	obstack_init(&record_obst);
+	write_bytes(TRACE_MAGIC, sizeof(TRACE_MAGIC) - 1);
+	return 0;
+}
+
+void ir_dump_trace_end(void)
+{
+	if (trace_file == NULL)
+		return;
+
+	flush_buffer();
+	fclose(trace_file);
+	trace_file = NULL;
+
+	foreach_pmap(graphs, entry) {
+		trace_graph_t *graph = (trace_graph_t*)entry->value;
+		for (size_t i = 0, n = ARR_LEN(graph->records); i < n; ++i)
+			free(graph->records[i]);
+		DEL_ARR_F(graph->records);
+		free(graph);
+	}
+	pmap_destroy(graphs);
+	pmap_destroy(strings);
+	obstack_free(&record_obst, NULL);
+	free(buffer);
+	buffer = NULL;
+}
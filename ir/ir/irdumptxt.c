@@ -353,8 +353,6 @@ void dump_irnode_to_file(FILE *const F, const ir_node *const n)
 		switch (b->state) {
 		case BITINFO_INVALID:   fputs(" (invalid)",   F); break;
 		case BITINFO_VALID:     /* nothing */             break;
-		case BITINFO_IN_FLIGHT: fputs(" (in flight)", F); break;
-		case BITINFO_UNSTABLE:  fputs(" (unstable)",  F); break;
 		}
 		fputc('\n', F);
 	}
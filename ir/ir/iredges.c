@@ -11,48 +11,23 @@
  * @brief
  *   These are out-edges (also called def-use edges) that are dynamically
  *   updated as the graph changes.
+ *
+ *   Every node keeps an array with the edge of each of its inputs, so the
+ *   edge of an input is found without a search when the input changes.
  */
 #include "iredges_t.h"
 
-#include "bitset.h"
 #include "debug.h"
-#include "hashptr.h"
 #include "irdump_t.h"
 #include "iredgekinds.h"
-#include "iredgeset.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
 #include "irnodemap.h"
 #include "iropt_t.h"
 #include "irprintf.h"
 #include "set.h"
-
-#define DO_REHASH
-#define SCALAR_RETURN
-#define HashSet                   ir_edgeset_t
-#define HashSetIterator           ir_edgeset_iterator_t
-#define ValueType                 ir_edge_t*
-#define NullValue                 NULL
-#define DeletedValue              ((ir_edge_t*)-1)
-#define Hash(this,key)            (hash_ptr(key->src) ^ (key->pos * 40013))
-#define KeysEqual(this,key1,key2) ((key1->src) == (key2->src) && (key1->pos == key2->pos))
-#define SetRangeEmpty(ptr,size)   memset(ptr, 0, (size) * sizeof((ptr)[0]))
-
-#define hashset_init            ir_edgeset_init
-void ir_edgeset_init_size(ir_edgeset_t *self, size_t size);
-#define hashset_init_size       ir_edgeset_init_size
-#define hashset_destroy         ir_edgeset_destroy
-#define hashset_insert          ir_edgeset_insert
-#define hashset_remove          ir_edgeset_remove
-ir_edge_t *ir_edgeset_find(const ir_edgeset_t *self, const ir_edge_t* key);
-#define hashset_find            ir_edgeset_find
-size_t ir_edgeset_size(const ir_edgeset_t *self);
-#define hashset_size            ir_edgeset_size
-#define hashset_iterator_init   ir_edgeset_iterator_init
-#define hashset_iterator_next   ir_edgeset_iterator_next
-#define hashset_remove_iterator ir_edgeset_remove_iterator
-
-#include "hashset.c.h"
+#include "util.h"
+#include <limits.h>
 
 /**
  * A function that allows for setting an edge.
@@ -138,21 +113,49 @@ static inline long edge_get_id(const ir_edge_t *e)
 void edges_init_graph_kind(ir_graph *irg, ir_edge_kind_t kind)
 {
 	if (edges_activated_kind(irg, kind)) {
-		irg_edge_info_t *info   = get_irg_edge_info(irg, kind);
-		size_t           amount = get_irg_last_idx(irg) * 5 / 4;
+		irg_edge_info_t *info = get_irg_edge_info(irg, kind);
 
-		if (info->allocated) {
-			amount = ir_edgeset_size(&info->edges);
-			ir_edgeset_destroy(&info->edges);
+		if (info->allocated)
 			obstack_free(&info->edges_obst, NULL);
-		}
 		obstack_init(&info->edges_obst);
 		INIT_LIST_HEAD(&info->free_edges);
-		ir_edgeset_init_size(&info->edges, amount);
 		info->allocated = 1;
 	}
 }
 
+/**
+ * Returns the slot holding the edge of input @p pos of @p src or NULL if
+ * @p src has no slot for it.
+ */
+static inline ir_edge_t **find_edge_slot(ir_node *src, int pos,
+                                         ir_edge_kind_t kind)
+{
+	irn_edge_info_t *info = get_irn_edge_info(src, kind);
+	unsigned         idx  = pos + 1;
+	return idx < info->n_slots ? &info->slots[idx] : NULL;
+}
+
+/**
+ * Returns the slot holding the edge of input @p pos of @p src, enlarges the
+ * slot array of @p src if necessary.
+ */
+static ir_edge_t **get_edge_slot(irg_edge_info_t *irg_info, ir_node *src,
+                                 int pos, ir_edge_kind_t kind)
+{
+	irn_edge_info_t *info = get_irn_edge_info(src, kind);
+	unsigned         idx  = pos + 1;
+	if (idx >= info->n_slots) {
+		/* dynamic nodes grow one input at a time, so double the size */
+		unsigned n_slots = MAX(idx + 1, (unsigned)get_irn_arity(src) + 1);
+		n_slots = MAX(n_slots, 2 * info->n_slots);
+		ir_edge_t **slots = OALLOCNZ(&irg_info->edges_obst, ir_edge_t*, n_slots);
+		MEMCPY(slots, info->slots, info->n_slots);
+		info->slots   = slots;
+		info->n_slots = n_slots;
+	}
+	return &info->slots[idx];
+}
+
 /**
  * Change the out count
  *
@@ -193,18 +196,23 @@ static inline void verify_list_head(ir_node *irn, ir_edge_kind_t kind)
 	del_pset(lh_set);
 }
 
+static void dump_edges_walker(ir_node *irn, void *data)
+{
+	ir_edge_kind_t         kind = *(ir_edge_kind_t*)data;
+	irn_edge_info_t const *info = get_irn_edge_info(irn, kind);
+	for (unsigned i = 0, n = info->n_slots; i < n; ++i) {
+		ir_edge_t const *e = info->slots[i];
+		if (e != NULL)
+			ir_printf("%+F %d\n", e->src, e->pos);
+	}
+}
+
 void edges_dump_kind(ir_graph *irg, ir_edge_kind_t kind)
 {
 	if (!edges_activated_kind(irg, kind))
 		return;
 
-	irg_edge_info_t       *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t          *edges = &info->edges;
-	ir_edge_t             *e;
-	ir_edgeset_iterator_t  iter;
-	foreach_ir_edgeset(edges, e, iter) {
-		ir_printf("%+F %d\n", e->src, e->pos);
-	}
+	irg_walk_graph(irg, dump_edges_walker, NULL, &kind);
 }
 
 static void add_edge(ir_node *src, int pos, ir_node *tgt, ir_edge_kind_t kind,
@@ -213,8 +221,9 @@ static void add_edge(ir_node *src, int pos, ir_node *tgt, ir_edge_kind_t kind,
 	if (tgt == NULL)
 		return;
 	assert(edges_activated_kind(irg, kind));
-	irg_edge_info_t *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t    *edges = &info->edges;
+	irg_edge_info_t *info = get_irg_edge_info(irg, kind);
+	ir_edge_t      **slot = get_edge_slot(info, src, pos, kind);
+	assert(*slot == NULL && "edge already exists");
 
 	irn_edge_info_t  *tgt_info = get_irn_edge_info(tgt, kind);
 	struct list_head *head     = &tgt_info->outs_head;
@@ -230,16 +239,11 @@ static void add_edge(ir_node *src, int pos, ir_node *tgt, ir_edge_kind_t kind,
 		list_del(&edge->list);
 	}
 
-	edge->src     = src;
-	edge->pos     = pos;
-#ifdef DEBUG_libfirm
-	edge->present = false;
-#endif
-
-	ir_edge_t *new_edge = ir_edgeset_insert(edges, edge);
-	assert(new_edge == edge);
+	edge->src = src;
+	edge->pos = pos;
+	*slot     = edge;
 
-	list_add(&new_edge->list, head);
+	list_add(&edge->list, head);
 	edge_change_cnt(tgt_info, +1);
 }
 
@@ -250,23 +254,16 @@ static void delete_edge(ir_node *src, int pos, ir_node *old_tgt,
 		return;
 	assert(edges_activated_kind(irg, kind));
 
-	irg_edge_info_t *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t    *edges = &info->edges;
-
-	/* Initialize the edge template to search in the set. */
-	ir_edge_t templ;
-	templ.src = src;
-	templ.pos = pos;
-
-	/* search the edge in the set. */
-	ir_edge_t *edge = ir_edgeset_find(edges, &templ);
+	ir_edge_t **slot = find_edge_slot(src, pos, kind);
+	ir_edge_t  *edge = slot != NULL ? *slot : NULL;
 
 	/* mark the edge invalid if it was found */
 	if (edge == NULL)
 		return;
 
+	irg_edge_info_t *info = get_irg_edge_info(irg, kind);
 	list_del(&edge->list);
-	ir_edgeset_remove(edges, edge);
+	*slot = NULL;
 	list_add(&edge->list, &info->free_edges);
 	edge->pos = -2;
 	edge->src = NULL;
@@ -274,9 +271,55 @@ static void delete_edge(ir_node *src, int pos, ir_node *old_tgt,
 	edge_change_cnt(old_tgt_info, -1);
 }
 
+/**
+ * Builds the edges of @p irn except the one of input @p skip and the edges
+ * of the nodes, which had no edges since the activation and are reached
+ * through them.
+ */
+static void build_missing_edges(ir_node *irn, int skip, ir_edge_kind_t kind,
+                                ir_graph *irg)
+{
+	ir_node **stack = NEW_ARR_F(ir_node*, 0);
+	get_irn_edge_info(irn, kind)->edges_built = 1;
+	for (;;) {
+		foreach_tgt(irn, i, n, kind) {
+			if (i == skip)
+				continue;
+			ir_node *pred = get_n(irn, i, kind);
+			if (pred == NULL)
+				continue;
+			add_edge(irn, i, pred, kind, irg);
+			irn_edge_info_t *pred_info = get_irn_edge_info(pred, kind);
+			if (!pred_info->edges_built) {
+				pred_info->edges_built = 1;
+				ARR_APP1(ir_node*, stack, pred);
+			}
+		}
+		size_t const len = ARR_LEN(stack);
+		if (len == 0)
+			break;
+		irn  = stack[len - 1];
+		skip = INT_MIN;
+		ARR_SHRINKLEN(stack, len - 1);
+	}
+	DEL_ARR_F(stack);
+}
+
 static void edges_notify_edge_kind(ir_node *src, int pos, ir_node *tgt, ir_node *old_tgt, ir_edge_kind_t kind, ir_graph *irg)
 {
 	assert(edges_activated_kind(irg, kind));
+	/* Nodes unreachable during the activation have no edges yet. The input
+	 * at pos of src may already be changed, so it is skipped. */
+	bool const src_built = get_irn_edge_info(src, kind)->edges_built;
+	if (!src_built)
+		build_missing_edges(src, pos, kind, irg);
+	if (tgt != NULL && !get_irn_edge_info(tgt, kind)->edges_built)
+		build_missing_edges(tgt, INT_MIN, kind, irg);
+	if (!src_built) {
+		add_edge(src, pos, tgt, kind, irg);
+		return;
+	}
+
 	if (old_tgt == NULL) {
 		add_edge(src, pos, tgt, kind, irg);
 		return;
@@ -289,9 +332,6 @@ static void edges_notify_edge_kind(ir_node *src, int pos, ir_node *tgt, ir_node
 	if (tgt == old_tgt)
 		return;
 
-	irg_edge_info_t *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t    *edges = &info->edges;
-
 	/* The target is not NULL and the old target differs
 	 * from the new target, the edge shall be moved (if the
 	 * old target was != NULL) or added (if the old target was
@@ -301,13 +341,9 @@ static void edges_notify_edge_kind(ir_node *src, int pos, ir_node *tgt, ir_node
 	assert(head->next && head->prev &&
 	       "target list head must have been initialized");
 
-	/* Initialize the edge template to search in the set. */
-	ir_edge_t templ;
-	templ.src = src;
-	templ.pos = pos;
-
-	ir_edge_t *edge = ir_edgeset_find(edges, &templ);
-	assert(edge && "edge to redirect not found!");
+	ir_edge_t **slot = find_edge_slot(src, pos, kind);
+	assert(slot != NULL && *slot != NULL && "edge to redirect not found!");
+	ir_edge_t *edge = *slot;
 
 	list_move(&edge->list, head);
 	irn_edge_info_t *old_tgt_info = get_irn_edge_info(old_tgt, kind);
@@ -417,7 +453,6 @@ static void edges_node_revival_kind(ir_node *irn, ir_edge_kind_t kind)
 
 typedef struct build_walker {
 	ir_edge_kind_t kind;
-	bitset_t      *reachable;
 	bool           fine;
 } build_walker;
 
@@ -438,17 +473,19 @@ static void build_edges_walker(ir_node *irn, void *data)
 }
 
 /**
- * Pre-Walker: initializes the list-heads and set the out-count
- * of all nodes to 0.
+ * Initializes the list-heads and sets the out-count of a node to 0.
  */
 static void init_lh_walker(ir_node *irn, void *data)
 {
 	build_walker   *w    = (build_walker*)data;
 	ir_edge_kind_t  kind = w->kind;
-	list_head      *head = &get_irn_edge_info(irn, kind)->outs_head;
-	INIT_LIST_HEAD(head);
-	get_irn_edge_info(irn, kind)->edges_built = 0;
-	get_irn_edge_info(irn, kind)->out_count   = 0;
+	irn_edge_info_t *info = get_irn_edge_info(irn, kind);
+	INIT_LIST_HEAD(&info->outs_head);
+	/* the slot arrays of the previous activation are gone */
+	info->slots       = NULL;
+	info->n_slots     = 0;
+	info->edges_built = 0;
+	info->out_count   = 0;
 }
 
 void edges_activate_kind(ir_graph *irg, ir_edge_kind_t kind)
@@ -473,7 +510,9 @@ void edges_activate_kind(ir_graph *irg, ir_edge_kind_t kind)
 	 * - Manually iterate over the identities root set. This did not consume more memory
 	 *   but increase the computation time because the |identities| >= |V|
 	 *
-	 * Currently, we use the last option.
+	 * Currently, we reset all nodes of the index map, which includes the
+	 * identities and nodes that are unreachable now but may be connected
+	 * again. Their slot arrays of a previous activation are gone.
 	 */
 	struct build_walker  w    = { .kind = kind };
 	irg_edge_info_t     *info = get_irg_edge_info(irg, kind);
@@ -482,12 +521,15 @@ void edges_activate_kind(ir_graph *irg, ir_edge_kind_t kind)
 
 	info->activated = 1;
 	edges_init_graph_kind(irg, kind);
+	for (unsigned idx = 0, n = get_irg_last_idx(irg); idx < n; ++idx) {
+		ir_node *irn = get_idx_irn(irg, idx);
+		if (irn != NULL)
+			init_lh_walker(irn, &w);
+	}
 	if (kind == EDGE_KIND_BLOCK) {
-		visit_all_identities(irg, init_lh_walker, &w);
-		irg_block_walk_graph(irg, init_lh_walker, build_edges_walker, &w);
+		irg_block_walk_graph(irg, NULL, build_edges_walker, &w);
 	} else {
-		visit_all_identities(irg, init_lh_walker, &w);
-		irg_walk_anchors(irg, init_lh_walker, build_edges_walker, &w);
+		irg_walk_anchors(irg, NULL, build_edges_walker, &w);
 	}
 }
 
@@ -498,7 +540,6 @@ void edges_deactivate_kind(ir_graph *irg, ir_edge_kind_t kind)
 	info->activated = 0;
 	if (info->allocated) {
 		obstack_free(&info->edges_obst, NULL);
-		ir_edgeset_destroy(&info->edges);
 		info->allocated = 0;
 	}
 	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
@@ -549,21 +590,31 @@ void edges_reroute_except(ir_node *from, ir_node *to, ir_node *exception)
 
 static void verify_set_presence(ir_node *irn, void *data)
 {
-	build_walker *w     = (build_walker*)data;
-	ir_graph     *irg   = get_irn_irg(irn);
-	ir_edgeset_t *edges = &get_irg_edge_info(irg, w->kind)->edges;
+	build_walker    *w     = (build_walker*)data;
+	irn_edge_info_t *info  = get_irn_edge_info(irn, w->kind);
+	int              first = edge_kind_info[w->kind].first_idx;
+	int              arity = edge_kind_info[w->kind].get_arity(irn);
 
-	foreach_tgt(irn, i, n, w->kind) {
-		ir_edge_t  templ = { .src = irn, .pos = i };
-		ir_edge_t *e     = ir_edgeset_find(edges, &templ);
-		ir_node   *dst   = get_n(irn, i, w->kind);
-		if (dst == NULL)
+	for (unsigned i = 0, n = info->n_slots; i < n; ++i) {
+		ir_edge_t *e = info->slots[i];
+		if (e == NULL)
 			continue;
-		if (e != NULL) {
-#ifdef DEBUG_libfirm
-			e->present = true;
-#endif
-		} else {
+		int      pos = (int)i - 1;
+		ir_node *dst = first <= pos && pos < arity ? get_n(irn, pos, w->kind) : NULL;
+		if (e->src != irn || e->pos != pos) {
+			w->fine = false;
+			ir_fprintf(stderr, "Edge Verifier: edge(%ld) %+F,%d is in slot %+F,%d\n",
+			           edge_get_id(e), e->src, e->pos, irn, pos);
+		} else if (dst == NULL) {
+			w->fine = false;
+			ir_fprintf(stderr, "Edge Verifier: edge(%ld) %+F,%d is superfluous\n",
+			           edge_get_id(e), irn, pos);
+		}
+	}
+
+	foreach_tgt(irn, i, n, w->kind) {
+		ir_edge_t **slot = find_edge_slot(irn, i, w->kind);
+		if (get_n(irn, i, w->kind) != NULL && (slot == NULL || *slot == NULL)) {
 			w->fine = false;
 			ir_fprintf(stderr, "Edge Verifier: %+F,%d is missing\n",
 			           irn, i);
@@ -575,8 +626,6 @@ static void verify_list_presence(ir_node *irn, void *data)
 {
 	build_walker *w = (build_walker*)data;
 
-	bitset_set(w->reachable, get_irn_idx(irn));
-
 	/* check list heads */
 	verify_list_head(irn, w->kind);
 
@@ -599,36 +648,10 @@ static void verify_list_presence(ir_node *irn, void *data)
 
 int edges_verify_kind(ir_graph *irg, ir_edge_kind_t kind)
 {
-	struct build_walker    w     = { .kind      = kind,
-	                                 .reachable = bitset_alloca(get_irg_last_idx(irg)),
-	                                 .fine      = true };
-
-#ifdef DEBUG_libfirm
-	ir_edgeset_t          *edges = &get_irg_edge_info(irg, kind)->edges;
-	ir_edge_t             *e;
-	ir_edgeset_iterator_t iter;
-	/* Clear the present bit in all edges available. */
-	foreach_ir_edgeset(edges, e, iter) {
-		e->present = false;
-	}
-#endif
+	struct build_walker w = { .kind = kind, .fine = true };
 
 	irg_walk_graph(irg, verify_set_presence, verify_list_presence, &w);
 
-#ifdef DEBUG_libfirm
-	/*
-	 * Dump all edges which are not invalid and not present.
-	 * These edges are superfluous and their presence in the
-	 * edge set is wrong.
-	 */
-	foreach_ir_edgeset(edges, e, iter) {
-		if (! e->present && bitset_is_set(w.reachable, get_irn_idx(e->src))) {
-			w.fine = false;
-			ir_fprintf(stderr, "Edge Verifier: edge(%ld) %+F,%d is superfluous\n", edge_get_id(e), e->src, e->pos);
-		}
-	}
-#endif
-
 	return w.fine;
 }
 
@@ -37,10 +37,7 @@
  */
 struct ir_edge_t {
 	ir_node *src;         /**< The source node of the edge. */
-	int      pos;         /**< The position of the edge at @p src. */
-#ifdef DEBUG_libfirm
-	bool     present : 1; /**< Used by the verifier. */
-#endif
+	int      pos;           /**< The position of the edge at @p src. */
 	struct list_head list;  /**< The list head to queue all out edges at a node. */
 };
 
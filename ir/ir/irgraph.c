@@ -20,12 +20,14 @@
 #include "irgwalk.h"
 #include "irhooks.h"
 #include "irmemory.h"
+#include "irnodemap.h"
 #include "irnode_t.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
 #include "irouts.h"
 #include "irprog_t.h"
 #include "irtools.h"
+#include "panic.h"
 #include "type_t.h"
 #include "util.h"
 #include "xmalloc.h"
@@ -77,6 +79,9 @@ static void free_graph(ir_graph *irg)
 	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i)
 		edges_deactivate_kind(irg, i);
 	DEL_ARR_F(irg->idx_irn_map);
+	irg_clear_free_nodes(irg);
+	if (irg->renumber_listeners != NULL)
+		DEL_ARR_F(irg->renumber_listeners);
 	free(irg);
 }
 
@@ -271,6 +276,8 @@ void free_ir_graph(ir_graph *irg)
 {
 	assert(irg->kind == k_ir_graph);
 
+	/* buffered hook events may refer to nodes of the graph */
+	hook_flush_batches();
 	remove_irp_irg(irg);
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
 
@@ -617,3 +624,53 @@ void confirm_irg_properties(ir_graph *irg, ir_graph_properties_t props)
 	if (!(props & IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS))
 		ir_free_dominance_frontiers(irg);
 }
+
+void irg_add_renumber_listener(ir_graph *irg, irg_renumber_func *func,
+                               void *data)
+{
+	if (irg->renumber_listeners == NULL)
+		irg->renumber_listeners = NEW_ARR_F(irg_renumber_listener_t, 0);
+	irg_renumber_listener_t const listener = { func, data };
+	ARR_APP1(irg_renumber_listener_t, irg->renumber_listeners, listener);
+}
+
+void irg_remove_renumber_listener(ir_graph *irg, irg_renumber_func *func,
+                                  void *data)
+{
+	irg_renumber_listener_t *const listeners = irg->renumber_listeners;
+	for (size_t i = 0, n = ARR_LEN(listeners); i < n; ++i) {
+		if (listeners[i].func == func && listeners[i].data == data) {
+			listeners[i] = listeners[n - 1];
+			ARR_SHRINKLEN(listeners, n - 1);
+			return;
+		}
+	}
+	panic("side table not registered");
+}
+
+void irg_notify_renumber(ir_graph *irg, unsigned const *new_idx,
+                         unsigned n_old)
+{
+	if (irg->renumber_listeners == NULL)
+		return;
+	for (size_t i = 0, n = ARR_LEN(irg->renumber_listeners); i < n; ++i) {
+		irg_renumber_listener_t const *const listener
+			= &irg->renumber_listeners[i];
+		listener->func(listener->data, irg, new_idx, n_old);
+	}
+}
+
+void ir_nodemap_renumber(void *data, ir_graph *irg, unsigned const *new_idx,
+                         unsigned n_old)
+{
+	ir_nodemap *const nodemap  = (ir_nodemap*)data;
+	void      **const new_data = NEW_ARR_FZ(void*, get_irg_last_idx(irg) + 32);
+	size_t      const len      = MIN(ARR_LEN(nodemap->data), (size_t)n_old);
+	for (size_t i = 0; i < len; ++i) {
+		unsigned const idx = new_idx[i];
+		if (idx != IRG_NO_IDX)
+			new_data[idx] = nodemap->data[i];
+	}
+	DEL_ARR_F(nodemap->data);
+	nodemap->data = new_data;
+}
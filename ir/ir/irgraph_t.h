@@ -16,7 +16,7 @@
 #include "entity_t.h"
 #include "firm_types.h"
 #include "iredgekinds.h"
-#include "iredgeset.h"
+#include "irhooks.h"
 #include "irloop.h"
 #include "irnodemap.h"
 #include "irprog.h"
@@ -24,6 +24,7 @@
 #include "obst.h"
 #include "pset.h"
 #include "type_t.h"
+#include <string.h>
 
 #define get_irg_start_block(irg)              get_irg_start_block_(irg)
 #define set_irg_start_block(irg, node)        set_irg_start_block_(irg, node)
@@ -73,9 +74,8 @@
  * Edge info to put into an irg.
  */
 typedef struct irg_edge_info_t {
-	ir_edgeset_t     edges;          /**< A set containing all edges of the current graph. */
 	struct list_head free_edges;     /**< list of all free edges. */
-	struct obstack   edges_obst;     /**< Obstack, where edges are allocated on. */
+	struct obstack   edges_obst;     /**< Obstack, where edges and slot arrays are allocated on. */
 	unsigned         allocated : 1;  /**< Set if edges are allocated on the obstack. */
 	unsigned         activated : 1;  /**< Set if edges are activated for the graph. */
 } irg_edge_info_t;
@@ -99,6 +99,27 @@ typedef struct ir_vrp_info {
 	struct obstack    obst;
 } ir_vrp_info;
 
+/** New index of nodes that are dropped when renumbering. */
+#define IRG_NO_IDX ((unsigned)-1)
+
+/**
+ * Called when the nodes of a graph are renumbered.
+ *
+ * @param data     the data given at registration
+ * @param irg      the graph
+ * @param new_idx  maps the old indices to the new ones or IRG_NO_IDX, new
+ *                 indices keep the order of the old ones
+ * @param n_old    the number of old indices
+ */
+typedef void (irg_renumber_func)(void *data, ir_graph *irg,
+                                 unsigned const *new_idx, unsigned n_old);
+
+/** A side table indexed by node index. */
+typedef struct irg_renumber_listener_t {
+	irg_renumber_func *func;
+	void              *data;
+} irg_renumber_listener_t;
+
 /**
  * An ir_graph represents the code of a function as a graph of nodes.
  */
@@ -124,6 +145,13 @@ struct ir_graph {
 	ir_visited_t     block_visited; /**< Visited flag for block nodes. */
 	ir_visited_t     self_visited;  /**< Visited flag of the irg */
 	ir_node        **idx_irn_map;   /**< Map of node indexes to nodes. */
+	/** Memory of collected nodes indexed by node size, linked by the link
+	 * field. NULL if collect_dead_nodes() never ran on the graph. */
+	ir_node        **free_nodes;
+	/** Side tables to update when the nodes are renumbered. */
+	irg_renumber_listener_t *renumber_listeners;
+	/** Node index at which the share of reachable nodes is checked next. */
+	unsigned         compact_check_idx;
 	size_t           index;         /**< a unique number for each graph */
 	/** A void* field to link any information to the graph. */
 	void            *link;
@@ -456,6 +484,67 @@ static inline unsigned irg_register_node_idx(ir_graph *irg, ir_node *irn)
 	return idx;
 }
 
+/**
+ * Returns the size of the memory block of a node.
+ */
+static inline size_t get_node_size(ir_op const *const op)
+{
+	return offsetof(ir_node, attr) + op->attr_size;
+}
+
+/**
+ * Puts the memory of a dead node into the free lists of the graph, so
+ * new_ir_node() can reuse it.
+ */
+static inline void free_node_memory(ir_graph *irg, ir_node *n)
+{
+	size_t const size = get_node_size(n->op);
+	if (irg->free_nodes == NULL) {
+		irg->free_nodes = NEW_ARR_FZ(ir_node*, size + 1);
+	} else {
+		size_t const n_sizes = ARR_LEN(irg->free_nodes);
+		if (size >= n_sizes) {
+			ARR_RESIZE(ir_node*, irg->free_nodes, size + 1);
+			memset(&irg->free_nodes[n_sizes], 0,
+			       (size + 1 - n_sizes) * sizeof(*irg->free_nodes));
+		}
+	}
+	n->kind               = k_BAD;
+	n->link               = irg->free_nodes[size];
+	irg->free_nodes[size] = n;
+}
+
+/**
+ * Registers a side table indexed by node index, which is updated by @p func
+ * when the nodes of @p irg are renumbered.
+ */
+void irg_add_renumber_listener(ir_graph *irg, irg_renumber_func *func,
+                               void *data);
+
+/**
+ * Unregisters a side table registered with irg_add_renumber_listener().
+ */
+void irg_remove_renumber_listener(ir_graph *irg, irg_renumber_func *func,
+                                  void *data);
+
+/**
+ * Notifies the registered side tables about renumbered nodes.
+ */
+void irg_notify_renumber(ir_graph *irg, unsigned const *new_idx,
+                         unsigned n_old);
+
+/**
+ * Forgets the memory of collected nodes. Must be called before the obstack
+ * of the graph is replaced.
+ */
+static inline void irg_clear_free_nodes(ir_graph *irg)
+{
+	if (irg->free_nodes != NULL) {
+		DEL_ARR_F(irg->free_nodes);
+		irg->free_nodes = NULL;
+	}
+}
+
 /**
  * Kill a node from the irg. BEWARE: this kills
  * all later created nodes.
@@ -465,10 +554,17 @@ static inline void irg_kill_node(ir_graph *irg, ir_node *n)
 	unsigned idx = get_irn_idx(n);
 	assert(idx + 1 == irg->last_node_idx);
 
+	hook_kill_node(n);
+
 	if (idx + 1 == irg->last_node_idx)
 		--irg->last_node_idx;
 	irg->idx_irn_map[idx] = NULL;
-	obstack_free(&irg->obst, n);
+	if (irg->free_nodes != NULL) {
+		/* the node might reuse memory in the middle of the obstack */
+		free_node_memory(irg, n);
+	} else {
+		obstack_free(&irg->obst, n);
+	}
 }
 
 /**
@@ -13,6 +13,18 @@
 #include <assert.h>
 
 hook_entry_t *hooks[hook_last];
+unsigned      hooks_active;
+
+/** Global list of registered batched hooks. */
+static hook_batch_t *hook_batches[hook_last];
+
+static void update_active(hook_type_t hook)
+{
+	if (hooks[hook] != NULL || hook_batches[hook] != NULL)
+		hooks_active |= 1u << hook;
+	else
+		hooks_active &= ~(1u << hook);
+}
 
 void register_hook(hook_type_t hook, hook_entry_t *entry)
 {
@@ -25,6 +37,7 @@ void register_hook(hook_type_t hook, hook_entry_t *entry)
 
 	entry->next = hooks[hook];
 	hooks[hook] = entry;
+	update_active(hook);
 }
 
 void unregister_hook(hook_type_t hook, hook_entry_t *entry)
@@ -36,4 +49,91 @@ void unregister_hook(hook_type_t hook, hook_entry_t *entry)
 			break;
 		}
 	}
+	update_active(hook);
+}
+
+static void flush_batch(hook_type_t hook, hook_batch_t *entry)
+{
+	if (entry->n_events == 0)
+		return;
+	entry->in_flush = true;
+	entry->flush(entry->context, hook, entry->n_events, entry->events);
+	entry->in_flush = false;
+	entry->n_events = 0;
+}
+
+void register_hook_batch(hook_type_t hook, hook_batch_t *entry)
+{
+	assert(hook == hook_new_node || hook == hook_replace);
+	assert(entry->flush != NULL);
+	/* hook should not be registered yet */
+	assert(entry->next == NULL && hook_batches[hook] != entry);
+
+	entry->n_events    = 0;
+	entry->in_flush    = false;
+	entry->next        = hook_batches[hook];
+	hook_batches[hook] = entry;
+	update_active(hook);
+}
+
+void unregister_hook_batch(hook_type_t hook, hook_batch_t *entry)
+{
+	for (hook_batch_t **p = &hook_batches[hook]; *p; p = &(*p)->next) {
+		if (*p == entry) {
+			*p          = entry->next;
+			entry->next = NULL;
+			break;
+		}
+	}
+	update_active(hook);
+	flush_batch(hook, entry);
+}
+
+void hook_flush_batches(void)
+{
+	for (hook_type_t hook = hook_new_node; hook < hook_last; ++hook) {
+		for (hook_batch_t *entry = hook_batches[hook]; entry != NULL;
+		     entry = entry->next) {
+			flush_batch(hook, entry);
+		}
+	}
+}
+
+static void record_event(hook_type_t hook, ir_node *node, ir_node *new_node)
+{
+	for (hook_batch_t *entry = hook_batches[hook]; entry != NULL;
+	     entry = entry->next) {
+		assert(!entry->in_flush);
+		if (entry->n_events == HOOK_BATCH_SIZE)
+			flush_batch(hook, entry);
+		hook_event_t *event = &entry->events[entry->n_events++];
+		event->node     = node;
+		event->new_node = new_node;
+	}
+}
+
+void hook_exec_new_node(ir_node *node)
+{
+	for (hook_entry_t *p = hooks[hook_new_node]; p != NULL; p = p->next)
+		p->hook._hook_new_node(p->context, node);
+	record_event(hook_new_node, node, NULL);
+}
+
+void hook_exec_replace(ir_node *old_node, ir_node *new_node)
+{
+	for (hook_entry_t *p = hooks[hook_replace]; p != NULL; p = p->next)
+		p->hook._hook_replace(p->context, old_node, new_node);
+	record_event(hook_replace, old_node, new_node);
+}
+
+void hook_exec_kill_node(ir_node *node)
+{
+	/* No node was created after the killed one, so its event is the last one
+	 * unless the events were delivered in between. */
+	for (hook_batch_t *entry = hook_batches[hook_new_node]; entry != NULL;
+	     entry = entry->next) {
+		size_t const n_events = entry->n_events;
+		if (n_events > 0 && entry->events[n_events - 1].node == node)
+			entry->n_events = n_events - 1;
+	}
 }
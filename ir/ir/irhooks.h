@@ -11,7 +11,10 @@
 #ifndef FIRM_IR_IRHOOKS_H
 #define FIRM_IR_IRHOOKS_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
+#include "compiler.h"
 #include "firm_types.h"
 
 /**
@@ -89,25 +92,117 @@ void register_hook(hook_type_t hook, hook_entry_t *entry);
  */
 void unregister_hook(hook_type_t hook, hook_entry_t *entry);
 
+/** Number of events a batched hook entry buffers before it is flushed. */
+#define HOOK_BATCH_SIZE 256
+
+/**
+ * A buffered hook_new_node() or hook_replace() event.
+ */
+typedef struct hook_event_t {
+	ir_node *node;     /**< the new node or the replaced node */
+	ir_node *new_node; /**< the replacement for hook_replace() events */
+} hook_event_t;
+
+typedef struct hook_batch_t hook_batch_t;
+
+/**
+ * A batched hook entry: Instead of being called for every event the flush
+ * function receives the events in bulk. The events are delivered when the
+ * buffer is full, when the entry is unregistered and by
+ * hook_flush_batches(). The flush function must not create or replace
+ * nodes.
+ */
+struct hook_batch_t {
+	/** Called with the buffered events. */
+	void (*flush)(void *context, hook_type_t hook, size_t n_events,
+	              const hook_event_t *events);
+	void         *context;  /**< the context for the flush function */
+	hook_batch_t *next;     /**< needed for chaining */
+	size_t        n_events; /**< number of buffered events */
+	bool          in_flush; /**< the flush function is running */
+	hook_event_t  events[HOOK_BATCH_SIZE];
+};
+
+/**
+ * register a batched hook entry. Only hook_new_node and hook_replace
+ * support batched delivery.
+ *
+ * @param hook   the hook type
+ * @param entry  the batched hook entry
+ */
+void register_hook_batch(hook_type_t hook, hook_batch_t *entry);
+
+/**
+ * unregister a batched hook entry after flushing its pending events.
+ *
+ * @param hook   the hook type
+ * @param entry  the batched hook entry
+ */
+void unregister_hook_batch(hook_type_t hook, hook_batch_t *entry);
+
+/**
+ * Deliver the pending events of all batched hook entries. The events refer
+ * to nodes, so this must happen before the memory of their nodes is freed or
+ * reused.
+ */
+void hook_flush_batches(void);
+
 /** Global list of registerd hooks. */
 extern hook_entry_t *hooks[hook_last];
 
+/** Bitset of the hook types with at least one registered entry. */
+extern unsigned hooks_active;
+
+/** Returns true if a hook of type @p what is registered. */
+#define hook_active(what) UNLIKELY(hooks_active & (1u << (what)))
+
+/**
+ * Calls the hook_new_node entries, the fast path is in hook_new_node().
+ * Do not use this function directly.
+ */
+void hook_exec_new_node(ir_node *node);
+
+/**
+ * Calls the hook_replace entries, the fast path is in hook_replace().
+ * Do not use this function directly.
+ */
+void hook_exec_replace(ir_node *old_node, ir_node *new_node);
+
+/**
+ * Drops the pending event of a node from the batched hook_new_node entries,
+ * the fast path is in hook_kill_node(). Do not use this function directly.
+ */
+void hook_exec_kill_node(ir_node *node);
+
 /**
  * Executes the hook @p what with the args @p args
  * Do not use this macro directly.
  */
-#define hook_exec(what, args) do {             \
-	hook_entry_t *_p;                          \
-	for (_p = hooks[what]; _p; _p = _p->next){ \
-		void *hook_ctx_ = _p->context;         \
-		_p->hook._##what args;                 \
-	}                                          \
+#define hook_exec(what, args) do {                 \
+	if (hook_active(what)) {                       \
+		hook_entry_t *_p;                          \
+		for (_p = hooks[what]; _p; _p = _p->next){ \
+			void *hook_ctx_ = _p->context;         \
+			_p->hook._##what args;                 \
+		}                                          \
+	}                                              \
 } while (0)
 
 /** Called after a new node has been created */
-#define hook_new_node(node)               hook_exec(hook_new_node, (hook_ctx_, node))
+#define hook_new_node(node) do {    \
+	if (hook_active(hook_new_node)) \
+		hook_exec_new_node(node);   \
+} while (0)
 /** Called when a node is replaced */
-#define hook_replace(old, nw)             hook_exec(hook_replace, (hook_ctx_, old, nw))
+#define hook_replace(old, nw) do {  \
+	if (hook_active(hook_replace))  \
+		hook_exec_replace(old, nw); \
+} while (0)
+/** Called before a node is freed right after its creation */
+#define hook_kill_node(node) do {   \
+	if (hook_active(hook_new_node)) \
+		hook_exec_kill_node(node);  \
+} while (0)
 /** Called after a new graph has been created */
 #define hook_new_graph(irg, ent)          hook_exec(hook_new_graph, (hook_ctx_, irg, ent))
 /** Called before a node gets lowered */
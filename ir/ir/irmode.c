@@ -206,6 +206,21 @@ ir_mode *new_non_arithmetic_mode(const char *name, unsigned bit_size)
 	return register_mode(result);
 }
 
+ir_mode *new_vector_mode(const char *name, ir_mode *element,
+                         unsigned n_lanes)
+{
+	assert(mode_is_int(element) || mode_is_float(element));
+	assert(n_lanes > 1);
+	unsigned bit_size = get_mode_size_bits(element) * n_lanes;
+	ir_mode *result = alloc_mode(name, irms_data, irma_none, bit_size, 0, 0);
+	result->vector_element = element;
+	result->vector_lanes   = n_lanes;
+	ir_mode *res = register_mode(result);
+	if (res->vector_element != element || res->vector_lanes != n_lanes)
+		panic("cannot create vector mode: name %s already used", name);
+	return res;
+}
+
 static ir_mode *new_non_data_mode(const char *name)
 {
 	ir_mode *result = alloc_mode(name, irms_auxiliary, irma_none, 0, 0, 0);
@@ -310,6 +325,21 @@ int (mode_is_data)(const ir_mode *mode)
 	return mode_is_data_(mode);
 }
 
+int (mode_is_vector)(const ir_mode *mode)
+{
+	return mode_is_vector_(mode);
+}
+
+ir_mode *(get_mode_vector_element)(const ir_mode *mode)
+{
+	return get_mode_vector_element_(mode);
+}
+
+unsigned (get_mode_vector_lanes)(const ir_mode *mode)
+{
+	return get_mode_vector_lanes_(mode);
+}
+
 unsigned (get_mode_mantissa_size)(const ir_mode *mode)
 {
 	return get_mode_mantissa_size_(mode);
@@ -14,6 +14,7 @@
 
 #include "irmode.h"
 
+#include <assert.h>
 #include <stdbool.h>
 #include "compiler.h"
 #include "firm_common.h"
@@ -30,6 +31,9 @@
 #define mode_is_reference(mode)        mode_is_reference_(mode)
 #define mode_is_num(mode)              mode_is_num_(mode)
 #define mode_is_data(mode)             mode_is_data_(mode)
+#define mode_is_vector(mode)           mode_is_vector_(mode)
+#define get_mode_vector_element(mode)  get_mode_vector_element_(mode)
+#define get_mode_vector_lanes(mode)    get_mode_vector_lanes_(mode)
 #define get_type_for_mode(mode)        get_type_for_mode_(mode)
 #define get_mode_mantissa_size(mode)   get_mode_mantissa_size_(mode)
 #define get_mode_exponent_size(mode)   get_mode_exponent_size_(mode)
@@ -92,6 +96,10 @@ struct ir_mode {
 	/** For reference modes, a signed integer mode used to add/subtract
 	 * offsets. */
 	ir_mode            *offset_mode;
+	/** For vector modes, the mode of a single lane. */
+	ir_mode            *vector_element;
+	/** For vector modes, the number of lanes. */
+	unsigned            vector_lanes;
 };
 
 static inline ident *get_mode_ident_(const ir_mode *mode)
@@ -156,6 +164,23 @@ static inline int mode_is_data_(const ir_mode *mode)
 	return (get_mode_sort(mode) & irmsh_is_data) != 0;
 }
 
+static inline int mode_is_vector_(const ir_mode *mode)
+{
+	return mode->vector_element != NULL;
+}
+
+static inline ir_mode *get_mode_vector_element_(const ir_mode *mode)
+{
+	assert(mode_is_vector_(mode));
+	return mode->vector_element;
+}
+
+static inline unsigned get_mode_vector_lanes_(const ir_mode *mode)
+{
+	assert(mode_is_vector_(mode));
+	return mode->vector_lanes;
+}
+
 static inline ir_type *get_type_for_mode_(const ir_mode *mode)
 {
 	return mode->type;
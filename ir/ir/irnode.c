@@ -73,13 +73,28 @@ ir_relation get_inversed_relation(ir_relation relation)
 	return code;
 }
 
+/**
+ * Allocates the memory for a node, reusing the memory of collected nodes.
+ */
+static ir_node *alloc_node_memory(ir_graph *irg, size_t size)
+{
+	ir_node **const free_nodes = irg->free_nodes;
+	if (free_nodes != NULL && size < ARR_LEN(free_nodes)) {
+		ir_node *const res = free_nodes[size];
+		if (res != NULL) {
+			free_nodes[size] = (ir_node*)res->link;
+			return (ir_node*)memset(res, 0, size);
+		}
+	}
+	return (ir_node*)OALLOCNZ(get_irg_obstack(irg), char, size);
+}
+
 ir_node *new_ir_node(dbg_info *db, ir_graph *irg, ir_node *block, ir_op *op,
                      ir_mode *mode, int arity, ir_node *const *in)
 {
 	assert(mode != NULL);
 
-	size_t   const node_size = offsetof(ir_node, attr) + op->attr_size;
-	ir_node *const res       = (ir_node*)OALLOCNZ(get_irg_obstack(irg), char, node_size);
+	ir_node *const res = alloc_node_memory(irg, get_node_size(op));
 
 	res->kind     = k_ir_node;
 	res->op       = op;
@@ -267,6 +267,8 @@ typedef union ir_attr {
  */
 typedef struct irn_edge_kind_info_t {
 	struct list_head outs_head;  /**< The list of all outs. */
+	ir_edge_t      **slots;      /**< The edges of the inputs, indexed by position + 1. */
+	unsigned         n_slots;    /**< Length of the slots array. */
 	unsigned edges_built : 1;    /**< Set edges where built for this node. */
 	unsigned out_count   : 31;   /**< Number of outs in the list. */
 } irn_edge_info_t;
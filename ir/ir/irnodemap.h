@@ -19,6 +19,7 @@
 #include "array.h"
 #include "irnode_t.h"
 #include "irgraph_t.h"
+#include "xmalloc.h"
 
 /**
  * Allocate and initialize a new nodemap object
@@ -103,4 +104,231 @@ static inline void *ir_nodemap_get_fast(const ir_nodemap *nodemap,
 	return nodemap->data[idx];
 }
 
+/**
+ * Moves the mappings of a nodemap to the new indices of renumbered nodes.
+ * Can be used as irg_renumber_func of an ir_nodemap.
+ */
+void ir_nodemap_renumber(void *data, ir_graph *irg, unsigned const *new_idx,
+                         unsigned n_old);
+
+/**
+ * @name Sparse nodemap
+ * A nodemap which splits the node-index space into pages that are only
+ * allocated when something is mapped into them.  It is preferable over
+ * ir_nodemap if only a part of the nodes (blocks for example) gets mapped,
+ * and over ir_nodehashmap because lookups do not hash.
+ * @{
+ */
+
+#define IR_NODEMAP_PAGE_SHIFT 8
+#define IR_NODEMAP_PAGE_SIZE  (1u << IR_NODEMAP_PAGE_SHIFT)
+
+/** Returns the number of pages needed for the nodes of @p irg. */
+static inline unsigned ir_nodemap_n_pages(const ir_graph *irg)
+{
+	return (get_irg_last_idx(irg) >> IR_NODEMAP_PAGE_SHIFT) + 1;
+}
+
+/**
+ * Initialize a sparse nodemap. No pages are allocated yet.
+ */
+static inline void ir_sparse_nodemap_init(ir_sparse_nodemap *nodemap,
+                                          const ir_graph *irg)
+{
+	nodemap->pages = NEW_ARR_FZ(void**, ir_nodemap_n_pages(irg));
+}
+
+/**
+ * Frees all internal memory used by the sparse nodemap.
+ */
+static inline void ir_sparse_nodemap_destroy(ir_sparse_nodemap *nodemap)
+{
+	for (size_t i = 0, n = ARR_LEN(nodemap->pages); i < n; ++i)
+		free(nodemap->pages[i]);
+	DEL_ARR_F(nodemap->pages);
+	nodemap->pages = NULL;
+}
+
+/**
+ * Insert a mapping from @p node to @p data.
+ */
+static inline void ir_sparse_nodemap_insert(ir_sparse_nodemap *nodemap,
+                                            const ir_node *node, void *data)
+{
+	unsigned idx    = get_irn_idx(node);
+	unsigned page_n = idx >> IR_NODEMAP_PAGE_SHIFT;
+	size_t   len    = ARR_LEN(nodemap->pages);
+	if (page_n >= len) {
+		ARR_RESIZE(void**, nodemap->pages, page_n + 1);
+		memset(nodemap->pages + len, 0,
+		       (page_n + 1 - len) * sizeof(nodemap->pages[0]));
+	}
+	void **page = nodemap->pages[page_n];
+	if (page == NULL) {
+		page = XMALLOCNZ(void*, IR_NODEMAP_PAGE_SIZE);
+		nodemap->pages[page_n] = page;
+	}
+	page[idx & (IR_NODEMAP_PAGE_SIZE - 1)] = data;
+}
+
+/**
+ * Get mapping for @p node. Returns NULL if nothing is mapped.
+ */
+static inline void *ir_sparse_nodemap_get(const ir_sparse_nodemap *nodemap,
+                                          const ir_node *node)
+{
+	unsigned idx    = get_irn_idx(node);
+	unsigned page_n = idx >> IR_NODEMAP_PAGE_SHIFT;
+	if (page_n >= ARR_LEN(nodemap->pages))
+		return NULL;
+	void **page = nodemap->pages[page_n];
+	if (page == NULL)
+		return NULL;
+	return page[idx & (IR_NODEMAP_PAGE_SIZE - 1)];
+}
+
+#define ir_sparse_nodemap_get(type, nodemap, node) \
+	((type*)ir_sparse_nodemap_get(nodemap, node))
+
+/** @} */
+
+/**
+ * @name Sparse nodeset
+ * A set of nodes with constant time insert, remove and membership test and
+ * iteration proportional to the number of elements.  The elements are kept
+ * in an array, the position of each element is found through lazily
+ * allocated pages indexed by the node index.
+ * @{
+ */
+
+/**
+ * Initialize a sparse nodeset.
+ */
+static inline void ir_sparse_nodeset_init(ir_sparse_nodeset *nodeset,
+                                          const ir_graph *irg)
+{
+	nodeset->pages = NEW_ARR_FZ(unsigned*, ir_nodemap_n_pages(irg));
+	nodeset->nodes = NEW_ARR_F(ir_node*, 0);
+}
+
+/**
+ * Frees all internal memory used by the sparse nodeset.
+ */
+static inline void ir_sparse_nodeset_destroy(ir_sparse_nodeset *nodeset)
+{
+	for (size_t i = 0, n = ARR_LEN(nodeset->pages); i < n; ++i)
+		free(nodeset->pages[i]);
+	DEL_ARR_F(nodeset->pages);
+	DEL_ARR_F(nodeset->nodes);
+	nodeset->pages = NULL;
+	nodeset->nodes = NULL;
+}
+
+/**
+ * Returns the slot holding the position of @p node or NULL if there is no
+ * page for it.
+ */
+static inline unsigned *ir_sparse_nodeset_slot(
+		const ir_sparse_nodeset *nodeset, const ir_node *node)
+{
+	unsigned idx    = get_irn_idx(node);
+	unsigned page_n = idx >> IR_NODEMAP_PAGE_SHIFT;
+	if (page_n >= ARR_LEN(nodeset->pages))
+		return NULL;
+	unsigned *page = nodeset->pages[page_n];
+	if (page == NULL)
+		return NULL;
+	return &page[idx & (IR_NODEMAP_PAGE_SIZE - 1)];
+}
+
+/**
+ * Tests whether @p node is an element of the set.
+ */
+static inline bool ir_sparse_nodeset_contains(const ir_sparse_nodeset *nodeset,
+                                              const ir_node *node)
+{
+	unsigned const *slot = ir_sparse_nodeset_slot(nodeset, node);
+	if (slot == NULL)
+		return false;
+	unsigned pos = *slot;
+	return pos < ARR_LEN(nodeset->nodes) && nodeset->nodes[pos] == node;
+}
+
+/**
+ * Inserts @p node into the set.
+ * @returns true if the node was not an element of the set before
+ */
+static inline bool ir_sparse_nodeset_insert(ir_sparse_nodeset *nodeset,
+                                            ir_node *node)
+{
+	if (ir_sparse_nodeset_contains(nodeset, node))
+		return false;
+
+	unsigned *slot = ir_sparse_nodeset_slot(nodeset, node);
+	if (slot == NULL) {
+		unsigned idx    = get_irn_idx(node);
+		unsigned page_n = idx >> IR_NODEMAP_PAGE_SHIFT;
+		size_t   len    = ARR_LEN(nodeset->pages);
+		if (page_n >= len) {
+			ARR_RESIZE(unsigned*, nodeset->pages, page_n + 1);
+			memset(nodeset->pages + len, 0,
+			       (page_n + 1 - len) * sizeof(nodeset->pages[0]));
+		}
+		unsigned *page = XMALLOCNZ(unsigned, IR_NODEMAP_PAGE_SIZE);
+		nodeset->pages[page_n] = page;
+		slot = &page[idx & (IR_NODEMAP_PAGE_SIZE - 1)];
+	}
+	*slot = ARR_LEN(nodeset->nodes);
+	ARR_APP1(ir_node*, nodeset->nodes, node);
+	return true;
+}
+
+/**
+ * Removes @p node from the set.  The last element takes the position of the
+ * removed one, so removing elements invalidates running iterations.
+ * @returns true if the node was an element of the set
+ */
+static inline bool ir_sparse_nodeset_remove(ir_sparse_nodeset *nodeset,
+                                            const ir_node *node)
+{
+	if (!ir_sparse_nodeset_contains(nodeset, node))
+		return false;
+
+	unsigned pos  = *ir_sparse_nodeset_slot(nodeset, node);
+	size_t   last = ARR_LEN(nodeset->nodes) - 1;
+	ir_node *moved = nodeset->nodes[last];
+	nodeset->nodes[pos] = moved;
+	*ir_sparse_nodeset_slot(nodeset, moved) = pos;
+	ARR_SHRINKLEN(nodeset->nodes, last);
+	return true;
+}
+
+/**
+ * Removes all elements from the set.  Takes constant time, the pages are kept
+ * for reuse.
+ */
+static inline void ir_sparse_nodeset_clear(ir_sparse_nodeset *nodeset)
+{
+	ARR_SHRINKLEN(nodeset->nodes, 0);
+}
+
+/**
+ * Returns the number of elements in the set.
+ */
+static inline size_t ir_sparse_nodeset_size(const ir_sparse_nodeset *nodeset)
+{
+	return ARR_LEN(nodeset->nodes);
+}
+
+/**
+ * Iterates over all elements of the set.  The set must not be modified
+ * while iterating.
+ */
+#define foreach_ir_sparse_nodeset(nodeset, irn) \
+	for (ir_node **irn##_iter = (nodeset)->nodes, \
+	     **irn##_end = irn##_iter + ARR_LEN((nodeset)->nodes), *irn; \
+	     irn##_iter != irn##_end && (irn = *irn##_iter, true); ++irn##_iter)
+
+/** @} */
+
 #endif
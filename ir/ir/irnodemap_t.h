@@ -15,4 +15,14 @@ typedef struct ir_nodemap {
 	void **data;
 } ir_nodemap;
 
+typedef struct ir_sparse_nodemap {
+	void ***pages; /**< ARR_F of lazily allocated pages */
+} ir_sparse_nodemap;
+
+typedef struct ir_sparse_nodeset {
+	unsigned **pages; /**< ARR_F of lazily allocated pages mapping node
+	                       indices to positions in nodes */
+	ir_node  **nodes; /**< ARR_F of the elements */
+} ir_sparse_nodeset;
+
 #endif
@@ -557,3 +557,11 @@ void ir_create_execfreqs_from_profile(void)
 		ir_set_execfreqs_from_profile(irg);
 	}
 }
+
+void ir_profile_set_execfreqs(ir_graph *irg)
+{
+	if (profile != NULL)
+		ir_set_execfreqs_from_profile(irg);
+	else
+		ir_estimate_execfreq(irg);
+}
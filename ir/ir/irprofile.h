@@ -47,4 +47,10 @@ uint32_t ir_profile_get_block_execcount(const ir_node *block);
  */
 void ir_create_execfreqs_from_profile(void);
 
+/**
+ * Sets the execution frequencies of @p irg from the profile data if a
+ * profile was read, estimates them otherwise.
+ */
+void ir_profile_set_execfreqs(ir_graph *irg);
+
 #endif
@@ -11,6 +11,10 @@
 #include "irtools.h"
 
 #include "irbackedge_t.h"
+#include "ircons.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
 #include "irnode_t.h"
 #include "iropt_t.h"
 #include "irprintf.h"
@@ -71,3 +75,134 @@ void irn_rewire_inputs(ir_node *node)
 	/* Now the new node is complete. We can add it to the hash table for CSE. */
 	add_identities(new_node);
 }
+
+/** The second definition of a value during SSA construction. */
+typedef struct ssa_second_def_t {
+	ir_node *block; /**< the block of the definition or NULL */
+	ir_node *value;
+} ssa_second_def_t;
+
+static ir_node *search_def_and_create_phis(ssa_second_def_t const *second,
+                                           ir_node *block, ir_mode *mode,
+                                           bool first)
+{
+	assert(is_Block(block));
+
+	/* the other defs can't be marked for cases where a user of the original
+	 * value is in the same block as the alternative definition.
+	 * In this case we mustn't use the alternative definition.
+	 * So we keep a flag that indicated whether we walked at least 1 block
+	 * away and may use the alternative definition */
+	if (block == second->block && !first)
+		return second->value;
+
+	/* already processed this block? */
+	if (irn_visited(block))
+		return (ir_node*)get_irn_link(block);
+
+	ir_graph *irg = get_irn_irg(block);
+	assert(block != get_irg_start_block(irg));
+
+	/* a Block with only 1 predecessor needs no Phi */
+	int n_cfgpreds = get_Block_n_cfgpreds(block);
+	if (n_cfgpreds == 1) {
+		ir_node *pred_block = get_Block_cfgpred_block(block, 0);
+		ir_node *value;
+		if (pred_block == NULL) {
+			value = new_r_Bad(irg, mode);
+		} else {
+			value = search_def_and_create_phis(second, pred_block, mode,
+			                                   false);
+		}
+		set_irn_link(block, value);
+		mark_irn_visited(block);
+		return value;
+	}
+
+	/* create a new Phi */
+	ir_node **in    = ALLOCAN(ir_node*, n_cfgpreds);
+	ir_node  *dummy = new_r_Dummy(irg, mode);
+	for (int i = 0; i < n_cfgpreds; ++i) {
+		in[i] = dummy;
+	}
+
+	/* we might have created a potential endless loop, and need a PhiLoop */
+	ir_node *phi = mode == mode_M ? new_r_Phi_loop(block, n_cfgpreds, in)
+	                              : new_r_Phi(block, n_cfgpreds, in, mode);
+	set_irn_link(block, phi);
+	mark_irn_visited(block);
+
+	/* set Phi predecessors */
+	for (int i = 0; i < n_cfgpreds; ++i) {
+		ir_node *pred_block = get_Block_cfgpred_block(block, i);
+		ir_node *pred_val;
+		if (pred_block == NULL) {
+			pred_val = new_r_Bad(irg, mode);
+		} else {
+			pred_val = search_def_and_create_phis(second, pred_block, mode,
+			                                      false);
+		}
+		set_irn_n(phi, i, pred_val);
+	}
+	/* the placeholder might be shared with a Phi under construction */
+	if (get_irn_n_edges(dummy) == 0)
+		kill_node(dummy);
+
+	return phi;
+}
+
+void irn_construct_ssa(ir_node *orig_block, ir_node *orig_val,
+                       ir_node *second_block, ir_node *second_val)
+{
+	/* no need to do anything */
+	if (orig_val == second_val && !(is_Phi(orig_val) && get_Phi_loop(orig_val)))
+		return;
+
+	ir_graph *irg = get_irn_irg(orig_val);
+	inc_irg_visited(irg);
+
+	ir_mode *mode = get_irn_mode(orig_val);
+	set_irn_link(orig_block, orig_val);
+	mark_irn_visited(orig_block);
+
+	/* In the loop-phi case setting a 2nd def is wrong */
+	ssa_second_def_t second = { NULL, NULL };
+	if (orig_val != second_val) {
+		second.block = second_block;
+		second.value = second_val;
+	}
+
+	/* Only fix the users of the first, i.e. the original node */
+	foreach_out_edge_safe(orig_val, edge) {
+		ir_node *user = get_edge_src_irn(edge);
+		/* ignore keeps */
+		if (is_End(user))
+			continue;
+
+		int      j          = get_edge_src_pos(edge);
+		ir_node *user_block = get_nodes_block(user);
+		ir_node *newval;
+		if (is_Phi(user)) {
+			ir_node *pred_block = get_Block_cfgpred_block(user_block, j);
+			if (pred_block == NULL) {
+				newval = new_r_Bad(irg, mode);
+			} else {
+				newval = search_def_and_create_phis(&second, pred_block, mode,
+				                                    true);
+			}
+		} else {
+			newval = search_def_and_create_phis(&second, user_block, mode,
+			                                    true);
+		}
+
+		/* don't fix newly created Phis from the SSA construction */
+		if (newval != user) {
+			set_irn_n(user, j, newval);
+			if (is_Phi(user) && get_irn_mode(user) == mode_M && !get_Phi_loop(user)) {
+				set_Phi_loop(user, true);
+				keep_alive(user);
+				keep_alive(user_block);
+			}
+		}
+	}
+}
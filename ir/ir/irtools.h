@@ -58,4 +58,15 @@ void firm_collect_block_phis(ir_node *node, void *env);
  */
 void irn_rewire_inputs(ir_node *node);
 
+/**
+ * Constructs SSA form for the users of @p orig_val, which is defined in
+ * @p orig_block, after a copy @p second_val of it has been placed in
+ * @p second_block. Each user gets the definition that reaches it, Phis are
+ * created where both definitions meet. The users are determined through the
+ * out edges of @p orig_val. Uses the visited flags and the links of the
+ * blocks, but not the dominance tree.
+ */
+void irn_construct_ssa(ir_node *orig_block, ir_node *orig_val,
+                       ir_node *second_block, ir_node *second_val);
+
 #endif
@@ -23,7 +23,9 @@
 #include "irop_t.h"
 #include "irouts.h"
 #include "irprintf.h"
-#include "irprog.h"
+#include "irprog_t.h"
+#include "hashptr.h"
+#include "typerep.h"
 
 static void warn(const ir_node *n, const char *format, ...)
 {
@@ -847,6 +849,42 @@ static int verify_node_Bitcast(const ir_node *n)
 	return fine;
 }
 
+static int mode_is_num_vector(const ir_mode *mode)
+{
+	return mode_is_vector(mode) && mode_is_num(get_mode_vector_element(mode));
+}
+
+static int mode_is_int_vector(const ir_mode *mode)
+{
+	return mode_is_vector(mode) && mode_is_int(get_mode_vector_element(mode));
+}
+
+static int verify_node_vector_num(const ir_node *n)
+{
+	bool fine = check_mode_func(n, mode_is_num_vector, "numeric vector");
+	fine &= check_mode_same_input(n, 0, "left");
+	fine &= check_mode_same_input(n, 1, "right");
+	return fine;
+}
+
+static int verify_node_vector_int(const ir_node *n)
+{
+	bool fine = check_mode_func(n, mode_is_int_vector, "int vector");
+	fine &= check_mode_same_input(n, 0, "left");
+	fine &= check_mode_same_input(n, 1, "right");
+	return fine;
+}
+
+static int verify_node_VSplat(const ir_node *n)
+{
+	bool fine = check_mode_func(n, mode_is_vector, "vector");
+	if (fine) {
+		ir_mode *element = get_mode_vector_element(get_irn_mode(n));
+		fine &= check_input_mode(n, n_VSplat_op, "op", element);
+	}
+	return fine;
+}
+
 static int mode_is_dataMb(const ir_mode *mode)
 {
 	return mode_is_data(mode) || mode == mode_M;
@@ -1302,6 +1340,55 @@ void irg_assert_verify(ir_graph *irg)
 	}
 }
 
+/** Fraction of verifications performed, in 1/1000. */
+static unsigned verify_sampling = 1000;
+
+void ir_set_verify_sampling(unsigned per_mille)
+{
+	verify_sampling = per_mille < 1000 ? per_mille : 1000;
+}
+
+unsigned ir_get_verify_sampling(void)
+{
+	return verify_sampling;
+}
+
+int ir_verify_selected(const ir_graph *irg, const char *pass)
+{
+	if (verify_sampling >= 1000)
+		return true;
+	if (verify_sampling == 0)
+		return false;
+
+	/* The decision only depends on the names, so the same graphs get
+	 * verified in every run and different passes pick different graphs. */
+	ir_entity const *ent  = get_irg_entity(irg);
+	unsigned         hash = hash_str(get_entity_ld_name(ent));
+	if (pass != NULL)
+		hash = hash_combine(hash, hash_str(pass));
+	/* the low bits of FNV hashes of similar names are poorly distributed */
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bU;
+	hash ^= hash >> 13;
+	return hash % 1000 < verify_sampling;
+}
+
+int irg_verify_sampled(ir_graph *irg, const char *pass)
+{
+	if (!ir_verify_selected(irg, pass))
+		return true;
+	return irg_verify(irg);
+}
+
+int irp_verify(const char *pass)
+{
+	int fine = tr_verify();
+	foreach_irp_irg(i, irg) {
+		fine &= irg_verify_sampled(irg, pass);
+	}
+	return fine;
+}
+
 void ir_register_verify_node_ops(void)
 {
 	set_op_verify(op_Add,      verify_node_Add);
@@ -1349,6 +1436,13 @@ void ir_register_verify_node_ops(void)
 	set_op_verify(op_Sub,      verify_node_Sub);
 	set_op_verify(op_Switch,   verify_node_Switch);
 	set_op_verify(op_Sync,     verify_node_Sync);
+	set_op_verify(op_VAdd,     verify_node_vector_num);
+	set_op_verify(op_VAnd,     verify_node_vector_int);
+	set_op_verify(op_VEor,     verify_node_vector_int);
+	set_op_verify(op_VMul,     verify_node_vector_num);
+	set_op_verify(op_VOr,      verify_node_vector_int);
+	set_op_verify(op_VSplat,   verify_node_VSplat);
+	set_op_verify(op_VSub,     verify_node_vector_num);
 
 	set_op_verify_proj(op_Alloc,  verify_node_Proj_Alloc);
 	set_op_verify_proj(op_Call,   verify_node_Proj_Call);
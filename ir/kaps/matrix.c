@@ -127,6 +127,11 @@ num pbqp_matrix_get_col_min(pbqp_matrix_t *matrix, unsigned col_index, vector_t
 
 		if (elem < min) {
 			min = elem;
+#if KAPS_USE_UNSIGNED
+			/* Costs are never negative, so nothing beats zero. */
+			if (min == 0)
+				break;
+#endif
 		}
 	}
 
@@ -193,6 +198,11 @@ num pbqp_matrix_get_row_min(pbqp_matrix_t *matrix, unsigned row_index, vector_t
 
 		if (elem < min) {
 			min = elem;
+#if KAPS_USE_UNSIGNED
+			/* Costs are never negative, so nothing beats zero. */
+			if (min == 0)
+				break;
+#endif
 		}
 	}
 
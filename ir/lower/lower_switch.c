@@ -9,6 +9,7 @@
  * @author  Moritz Kroll
  */
 #include "array.h"
+#include "execfreq.h"
 #include "ircons.h"
 #include "irgopt.h"
 #include "irgwalk.h"
@@ -18,6 +19,9 @@
 #include "lowering.h"
 #include "panic.h"
 #include "util.h"
+#include "xmalloc.h"
+#include <float.h>
+#include <math.h>
 #include <stdbool.h>
 
 typedef struct walk_env_t {
@@ -28,19 +32,44 @@ typedef struct walk_env_t {
 	bool          changed;    /**< indicates whether a change was performed */
 } walk_env_t;
 
+/** Up to this many clusters are tested one after the other, more are split
+ * into a search tree. */
+#define MAX_CHAIN_CLUSTERS   2
+/** Maximum number of different targets handled by one bit test cluster. */
+#define MAX_BIT_TEST_TARGETS 3
+
 typedef struct target_t {
-	ir_node *block;     /**< block that is targetted */
-	uint16_t n_entries; /**< number of table entries targetting this block */
-	uint16_t i;
+	ir_node  *block;     /**< block that is targetted */
+	ir_node **preds;     /**< new control flow predecessors of the block */
+	unsigned  n_entries; /**< number of table entries targetting this block */
+	double    weight;    /**< execution weight of a single table entry */
 } target_t;
 
+typedef enum cluster_kind_t {
+	CLUSTER_CASE,       /**< a single table entry tested by a compare */
+	CLUSTER_JUMP_TABLE, /**< a dense range of entries lowered to a Switch */
+	CLUSTER_BIT_TEST,   /**< entries with few targets tested by bit masks */
+} cluster_kind_t;
+
+/** A run of consecutive switch table entries lowered together. */
+typedef struct cluster_t {
+	cluster_kind_t               kind;
+	const ir_switch_table_entry *entries;   /**< first entry of the cluster */
+	unsigned                     n_entries;
+	ir_tarval                   *min;
+	ir_tarval                   *max;
+	double                       weight;    /**< execution weight */
+} cluster_t;
+
 typedef struct switch_info_t {
+	walk_env_t  *env;
 	ir_node     *switchn;
 	ir_tarval   *switch_min;
 	ir_tarval   *switch_max;
 	ir_node     *default_block;
 	unsigned     num_cases;
 	target_t    *targets;
+	cluster_t   *clusters;
 	ir_node    **defusers;    /**< the Projs pointing to the default case */
 } switch_info_t;
 
@@ -105,6 +134,22 @@ static void analyse_switch1(switch_info_t *info)
 		++target->n_entries;
 	}
 
+	/* every table entry gets its share of the execution frequency of its
+	 * target, fall back to equal weights if no frequencies are known */
+	bool have_freqs = false;
+	for (unsigned pn = 0; pn < n_outs; ++pn) {
+		target_t *target = &targets[pn];
+		if (target->block != NULL && target->n_entries > 0) {
+			double freq = get_block_execfreq(target->block);
+			target->weight = freq / target->n_entries;
+			have_freqs |= freq > 0.0;
+		}
+	}
+	if (!have_freqs) {
+		for (unsigned pn = 0; pn < n_outs; ++pn)
+			targets[pn].weight = 1.0;
+	}
+
 	info->default_block = targets[pn_Switch_default].block;
 	info->targets       = targets;
 }
@@ -269,6 +314,16 @@ static bool normalize_switch(switch_info_t *info, ir_mode *selector_mode)
 	return true;
 }
 
+/**
+ * Returns max - min as unsigned value.
+ */
+static ir_tarval *get_range(ir_tarval *min, ir_tarval *max)
+{
+	ir_mode *mode = find_unsigned_mode(get_tarval_mode(min));
+	return tarval_sub(tarval_convert_to(max, mode),
+	                  tarval_convert_to(min, mode));
+}
+
 /**
  * Create an if (selector == caseval) Cond node (and handle the special case
  * of ranged cases)
@@ -277,98 +332,421 @@ static ir_node *create_case_cond(const ir_switch_table_entry *entry,
                                  dbg_info *dbgi, ir_node *block,
                                  ir_node *selector)
 {
-	ir_graph *irg      = get_irn_irg(block);
-	ir_node  *minconst = new_r_Const(irg, entry->min);
-
+	ir_graph *irg = get_irn_irg(block);
 	ir_node  *cmp;
 	if (entry->min == entry->max) {
+		ir_node *minconst = new_r_Const(irg, entry->min);
 		cmp = new_rd_Cmp(dbgi, block, selector, minconst, ir_relation_equal);
 	} else {
-		ir_tarval *adjusted_max = tarval_sub(entry->max, entry->min);
-		ir_node   *sub          = new_rd_Sub(dbgi, block, selector, minconst);
+		/* the range check has to be done unsigned */
+		ir_mode   *mode         = find_unsigned_mode(get_irn_mode(selector));
+		ir_node   *conv         = new_rd_Conv(dbgi, block, selector, mode);
+		ir_tarval *min          = tarval_convert_to(entry->min, mode);
+		ir_node   *umin         = new_r_Const(irg, min);
+		ir_tarval *adjusted_max = get_range(entry->min, entry->max);
+		ir_node   *sub          = new_rd_Sub(dbgi, block, conv, umin);
 		ir_node   *maxconst     = new_r_Const(irg, adjusted_max);
 		cmp = new_rd_Cmp(dbgi, block, sub, maxconst, ir_relation_less_equal);
 	}
 	return new_rd_Cond(dbgi, block, cmp);
 }
 
-static void connect_to_target(target_t *target, ir_node *cf)
+static void add_target_pred(switch_info_t *info, unsigned pn, ir_node *cf)
+{
+	target_t *target = &info->targets[pn];
+	if (target->preds == NULL)
+		target->preds = NEW_ARR_F(ir_node*, 0);
+	ARR_APP1(ir_node*, target->preds, cf);
+}
+
+/**
+ * Checks whether a jump table covering @p range with @p n_entries entries
+ * wastes less than spare_size table slots.
+ */
+static bool is_dense(const walk_env_t *env, ir_tarval *range,
+                     size_t n_entries)
+{
+	ir_mode   *mode  = get_tarval_mode(range);
+	ir_tarval *used  = new_tarval_from_long(n_entries - 1, mode);
+	ir_tarval *spare = tarval_sub(range, used);
+	return tarval_is_long(spare) && get_tarval_long(spare) < (long)env->spare_size;
+}
+
+/**
+ * Checks whether a bit test is cheaper than comparing @p n_entries entries
+ * with @p n_targets different targets one after the other.  The range of
+ * the entries must fit into a machine word.
+ */
+static bool is_bit_test(size_t n_entries, unsigned n_targets)
+{
+	switch (n_targets) {
+	case 1:  return n_entries >= 3;
+	case 2:  return n_entries >= 5;
+	case 3:  return n_entries >= 6;
+	default: return false;
+	}
+}
+
+/**
+ * Partitions the (sorted) switch table into jump table clusters, bit test
+ * clusters and single cases.
+ */
+static void create_clusters(switch_info_t *info)
+{
+	const walk_env_t            *env     = info->env;
+	const ir_switch_table       *table   = get_Switch_table(info->switchn);
+	const ir_switch_table_entry *entries = table->entries;
+	size_t                       n       = ir_switch_table_get_n_entries(table);
+
+	info->clusters = NEW_ARR_F(cluster_t, 0);
+	for (size_t i = 0; i < n; ) {
+		const ir_switch_table_entry *first = &entries[i];
+		cluster_kind_t               kind  = CLUSTER_CASE;
+		size_t                       end   = i + 1;
+
+		/* the longest dense run starting here could become a jump table */
+		size_t last = i;
+		while (last + 1 < n
+		       && is_dense(env, get_range(first->min, entries[last+1].max),
+		                   last + 2 - i))
+			++last;
+		if (last + 1 - i > env->small_switch) {
+			kind = CLUSTER_JUMP_TABLE;
+			end  = last + 1;
+		}
+
+		/* bit tests are cheaper than jump tables if they cover as much */
+		unsigned pns[MAX_BIT_TEST_TARGETS];
+		unsigned n_pns = 0;
+		unsigned bits  = get_mode_size_bits(env->selector_mode);
+		for (size_t j = i; j < n; ++j) {
+			ir_tarval *range = get_range(first->min, entries[j].max);
+			if (!tarval_is_long(range) || get_tarval_long(range) >= (long)bits)
+				break;
+
+			unsigned pn = entries[j].pn;
+			unsigned t  = 0;
+			while (t < n_pns && pns[t] != pn)
+				++t;
+			if (t == n_pns) {
+				if (n_pns == MAX_BIT_TEST_TARGETS)
+					break;
+				pns[n_pns++] = pn;
+			}
+
+			if (j + 1 >= end && is_bit_test(j + 1 - i, n_pns)) {
+				kind = CLUSTER_BIT_TEST;
+				end  = j + 1;
+			}
+		}
+
+		double weight = 0.0;
+		for (size_t j = i; j < end; ++j)
+			weight += info->targets[entries[j].pn].weight;
+
+		cluster_t cluster = {
+			.kind      = kind,
+			.entries   = first,
+			.n_entries = end - i,
+			.min       = first->min,
+			.max       = entries[end-1].max,
+			.weight    = weight,
+		};
+		ARR_APP1(cluster_t, info->clusters, cluster);
+		i = end;
+	}
+}
+
+/**
+ * Checks whether all values in [lo, hi] are inside the cluster.
+ */
+static bool cluster_covers(const cluster_t *cluster, ir_tarval *lo,
+                           ir_tarval *hi)
+{
+	return tarval_cmp(lo, cluster->min) != ir_relation_less
+	    && tarval_cmp(hi, cluster->max) != ir_relation_greater;
+}
+
+/**
+ * Creates "if ((unsigned)(sel - min) <= max - min)" unless the selector is
+ * already known to be inside the cluster.  @p block is updated to the block
+ * reached if the check succeeds and the selector minus the cluster minimum
+ * is returned in @p offset.
+ *
+ * @return the control flow taken if the check fails or NULL
+ */
+static ir_node *create_range_check(switch_info_t *info, ir_node **block,
+                                   const cluster_t *cluster, ir_tarval *lo,
+                                   ir_tarval *hi, ir_node **offset)
+{
+	ir_graph  *irg      = get_irn_irg(*block);
+	dbg_info  *dbgi     = get_irn_dbg_info(info->switchn);
+	ir_node   *selector = get_Switch_selector(info->switchn);
+	ir_mode   *mode     = find_unsigned_mode(get_irn_mode(selector));
+	ir_node   *conv     = new_rd_Conv(dbgi, *block, selector, mode);
+	ir_tarval *min      = tarval_convert_to(cluster->min, mode);
+	*offset = new_rd_Sub(dbgi, *block, conv, new_r_Const(irg, min));
+	if (cluster_covers(cluster, lo, hi))
+		return NULL;
+
+	ir_tarval *range    = get_range(cluster->min, cluster->max);
+	ir_node   *maxconst = new_r_Const(irg, range);
+	ir_node   *cmp      = new_rd_Cmp(dbgi, *block, *offset, maxconst,
+	                                 ir_relation_less_equal);
+	ir_node   *cond     = new_rd_Cond(dbgi, *block, cmp);
+	ir_node   *in[]     = { new_r_Proj(cond, mode_X, pn_Cond_true) };
+	*block = new_r_Block(irg, ARRAY_SIZE(in), in);
+	return new_r_Proj(cond, mode_X, pn_Cond_false);
+}
+
+static ir_node *create_case(switch_info_t *info, ir_node *block,
+                            const cluster_t *cluster, ir_tarval *lo,
+                            ir_tarval *hi)
+{
+	const ir_switch_table_entry *entry = cluster->entries;
+	if (cluster_covers(cluster, lo, hi)) {
+		add_target_pred(info, entry->pn, new_r_Jmp(block));
+		return NULL;
+	}
+
+	dbg_info *dbgi     = get_irn_dbg_info(info->switchn);
+	ir_node  *selector = get_Switch_selector(info->switchn);
+	ir_node  *cond     = create_case_cond(entry, dbgi, block, selector);
+	add_target_pred(info, entry->pn, new_r_Proj(cond, mode_X, pn_Cond_true));
+	return new_r_Proj(cond, mode_X, pn_Cond_false);
+}
+
+/**
+ * Creates a new Switch for a jump table cluster.  The new Switch is already
+ * normalized: its selector starts at 0 and has the backend selector mode.
+ */
+static ir_node *create_jump_table(switch_info_t *info, ir_node *block,
+                                  const cluster_t *cluster, ir_tarval *lo,
+                                  ir_tarval *hi)
 {
-	ir_node *block     = target->block;
-	unsigned n_entries = target->n_entries;
-	if (get_Block_n_cfgpreds(block) != (int)n_entries) {
-		ir_node **new_in = ALLOCAN(ir_node*, n_entries);
-		ir_graph *irg    = get_irn_irg(block);
-		ir_node  *dummy  = new_r_Dummy(irg, mode_X);
-		for (unsigned i = 0; i < n_entries; ++i) {
-			new_in[i] = dummy;
+	ir_node *offset;
+	ir_node *miss = create_range_check(info, &block, cluster, lo, hi, &offset);
+
+	ir_graph  *irg    = get_irn_irg(block);
+	dbg_info  *dbgi   = get_irn_dbg_info(info->switchn);
+	ir_mode   *mode   = info->env->selector_mode;
+	ir_mode   *umode  = get_irn_mode(offset);
+	ir_tarval *base   = tarval_convert_to(cluster->min, umode);
+	ir_node   *sel    = new_rd_Conv(dbgi, block, offset, mode);
+	unsigned   n_outs = get_Switch_n_outs(info->switchn);
+	unsigned  *pns    = XMALLOCNZ(unsigned, n_outs);
+
+	/* map the targets to the Proj numbers of the new Switch */
+	unsigned         n_new_outs = pn_Switch_max + 1;
+	ir_switch_table *table = ir_new_switch_table(irg, cluster->n_entries);
+	for (unsigned e = 0; e < cluster->n_entries; ++e) {
+		const ir_switch_table_entry *entry = &cluster->entries[e];
+		if (pns[entry->pn] == 0)
+			pns[entry->pn] = n_new_outs++;
+
+		ir_tarval *min = tarval_convert_to(entry->min, umode);
+		ir_tarval *max = tarval_convert_to(entry->max, umode);
+		min = tarval_convert_to(tarval_sub(min, base), mode);
+		max = tarval_convert_to(tarval_sub(max, base), mode);
+		ir_switch_table_set(table, e, min, max, pns[entry->pn]);
+	}
+
+	ir_node *switchn = new_rd_Switch(dbgi, block, sel, n_new_outs, table);
+	ir_nodeset_insert(&info->env->processed, switchn);
+	ARR_APP1(ir_node*, info->defusers,
+	         new_r_Proj(switchn, mode_X, pn_Switch_default));
+	for (unsigned pn = 0; pn < n_outs; ++pn) {
+		if (pns[pn] != 0)
+			add_target_pred(info, pn, new_r_Proj(switchn, mode_X, pns[pn]));
+	}
+	free(pns);
+	return miss;
+}
+
+typedef struct bit_test_target_t {
+	unsigned   pn;
+	ir_tarval *mask;
+	double     weight;
+} bit_test_target_t;
+
+/**
+ * Creates "if ((1 << (sel - min)) & mask)" tests for each target of the
+ * cluster, starting with the most frequent one.
+ */
+static ir_node *create_bit_test(switch_info_t *info, ir_node *block,
+                                const cluster_t *cluster, ir_tarval *lo,
+                                ir_tarval *hi)
+{
+	ir_node *offset;
+	ir_node *miss = create_range_check(info, &block, cluster, lo, hi, &offset);
+
+	ir_graph  *irg   = get_irn_irg(block);
+	dbg_info  *dbgi  = get_irn_dbg_info(info->switchn);
+	ir_mode   *mode  = info->env->selector_mode;
+	ir_mode   *umode = get_irn_mode(offset);
+	ir_tarval *base  = tarval_convert_to(cluster->min, umode);
+	ir_tarval *one   = get_mode_one(mode);
+	ir_tarval *null  = get_mode_null(mode);
+
+	bit_test_target_t dests[MAX_BIT_TEST_TARGETS];
+	unsigned          n_dests = 0;
+	ir_tarval        *all     = null;
+	for (unsigned e = 0; e < cluster->n_entries; ++e) {
+		const ir_switch_table_entry *entry = &cluster->entries[e];
+		unsigned d = 0;
+		while (d < n_dests && dests[d].pn != entry->pn)
+			++d;
+		if (d == n_dests) {
+			assert(n_dests < MAX_BIT_TEST_TARGETS);
+			dests[d].pn     = entry->pn;
+			dests[d].mask   = null;
+			dests[d].weight = 0.0;
+			++n_dests;
+		}
+		dests[d].weight += info->targets[entry->pn].weight;
+
+		ir_tarval *min  = tarval_sub(tarval_convert_to(entry->min, umode), base);
+		ir_tarval *max  = tarval_sub(tarval_convert_to(entry->max, umode), base);
+		long       from = get_tarval_long(min);
+		long       to   = get_tarval_long(max);
+		for (long b = from; b <= to; ++b)
+			dests[d].mask = tarval_or(dests[d].mask, tarval_shl_unsigned(one, b));
+		all = tarval_or(all, dests[d].mask);
+	}
+
+	/* most frequent target first */
+	for (unsigned d = 1; d < n_dests; ++d) {
+		for (unsigned k = d; k > 0 && dests[k].weight > dests[k-1].weight; --k) {
+			bit_test_target_t tmp = dests[k];
+			dests[k]   = dests[k-1];
+			dests[k-1] = tmp;
+		}
+	}
+
+	/* without holes a single target needs no test at all */
+	long range = get_tarval_long(get_range(cluster->min, cluster->max));
+	if (n_dests == 1 && range + 1 < (long)get_mode_size_bits(mode)
+	    && all == tarval_sub(tarval_shl_unsigned(one, range + 1), one)) {
+		add_target_pred(info, dests[0].pn, new_r_Jmp(block));
+		return miss;
+	}
+
+	ir_node *amount = new_rd_Conv(dbgi, block, offset, mode);
+	ir_node *bit    = new_rd_Shl(dbgi, block, new_r_Const(irg, one), amount);
+	for (unsigned d = 0; d < n_dests; ++d) {
+		ir_node *mask  = new_r_Const(irg, dests[d].mask);
+		ir_node *test  = new_rd_And(dbgi, block, bit, mask);
+		ir_node *zero  = new_r_Const(irg, null);
+		ir_node *cmp   = new_rd_Cmp(dbgi, block, test, zero,
+		                            ir_relation_less_greater);
+		ir_node *cond  = new_rd_Cond(dbgi, block, cmp);
+		ir_node *taken = new_r_Proj(cond, mode_X, pn_Cond_true);
+		ir_node *next  = new_r_Proj(cond, mode_X, pn_Cond_false);
+		add_target_pred(info, dests[d].pn, taken);
+		if (d + 1 == n_dests) {
+			ARR_APP1(ir_node*, info->defusers, next);
+		} else {
+			ir_node *in[] = { next };
+			block = new_r_Block(irg, ARRAY_SIZE(in), in);
 		}
-		set_irn_in(block, n_entries, new_in);
-		assert(target->i == 0);
 	}
-	assert(target->i < n_entries);
-	set_Block_cfgpred(target->block, target->i++, cf);
+	return miss;
 }
 
 /**
- * Creates an if cascade realizing binary search.
+ * Lowers a cluster.
+ *
+ * @return the control flow taken if the selector is outside of the cluster
+ *         or NULL if [lo, hi] is covered by the cluster.
  */
-static void create_if_cascade(switch_info_t *info, ir_node *block,
-                              ir_switch_table_entry *curcases,
-                              unsigned numcases)
+static ir_node *create_cluster(switch_info_t *info, ir_node *block,
+                               const cluster_t *cluster, ir_tarval *lo,
+                               ir_tarval *hi)
 {
-	ir_graph      *irg      = get_irn_irg(block);
-	const ir_node *switchn  = info->switchn;
-	dbg_info      *dbgi     = get_irn_dbg_info(switchn);
-	ir_node       *selector = get_Switch_selector(switchn);
+	switch (cluster->kind) {
+	case CLUSTER_CASE:
+		return create_case(info, block, cluster, lo, hi);
+	case CLUSTER_JUMP_TABLE:
+		return create_jump_table(info, block, cluster, lo, hi);
+	case CLUSTER_BIT_TEST:
+		return create_bit_test(info, block, cluster, lo, hi);
+	}
+	panic("invalid cluster kind");
+}
 
-	if (numcases == 0) {
+/**
+ * Creates a search tree over the clusters.  Instead of splitting in the
+ * middle the clusters are split so that both halves have about the same
+ * execution weight, so frequent cases are reached with fewer compares.
+ * The selector is known to be in [lo, hi] when reaching @p block.
+ */
+static void create_search_tree(switch_info_t *info, ir_node *block,
+                               const cluster_t *clusters, size_t n_clusters,
+                               ir_tarval *lo, ir_tarval *hi)
+{
+	ir_graph *irg = get_irn_irg(block);
+	if (n_clusters == 0) {
 		/* zero cases: "goto default;" */
 		ARR_APP1(ir_node*, info->defusers, new_r_Jmp(block));
-	} else if (numcases == 1) {
-		/*only one case: "if (sel == val) goto target else goto default;"*/
-		const ir_switch_table_entry *entry = &curcases[0];
-		ir_node *cond      = create_case_cond(entry, dbgi, block, selector);
-		ir_node *trueproj  = new_r_Proj(cond, mode_X, pn_Cond_true);
-		ir_node *falseproj = new_r_Proj(cond, mode_X, pn_Cond_false);
-
-		connect_to_target(&info->targets[entry->pn], trueproj);
-		ARR_APP1(ir_node*, info->defusers, falseproj);
-	} else if (numcases == 2) {
-		/* only two cases: "if (sel == val[0]) goto target[0];" */
-		const ir_switch_table_entry *entry0 = &curcases[0];
-		const ir_switch_table_entry *entry1 = &curcases[1];
-		ir_node *cond      = create_case_cond(entry0, dbgi, block, selector);
-		ir_node *trueproj  = new_r_Proj(cond, mode_X, pn_Cond_true);
-		ir_node *falseproj = new_r_Proj(cond, mode_X, pn_Cond_false);
-		connect_to_target(&info->targets[entry0->pn], trueproj);
-
-		ir_node *in[]    = { falseproj };
-		ir_node *neblock = new_r_Block(irg, ARRAY_SIZE(in), in);
-
-		/* second part: "else if (sel == val[1]) goto target[1] else goto default;" */
-		ir_node *cond1      = create_case_cond(entry1, dbgi, neblock, selector);
-		ir_node *trueproj1  = new_r_Proj(cond1, mode_X, pn_Cond_true);
-		ir_node *falseproj1 = new_r_Proj(cond1, mode_X, pn_Cond_false);
-		connect_to_target(&info->targets[entry1->pn], trueproj1);
-		ARR_APP1(ir_node*, info->defusers, falseproj1);
-	} else {
-		/* recursive case: split cases in the middle */
-		unsigned midcase = numcases / 2;
-		const ir_switch_table_entry *entry = &curcases[midcase];
-		ir_node *val = new_r_Const(irg, entry->min);
-		ir_node *cmp = new_rd_Cmp(dbgi, block, selector, val, ir_relation_less);
-		ir_node *cond = new_rd_Cond(dbgi, block, cmp);
-
-		ir_node *ltin[]  = { new_r_Proj(cond, mode_X, pn_Cond_true) };
-		ir_node *ltblock = new_r_Block(irg, ARRAY_SIZE(ltin), ltin);
+		return;
+	}
 
-		ir_node *gein[]  = { new_r_Proj(cond, mode_X, pn_Cond_false) };
-		ir_node *geblock = new_r_Block(irg, ARRAY_SIZE(gein), gein);
+	if (n_clusters <= MAX_CHAIN_CLUSTERS) {
+		/* test the clusters one after the other, most frequent first */
+		const cluster_t *order[MAX_CHAIN_CLUSTERS];
+		for (size_t c = 0; c < n_clusters; ++c)
+			order[c] = &clusters[c];
+		if (n_clusters == 2 && clusters[1].weight > clusters[0].weight) {
+			order[0] = &clusters[1];
+			order[1] = &clusters[0];
+		}
+		for (size_t c = 0; c < n_clusters; ++c) {
+			ir_node *miss = create_cluster(info, block, order[c], lo, hi);
+			if (miss == NULL)
+				return;
+			if (c + 1 == n_clusters) {
+				ARR_APP1(ir_node*, info->defusers, miss);
+			} else {
+				ir_node *in[] = { miss };
+				block = new_r_Block(irg, ARRAY_SIZE(in), in);
+			}
+		}
+		return;
+	}
 
-		create_if_cascade(info, ltblock, curcases, midcase);
-		create_if_cascade(info, geblock, curcases + midcase, numcases - midcase);
+	double total = 0.0;
+	for (size_t c = 0; c < n_clusters; ++c)
+		total += clusters[c].weight;
+	size_t split = 1;
+	double left  = 0.0;
+	double best  = DBL_MAX;
+	for (size_t c = 1; c < n_clusters; ++c) {
+		left += clusters[c-1].weight;
+		double diff = fabs(total - 2.0 * left);
+		if (diff < best) {
+			best  = diff;
+			split = c;
+		}
 	}
+
+	dbg_info  *dbgi     = get_irn_dbg_info(info->switchn);
+	ir_node   *selector = get_Switch_selector(info->switchn);
+	ir_tarval *pivot    = clusters[split].min;
+	ir_node   *val      = new_r_Const(irg, pivot);
+	ir_node   *cmp      = new_rd_Cmp(dbgi, block, selector, val,
+	                                 ir_relation_less);
+	ir_node   *cond     = new_rd_Cond(dbgi, block, cmp);
+
+	ir_node *ltin[]  = { new_r_Proj(cond, mode_X, pn_Cond_true) };
+	ir_node *ltblock = new_r_Block(irg, ARRAY_SIZE(ltin), ltin);
+
+	ir_node *gein[]  = { new_r_Proj(cond, mode_X, pn_Cond_false) };
+	ir_node *geblock = new_r_Block(irg, ARRAY_SIZE(gein), gein);
+
+	ir_tarval *below = tarval_sub(pivot, get_mode_one(get_tarval_mode(pivot)));
+	create_search_tree(info, ltblock, clusters, split, lo, below);
+	create_search_tree(info, geblock, clusters + split, n_clusters - split,
+	                   pivot, hi);
 }
 
 /**
@@ -395,44 +773,53 @@ static void find_switch_nodes(ir_node *block, void *ctx)
 		return;
 
 	switch_info_t info;
+	info.env = env;
 	analyse_switch0(&info, switchn);
 
-	/*
-	 * Here we have: num_cases and [switch_min, switch_max] interval.
-	 * We do an if-cascade if there are too many spare numbers.
-	 */
-	ir_mode   *selector_mode = get_irn_mode(get_Switch_selector(switchn));
-	ir_tarval *spare = tarval_sub(info.switch_max, info.switch_min);
-	ir_mode   *mode  = find_unsigned_mode(selector_mode);
-	spare = tarval_convert_to(spare, mode);
-	ir_tarval *num_cases_minus_one
-		= new_tarval_from_long(info.num_cases-1, mode);
-	spare = tarval_sub(spare, num_cases_minus_one);
-	ir_tarval *spare_size = new_tarval_from_long(env->spare_size, mode);
-	bool lower_switch = info.num_cases <= env->small_switch
-		|| (tarval_cmp(spare, spare_size) & ir_relation_greater_equal);
-
-	if (!lower_switch) {
+	ir_mode *selector_mode = get_irn_mode(get_Switch_selector(switchn));
+	normalize_table(switchn, selector_mode, NULL);
+	analyse_switch1(&info);
+	create_clusters(&info);
+
+	size_t n_clusters = ARR_LEN(info.clusters);
+	if (n_clusters == 1 && info.clusters[0].kind == CLUSTER_JUMP_TABLE) {
 		/* we won't decompose the switch. But we must add an out-of-bounds
 		 * check */
 		env->changed |= normalize_switch(&info, env->selector_mode);
-		return;
+	} else {
+		/* Now create the search tree */
+		env->changed  = true;
+		info.defusers = NEW_ARR_F(ir_node*, 0);
+		block         = get_nodes_block(switchn);
+		create_search_tree(&info, block, info.clusters, n_clusters,
+		                   get_mode_min(selector_mode),
+		                   get_mode_max(selector_mode));
+
+		/* Connect new default case users */
+		set_irn_in(info.default_block, ARR_LEN(info.defusers), info.defusers);
+		DEL_ARR_F(info.defusers);
+
+		/* Connect the case targets */
+		ir_graph *irg = get_irn_irg(block);
+		for (unsigned pn = pn_Switch_max + 1, n_outs = get_Switch_n_outs(switchn);
+		     pn < n_outs; ++pn) {
+			target_t *target = &info.targets[pn];
+			if (target->block == NULL)
+				continue;
+			if (target->preds != NULL) {
+				set_irn_in(target->block, ARR_LEN(target->preds), target->preds);
+			} else {
+				ir_node *in[] = { new_r_Bad(irg, mode_X) };
+				set_irn_in(target->block, ARRAY_SIZE(in), in);
+			}
+		}
 	}
 
-	normalize_table(switchn, selector_mode, NULL);
-	analyse_switch1(&info);
-
-	/* Now create the if cascade */
-	env->changed  = true;
-	info.defusers = NEW_ARR_F(ir_node*, 0);
-	block         = get_nodes_block(switchn);
-	ir_switch_table *table = get_Switch_table(switchn);
-	create_if_cascade(&info, block, table->entries, table->n_entries);
-
-	/* Connect new default case users */
-	set_irn_in(info.default_block, ARR_LEN(info.defusers), info.defusers);
-
-	DEL_ARR_F(info.defusers);
+	for (unsigned pn = 0, n_outs = get_Switch_n_outs(switchn); pn < n_outs; ++pn) {
+		if (info.targets[pn].preds != NULL)
+			DEL_ARR_F(info.targets[pn].preds);
+	}
+	DEL_ARR_F(info.clusters);
 	free(info.targets);
 }
 
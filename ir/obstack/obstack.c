@@ -91,6 +91,17 @@ int obstack_exit_failure = EXIT_FAILURE;
   } while (0)
 
 
+/* Total size of the chunks of all obstacks and the maximum it reached.  */
+static ptrdiff_t chunk_memory;
+static ptrdiff_t chunk_memory_peak;
+
+static void account_chunk(ptrdiff_t size)
+{
+  chunk_memory += size;
+  if (chunk_memory > chunk_memory_peak)
+    chunk_memory_peak = chunk_memory;
+}
+
 /* Initialize an obstack H for use.  Specify chunk size SIZE (0 means default).
    Objects start on multiples of ALIGNMENT (0 means use default).
    CHUNKFUN is the function to use to allocate chunks,
@@ -132,6 +143,7 @@ int _obstack_begin(struct obstack *h, int size, int alignment,
   chunk = h->chunk = CALL_CHUNKFUN (h, h -> chunk_size);
   if (!chunk)
     (*obstack_alloc_failed_handler) ();
+  account_chunk (h->chunk_size);
   h->next_free = h->object_base = __PTR_ALIGN ((char *) chunk, chunk->contents,
 					       alignment - 1);
   h->chunk_limit = chunk->limit
@@ -178,6 +190,7 @@ int _obstack_begin_1(struct obstack *h, int size, int alignment,
   chunk = h->chunk = CALL_CHUNKFUN (h, h -> chunk_size);
   if (!chunk)
     (*obstack_alloc_failed_handler) ();
+  account_chunk (h->chunk_size);
   h->next_free = h->object_base = __PTR_ALIGN ((char *) chunk, chunk->contents,
 					       alignment - 1);
   h->chunk_limit = chunk->limit
@@ -214,6 +227,7 @@ void _obstack_newchunk(struct obstack *h, ptrdiff_t length)
   new_chunk = CALL_CHUNKFUN (h, new_size);
   if (!new_chunk)
     (*obstack_alloc_failed_handler) ();
+  account_chunk (new_size);
   h->chunk = new_chunk;
   new_chunk->prev = old_chunk;
   new_chunk->limit = h->chunk_limit = (char *) new_chunk + new_size;
@@ -251,6 +265,7 @@ void _obstack_newchunk(struct obstack *h, ptrdiff_t length)
 			  h->alignment_mask)))
     {
       new_chunk->prev = old_chunk->prev;
+      account_chunk (-(old_chunk->limit - (char *) old_chunk));
       CALL_FREEFUN (h, old_chunk);
     }
 
@@ -302,6 +317,7 @@ void obstack_free(struct obstack *h, void *obj)
   while (lp != 0 && ((void *) lp >= obj || (void *) (lp)->limit < obj))
     {
       plp = lp->prev;
+      account_chunk (-(lp->limit - (char *) lp));
       CALL_FREEFUN (h, lp);
       lp = plp;
       /* If we switch chunks, we can't tell whether the new current
@@ -331,6 +347,23 @@ ptrdiff_t _obstack_memory_used(struct obstack *h)
   return nbytes;
 }
 
+ptrdiff_t obstack_total_memory_used(void)
+{
+  return chunk_memory;
+}
+
+ptrdiff_t obstack_peak_memory_used(void)
+{
+  return chunk_memory_peak;
+}
+
+ptrdiff_t obstack_set_peak_memory_used(ptrdiff_t peak)
+{
+  ptrdiff_t old_peak = chunk_memory_peak;
+  chunk_memory_peak = peak;
+  return old_peak;
+}
+
 static FIRM_NORETURN print_and_abort(void)
 {
   /* Don't change any of these strings.  Yes, it would be possible to add
@@ -16,6 +16,7 @@
 #include "irgwalk.h"
 #include "irnode_t.h"
 #include "iroptimize.h"
+#include "passtiming.h"
 #include "tv.h"
 #include <assert.h>
 
@@ -732,6 +733,7 @@ restart:
 
 void opt_bool(ir_graph *const irg)
 {
+	ir_pass_timing_push("opt_bool", irg);
 	bool_opt_env_t env;
 
 	/* register a debug mask */
@@ -752,4 +754,5 @@ void opt_bool(ir_graph *const irg)
 
 	confirm_irg_properties(irg,
 		env.changed ? IR_GRAPH_PROPERTIES_NONE : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_timing_pop();
 }
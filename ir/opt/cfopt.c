@@ -19,6 +19,7 @@
 #include "irnode_t.h"
 #include "iroptimize.h"
 #include "irverify.h"
+#include "passtiming.h"
 #include "util.h"
 #include "xmalloc.h"
 #include <assert.h>
@@ -542,6 +543,7 @@ again:;
 
 void optimize_cf(ir_graph *irg)
 {
+	ir_pass_timing_push("optimize_cf", irg);
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
 	                         | IR_GRAPH_PROPERTY_ONE_RETURN);
 	/* we have some hacky is_Id() checks here so exchange must not use Deleted
@@ -583,4 +585,5 @@ void optimize_cf(ir_graph *irg)
 	                     | IR_RESOURCE_IRN_LINK);
 	confirm_irg_properties(irg, global_changed ? IR_GRAPH_PROPERTIES_NONE
 	                                           : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_timing_pop();
 }
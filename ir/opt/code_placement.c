@@ -18,6 +18,7 @@
 #include "irgopt.h"
 #include "irnode_t.h"
 #include "iroptimize.h"
+#include "passtiming.h"
 #include "pdeq.h"
 #include <stdbool.h>
 
@@ -328,6 +329,7 @@ static void place_late(ir_graph *irg, deq_t *worklist)
 /* Code Placement. */
 void place_code(ir_graph *irg)
 {
+	ir_pass_timing_push("place_code", irg);
 	/* Handle graph state */
 	assure_irg_properties(irg,
 		IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES |
@@ -354,4 +356,5 @@ void place_code(ir_graph *irg)
 
 	deq_free(&worklist);
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	ir_pass_timing_pop();
 }
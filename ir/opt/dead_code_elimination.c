@@ -13,6 +13,10 @@
  * The only drawback is that the nodes still take up memory. This phase fixes
  * this by copying all (reachable) nodes to a new obstack and throwing away
  * the old one.
+ *
+ * collect_dead_nodes() is a cheaper alternative that does not copy: it marks
+ * the reachable nodes, puts the memory of the other nodes into free lists
+ * of the graph and renumbers the reachable nodes densely.
  */
 #include "cgana.h"
 #include "iredges_t.h"
@@ -24,8 +28,11 @@
 #include "iroptimize.h"
 #include "irouts.h"
 #include "irtools.h"
+#include "passtiming.h"
 #include "pmap.h"
+#include "util.h"
 #include "vrp.h"
+#include <stdbool.h>
 
 /**
  * Reroute the inputs of a node from nodes in the old graph to copied nodes in
@@ -39,10 +46,11 @@ static void rewire_inputs(ir_node *node, void *env)
 
 static void copy_node_dce(ir_node *node, void *env)
 {
-	(void)env;
-	ir_node *new_node = exact_copy(node);
+	unsigned *const new_idx  = (unsigned*)env;
+	ir_node  *const new_node = exact_copy(node);
 	/* preserve the node numbers for easier debugging */
 	new_node->node_nr = node->node_nr;
+	new_idx[get_irn_idx(node)] = get_irn_idx(new_node);
 	set_irn_link(node, new_node);
 }
 
@@ -52,11 +60,11 @@ static void copy_node_dce(ir_node *node, void *env)
  *
  * @param copy_node_nr  If non-zero, the node number will be copied
  */
-static void copy_graph_env(ir_graph *irg)
+static void copy_graph_env(ir_graph *irg, unsigned *new_idx)
 {
 	/* copy nodes */
 	ir_node *anchor = irg->anchor;
-	irg_walk_in_or_dep(anchor, copy_node_dce, rewire_inputs, NULL);
+	irg_walk_in_or_dep(anchor, copy_node_dce, rewire_inputs, new_idx);
 
 	/* fix the anchor */
 	ir_node *new_anchor = (ir_node*)get_irn_link(anchor);
@@ -64,6 +72,19 @@ static void copy_graph_env(ir_graph *irg)
 	irg->anchor = new_anchor;
 }
 
+/**
+ * Frees the analysis information that may refer to unreachable nodes.
+ */
+static void free_analyses(ir_graph *irg)
+{
+	free_callee_info(irg);
+	free_irg_outs(irg);
+	free_loop_information(irg);
+	free_vrp_data(irg);
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+	                        | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+}
+
 /**
  * Copies all reachable nodes to a new obstack.  Removes bad inputs
  * from block nodes and the corresponding inputs from Phi nodes.
@@ -74,14 +95,13 @@ static void copy_graph_env(ir_graph *irg)
  */
 void dead_node_elimination(ir_graph *irg)
 {
+	ir_pass_timing_push("dead_node_elimination", irg);
 	edges_deactivate(irg);
 
 	/* Handle graph state */
-	free_callee_info(irg);
-	free_irg_outs(irg);
-	free_loop_information(irg);
-	free_vrp_data(irg);
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	free_analyses(irg);
+
+	irg_clear_free_nodes(irg);
 
 	/* A quiet place, where the old obstack can rest in peace,
 	   until it will be cremated. */
@@ -89,6 +109,10 @@ void dead_node_elimination(ir_graph *irg)
 
 	/* A new obstack, where the reachable nodes will be copied to. */
 	obstack_init(&irg->obst);
+	unsigned const  last_idx = get_irg_last_idx(irg);
+	unsigned *const new_idx  = XMALLOCN(unsigned, last_idx);
+	for (unsigned idx = 0; idx < last_idx; ++idx)
+		new_idx[idx] = IRG_NO_IDX;
 	irg->last_node_idx = 0;
 
 	/* We also need a new value table for CSE */
@@ -96,9 +120,140 @@ void dead_node_elimination(ir_graph *irg)
 
 	/* Copy the graph from the old to the new obstack */
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
-	copy_graph_env(irg);
+	copy_graph_env(irg, new_idx);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	irg_notify_renumber(irg, new_idx, last_idx);
+	free(new_idx);
 
 	/* Free memory from old unoptimized obstack */
+	hook_flush_batches();
 	obstack_free(&graveyard_obst, 0);  /* First empty the obstack ... */
+	ir_pass_timing_pop();
+}
+
+static void count_reachable(ir_node *node, void *env)
+{
+	(void)node;
+	++*(unsigned*)env;
+}
+
+/**
+ * Renumbers the nodes reachable from the anchor densely in their old order.
+ * The memory of the other nodes is reused for new nodes if @p free_dead is
+ * set.
+ */
+static void renumber_nodes(ir_graph *irg, bool free_dead)
+{
+	assert(!irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_CONSTRUCTION));
+
+	/* The out edges of reachable nodes contain dead users. */
+	bool const consistent_edges
+		= irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+	bool edges_active[EDGE_KIND_LAST + 1];
+	for (ir_edge_kind_t kind = EDGE_KIND_FIRST; kind <= EDGE_KIND_LAST; ++kind) {
+		edges_active[kind] = edges_activated_kind(irg, kind);
+		if (edges_active[kind])
+			edges_deactivate_kind(irg, kind);
+	}
+
+	/* The value table might contain dead nodes, keep the reachable ones. */
+	ir_node **identities = NEW_ARR_F(ir_node*, 0);
+	unsigned n_reachable = 0;
+	irg_walk_in_or_dep(irg->anchor, count_reachable, NULL, &n_reachable);
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
+	foreach_pset(irg->value_table, ir_node, node) {
+		if (irn_visited(node))
+			ARR_APP1(ir_node*, identities, node);
+	}
+
+	/* Buffered hook events may refer to the dead nodes. */
+	if (free_dead)
+		hook_flush_batches();
+
+	unsigned const  last_idx = get_irg_last_idx(irg);
+	ir_node **const map      = irg->idx_irn_map;
+	unsigned *const new_idx  = XMALLOCN(unsigned, last_idx);
+	unsigned        n_live   = 0;
+	for (unsigned idx = 0; idx < last_idx; ++idx) {
+		ir_node *const node = map[idx];
+		if (node != NULL && irn_visited(node)) {
+			node->node_idx = n_live;
+			new_idx[idx]   = n_live;
+			map[n_live++]  = node;
+		} else {
+			new_idx[idx] = IRG_NO_IDX;
+			if (node == NULL)
+				continue;
+			/* The old index of a dead node belongs to a live one now. */
+			node->node_idx = IRG_NO_IDX;
+			if (free_dead)
+				free_node_memory(irg, node);
+		}
+	}
+	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
+	assert(n_live == n_reachable);
+	irg->last_node_idx = n_live;
+	ARR_RESIZE(ir_node*, irg->idx_irn_map, MAX(n_live, 1u));
+	irg_notify_renumber(irg, new_idx, last_idx);
+	free(new_idx);
+
+	/* The hash of a node depends on the indices of its operands. */
+	new_identities(irg);
+	for (size_t i = 0, n = ARR_LEN(identities); i < n; ++i)
+		identify_remember(identities[i]);
+	DEL_ARR_F(identities);
+
+	for (ir_edge_kind_t kind = EDGE_KIND_FIRST; kind <= EDGE_KIND_LAST; ++kind) {
+		if (edges_active[kind])
+			edges_activate_kind(irg, kind);
+	}
+	if (consistent_edges)
+		add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+}
+
+void collect_dead_nodes(ir_graph *irg)
+{
+	ir_pass_timing_push("collect_dead_nodes", irg);
+	free_analyses(irg);
+	renumber_nodes(irg, true);
+	ir_pass_timing_pop();
+}
+
+void compact_node_indices(ir_graph *irg)
+{
+	ir_pass_timing_push("compact_node_indices", irg);
+	renumber_nodes(irg, false);
+	ir_pass_timing_pop();
+}
+
+/** Minimal share of reachable nodes among the node indices. */
+static double compaction_threshold = 0.5;
+
+void set_node_index_compaction_threshold(double threshold)
+{
+	assert(0.0 <= threshold && threshold < 1.0);
+	compaction_threshold = threshold;
+}
+
+void maybe_compact_node_indices(ir_graph *irg)
+{
+	unsigned const last_idx = get_irg_last_idx(irg);
+	if (last_idx < irg->compact_check_idx || compaction_threshold <= 0.0
+	 || irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_CONSTRUCTION
+	                          | IR_GRAPH_CONSTRAINT_BACKEND)
+	 || ir_resources_reserved(irg) != 0)
+		return;
+
+	unsigned n_reachable = 0;
+	irg_walk_in_or_dep(irg->anchor, count_reachable, NULL, &n_reachable);
+	bool const compact = n_reachable < compaction_threshold * last_idx;
+
+	/* The share can drop below the threshold only after this many nodes have
+	 * been created, checking not too often keeps the walks amortized. */
+	unsigned const n_idx = compact ? n_reachable : last_idx;
+	unsigned const next  = (unsigned)(n_reachable / compaction_threshold);
+	irg->compact_check_idx = MAX(MAX(next, n_idx + n_idx / 4), 1024u);
+
+	if (compact)
+		compact_node_indices(irg);
 }
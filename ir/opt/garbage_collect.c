@@ -15,6 +15,7 @@
 #include "iroptimize.h"
 #include "irprog_t.h"
 #include "panic.h"
+#include "passtiming.h"
 #include "type_t.h"
 #include "typerep.h"
 
@@ -120,6 +121,7 @@ static void garbage_collect_in_segment(ir_type *segment)
 
 void garbage_collect_entities(void)
 {
+	ir_pass_timing_push("garbage_collect_entities", NULL);
 	FIRM_DBG_REGISTER(dbg, "firm.opt.garbagecollect");
 
 	/* start a type walk for all externally visible entities */
@@ -153,4 +155,5 @@ void garbage_collect_entities(void)
 		garbage_collect_in_segment(type);
 	}
 	irp_free_resources(irp, IRP_RESOURCE_TYPE_VISITED);
+	ir_pass_timing_pop();
 }
@@ -27,6 +27,7 @@
 #include "iropt_t.h"
 #include "iroptimize.h"
 #include "irouts.h"
+#include "passtiming.h"
 #include "tv_t.h"
 #include "valueset.h"
 
@@ -1785,6 +1786,7 @@ static void gvn_pre(ir_graph *irg, pre_env *env)
  */
 void do_gvn_pre(ir_graph *irg)
 {
+	ir_pass_timing_push("do_gvn_pre", irg);
 	pre_env               env;
 	ir_nodeset_t          keeps;
 	optimization_state_t  state;
@@ -1878,4 +1880,5 @@ void do_gvn_pre(ir_graph *irg)
 	/* TODO assure nothing else breaks. */
 	set_opt_global_cse(0);
 	edges_activate(irg);
+	ir_pass_timing_pop();
 }
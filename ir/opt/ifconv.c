@@ -17,6 +17,7 @@
 #include "irnode_t.h"
 #include "iroptimize.h"
 #include "irtools.h"
+#include "passtiming.h"
 #include "pdeq.h"
 #include "target_t.h"
 #include <assert.h>
@@ -447,6 +448,7 @@ static void fill_waitq(ir_node *node, void *env) {
 
 void opt_if_conv_cb(ir_graph *irg, arch_allow_ifconv_func callback)
 {
+	ir_pass_timing_push("opt_if_conv_cb", irg);
 	walker_env  env   = { .allow_ifconv = callback, .changed = false };
 	deq_t waitq;
 	deq_init(&waitq);
@@ -493,6 +495,7 @@ void opt_if_conv_cb(ir_graph *irg, arch_allow_ifconv_func callback)
 	confirm_irg_properties(irg,
 		IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
 		| IR_GRAPH_PROPERTY_ONE_RETURN);
+	ir_pass_timing_pop();
 }
 
 void opt_if_conv(ir_graph *irg)
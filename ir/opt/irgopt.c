@@ -22,6 +22,7 @@
 #include "iropt_t.h"
 #include "iroptimize.h"
 #include "irtools.h"
+#include "passtiming.h"
 #include "pdeq.h"
 #include <assert.h>
 
@@ -153,6 +154,7 @@ static void opt_walker(ir_node *n, deq_t *waitq)
 
 void optimize_graph_df(ir_graph *irg)
 {
+	ir_pass_timing_push("optimize_graph_df", irg);
 	ir_graph_properties_t props = IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES;
 	if (get_opt_global_cse()) {
 		set_irg_pinned(irg, op_pin_state_floats);
@@ -207,6 +209,9 @@ void optimize_graph_df(ir_graph *irg)
 	                            | IR_GRAPH_PROPERTY_MANY_RETURNS
 	                            | IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES);
 
+	/* the local optimizations leave many unreachable nodes behind */
+	maybe_compact_node_indices(irg);
+
 	if (get_opt_algebraic_simplification()) {
 		/* Unreachable code elimination was enabled. */
 		clear_irg_constraints(irg, IR_GRAPH_CONSTRAINT_OPTIMIZE_UNREACHABLE_CODE);
@@ -217,6 +222,7 @@ void optimize_graph_df(ir_graph *irg)
 	 * Doing this AFTER edges where deactivated saves cycles */
 	ir_node *end = get_irg_end(irg);
 	remove_End_Bads_and_doublets(end);
+	ir_pass_timing_pop();
 }
 
 void local_opts_const_code(void)
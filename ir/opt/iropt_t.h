@@ -129,4 +129,11 @@ ir_node *predict_load(ir_node *ptr, ir_mode *mode);
 
 void ir_register_opt_node_ops(void);
 
+/**
+ * Compacts the node indices of @p irg with compact_node_indices() if less
+ * than the compaction threshold of them belong to reachable nodes. Must only
+ * be called where no pass holds node indices.
+ */
+void maybe_compact_node_indices(ir_graph *irg);
+
 #endif
@@ -21,6 +21,7 @@
 #include "iroptimize.h"
 #include "iroptimize.h"
 #include "irtools.h"
+#include "passtiming.h"
 #include "tv.h"
 #include "vrp.h"
 #include <assert.h>
@@ -44,142 +45,6 @@ static void add_pred(ir_node *node, ir_node *x)
 	set_irn_in(node, n + 1, ins);
 }
 
-static ir_node *ssa_second_def;
-static ir_node *ssa_second_def_block;
-
-static ir_node *search_def_and_create_phis(ir_node *block, ir_mode *mode,
-                                           bool first)
-{
-	assert(is_Block(block));
-
-	/* the other defs can't be marked for cases where a user of the original
-	 * value is in the same block as the alternative definition.
-	 * In this case we mustn't use the alternative definition.
-	 * So we keep a flag that indicated whether we walked at least 1 block
-	 * away and may use the alternative definition */
-	if (block == ssa_second_def_block && !first)
-		return ssa_second_def;
-
-	/* already processed this block? */
-	if (irn_visited(block)) {
-		ir_node *value = (ir_node*) get_irn_link(block);
-		return value;
-	}
-
-	ir_graph *irg = get_irn_irg(block);
-	assert(block != get_irg_start_block(irg));
-
-	/* a Block with only 1 predecessor needs no Phi */
-	int n_cfgpreds = get_Block_n_cfgpreds(block);
-	if (n_cfgpreds == 1) {
-		ir_node *pred_block = get_Block_cfgpred_block(block, 0);
-		ir_node *value;
-		if (pred_block == NULL) {
-			ir_graph *irg = get_irn_irg(block);
-			value = new_r_Bad(irg, mode);
-		} else {
-			value = search_def_and_create_phis(pred_block, mode, false);
-		}
-		set_irn_link(block, value);
-		mark_irn_visited(block);
-		return value;
-	}
-
-	/* create a new Phi */
-	ir_node **in    = ALLOCAN(ir_node*, n_cfgpreds);
-	ir_node  *dummy = new_r_Dummy(irg, mode);
-	for (int i = 0; i < n_cfgpreds; ++i) {
-		in[i] = dummy;
-	}
-
-	/* we might have created a potential endless loop, and need a PhiLoop */
-	ir_node *phi = mode == mode_M ? new_r_Phi_loop(block, n_cfgpreds, in)
-	                              : new_r_Phi(block, n_cfgpreds, in, mode);
-	set_irn_link(block, phi);
-	mark_irn_visited(block);
-
-	/* set Phi predecessors */
-	for (int i = 0; i < n_cfgpreds; ++i) {
-		ir_node *pred_block = get_Block_cfgpred_block(block, i);
-		ir_node *pred_val;
-		if (pred_block == NULL) {
-			ir_graph *irg = get_irn_irg(block);
-			pred_val = new_r_Bad(irg, mode);
-		} else {
-			pred_val = search_def_and_create_phis(pred_block, mode, false);
-		}
-		set_irn_n(phi, i, pred_val);
-	}
-
-	return phi;
-}
-
-/**
- * Given a set of values this function constructs SSA-form for the users of the
- * first value (the users are determined through the out-edges of the value).
- * Uses the irn_visited flags. Works without using the dominance tree.
- */
-static void construct_ssa(ir_node *orig_block, ir_node *orig_val,
-                          ir_node *second_block, ir_node *second_val)
-{
-	/* no need to do anything */
-	if (orig_val == second_val && !(is_Phi(orig_val) && get_Phi_loop(orig_val)))
-		return;
-
-	ir_graph *irg = get_irn_irg(orig_val);
-	inc_irg_visited(irg);
-
-	ir_mode *mode = get_irn_mode(orig_val);
-	set_irn_link(orig_block, orig_val);
-	mark_irn_visited(orig_block);
-
-	if (orig_val == second_val) {
-		/* In the loop-phi case setting a 2nd def is wrong */
-		ssa_second_def_block = NULL;
-	} else {
-		ssa_second_def_block = second_block;
-		ssa_second_def       = second_val;
-	}
-
-	/* Only fix the users of the first, i.e. the original node */
-	foreach_out_edge_safe(orig_val, edge) {
-		ir_node *user = get_edge_src_irn(edge);
-		/* ignore keeps */
-		if (is_End(user))
-			continue;
-
-		int j = get_edge_src_pos(edge);
-		DB((dbg, LEVEL_3, ">>> Fixing user %+F (pred %d == %+F)\n", user, j,
-		    get_irn_n(user, j)));
-
-		ir_node *user_block = get_nodes_block(user);
-		ir_node *newval;
-		if (is_Phi(user)) {
-			ir_node *pred_block = get_Block_cfgpred_block(user_block, j);
-			if (pred_block == NULL) {
-				ir_graph *irg = get_irn_irg(user_block);
-				newval = new_r_Bad(irg, mode);
-			} else {
-				newval = search_def_and_create_phis(pred_block, mode, true);
-			}
-		} else {
-			newval = search_def_and_create_phis(user_block, mode, true);
-		}
-
-		/* don't fix newly created Phis from the SSA construction */
-		if (newval != user) {
-			DB((dbg, LEVEL_4, ">>>> Setting input %d of %+F to %+F\n", j, user,
-			    newval));
-			set_irn_n(user, j, newval);
-			if (is_Phi(user) && get_irn_mode(user) == mode_M && !get_Phi_loop(user)) {
-				set_Phi_loop(user, true);
-				keep_alive(user);
-				keep_alive(user_block);
-			}
-		}
-	}
-}
-
 /**
  * jumpthreading produces critical edges, e.g. B-C:
  *     A         A
@@ -312,7 +177,7 @@ static void copy_and_fix(const jumpthreading_env_t *env, ir_node *block,
 
 		ir_node *copy_node = (ir_node*)get_irn_link(node);
 		DB((dbg, LEVEL_2, ">> Fixing users of %+F (copy %+F)\n", node, copy_node));
-		construct_ssa(block, node, copy_block, copy_node);
+		irn_construct_ssa(block, node, copy_block, copy_node);
 	}
 
 	/* make sure copied PhiM nodes are kept alive if old nodes were */
@@ -635,6 +500,7 @@ static void thread_jumps(ir_node* block, void* data)
 
 void opt_jumpthreading(ir_graph* irg)
 {
+	ir_pass_timing_push("opt_jumpthreading", irg);
 	assure_irg_properties(irg,
 		IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
@@ -663,4 +529,5 @@ void opt_jumpthreading(ir_graph* irg)
 	} else {
 		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
 	}
+	ir_pass_timing_pop();
 }
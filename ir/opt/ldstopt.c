@@ -29,6 +29,7 @@
 #include "iroptimize.h"
 #include "irtools.h"
 #include "panic.h"
+#include "passtiming.h"
 #include "set.h"
 #include "target_t.h"
 #include "tv_t.h"
@@ -2295,6 +2296,7 @@ void combine_memops(ir_graph *irg)
 
 void optimize_load_store(ir_graph *irg)
 {
+	ir_pass_timing_push("optimize_load_store", irg);
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
 	                         | IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
 	                         | IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
@@ -2343,4 +2345,5 @@ void optimize_load_store(ir_graph *irg)
 		| IR_GRAPH_PROPERTY_NO_BADS | IR_GRAPH_PROPERTY_NO_TUPLES
 		| IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE
 		| IR_GRAPH_PROPERTY_MANY_RETURNS);
+	ir_pass_timing_pop();
 }
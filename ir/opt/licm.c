@@ -0,0 +1,779 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Loop invariant code motion for pinned operations.
+ *
+ * Code placement already moves floating nodes out of loops. This pass handles
+ * the pinned operations code placement has to leave alone: Loads whose address
+ * is loop invariant and which are not aliased by any memory write in the loop,
+ * and Div/Mod nodes on invariant operands. They are moved into a preheader of
+ * the loop, creating one if necessary.
+ *
+ * An operation is only moved if it executes in every iteration of the loop,
+ * or if it cannot trap, which is the case for Loads from a known entity within
+ * its bounds.
+ *
+ * Every hoisted value is live throughout the loop. We estimate the register
+ * pressure of each loop similar to beloopana by counting the values crossing
+ * block borders inside the loop, and stop hoisting once the estimate reaches
+ * the number of registers of the target.
+ */
+#include "array.h"
+#include "debug.h"
+#include "irdom_t.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irloop_t.h"
+#include "irmemory_t.h"
+#include "irnode_t.h"
+#include "iroptimize.h"
+#include "irtools.h"
+#include "obst.h"
+#include "passtiming.h"
+#include "target_t.h"
+#include "util.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** Nesting depth limit when checking whether a value is loop invariant. */
+#define MAX_INVARIANT_DEPTH 16
+
+/** Registers a value of a given mode is allocated to. */
+typedef enum value_class_t {
+	VALUE_CLASS_GP,    /**< integer and reference values */
+	VALUE_CLASS_FP,    /**< floating point and vector values */
+	VALUE_CLASS_COUNT,
+	VALUE_CLASS_NONE = VALUE_CLASS_COUNT, /**< values not held in registers */
+} value_class_t;
+
+typedef struct licm_loop_t {
+	ir_loop  *loop;
+	ir_node  *header;       /**< the only block entered from outside */
+	bool      irreducible;  /**< loop has several entry blocks */
+	bool      has_calls;    /**< a call in the loop might not return */
+	bool      clobbers_all; /**< loop writes memory of unknown address */
+	ir_node **must_pass;    /**< loop exits and backedge sources */
+	ir_node **stores;       /**< Stores and CopyBs in the loop */
+	ir_node **candidates;   /**< pinned operations to hoist */
+	ir_node  *preheader;    /**< preheader, created on demand */
+	int       entry_pos;    /**< position of preheader at header */
+	ir_node  *mem_phi;      /**< memory Phi of the header, if unique */
+	unsigned  pressure[VALUE_CLASS_COUNT];
+} licm_loop_t;
+
+/** Estimated register pressure at a block. */
+typedef struct block_pressure_t {
+	unsigned n[VALUE_CLASS_COUNT];
+} block_pressure_t;
+
+typedef struct licm_env_t {
+	ir_graph       *irg;
+	struct obstack  obst;
+	licm_loop_t   **loops;      /**< loops in postorder */
+	block_pressure_t *block_pressure; /**< indexed by block index */
+	ir_node       **worklist;
+	unsigned        budget[VALUE_CLASS_COUNT];
+	bool            changed;
+	bool            cf_changed;
+} licm_env_t;
+
+static licm_loop_t *get_loop_info(ir_loop const *const loop)
+{
+	return (licm_loop_t*)get_loop_link(loop);
+}
+
+/** Returns true iff @p inner is nested inside @p outer or the same loop. */
+static bool is_loop_nested_inside(ir_loop const *inner,
+                                  ir_loop const *const outer)
+{
+	unsigned const outer_depth = get_loop_depth(outer);
+	unsigned       inner_depth = get_loop_depth(inner);
+	if (outer_depth > inner_depth)
+		return false;
+	for (; inner_depth > outer_depth; --inner_depth)
+		inner = get_loop_outer_loop(inner);
+	return inner == outer;
+}
+
+static bool block_in_loop(ir_node const *const block,
+                          ir_loop const *const loop)
+{
+	ir_loop const *const block_loop = get_irn_loop(block);
+	return block_loop != NULL && is_loop_nested_inside(block_loop, loop);
+}
+
+static bool is_in_loop(licm_loop_t const *const info, ir_node const *const node)
+{
+	return block_in_loop(get_nodes_block(node), info->loop);
+}
+
+static value_class_t get_value_class(ir_mode const *const mode)
+{
+	if (mode_is_float(mode) || mode_is_vector(mode))
+		return VALUE_CLASS_FP;
+	if (mode_is_int(mode) || mode_is_reference(mode))
+		return VALUE_CLASS_GP;
+	return VALUE_CLASS_NONE;
+}
+
+/**
+ * Count the registers of the target for each value class. Targets without
+ * floating point registers keep floating point values in general purpose
+ * registers.
+ */
+static void init_register_budget(licm_env_t *const env)
+{
+	arch_isa_if_t const *const isa = ir_target.isa;
+	if (isa == NULL) {
+		for (unsigned c = 0; c < VALUE_CLASS_COUNT; ++c)
+			env->budget[c] = UINT_MAX;
+		return;
+	}
+
+	unsigned const pointer_bits = isa->pointer_size * 8;
+	for (unsigned i = 0; i < isa->n_register_classes; ++i) {
+		arch_register_class_t const *const cls = &isa->register_classes[i];
+		if (cls->manual_ra || cls->mode == NULL)
+			continue;
+		unsigned n_regs = 0;
+		for (unsigned r = 0; r < cls->n_regs; ++r) {
+			if (!cls->regs[r].is_virtual)
+				++n_regs;
+		}
+		ir_mode      *const mode = cls->mode;
+		value_class_t const vc   = mode_is_int(mode)
+		                        && get_mode_size_bits(mode) == pointer_bits
+			? VALUE_CLASS_GP : VALUE_CLASS_FP;
+		env->budget[vc] = MAX(env->budget[vc], n_regs);
+	}
+	/* leave one register for the stack pointer */
+	if (env->budget[VALUE_CLASS_GP] > 0)
+		--env->budget[VALUE_CLASS_GP];
+	if (env->budget[VALUE_CLASS_FP] == 0)
+		env->budget[VALUE_CLASS_FP] = env->budget[VALUE_CLASS_GP];
+}
+
+static void add_live_block(licm_env_t *const env, ir_node *const block,
+                           value_class_t const vc)
+{
+	if (Block_block_visited(block))
+		return;
+	mark_Block_block_visited(block);
+	++env->block_pressure[get_irn_idx(block)].n[vc];
+	ARR_APP1(ir_node*, env->worklist, block);
+}
+
+/**
+ * Mark the blocks where @p value is live in or live at the end. Values living
+ * only within one block are not counted, so this underestimates the real
+ * register pressure by the temporaries of a block.
+ */
+static void count_live_blocks(ir_node *const value, void *const data)
+{
+	licm_env_t *const env = (licm_env_t*)data;
+	if (is_Block(value) || is_irn_constlike(value))
+		return;
+	value_class_t const vc = get_value_class(get_irn_mode(value));
+	if (vc == VALUE_CLASS_NONE)
+		return;
+
+	ir_node *const def_block = get_nodes_block(value);
+	inc_irg_block_visited(env->irg);
+	ARR_RESIZE(ir_node*, env->worklist, 0);
+	foreach_out_edge(value, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_End(user) || is_Anchor(user))
+			continue;
+		if (is_Phi(user)) {
+			ir_node *const pred = get_Block_cfgpred_block(get_nodes_block(user),
+			                                              get_edge_src_pos(edge));
+			if (pred != NULL)
+				add_live_block(env, pred, vc);
+		} else {
+			ir_node *const block = get_nodes_block(user);
+			if (block != def_block)
+				add_live_block(env, block, vc);
+		}
+	}
+
+	for (size_t len; (len = ARR_LEN(env->worklist)) > 0;) {
+		ir_node *const block = env->worklist[len - 1];
+		ARR_SHRINKLEN(env->worklist, len - 1);
+		if (block == def_block)
+			continue;
+		for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+			ir_node *const pred = get_Block_cfgpred_block(block, i);
+			if (pred != NULL)
+				add_live_block(env, pred, vc);
+		}
+	}
+}
+
+static void compute_pressure(licm_env_t *const env)
+{
+	ir_graph *const irg = env->irg;
+	env->block_pressure = XMALLOCNZ(block_pressure_t, get_irg_last_idx(irg));
+	env->worklist       = NEW_ARR_F(ir_node*, 0);
+	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED);
+	irg_walk_graph(irg, NULL, count_live_blocks, env);
+	ir_free_resources(irg, IR_RESOURCE_BLOCK_VISITED);
+	DEL_ARR_F(env->worklist);
+}
+
+static void create_loop_infos(licm_env_t *const env, ir_loop *const loop)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind == k_ir_loop)
+			create_loop_infos(env, element.son);
+	}
+	if (get_loop_depth(loop) == 0)
+		return;
+
+	licm_loop_t *const info = OALLOCZ(&env->obst, licm_loop_t);
+	info->loop       = loop;
+	info->must_pass  = NEW_ARR_F(ir_node*, 0);
+	info->stores     = NEW_ARR_F(ir_node*, 0);
+	info->candidates = NEW_ARR_F(ir_node*, 0);
+	set_loop_link(loop, info);
+	ARR_APP1(licm_loop_t*, env->loops, info);
+}
+
+static void free_loop_infos(licm_env_t *const env)
+{
+	for (size_t i = 0, n = ARR_LEN(env->loops); i < n; ++i) {
+		licm_loop_t *const info = env->loops[i];
+		DEL_ARR_F(info->candidates);
+		DEL_ARR_F(info->stores);
+		DEL_ARR_F(info->must_pass);
+		set_loop_link(info->loop, NULL);
+	}
+}
+
+/** Find the loop headers and the blocks every iteration passes through. */
+static void analyze_block(ir_node *const block, void *const data)
+{
+	licm_env_t *const env   = (licm_env_t*)data;
+	ir_loop    *const loop  = get_irn_loop(block);
+	if (loop == NULL)
+		return;
+
+	unsigned const *const pressure = env->block_pressure[get_irn_idx(block)].n;
+	for (ir_loop *l = loop; get_loop_depth(l) > 0; l = get_loop_outer_loop(l)) {
+		licm_loop_t *const info = get_loop_info(l);
+		for (unsigned c = 0; c < VALUE_CLASS_COUNT; ++c)
+			info->pressure[c] = MAX(info->pressure[c], pressure[c]);
+	}
+
+	for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+		ir_node *const pred = get_Block_cfgpred_block(block, i);
+		if (pred == NULL)
+			continue;
+		for (ir_loop *l = loop; get_loop_depth(l) > 0;
+		     l = get_loop_outer_loop(l)) {
+			if (block_in_loop(pred, l))
+				break;
+			licm_loop_t *const info = get_loop_info(l);
+			if (info->header != NULL && info->header != block)
+				info->irreducible = true;
+			info->header = block;
+		}
+	}
+}
+
+static void collect_must_pass(ir_node *const block, void *const data)
+{
+	(void)data;
+	for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+		ir_node *const pred = get_Block_cfgpred_block(block, i);
+		if (pred == NULL)
+			continue;
+		ir_loop *const pred_loop = get_irn_loop(pred);
+		if (pred_loop == NULL)
+			continue;
+		for (ir_loop *l = pred_loop; get_loop_depth(l) > 0;
+		     l = get_loop_outer_loop(l)) {
+			licm_loop_t *const info = get_loop_info(l);
+			if (!block_in_loop(block, l) || block == info->header)
+				ARR_APP1(ir_node*, info->must_pass, pred);
+		}
+	}
+}
+
+static bool is_Call_no_write(ir_node const *const call)
+{
+	ir_type *const type = get_Call_type(call);
+	mtp_additional_properties const props
+		= get_method_additional_properties(type);
+	return props & (mtp_property_no_write | mtp_property_pure);
+}
+
+static bool has_memory_input(ir_node const *const node)
+{
+	foreach_irn_in(node, i, pred) {
+		if (get_irn_mode(pred) == mode_M)
+			return true;
+	}
+	return false;
+}
+
+/** Collect the candidates and memory writes of each loop. */
+static void collect_node(ir_node *const node, void *const data)
+{
+	(void)data;
+	if (is_Block(node))
+		return;
+	ir_loop *const loop = get_irn_loop(get_nodes_block(node));
+	if (loop == NULL || get_loop_depth(loop) == 0)
+		return;
+
+	licm_loop_t *const info = get_loop_info(loop);
+	switch (get_irn_opcode(node)) {
+	case iro_Load:
+		if (get_Load_volatility(node) != volatility_is_volatile
+		    && !ir_throws_exception(node))
+			ARR_APP1(ir_node*, info->candidates, node);
+		return;
+	case iro_Div:
+	case iro_Mod:
+		if (get_irn_pinned(node) && !ir_throws_exception(node))
+			ARR_APP1(ir_node*, info->candidates, node);
+		return;
+	case iro_Store:
+	case iro_CopyB:
+		ARR_APP1(ir_node*, info->stores, node);
+		return;
+	case iro_Call:
+		info->has_calls = true;
+		if (!is_Call_no_write(node))
+			info->clobbers_all = true;
+		return;
+	case iro_Phi:
+	case iro_Proj:
+	case iro_Sync:
+	case iro_Return:
+		return;
+	default:
+		if (has_memory_input(node))
+			info->clobbers_all = true;
+		return;
+	}
+}
+
+/** Make the memory writes of inner loops visible to their outer loops. */
+static void propagate_to_outer(licm_loop_t const *const info)
+{
+	ir_loop *const outer = get_loop_outer_loop(info->loop);
+	if (get_loop_depth(outer) == 0)
+		return;
+	licm_loop_t *const outer_info = get_loop_info(outer);
+	outer_info->has_calls    |= info->has_calls;
+	outer_info->clobbers_all |= info->clobbers_all;
+	for (size_t i = 0, n = ARR_LEN(info->stores); i < n; ++i)
+		ARR_APP1(ir_node*, outer_info->stores, info->stores[i]);
+}
+
+static ir_node *get_op_mem(ir_node const *const node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Load: return get_Load_mem(node);
+	case iro_Div:  return get_Div_mem(node);
+	case iro_Mod:  return get_Mod_mem(node);
+	default:       panic("unexpected %+F", node);
+	}
+}
+
+static void set_op_mem(ir_node *const node, ir_node *const mem)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Load: set_Load_mem(node, mem); return;
+	case iro_Div:  set_Div_mem(node, mem);  return;
+	case iro_Mod:  set_Mod_mem(node, mem);  return;
+	default:       panic("unexpected %+F", node);
+	}
+}
+
+static ir_mode *get_op_result_mode(ir_node const *const node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Load: return get_Load_mode(node);
+	case iro_Div:  return get_Div_resmode(node);
+	case iro_Mod:  return get_Mod_resmode(node);
+	default:       panic("unexpected %+F", node);
+	}
+}
+
+static unsigned get_op_pn_M(ir_node const *const node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Load: return pn_Load_M;
+	case iro_Div:  return pn_Div_M;
+	case iro_Mod:  return pn_Mod_M;
+	default:       panic("unexpected %+F", node);
+	}
+}
+
+static bool is_invariant_(licm_loop_t const *const info,
+                          ir_node const *const node, unsigned const depth)
+{
+	if (!is_in_loop(info, node))
+		return true;
+	if (depth >= MAX_INVARIANT_DEPTH || get_irn_pinned(node) || is_Phi(node))
+		return false;
+	foreach_irn_in(node, i, pred) {
+		if (!is_invariant_(info, pred, depth + 1))
+			return false;
+	}
+	return true;
+}
+
+/** Check whether @p node computes the same value in every iteration. */
+static bool is_invariant(licm_loop_t const *const info, ir_node const *node)
+{
+	return is_invariant_(info, node, 0);
+}
+
+/** Move the floating operands of an invariant node into the preheader. */
+static void move_invariant_operands(licm_loop_t const *const info,
+                                    ir_node *const node)
+{
+	foreach_irn_in(node, i, pred) {
+		if (get_irn_mode(pred) == mode_M || !is_in_loop(info, pred))
+			continue;
+		assert(!get_irn_pinned(pred));
+		set_nodes_block(pred, info->preheader);
+		move_invariant_operands(info, pred);
+	}
+}
+
+/** Check whether no write in the loop may modify the memory @p load reads. */
+static bool is_memory_invariant(licm_loop_t const *const info,
+                                ir_node const *const load)
+{
+	if (info->clobbers_all)
+		return false;
+
+	ir_node const *const ptr  = get_Load_ptr(load);
+	ir_type const *const type = get_Load_type(load);
+	unsigned       const size = get_mode_size_bytes(get_Load_mode(load));
+	for (size_t i = 0, n = ARR_LEN(info->stores); i < n; ++i) {
+		ir_node const *const store = info->stores[i];
+		ir_alias_relation rel;
+		if (is_Store(store)) {
+			ir_node const *const value = get_Store_value(store);
+			rel = get_alias_relation(ptr, type, size, get_Store_ptr(store),
+			                         get_Store_type(store),
+			                         get_mode_size_bytes(get_irn_mode(value)));
+		} else {
+			ir_type const *const copy_type = get_CopyB_type(store);
+			rel = get_alias_relation(ptr, type, size, get_CopyB_dst(store),
+			                         copy_type, get_type_size(copy_type));
+		}
+		if (rel != ir_no_alias)
+			return false;
+	}
+	return true;
+}
+
+/** Check whether @p node runs at least once whenever the loop is entered. */
+static bool is_executed_each_iteration(licm_loop_t const *const info,
+                                       ir_node const *const node)
+{
+	/* a call might not return */
+	if (info->has_calls)
+		return false;
+
+	ir_node const *const block = get_nodes_block(node);
+	for (size_t i = 0, n = ARR_LEN(info->must_pass); i < n; ++i) {
+		if (!block_dominates(block, info->must_pass[i]))
+			return false;
+	}
+	return true;
+}
+
+/** Check whether a load of @p size bytes from @p ptr cannot trap. */
+static bool is_dereferenceable(ir_node *const ptr, unsigned const size)
+{
+	long           offset;
+	ir_node *const base = get_base_address(ptr, &offset);
+	ir_entity     *entity;
+	if (is_Address(base)) {
+		entity = get_Address_entity(base);
+	} else if (is_Member(base)
+	           && get_Member_ptr(base) == get_irg_frame(get_irn_irg(base))) {
+		entity = get_Member_entity(base);
+	} else {
+		return false;
+	}
+
+	/* weak symbols might not be defined */
+	if (get_entity_linkage(entity) & IR_LINKAGE_WEAK)
+		return false;
+	ir_type *const type = get_entity_type(entity);
+	if (is_Method_type(type))
+		return false;
+	return offset >= 0 && (unsigned long)offset + size <= get_type_size(type);
+}
+
+static bool can_speculate(ir_node const *const node)
+{
+	if (!is_Load(node))
+		return false;
+	return is_dereferenceable(get_Load_ptr(node),
+	                          get_mode_size_bytes(get_Load_mode(node)));
+}
+
+static bool can_hoist(licm_env_t const *const env,
+                      licm_loop_t const *const info, ir_node const *const node)
+{
+	foreach_irn_in(node, i, pred) {
+		if (get_irn_mode(pred) != mode_M && !is_invariant(info, pred))
+			return false;
+	}
+	if (is_in_loop(info, get_op_mem(node)) && info->mem_phi == NULL)
+		return false;
+	if (is_Load(node) && !is_memory_invariant(info, node))
+		return false;
+	if (!is_executed_each_iteration(info, node) && !can_speculate(node))
+		return false;
+
+	value_class_t const vc = get_value_class(get_op_result_mode(node));
+	if (vc != VALUE_CLASS_NONE && info->pressure[vc] >= env->budget[vc]) {
+		DB((dbg, LEVEL_2, "%+F: register pressure %u too high for %+F\n",
+		    info->header, info->pressure[vc], node));
+		return false;
+	}
+	return true;
+}
+
+/** Find the memory Phi of the loop header, if there is exactly one. */
+static ir_node *find_mem_phi(ir_node *const header)
+{
+	ir_node *mem_phi = NULL;
+	foreach_out_edge(header, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (!is_Phi(node) || get_irn_mode(node) != mode_M)
+			continue;
+		if (mem_phi != NULL)
+			return NULL;
+		mem_phi = node;
+	}
+	return mem_phi;
+}
+
+/**
+ * Create a block in front of the loop header which is the only predecessor of
+ * the header outside the loop. An existing predecessor ending in a Jmp is
+ * reused.
+ */
+static void create_preheader(licm_env_t *const env, licm_loop_t *const info)
+{
+	ir_node *const header  = info->header;
+	int      const n_preds = get_Block_n_cfgpreds(header);
+	ir_node      **ins     = ALLOCAN(ir_node*, n_preds);
+	ir_node      **blocks  = ALLOCAN(ir_node*, n_preds);
+	int            n_outer = 0;
+	int            outer   = -1;
+	for (int i = 0; i < n_preds; ++i) {
+		ir_node *const pred = get_Block_cfgpred_block(header, i);
+		if (pred == NULL || !block_in_loop(pred, info->loop)) {
+			blocks[n_outer] = pred;
+			ins[n_outer++]  = get_Block_cfgpred(header, i);
+			outer           = i;
+		}
+	}
+	assert(n_outer > 0);
+
+	if (n_outer == 1 && is_Jmp(ins[0])) {
+		info->preheader = get_nodes_block(ins[0]);
+		info->entry_pos = outer;
+		return;
+	}
+
+	ir_graph *const irg       = env->irg;
+	ir_node  *const preheader = new_r_Block(irg, n_outer, ins);
+	set_irn_loop(preheader, get_loop_outer_loop(info->loop));
+
+	/* The preheader becomes the first predecessor of the header. */
+	ir_node **const new_ins = ALLOCAN(ir_node*, n_preds - n_outer + 1);
+	foreach_out_edge_safe(header, edge) {
+		ir_node *const phi = get_edge_src_irn(edge);
+		if (!is_Phi(phi))
+			continue;
+		int n_inner = 1;
+		int n_phi   = 0;
+		for (int i = 0; i < n_preds; ++i) {
+			ir_node *const pred = get_Block_cfgpred_block(header, i);
+			if (pred == NULL || !block_in_loop(pred, info->loop))
+				ins[n_phi++] = get_Phi_pred(phi, i);
+			else
+				new_ins[n_inner++] = get_Phi_pred(phi, i);
+		}
+		new_ins[0] = n_outer == 1 ? ins[0]
+			: new_r_Phi(preheader, n_outer, ins, get_irn_mode(phi));
+		set_irn_in(phi, n_inner, new_ins);
+	}
+
+	int n_inner = 1;
+	for (int i = 0; i < n_preds; ++i) {
+		ir_node *const pred = get_Block_cfgpred_block(header, i);
+		if (pred != NULL && block_in_loop(pred, info->loop))
+			new_ins[n_inner++] = get_Block_cfgpred(header, i);
+	}
+	new_ins[0] = new_r_Jmp(preheader);
+	set_irn_in(header, n_inner, new_ins);
+
+	/* The entry edges now lead into the preheader. */
+	ir_cfg_update_t *const updates   = ALLOCAN(ir_cfg_update_t, 2 * n_outer + 1);
+	size_t                 n_updates = 0;
+	for (int i = 0; i < n_outer; ++i) {
+		if (blocks[i] == NULL)
+			continue;
+		ir_cfg_update_t const removed = { blocks[i], header, false };
+		ir_cfg_update_t const added   = { blocks[i], preheader, true };
+		updates[n_updates++] = removed;
+		updates[n_updates++] = added;
+	}
+	ir_cfg_update_t const entry = { preheader, header, true };
+	updates[n_updates++] = entry;
+	dom_update_cfg(irg, n_updates, updates);
+
+	info->preheader = preheader;
+	info->entry_pos = 0;
+	env->cf_changed = true;
+	DB((dbg, LEVEL_2, "created preheader %+F for %+F\n", preheader, header));
+}
+
+static void hoist(licm_env_t *const env, licm_loop_t *const info,
+                  ir_node *const node)
+{
+	DB((dbg, LEVEL_1, "hoisting %+F out of loop with header %+F\n", node,
+	    info->header));
+	if (info->preheader == NULL) {
+		create_preheader(env, info);
+		info->mem_phi = find_mem_phi(info->header);
+	}
+
+	/* Remove the operation from the memory chain inside the loop. */
+	ir_node *const mem  = get_op_mem(node);
+	unsigned const pn_M = get_op_pn_M(node);
+	foreach_out_edge_safe(node, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (is_Proj(proj) && get_Proj_num(proj) == pn_M)
+			exchange(proj, mem);
+	}
+
+	move_invariant_operands(info, node);
+	set_nodes_block(node, info->preheader);
+	foreach_out_edge(node, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (is_Proj(proj))
+			set_nodes_block(proj, info->preheader);
+	}
+
+	/* Chain it to the memory entering the loop. */
+	if (is_in_loop(info, mem)) {
+		ir_node *const mem_phi   = info->mem_phi;
+		ir_node *const entry_mem = get_Phi_pred(mem_phi, info->entry_pos);
+		set_op_mem(node, entry_mem);
+		set_Phi_pred(mem_phi, info->entry_pos,
+		             new_r_Proj(node, mode_M, pn_M));
+	}
+
+	value_class_t const vc = get_value_class(get_op_result_mode(node));
+	if (vc != VALUE_CLASS_NONE) {
+		++info->pressure[vc];
+		for (ir_loop *l = get_loop_outer_loop(info->loop);
+		     get_loop_depth(l) > 0; l = get_loop_outer_loop(l)) {
+			licm_loop_t *const outer = get_loop_info(l);
+			outer->pressure[vc] = MAX(outer->pressure[vc], info->pressure[vc]);
+		}
+	}
+
+	/* The operation might be hoisted further out of the outer loop. */
+	ir_loop *const outer = get_loop_outer_loop(info->loop);
+	if (get_loop_depth(outer) > 0)
+		ARR_APP1(ir_node*, get_loop_info(outer)->candidates, node);
+	env->changed = true;
+}
+
+static void optimize_loop(licm_env_t *const env, licm_loop_t *const info)
+{
+	if (info->header == NULL || info->irreducible)
+		return;
+
+	/* The memory Phi is only needed for operations depending on memory
+	 * modified in the loop, it is determined again after creating the
+	 * preheader. */
+	info->mem_phi = find_mem_phi(info->header);
+
+	/* Hoisting an operation might make others invariant. */
+	bool progress;
+	do {
+		progress = false;
+		for (size_t i = 0; i < ARR_LEN(info->candidates); ++i) {
+			ir_node *const node = info->candidates[i];
+			if (!is_in_loop(info, node) || !can_hoist(env, info, node))
+				continue;
+			hoist(env, info, node);
+			progress = true;
+		}
+	} while (progress);
+}
+
+void opt_licm(ir_graph *const irg)
+{
+	ir_pass_timing_push("opt_licm", irg);
+	FIRM_DBG_REGISTER(dbg, "firm.opt.licm");
+
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO
+		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+
+	licm_env_t env;
+	memset(&env, 0, sizeof(env));
+	env.irg   = irg;
+	env.loops = NEW_ARR_F(licm_loop_t*, 0);
+	obstack_init(&env.obst);
+
+	create_loop_infos(&env, get_irg_loop(irg));
+	if (ARR_LEN(env.loops) > 0) {
+		init_register_budget(&env);
+		compute_pressure(&env);
+		irg_block_walk_graph(irg, NULL, analyze_block, &env);
+		irg_block_walk_graph(irg, NULL, collect_must_pass, &env);
+		irg_walk_graph(irg, NULL, collect_node, &env);
+		free(env.block_pressure);
+
+		/* env.loops is in postorder, so inner loops come first. */
+		for (size_t i = 0, n = ARR_LEN(env.loops); i < n; ++i)
+			propagate_to_outer(env.loops[i]);
+		for (size_t i = 0, n = ARR_LEN(env.loops); i < n; ++i)
+			optimize_loop(&env, env.loops[i]);
+	}
+
+	free_loop_infos(&env);
+	DEL_ARR_F(env.loops);
+	obstack_free(&env.obst, NULL);
+
+	ir_graph_properties_t props = IR_GRAPH_PROPERTIES_ALL;
+	if (env.changed) {
+		props = IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		      | IR_GRAPH_PROPERTY_NO_BADS
+		      | IR_GRAPH_PROPERTY_NO_TUPLES;
+		if (!env.cf_changed)
+			props |= IR_GRAPH_PROPERTIES_CONTROL_FLOW;
+		else
+			props |= IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE;
+	}
+	confirm_irg_properties(irg, props);
+	ir_pass_timing_pop();
+}
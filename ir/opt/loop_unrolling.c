@@ -10,6 +10,7 @@
  */
 #include "lcssa_t.h"
 #include "irtools.h"
+#include "passtiming.h"
 #include "xmalloc.h"
 #include "debug.h"
 #include <assert.h>
@@ -656,6 +657,7 @@ static bool duplicate_innermost_loops(ir_loop *const loop, unsigned const factor
 
 void unroll_loops(ir_graph *const irg, unsigned factor, unsigned maxsize)
 {
+	ir_pass_timing_push("unroll_loops", irg);
 	FIRM_DBG_REGISTER(dbg, "firm.opt.loop-unrolling");
 	n_loops_unrolled = 0;
 	assure_lcssa(irg);
@@ -670,4 +672,5 @@ void unroll_loops(ir_graph *const irg, unsigned factor, unsigned maxsize)
 		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
 	} while (reanalyze);
 	DB((dbg, LEVEL_1, "%+F: %d loops unrolled\n", irg, n_loops_unrolled));
+	ir_pass_timing_pop();
 }
@@ -0,0 +1,722 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Vectorization of counted innermost loops.
+ *
+ * We handle loops made of a header and a single body block:
+ *
+ *     header: i = Phi(init, i + 1); mem = Phi(mem0, mem')
+ *             if (i < n) goto body; else goto exit;
+ *     body:   ... Loads/Stores of base[i] and arithmetic on the values ...
+ *             goto header;
+ *
+ * A vector loop processing n_lanes iterations at once is placed in front of
+ * the loop. The original loop stays unchanged and runs the remaining
+ * iterations, so no separate epilogue has to be built. A chain of guard blocks
+ * in front of the vector loop makes sure that n - (n_lanes - 1) does not
+ * overflow and that no stored array overlaps with another accessed array
+ * within one vector. If a guard fails we directly continue with the original
+ * loop.
+ */
+#include "array.h"
+#include "debug.h"
+#include "ircons_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irloop_t.h"
+#include "irnode_t.h"
+#include "irnodemap.h"
+#include "iropt_t.h"
+#include "iroptimize.h"
+#include "irouts_t.h"
+#include "irtools.h"
+#include "passtiming.h"
+#include "pmap.h"
+#include "target_t.h"
+#include "tv_t.h"
+#include "util.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** Maximum number of runtime alias checks we generate per loop. */
+#define MAX_ALIAS_CHECKS 8
+
+typedef enum value_class_t {
+	VC_UNKNOWN,   /**< not classified yet */
+	VC_FAIL,      /**< cannot be vectorized */
+	VC_INVARIANT, /**< loop invariant value, splatted if used as vector */
+	VC_SCALAR,    /**< scalar value derived from the induction variable,
+	                   copied into the vector loop (address calculations) */
+	VC_VECTOR,    /**< one value per lane */
+	VC_MEMORY,    /**< memory or tuple of a memory operation */
+} value_class_t;
+
+typedef struct vloop_t {
+	ir_node    *header;
+	ir_node    *body;
+	int         entry_pos;   /**< header predecessor entering the loop */
+	int         back_pos;    /**< header predecessor from the body */
+	ir_node    *iv;          /**< induction variable Phi */
+	ir_node    *mem;         /**< memory Phi */
+	ir_node    *bound;       /**< loop invariant bound of the induction */
+	ir_mode    *element;     /**< mode of all vectorized values */
+	ir_mode    *vmode;
+	unsigned    n_lanes;
+	ir_node   **load_bases;  /**< distinct base addresses of Loads */
+	ir_node   **store_bases; /**< distinct base addresses of Stores */
+	ir_nodemap  classes;     /**< value_class_t per body node */
+	/* vector loop under construction */
+	ir_node    *vbody;
+	ir_node    *viv;
+	ir_node    *vmem;
+	pmap       *splats;      /**< invariant value -> VSplat */
+} vloop_t;
+
+static bool is_in_loop(vloop_t const *const env, ir_node const *const node)
+{
+	ir_node const *const block = get_nodes_block(node);
+	return block == env->header || block == env->body;
+}
+
+/** Check whether @p node is the induction variable, possibly extended. */
+static bool is_iv(vloop_t const *const env, ir_node const *node)
+{
+	if (is_Conv(node)) {
+		ir_node const *const op = get_Conv_op(node);
+		if (!smaller_mode(get_irn_mode(op), get_irn_mode(node)))
+			return false;
+		node = op;
+	}
+	return node == env->iv;
+}
+
+/**
+ * Match @p ptr against base + iv * element size, with a loop invariant base.
+ *
+ * @return the base address or NULL if @p ptr does not match
+ */
+static ir_node *match_address(vloop_t const *const env, ir_node const *const ptr,
+                              unsigned const size)
+{
+	if (!is_Add(ptr))
+		return NULL;
+	ir_node *base   = get_Add_left(ptr);
+	ir_node *offset = get_Add_right(ptr);
+	if (!mode_is_reference(get_irn_mode(base))) {
+		ir_node *const tmp = base;
+		base   = offset;
+		offset = tmp;
+	}
+	if (is_in_loop(env, base))
+		return NULL;
+
+	unsigned scale = 1;
+	ir_node *index = offset;
+	if (is_Mul(offset) && is_Const(get_Mul_right(offset))) {
+		ir_tarval *const tv = get_Const_tarval(get_Mul_right(offset));
+		if (!tarval_is_long(tv))
+			return NULL;
+		scale = get_tarval_long(tv);
+		index = get_Mul_left(offset);
+	} else if (is_Shl(offset) && is_Const(get_Shl_right(offset))) {
+		ir_tarval *const tv = get_Const_tarval(get_Shl_right(offset));
+		if (!tarval_is_long(tv) || get_tarval_long(tv) >= 8)
+			return NULL;
+		scale = 1u << get_tarval_long(tv);
+		index = get_Shl_left(offset);
+	}
+	if (scale != size || !is_iv(env, index))
+		return NULL;
+	return base;
+}
+
+static void add_base(ir_node ***const bases, ir_node *const base)
+{
+	for (size_t i = 0, n = ARR_LEN(*bases); i < n; ++i) {
+		if ((*bases)[i] == base)
+			return;
+	}
+	ARR_APP1(ir_node*, *bases, base);
+}
+
+static bool check_element_mode(vloop_t *const env, ir_mode *const mode)
+{
+	if (env->element == NULL) {
+		if (!mode_is_int(mode) && !mode_is_float(mode))
+			return false;
+		unsigned const size = get_mode_size_bytes(mode);
+		if (size == 0 || ir_target.vector_size % size != 0
+		    || ir_target.vector_size / size < 2)
+			return false;
+		unsigned const n_lanes = ir_target.vector_size / size;
+		char name[32];
+		snprintf(name, sizeof(name), "V%u%s", n_lanes, get_mode_name(mode));
+		env->element = mode;
+		env->n_lanes = n_lanes;
+		env->vmode   = new_vector_mode(name, mode, n_lanes);
+	}
+	return mode == env->element;
+}
+
+static ir_op *get_vector_op(ir_node const *const node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Add: return op_VAdd;
+	case iro_And: return op_VAnd;
+	case iro_Eor: return op_VEor;
+	case iro_Mul: return op_VMul;
+	case iro_Or:  return op_VOr;
+	case iro_Sub: return op_VSub;
+	default:      return NULL;
+	}
+}
+
+static value_class_t classify(vloop_t *const env, ir_node *const node);
+
+static value_class_t classify_memop(vloop_t *const env, ir_node *const node,
+                                    ir_node *const mem, ir_node *const ptr,
+                                    ir_mode *const mode, bool const is_store)
+{
+	if (ir_throws_exception(node) || !check_element_mode(env, mode))
+		return VC_FAIL;
+	if (classify(env, mem) != VC_MEMORY)
+		return VC_FAIL;
+	ir_node *const base = match_address(env, ptr, get_mode_size_bytes(mode));
+	if (base == NULL || classify(env, ptr) != VC_SCALAR)
+		return VC_FAIL;
+	add_base(is_store ? &env->store_bases : &env->load_bases, base);
+	return VC_MEMORY;
+}
+
+static value_class_t classify_node(vloop_t *const env, ir_node *const node)
+{
+	if (node == env->iv)
+		return VC_SCALAR;
+	if (node == env->mem)
+		return VC_MEMORY;
+	if (get_nodes_block(node) != env->body)
+		return VC_FAIL;
+
+	switch (get_irn_opcode(node)) {
+	case iro_Load:
+		if (get_Load_volatility(node) == volatility_is_volatile)
+			return VC_FAIL;
+		return classify_memop(env, node, get_Load_mem(node),
+		                      get_Load_ptr(node), get_Load_mode(node), false);
+
+	case iro_Store: {
+		if (get_Store_volatility(node) == volatility_is_volatile)
+			return VC_FAIL;
+		ir_node      *const value = get_Store_value(node);
+		value_class_t const cls   = classify(env, value);
+		if (cls != VC_VECTOR && cls != VC_INVARIANT)
+			return VC_FAIL;
+		value_class_t const res
+			= classify_memop(env, node, get_Store_mem(node),
+			                 get_Store_ptr(node), get_irn_mode(value), true);
+		if (res == VC_MEMORY && cls == VC_INVARIANT
+		    && !ir_target.allow_vector_op(op_VSplat, env->vmode))
+			return VC_FAIL;
+		return res;
+	}
+
+	case iro_Proj: {
+		ir_node      *const pred = get_Proj_pred(node);
+		value_class_t const cls  = classify(env, pred);
+		if (cls != VC_MEMORY)
+			return VC_FAIL;
+		if (get_irn_mode(node) == mode_M)
+			return VC_MEMORY;
+		if (is_Load(pred) && get_Proj_num(node) == pn_Load_res)
+			return VC_VECTOR;
+		return VC_FAIL;
+	}
+
+	case iro_Phi:
+	case iro_Sync:
+		return VC_FAIL;
+
+	default:
+		break;
+	}
+
+	ir_mode *const mode = get_irn_mode(node);
+	if (!mode_is_data(mode))
+		return VC_FAIL;
+
+	bool has_scalar = false;
+	bool has_vector = false;
+	foreach_irn_in(node, i, pred) {
+		switch (classify(env, pred)) {
+		case VC_INVARIANT:
+			break;
+		case VC_SCALAR:
+			has_scalar = true;
+			break;
+		case VC_VECTOR:
+			has_vector = true;
+			break;
+		default:
+			return VC_FAIL;
+		}
+	}
+	if (!has_vector)
+		return VC_SCALAR;
+
+	/* vector operands may only be mixed with invariants, which get splatted */
+	ir_op *const vop = get_vector_op(node);
+	if (has_scalar || vop == NULL || mode != env->element
+	    || !ir_target.allow_vector_op(vop, env->vmode))
+		return VC_FAIL;
+	foreach_irn_in(node, i, pred) {
+		if (!is_in_loop(env, pred)
+		    && !ir_target.allow_vector_op(op_VSplat, env->vmode))
+			return VC_FAIL;
+	}
+	return VC_VECTOR;
+}
+
+static value_class_t classify(vloop_t *const env, ir_node *const node)
+{
+	if (!is_in_loop(env, node))
+		return VC_INVARIANT;
+
+	value_class_t cls
+		= (value_class_t)(uintptr_t)ir_nodemap_get(void, &env->classes, node);
+	if (cls != VC_UNKNOWN)
+		return cls;
+	/* the body is acyclic, only the header Phis close cycles */
+	ir_nodemap_insert(&env->classes, node, (void*)(uintptr_t)VC_FAIL);
+	cls = classify_node(env, node);
+	ir_nodemap_insert(&env->classes, node, (void*)(uintptr_t)cls);
+	DB((dbg, LEVEL_3, "  %+F: class %d\n", node, (int)cls));
+	return cls;
+}
+
+/** Check that @p node is iv + 1. */
+static bool is_iv_increment(vloop_t const *const env, ir_node const *const node)
+{
+	if (!is_Add(node))
+		return false;
+	ir_node const *const left  = get_Add_left(node);
+	ir_node const *const right = get_Add_right(node);
+	return left == env->iv && is_Const(right) && is_Const_one(right);
+}
+
+/**
+ * Match the loop control: the header contains only the induction variable
+ * Phi, the memory Phi and the Cond of iv < bound.
+ */
+static bool analyze_header(vloop_t *const env)
+{
+	ir_node *const header = env->header;
+	ir_node *cond = NULL;
+	foreach_irn_out_r(header, i, node) {
+		if (is_Block(node) || get_nodes_block(node) != header)
+			continue;
+		if (is_Phi(node)) {
+			ir_mode *const mode = get_irn_mode(node);
+			if (mode == mode_M && env->mem == NULL) {
+				env->mem = node;
+			} else if (mode_is_int(mode) && env->iv == NULL) {
+				env->iv = node;
+			} else {
+				return false;
+			}
+		} else if (is_Cond(node)) {
+			cond = node;
+		} else if (!is_Cmp(node) && !is_Proj(node)) {
+			return false;
+		}
+	}
+	if (cond == NULL || env->iv == NULL || env->mem == NULL)
+		return false;
+	if (!is_iv_increment(env, get_Phi_pred(env->iv, env->back_pos)))
+		return false;
+
+	ir_node *const cmp = get_Cond_selector(cond);
+	if (!is_Cmp(cmp) || get_nodes_block(cmp) != header)
+		return false;
+	ir_relation relation = get_Cmp_relation(cmp);
+	ir_node    *left     = get_Cmp_left(cmp);
+	ir_node    *right    = get_Cmp_right(cmp);
+	if (right == env->iv) {
+		right    = left;
+		left     = env->iv;
+		relation = get_inversed_relation(relation);
+	}
+	if (left != env->iv || is_in_loop(env, right))
+		return false;
+
+	/* the body must be entered if the relation holds */
+	ir_node *const body_pred = get_Block_cfgpred(env->body, 0);
+	if (get_Proj_pred(body_pred) != cond)
+		return false;
+	if (get_Proj_num(body_pred) == pn_Cond_false)
+		relation = get_negated_relation(relation) & ~ir_relation_unordered;
+	if (relation != ir_relation_less)
+		return false;
+	env->bound = right;
+	return true;
+}
+
+static bool analyze_loop(vloop_t *const env, ir_loop *const loop)
+{
+	if (get_loop_n_elements(loop) != 2)
+		return false;
+	ir_node *blocks[2];
+	for (size_t i = 0; i < 2; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind != k_ir_node)
+			return false;
+		blocks[i] = element.node;
+	}
+
+	/* find the header: the block entered from outside the loop */
+	for (size_t i = 0; i < 2; ++i) {
+		ir_node *const header = blocks[i];
+		ir_node *const body   = blocks[1 - i];
+		if (get_Block_n_cfgpreds(header) != 2
+		    || get_Block_n_cfgpreds(body) != 1)
+			continue;
+		ir_node *const body_pred = get_Block_cfgpred(body, 0);
+		if (!is_Proj(body_pred) || get_nodes_block(body_pred) != header)
+			continue;
+		for (int p = 0; p < 2; ++p) {
+			ir_node *const back = get_Block_cfgpred(header, p);
+			if (is_Jmp(back) && get_nodes_block(back) == body) {
+				env->header    = header;
+				env->body      = body;
+				env->back_pos  = p;
+				env->entry_pos = 1 - p;
+			}
+		}
+	}
+	if (env->header == NULL)
+		return false;
+	ir_node *const entry = get_Block_cfgpred(env->header, env->entry_pos);
+	if (is_Bad(entry) || is_in_loop(env, entry))
+		return false;
+
+	if (!analyze_header(env))
+		return false;
+
+	/* the body may only contain simple operations and the back edge */
+	foreach_irn_out_r(env->body, i, node) {
+		if (is_Block(node) || get_nodes_block(node) != env->body)
+			continue;
+		if (get_irn_mode(node) == mode_X) {
+			if (node != get_Block_cfgpred(env->header, env->back_pos))
+				return false;
+		} else if (!is_Load(node) && !is_Store(node) && !is_Proj(node)
+		           && !is_binop(node) && !is_Conv(node) && !is_Not(node)
+		           && !is_Minus(node)) {
+			return false;
+		}
+	}
+
+	/* classify everything reachable from the back edge memory */
+	ir_node *const back_mem = get_Phi_pred(env->mem, env->back_pos);
+	if (back_mem == env->mem)
+		return false;
+	if (classify(env, back_mem) != VC_MEMORY)
+		return false;
+	if (env->element == NULL || ARR_LEN(env->store_bases) == 0)
+		return false;
+
+	size_t const n_stores = ARR_LEN(env->store_bases);
+	size_t const n_checks = n_stores * (n_stores - 1) / 2
+	                      + n_stores * ARR_LEN(env->load_bases);
+	if (n_checks > MAX_ALIAS_CHECKS)
+		return false;
+
+	/* memory operations not reached through the memory chain */
+	foreach_irn_out_r(env->body, i, node) {
+		if ((is_Load(node) || is_Store(node))
+		    && ir_nodemap_get(void, &env->classes, node) == NULL)
+			return false;
+	}
+	return true;
+}
+
+/* vector loop construction */
+
+static ir_node *build(vloop_t *env, ir_node *node);
+
+static ir_node *build_vector(vloop_t *const env, ir_node *const node)
+{
+	if (is_in_loop(env, node))
+		return build(env, node);
+
+	ir_node *splat = pmap_get(ir_node, env->splats, node);
+	if (splat == NULL) {
+		splat = new_r_VSplat(env->vbody, node, env->vmode);
+		pmap_insert(env->splats, node, splat);
+	}
+	return splat;
+}
+
+static ir_node *build_vector_op(vloop_t *const env, ir_node *const node)
+{
+	ir_node *const block = env->vbody;
+	ir_node *const left  = build_vector(env, get_binop_left(node));
+	ir_node *const right = build_vector(env, get_binop_right(node));
+	switch (get_irn_opcode(node)) {
+	case iro_Add: return new_r_VAdd(block, left, right);
+	case iro_And: return new_r_VAnd(block, left, right);
+	case iro_Eor: return new_r_VEor(block, left, right);
+	case iro_Mul: return new_r_VMul(block, left, right);
+	case iro_Or:  return new_r_VOr(block, left, right);
+	case iro_Sub: return new_r_VSub(block, left, right);
+	default:      panic("unexpected vector operation %+F", node);
+	}
+}
+
+static ir_node *build(vloop_t *const env, ir_node *const node)
+{
+	if (!is_in_loop(env, node))
+		return node;
+	if (node == env->iv)
+		return env->viv;
+	if (node == env->mem)
+		return env->vmem;
+	ir_node *res = (ir_node*)get_irn_link(node);
+	if (res != NULL)
+		return res;
+
+	ir_node       *const block = env->vbody;
+	value_class_t  const cls
+		= (value_class_t)(uintptr_t)ir_nodemap_get(void, &env->classes, node);
+	switch (get_irn_opcode(node)) {
+	case iro_Load: {
+		ir_node *const mem = build(env, get_Load_mem(node));
+		ir_node *const ptr = build(env, get_Load_ptr(node));
+		/* keep the element type, so type based alias analysis still
+		 * relates the vector access to scalar accesses of the array */
+		res = new_r_Load(block, mem, ptr, env->vmode, get_Load_type(node),
+		                 cons_unaligned);
+		break;
+	}
+	case iro_Store: {
+		ir_node *const mem   = build(env, get_Store_mem(node));
+		ir_node *const ptr   = build(env, get_Store_ptr(node));
+		ir_node *const value = build_vector(env, get_Store_value(node));
+		res = new_r_Store(block, mem, ptr, value, get_Store_type(node),
+		                  cons_unaligned);
+		break;
+	}
+	case iro_Proj: {
+		ir_node *const pred = build(env, get_Proj_pred(node));
+		ir_mode *const mode = cls == VC_VECTOR ? env->vmode : get_irn_mode(node);
+		res = new_r_Proj(pred, mode, get_Proj_num(node));
+		break;
+	}
+	default:
+		if (cls == VC_VECTOR) {
+			res = build_vector_op(env, node);
+		} else {
+			assert(cls == VC_SCALAR);
+			res = exact_copy(node);
+			set_nodes_block(res, block);
+			foreach_irn_in(node, i, pred) {
+				set_irn_n(res, i, build(env, pred));
+			}
+		}
+		break;
+	}
+	set_irn_link(node, res);
+	return res;
+}
+
+static ir_node *new_guard_block(ir_node *const cfg)
+{
+	return new_r_Block(get_irn_irg(cfg), 1, &cfg);
+}
+
+/**
+ * Finish a guard block with a Cond on @p cmp. The true exit becomes the new
+ * @p cfg, the false exit is appended to @p fails.
+ */
+static void add_guard(ir_node **const cfg, ir_node ***const fails,
+                      ir_node *const cmp)
+{
+	ir_node *const block = get_nodes_block(cmp);
+	ir_node *const cond  = new_r_Cond(block, cmp);
+	*cfg = new_r_Proj(cond, mode_X, pn_Cond_true);
+	ARR_APP1(ir_node*, *fails, new_r_Proj(cond, mode_X, pn_Cond_false));
+}
+
+/**
+ * Build the guard for |store_base - other| >= vector size, i.e. one vector
+ * access never touches the other array.
+ */
+static void add_alias_guard(ir_node **const cfg, ir_node ***const fails,
+                            ir_node *const store_base, ir_node *const other)
+{
+	ir_node  *const block   = new_guard_block(*cfg);
+	ir_graph *const irg     = get_irn_irg(block);
+	ir_node  *const dist    = new_r_Sub(block, store_base, other);
+	ir_mode  *const mode    = get_irn_mode(dist);
+	ir_mode  *const umode   = find_unsigned_mode(mode);
+	long      const size    = ir_target.vector_size;
+	/* (unsigned)(dist + size - 1) > 2 * size - 2 */
+	ir_node  *const c_add   = new_r_Const_long(irg, mode, size - 1);
+	ir_node  *const shifted = new_r_Add(block, dist, c_add);
+	ir_node  *const udist   = new_r_Conv(block, shifted, umode);
+	ir_node  *const c_cmp   = new_r_Const_long(irg, umode, 2 * size - 2);
+	ir_node  *const cmp     = new_r_Cmp(block, udist, c_cmp,
+	                                    ir_relation_greater);
+	add_guard(cfg, fails, cmp);
+}
+
+static void vectorize_loop(vloop_t *const env)
+{
+	ir_node  *const header = env->header;
+	ir_graph *const irg    = get_irn_irg(header);
+	ir_node  *const iv     = env->iv;
+	ir_node  *const mem    = env->mem;
+	ir_mode  *const mode   = get_irn_mode(iv);
+	ir_node  *const init   = get_Phi_pred(iv, env->entry_pos);
+	ir_node  *const mem0   = get_Phi_pred(mem, env->entry_pos);
+	ir_node        *cfg    = get_Block_cfgpred(header, env->entry_pos);
+	ir_node       **fails  = NEW_ARR_F(ir_node*, 0);
+
+	DB((dbg, LEVEL_1, "vectorizing loop %+F with %u lanes of %+F\n", header,
+	    env->n_lanes, env->element));
+
+	/* the vector loop runs while iv < bound - (n_lanes - 1), make sure this
+	 * does not overflow */
+	ir_node   *const guard    = new_guard_block(cfg);
+	ir_tarval *const tv_lanes = new_tarval_from_long(env->n_lanes - 1, mode);
+	ir_tarval *const tv_min   = tarval_add(get_mode_min(mode), tv_lanes);
+	ir_node   *const c_min    = new_r_Const(irg, tv_min);
+	ir_node   *const c_lanes  = new_r_Const(irg, tv_lanes);
+	ir_node   *const vbound   = new_r_Sub(guard, env->bound, c_lanes);
+	ir_node   *const cmp_min  = new_r_Cmp(guard, env->bound, c_min,
+	                                      ir_relation_greater_equal);
+	add_guard(&cfg, &fails, cmp_min);
+
+	/* stored arrays must not overlap with other accessed arrays */
+	for (size_t s = 0, n_s = ARR_LEN(env->store_bases); s < n_s; ++s) {
+		ir_node *const store_base = env->store_bases[s];
+		for (size_t o = s + 1; o < n_s; ++o)
+			add_alias_guard(&cfg, &fails, store_base, env->store_bases[o]);
+		for (size_t l = 0, n_l = ARR_LEN(env->load_bases); l < n_l; ++l) {
+			ir_node *const load_base = env->load_bases[l];
+			if (load_base != store_base)
+				add_alias_guard(&cfg, &fails, store_base, load_base);
+		}
+	}
+
+	/* vector loop header, the back edge is filled in later */
+	int const rem_opt = get_optimize();
+	set_optimize(0);
+	ir_node *const dummy_x  = new_r_Dummy(irg, mode_X);
+	ir_node *const vhead_in[] = { cfg, dummy_x };
+	ir_node *const vhead    = new_r_Block(irg, ARRAY_SIZE(vhead_in), vhead_in);
+	ir_node *const dummy_iv = new_r_Dummy(irg, mode);
+	ir_node *const iv_in[]  = { init, dummy_iv };
+	ir_node *const viv      = new_r_Phi(vhead, ARRAY_SIZE(iv_in), iv_in, mode);
+	ir_node *const dummy_m  = new_r_Dummy(irg, mode_M);
+	ir_node *const mem_in[] = { mem0, dummy_m };
+	ir_node *const vmem     = new_r_Phi(vhead, ARRAY_SIZE(mem_in), mem_in,
+	                                    mode_M);
+	set_optimize(rem_opt);
+
+	ir_node *const vcmp   = new_r_Cmp(vhead, viv, vbound, ir_relation_less);
+	ir_node *const vcond  = new_r_Cond(vhead, vcmp);
+	ir_node *const vtrue  = new_r_Proj(vcond, mode_X, pn_Cond_true);
+	ir_node *const vfalse = new_r_Proj(vcond, mode_X, pn_Cond_false);
+	ARR_APP1(ir_node*, fails, vfalse);
+
+	/* vector loop body */
+	env->vbody  = new_r_Block(irg, 1, &vtrue);
+	env->viv    = viv;
+	env->vmem   = vmem;
+	env->splats = pmap_create();
+	foreach_irn_out_r(env->body, i, node) {
+		set_irn_link(node, NULL);
+	}
+	ir_node *const back_mem  = build(env, get_Phi_pred(mem, env->back_pos));
+	ir_node *const c_step    = new_r_Const_long(irg, mode, env->n_lanes);
+	ir_node *const viv_next  = new_r_Add(env->vbody, viv, c_step);
+	ir_node *const vjmp      = new_r_Jmp(env->vbody);
+	pmap_destroy(env->splats);
+
+	set_irn_n(vhead, 1, vjmp);
+	set_Phi_pred(viv, 1, viv_next);
+	set_Phi_pred(vmem, 1, back_mem);
+
+	/* join the vector loop exit and the failed guards in front of the
+	 * original loop */
+	size_t    const n_fails = ARR_LEN(fails);
+	ir_node **const iv_ins  = ALLOCAN(ir_node*, n_fails);
+	ir_node **const mem_ins = ALLOCAN(ir_node*, n_fails);
+	for (size_t i = 0; i < n_fails - 1; ++i) {
+		iv_ins[i]  = init;
+		mem_ins[i] = mem0;
+	}
+	iv_ins[n_fails - 1]  = viv;
+	mem_ins[n_fails - 1] = vmem;
+	ir_node *const join     = new_r_Block(irg, n_fails, fails);
+	ir_node *const join_iv  = new_r_Phi(join, n_fails, iv_ins, mode);
+	ir_node *const join_mem = new_r_Phi(join, n_fails, mem_ins, mode_M);
+	DEL_ARR_F(fails);
+
+	set_irn_n(header, env->entry_pos, new_r_Jmp(join));
+	set_Phi_pred(iv, env->entry_pos, join_iv);
+	set_Phi_pred(mem, env->entry_pos, join_mem);
+}
+
+static bool vectorize_innermost_loops(ir_loop *const loop)
+{
+	bool innermost = true;
+	bool changed   = false;
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind == k_ir_loop) {
+			changed  |= vectorize_innermost_loops(element.son);
+			innermost = false;
+		}
+	}
+	if (!innermost || get_loop_depth(loop) == 0)
+		return changed;
+
+	vloop_t env;
+	memset(&env, 0, sizeof(env));
+	ir_graph *const irg = get_irn_irg(get_loop_element(loop, 0).node);
+	ir_nodemap_init(&env.classes, irg);
+	env.load_bases  = NEW_ARR_F(ir_node*, 0);
+	env.store_bases = NEW_ARR_F(ir_node*, 0);
+
+	if (analyze_loop(&env, loop)) {
+		vectorize_loop(&env);
+		changed = true;
+	}
+	DEL_ARR_F(env.store_bases);
+	DEL_ARR_F(env.load_bases);
+	ir_nodemap_destroy(&env.classes);
+	return changed;
+}
+
+void vectorize_loops(ir_graph *const irg)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.vectorize");
+	if (ir_target.vector_size == 0)
+		return;
+
+	ir_pass_timing_push("vectorize_loops", irg);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_BADS
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	bool const changed = vectorize_innermost_loops(get_irg_loop(irg));
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	confirm_irg_properties(irg, changed ? IR_GRAPH_PROPERTIES_NONE
+	                                    : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_timing_pop();
+}
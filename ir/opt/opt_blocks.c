@@ -20,6 +20,7 @@
 #include "irnode_t.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
+#include "passtiming.h"
 #include "set.h"
 #include "util.h"
 
@@ -1163,6 +1164,7 @@ static void add_roots(ir_graph *irg, environment_t *env)
 /* Combines congruent end blocks into one. */
 void shape_blocks(ir_graph *irg)
 {
+	ir_pass_timing_push("shape_blocks", irg);
 	environment_t env;
 	block_t       *bl;
 	int           res, n;
@@ -1239,4 +1241,5 @@ void shape_blocks(ir_graph *irg)
 	DEL_ARR_F(env.live_outs);
 	del_set(env.opcode2id_map);
 	obstack_free(&env.obst, NULL);
+	ir_pass_timing_pop();
 }
@@ -13,7 +13,9 @@
 #include "cgana.h"
 #include "debug.h"
 #include "entity_t.h"
+#include "execfreq.h"
 #include "irbackedge_t.h"
+#include "irdom_t.h"
 #include "ircons_t.h"
 #include "iredges_t.h"
 #include "irflag_t.h"
@@ -30,10 +32,12 @@
 #include "iropt_t.h"
 #include "iroptimize.h"
 #include "irouts_t.h"
+#include "irprofile.h"
 #include "irprog_t.h"
 #include "irtools.h"
 #include "list.h"
 #include "opt_init.h"
+#include "passtiming.h"
 #include "pmap.h"
 #include "pqueue.h"
 #include "xmalloc.h"
@@ -1239,6 +1243,7 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 void inline_functions(unsigned maxsize, int inline_threshold,
                       opt_ptr after_inline_opt)
 {
+	ir_pass_timing_push("inline_functions", NULL);
 	ir_graph *rem = current_ir_graph;
 	obstack_init(&temp_obst);
 
@@ -1301,6 +1306,431 @@ void inline_functions(unsigned maxsize, int inline_threshold,
 
 	obstack_free(&temp_obst, NULL);
 	current_ir_graph = rem;
+	ir_pass_timing_pop();
+}
+
+/** Regions entered less often than this (relative to the function entry) are
+ * cold. */
+#define OUTLINE_COLD_FREQ  0.05
+/** Minimum number of nodes a region must have to be worth a call. */
+#define OUTLINE_MIN_NODES  16
+/** Maximum number of values passed into an outlined function. */
+#define OUTLINE_MAX_PARAMS 8
+
+/** Environment for outlining cold regions. */
+typedef struct outline_env_t {
+	ir_graph   *irg;
+	ir_nodemap  block_nodes;    /**< Maps blocks to an array of their nodes. */
+	ir_node   **nodes_blocks;   /**< Blocks with an entry in block_nodes. */
+	ir_node   **blocks;         /**< Blocks of the current region. */
+	ir_node   **params;         /**< Data values flowing into the region. */
+	ir_node   **mems;           /**< Memory values flowing into the region. */
+	ir_node   **consts;         /**< Constants used inside the region. */
+	ir_node   **frame_members;  /**< Frame Members inside the region. */
+	unsigned    n_nodes;        /**< Number of (non-nop) nodes in the region. */
+	bool        leads_to_panic; /**< Region contains a noreturn call. */
+	bool        has_return;     /**< Region contains a Return. */
+	bool        changed;
+} outline_env_t;
+
+static bool is_frame_member(const ir_node *node)
+{
+	return is_Member(node)
+	    && get_Member_ptr(node) == get_irg_frame(get_irn_irg(node));
+}
+
+/**
+ * Frame Members are not copied into the outlined function: their address is
+ * computed in the original function and passed as a parameter instead.
+ */
+static bool in_region(const ir_node *node)
+{
+	ir_node *block = is_Block(node) ? (ir_node*)node : get_nodes_block(node);
+	return get_Block_mark(block) && !is_frame_member(node);
+}
+
+/**
+ * Walker: records all nodes in the array of their block.
+ */
+static void collect_block_nodes(ir_node *node, void *data)
+{
+	outline_env_t *env = (outline_env_t*)data;
+	if (is_Block(node)) {
+		set_Block_mark(node, false);
+		return;
+	}
+
+	ir_node  *block = get_nodes_block(node);
+	ir_node **nodes = ir_nodemap_get(ir_node*, &env->block_nodes, block);
+	if (nodes == NULL) {
+		nodes = NEW_ARR_F(ir_node*, 0);
+		ARR_APP1(ir_node*, env->nodes_blocks, block);
+	}
+	ARR_APP1(ir_node*, nodes, node);
+	ir_nodemap_insert(&env->block_nodes, block, nodes);
+}
+
+/**
+ * Marks all blocks dominated by @p block as part of the current region.
+ */
+static void collect_region(outline_env_t *env, ir_node *block)
+{
+	set_Block_mark(block, true);
+	ARR_APP1(ir_node*, env->blocks, block);
+	dominates_for_each(block, child) {
+		collect_region(env, child);
+	}
+}
+
+/**
+ * Classifies a value defined outside the region but used inside it.
+ *
+ * @return false if the value cannot be passed into an outlined function
+ */
+static bool add_live_in(outline_env_t *env, ir_node *value)
+{
+	if (irn_visited_else_mark(value))
+		return true;
+
+	ir_mode *mode = get_irn_mode(value);
+	if (is_Bad(value) || is_NoMem(value)
+	    || (is_irn_start_block_placed(value) && get_irn_arity(value) == 0)) {
+		ARR_APP1(ir_node*, env->consts, value);
+	} else if (mode == mode_M) {
+		ARR_APP1(ir_node*, env->mems, value);
+	} else if (value != get_irg_frame(env->irg) && mode_is_data(mode)) {
+		ARR_APP1(ir_node*, env->params, value);
+	} else {
+		/* direct frame accesses, mode_b values, ... */
+		return false;
+	}
+	return true;
+}
+
+static mtp_additional_properties get_call_properties(const ir_node *call)
+{
+	mtp_additional_properties props
+		= get_method_additional_properties(get_Call_type(call));
+	ir_entity *callee = get_Call_callee(call);
+	if (callee != NULL)
+		props |= get_entity_additional_properties(callee);
+	return props;
+}
+
+/**
+ * Checks whether the region starting at @p entry can be moved into a
+ * separate function and collects its live-in values.
+ */
+static bool check_region(outline_env_t *env, ir_node *entry)
+{
+	ir_graph *irg       = env->irg;
+	ir_node  *end_block = get_irg_end_block(irg);
+
+	inc_irg_visited(irg);
+	for (size_t b = 0, n_blocks = ARR_LEN(env->blocks); b < n_blocks; ++b) {
+		ir_node *block = env->blocks[b];
+		if (get_Block_entity(block) != NULL)
+			return false;
+
+		/* the region may only be left by leaving the function */
+		foreach_block_succ(block, edge) {
+			ir_node *succ = get_edge_src_irn(edge);
+			if (succ != end_block && !get_Block_mark(succ))
+				return false;
+		}
+
+		ir_node **nodes = ir_nodemap_get(ir_node*, &env->block_nodes, block);
+		if (nodes == NULL)
+			continue;
+		for (size_t i = 0, n = ARR_LEN(nodes); i < n; ++i) {
+			ir_node *node = nodes[i];
+			if (is_frame_member(node)) {
+				ARR_APP1(ir_node*, env->frame_members, node);
+				continue;
+			}
+			if (!is_nop(node))
+				++env->n_nodes;
+
+			if (is_Call(node)) {
+				mtp_additional_properties props = get_call_properties(node);
+				if (props & mtp_property_returns_twice)
+					return false;
+				if (props & mtp_property_noreturn)
+					env->leads_to_panic = true;
+			} else if (is_Builtin(node)) {
+				switch (get_Builtin_kind(node)) {
+				case ir_bk_va_start:
+				case ir_bk_return_address:
+				case ir_bk_frame_address:
+					return false;
+				default:
+					break;
+				}
+			} else if (is_Return(node)) {
+				env->has_return = true;
+			}
+
+			foreach_irn_in(node, p, pred) {
+				if (!in_region(pred) && !add_live_in(env, pred))
+					return false;
+			}
+		}
+	}
+
+	/* a region without Return never comes back */
+	if (!env->has_return)
+		env->leads_to_panic = true;
+
+	ir_node *start_block = get_irg_start_block(irg);
+	double   entry_freq  = get_block_execfreq(start_block);
+	double   freq        = get_block_execfreq(entry);
+	if (!env->leads_to_panic && freq >= OUTLINE_COLD_FREQ * entry_freq)
+		return false;
+
+	return env->n_nodes >= OUTLINE_MIN_NODES
+	    && ARR_LEN(env->params) <= OUTLINE_MAX_PARAMS
+	    && ARR_LEN(env->mems) > 0;
+}
+
+/**
+ * Creates the method type of an outlined region: the live-in values become
+ * parameters, the results are the same as the ones of the original function.
+ */
+static ir_type *create_outlined_type(outline_env_t *env)
+{
+	ir_type *mtp      = get_entity_type(get_irg_entity(env->irg));
+	size_t   n_params = ARR_LEN(env->params);
+	size_t   n_ress   = get_method_n_ress(mtp);
+	ir_type *new_mtp  = new_type_method(n_params, n_ress, false, cc_cdecl_set,
+	                                    mtp_no_property);
+	for (size_t i = 0; i < n_params; ++i) {
+		ir_mode *mode = get_irn_mode(env->params[i]);
+		set_method_param_type(new_mtp, i, get_type_for_mode(mode));
+	}
+	for (size_t i = 0; i < n_ress; ++i)
+		set_method_res_type(new_mtp, i, get_method_res_type(mtp, i));
+	return new_mtp;
+}
+
+/**
+ * Moves the region starting at @p entry into a new function and replaces it
+ * by a call to that function.
+ */
+static void outline_region(outline_env_t *env, ir_node *entry)
+{
+	ir_graph  *irg     = env->irg;
+	ir_entity *ent     = get_irg_entity(irg);
+	ident     *name    = new_id_fmt("%s.cold", get_entity_name(ent));
+	ir_type   *new_mtp = create_outlined_type(env);
+	ir_entity *new_ent = new_entity(get_glob_type(),
+	                                id_unique(get_id_str(name)), new_mtp);
+	set_entity_visibility(new_ent, ir_visibility_local);
+	add_entity_additional_properties(new_ent, mtp_property_noinline
+		| (env->has_return ? mtp_no_property : mtp_property_noreturn));
+
+	ir_graph *new_irg     = new_ir_graph(new_ent, 0);
+	ir_node  *start_block = get_irg_start_block(new_irg);
+	ir_node  *args        = get_irg_args(new_irg);
+	ir_node  *initial_mem = get_irg_initial_mem(new_irg);
+
+	/* map the values flowing into the region */
+	for (size_t i = 0, n = ARR_LEN(env->params); i < n; ++i) {
+		ir_node *param = env->params[i];
+		set_new_node(param, new_r_Proj(args, get_irn_mode(param), i));
+	}
+	for (size_t i = 0, n = ARR_LEN(env->mems); i < n; ++i)
+		set_new_node(env->mems[i], initial_mem);
+	for (size_t i = 0, n = ARR_LEN(env->consts); i < n; ++i) {
+		ir_node *value = env->consts[i];
+		ir_node *new_value;
+		if (is_Bad(value)) {
+			new_value = new_r_Bad(new_irg, get_irn_mode(value));
+		} else if (is_NoMem(value)) {
+			new_value = get_irg_no_mem(new_irg);
+		} else {
+			new_value = irn_copy_into_irg(value, new_irg);
+			set_nodes_block(new_value, start_block);
+		}
+		set_new_node(value, new_value);
+	}
+	set_new_node(get_Block_cfgpred(entry, 0), new_r_Jmp(start_block));
+
+	/* copy the region */
+	for (size_t b = 0, n_blocks = ARR_LEN(env->blocks); b < n_blocks; ++b) {
+		ir_node *block = env->blocks[b];
+		set_new_node(block, irn_copy_into_irg(block, new_irg));
+		mark_irn_visited(block);
+		ir_node **nodes = ir_nodemap_get(ir_node*, &env->block_nodes, block);
+		if (nodes == NULL)
+			continue;
+		for (size_t i = 0, n = ARR_LEN(nodes); i < n; ++i) {
+			ir_node *node = nodes[i];
+			if (!in_region(node))
+				continue;
+			set_new_node(node, irn_copy_into_irg(node, new_irg));
+			mark_irn_visited(node);
+		}
+	}
+	for (size_t b = 0, n_blocks = ARR_LEN(env->blocks); b < n_blocks; ++b) {
+		ir_node *block = env->blocks[b];
+		irn_rewire_inputs(block);
+		ir_node **nodes = ir_nodemap_get(ir_node*, &env->block_nodes, block);
+		if (nodes == NULL)
+			continue;
+		for (size_t i = 0, n = ARR_LEN(nodes); i < n; ++i) {
+			ir_node *node = nodes[i];
+			if (in_region(node))
+				irn_rewire_inputs(node);
+		}
+	}
+
+	/* move the exits and keep-alives of the region */
+	ir_node  *end_block   = get_irg_end_block(irg);
+	ir_node  *new_end_blk = get_irg_end_block(new_irg);
+	int       n_end_preds = get_Block_n_cfgpreds(end_block);
+	ir_node **end_in      = ALLOCAN(ir_node*, n_end_preds + 1);
+	int       n_end_in    = 0;
+	for (int i = 0; i < n_end_preds; ++i) {
+		ir_node *pred = get_Block_cfgpred(end_block, i);
+		if (in_region(pred))
+			add_immBlock_pred(new_end_blk, get_new_node(pred));
+		else
+			end_in[n_end_in++] = pred;
+	}
+	ir_node *end     = get_irg_end(irg);
+	ir_node *new_end = get_irg_end(new_irg);
+	for (int i = get_End_n_keepalives(end); i-- > 0; ) {
+		ir_node *keep = get_End_keepalive(end, i);
+		if (!in_region(keep))
+			continue;
+		add_End_keepalive(new_end, get_new_node(keep));
+		set_End_keepalive(end, i, new_r_Bad(irg, get_irn_mode(keep)));
+	}
+	remove_End_Bads_and_doublets(end);
+	irg_finalize_cons(new_irg);
+
+	/* replace the region by a call */
+	ir_node *frame_block = get_nodes_block(get_irg_frame(irg));
+	for (size_t i = 0, n = ARR_LEN(env->frame_members); i < n; ++i)
+		set_nodes_block(env->frame_members[i], frame_block);
+
+	size_t   n_mems = ARR_LEN(env->mems);
+	ir_node *mem    = n_mems == 1 ? env->mems[0]
+	                : new_r_Sync(entry, n_mems, env->mems);
+	ir_node *callee = new_r_Address(irg, new_ent);
+	ir_node *call   = new_rd_Call(get_irn_dbg_info(entry), entry, mem, callee,
+	                              ARR_LEN(env->params), env->params, new_mtp);
+	ir_node *call_mem = new_r_Proj(call, mode_M, pn_Call_M);
+	ir_node *call_res = new_r_Proj(call, mode_T, pn_Call_T_result);
+
+	size_t    n_ress  = get_method_n_ress(new_mtp);
+	ir_node **results = ALLOCAN(ir_node*, n_ress);
+	for (size_t i = 0; i < n_ress; ++i) {
+		ir_mode *mode = get_type_mode(get_method_res_type(new_mtp, i));
+		results[i] = new_r_Proj(call_res, mode, i);
+	}
+	end_in[n_end_in++] = new_r_Return(entry, call_mem, n_ress, results);
+	set_irn_in(end_block, n_end_in, end_in);
+
+	DB((dbg, LEVEL_1, "%+F: outlined region at %+F (%u nodes) into %+F\n",
+	    irg, entry, env->n_nodes, new_ent));
+	env->changed = true;
+}
+
+static bool try_outline(outline_env_t *env, ir_node *entry)
+{
+	ir_graph *irg = env->irg;
+	if (entry == get_irg_start_block(irg) || entry == get_irg_end_block(irg)
+	    || get_Block_n_cfgpreds(entry) != 1)
+		return false;
+
+	ARR_SHRINKLEN(env->blocks, 0);
+	ARR_SHRINKLEN(env->params, 0);
+	ARR_SHRINKLEN(env->mems, 0);
+	ARR_SHRINKLEN(env->consts, 0);
+	ARR_SHRINKLEN(env->frame_members, 0);
+	env->n_nodes        = 0;
+	env->leads_to_panic = false;
+	env->has_return     = false;
+
+	collect_region(env, entry);
+	bool const outline = check_region(env, entry);
+	if (outline)
+		outline_region(env, entry);
+
+	for (size_t b = 0, n_blocks = ARR_LEN(env->blocks); b < n_blocks; ++b)
+		set_Block_mark(env->blocks[b], false);
+	return outline;
+}
+
+static void outline_walk(outline_env_t *env, ir_node *block)
+{
+	if (try_outline(env, block))
+		return;
+	dominates_for_each(block, child) {
+		outline_walk(env, child);
+	}
+}
+
+void outline_cold_regions(ir_graph *irg)
+{
+	ir_entity *ent = get_irg_entity(irg);
+	ir_type   *mtp = get_entity_type(ent);
+	mtp_additional_properties props = get_entity_additional_properties(ent);
+	/* outlining only pays off if the remainder may be inlined */
+	if (props & (mtp_property_noinline | mtp_property_naked)) {
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
+		return;
+	}
+	for (size_t i = 0, n = get_method_n_ress(mtp); i < n; ++i) {
+		if (is_compound_type(get_method_res_type(mtp, i))) {
+			confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
+			return;
+		}
+	}
+
+	ir_pass_timing_push("outline_cold_regions", irg);
+	ir_profile_set_execfreqs(irg);
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_NO_BADS
+		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+
+	outline_env_t env;
+	env.irg           = irg;
+	env.nodes_blocks  = NEW_ARR_F(ir_node*, 0);
+	env.blocks        = NEW_ARR_F(ir_node*, 0);
+	env.params        = NEW_ARR_F(ir_node*, 0);
+	env.mems          = NEW_ARR_F(ir_node*, 0);
+	env.consts        = NEW_ARR_F(ir_node*, 0);
+	env.frame_members = NEW_ARR_F(ir_node*, 0);
+	env.changed       = false;
+	ir_nodemap_init(&env.block_nodes, irg);
+	irg_walk_graph(irg, NULL, collect_block_nodes, &env);
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED
+	                          | IR_RESOURCE_BLOCK_MARK);
+
+	outline_walk(&env, get_irg_start_block(irg));
+
+	for (size_t i = 0, n = ARR_LEN(env.nodes_blocks); i < n; ++i) {
+		ir_node *block = env.nodes_blocks[i];
+		DEL_ARR_F(ir_nodemap_get(ir_node*, &env.block_nodes, block));
+	}
+	ir_nodemap_destroy(&env.block_nodes);
+	DEL_ARR_F(env.frame_members);
+	DEL_ARR_F(env.consts);
+	DEL_ARR_F(env.mems);
+	DEL_ARR_F(env.params);
+	DEL_ARR_F(env.blocks);
+	DEL_ARR_F(env.nodes_blocks);
+
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED
+	                       | IR_RESOURCE_BLOCK_MARK);
+	confirm_irg_properties(irg, env.changed ? IR_GRAPH_PROPERTIES_NONE
+	                                        : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_timing_pop();
 }
 
 void firm_init_inline(void)
@@ -22,6 +22,7 @@
 #include "irnodeset.h"
 #include "iroptimize.h"
 #include "obst.h"
+#include "passtiming.h"
 #include "type_t.h"
 
 typedef struct parallelize_info
@@ -494,6 +495,7 @@ static void eliminate_sync_edges(ir_graph *irg)
 
 void opt_parallelize_mem(ir_graph *irg)
 {
+	ir_pass_timing_push("opt_parallelize_mem", irg);
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
 	                           | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
 	irg_walk_blkwise_dom_top_down(irg, NULL, walker, NULL);
@@ -501,4 +503,5 @@ void opt_parallelize_mem(ir_graph *irg)
 	eliminate_sync_edges(irg);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	ir_pass_timing_pop();
 }
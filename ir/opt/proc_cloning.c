@@ -30,6 +30,7 @@
 #include "irprog_t.h"
 #include "irtools.h"
 #include "panic.h"
+#include "passtiming.h"
 #include "set.h"
 #include "tv.h"
 
@@ -589,6 +590,7 @@ restart:
 
 void proc_cloning(float threshold)
 {
+	ir_pass_timing_push("proc_cloning", NULL);
 	DEBUG_ONLY(firm_dbg_module_t *dbg;)
 
 	/* register a debug mask */
@@ -665,4 +667,5 @@ void proc_cloning(float threshold)
 		}
 	}
 	obstack_free(&hmap.obst, NULL);
+	ir_pass_timing_pop();
 }
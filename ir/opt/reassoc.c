@@ -8,10 +8,14 @@
  * @brief   Reassociation
  * @author  Michael Beck
  */
+#include "passtiming.h"
 #include "reassoc_t.h"
 
+#include "array.h"
 #include "debug.h"
+#include "heights.h"
 #include "ircons_t.h"
+#include "irdom.h"
 #include "iredges_t.h"
 #include "irflag_t.h"
 #include "irgmod.h"
@@ -26,10 +30,13 @@
 #include "iropt_t.h"
 #include "iroptimize.h"
 #include "irouts.h"
+#include "irtools.h"
 #include "opt_init.h"
 #include "panic.h"
 #include "pdeq.h"
+#include "target_t.h"
 #include "unionfind.h"
+#include "util.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -2064,11 +2071,294 @@ static void do_chaining(ir_graph *irg)
 	deq_free(&wq);
 }
 
+/**
+ * Returns whether the chains of the operation of @p node may be rebalanced.
+ */
+static bool is_balanceable(const ir_node *node)
+{
+	if (!is_Add(node) && !is_Mul(node) && !is_And(node) && !is_Or(node)
+	    && !is_Eor(node))
+		return false;
+
+	/* reassociating floatingpoint ops is imprecise */
+	ir_mode *const mode = get_irn_mode(node);
+	if (mode_is_float(mode))
+		return ir_imprecise_float_transforms_allowed();
+	return mode_is_int(mode);
+}
+
+/**
+ * Returns whether @p node is an inner node of the chain that contains its
+ * only user @p user.
+ */
+static bool is_chain_inner(const ir_node *node, const ir_node *user)
+{
+	return get_irn_op(node) == get_irn_op(user)
+	    && get_irn_mode(node) == get_irn_mode(user)
+	    && get_nodes_block(node) == get_nodes_block(user)
+	    && get_irn_n_edges(node) == 1;
+}
+
+static bool is_chain_root(const ir_node *node)
+{
+	if (!is_balanceable(node))
+		return false;
+	if (get_irn_n_edges(node) != 1)
+		return true;
+	ir_node const *const user = get_edge_src_irn(get_irn_out_edge_first(node));
+	return !is_chain_inner(node, user);
+}
+
+typedef struct {
+	ir_heights_t *heights;
+	ir_node     **roots; /**< roots of the chains in walk order */
+} thr_env_t;
+
+/* the link of a block tells whether the block is latency bound */
+#define BLOCK_LATENCY_BOUND    INT_TO_PTR(1)
+#define BLOCK_THROUGHPUT_BOUND INT_TO_PTR(2)
+
+/**
+ * Checks with the heights whether the instructions of @p block can fill
+ * the issue slots of the target. Only then the block is throughput bound
+ * and a shorter critical path does not pay off.
+ */
+static bool is_latency_bound(ir_heights_t *heights, ir_node *block)
+{
+	unsigned n_insns    = 0;
+	unsigned max_height = 0;
+	foreach_out_edge(block, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (is_Phi(node) || is_Proj(node))
+			continue;
+		++n_insns;
+		max_height = MAX(max_height, get_irn_height(heights, node));
+	}
+	return n_insns < ir_target.issue_width * (max_height + 1);
+}
+
+static void collect_chain_roots(ir_node *node, void *data)
+{
+	thr_env_t *const env = (thr_env_t*)data;
+	if (!is_chain_root(node))
+		return;
+
+	ir_node *const block = get_nodes_block(node);
+	if (get_irn_link(block) == NULL) {
+		bool const latency_bound = is_latency_bound(env->heights, block);
+		set_irn_link(block, latency_bound ? BLOCK_LATENCY_BOUND
+		                                  : BLOCK_THROUGHPUT_BOUND);
+	}
+	if (get_irn_link(block) == BLOCK_LATENCY_BOUND)
+		ARR_APP1(ir_node*, env->roots, node);
+}
+
+/**
+ * Returns the length of the longest data dependency path from the start of
+ * @p block to @p node, counted in instructions. The result is cached in the
+ * link of the node.
+ */
+static unsigned get_depth(ir_node *node, ir_node const *block)
+{
+	if (get_nodes_block(node) != block || is_Phi(node))
+		return 0;
+	intptr_t const cached = PTR_TO_INT(get_irn_link(node));
+	if (cached != 0)
+		return cached - 1;
+
+	/* memory edges order the operations but do not delay them */
+	unsigned depth = 0;
+	foreach_irn_in(node, i, pred) {
+		if (get_irn_mode(pred) != mode_M)
+			depth = MAX(depth, get_depth(pred, block));
+	}
+	if (!is_Proj(node))
+		++depth;
+	set_irn_link(node, INT_TO_PTR(depth + 1));
+	return depth;
+}
+
+/**
+ * Returns whether @p node is a value of the previous iteration of a loop
+ * containing @p block.
+ */
+static bool is_loop_carried(ir_node const *node, ir_node const *block)
+{
+	if (!is_Phi(node))
+		return false;
+	ir_node const *const phi_block = get_nodes_block(node);
+	return has_backedges(phi_block) && block_dominates(phi_block, block);
+}
+
+typedef struct {
+	ir_node *node;
+	unsigned ready; /**< cycle in which the value is available */
+} chain_value_t;
+
+/** Inserts @p value into the array @p values sorted by ready time. */
+static chain_value_t *insert_value(chain_value_t *values, chain_value_t value)
+{
+	size_t i = ARR_LEN(values);
+	ARR_APP1(chain_value_t, values, value);
+	for (; i > 0 && values[i - 1].ready > value.ready; --i)
+		values[i] = values[i - 1];
+	values[i] = value;
+	return values;
+}
+
+/**
+ * Combines @p values to a balanced tree: In every cycle the two earliest
+ * available values are combined, but not more pairs than the target can
+ * issue. Only the ready times are computed if @p root is NULL, otherwise
+ * the nodes are created like @p root.
+ *
+ * @return the value of the tree
+ */
+static chain_value_t combine_values(chain_value_t const *values,
+                                    ir_node const *root)
+{
+	chain_value_t *tree = NEW_ARR_F(chain_value_t, 0);
+	for (size_t i = 0, n = ARR_LEN(values); i < n; ++i)
+		ARR_APP1(chain_value_t, tree, values[i]);
+
+	unsigned const width = ir_target.issue_width;
+	unsigned       cycle = 0;
+	while (ARR_LEN(tree) > 1) {
+		cycle = MAX(cycle, tree[1].ready);
+		size_t n_ready = 2;
+		while (n_ready < ARR_LEN(tree) && tree[n_ready].ready <= cycle)
+			++n_ready;
+		size_t const n_pairs = MIN(n_ready / 2, (size_t)width);
+
+		chain_value_t *next = NEW_ARR_F(chain_value_t, 0);
+		for (size_t i = 2 * n_pairs, n = ARR_LEN(tree); i < n; ++i)
+			ARR_APP1(chain_value_t, next, tree[i]);
+		for (size_t i = 0; i < n_pairs; ++i) {
+			chain_value_t value = { NULL, cycle + 1 };
+			if (root != NULL) {
+				ir_node *in[] = { tree[2 * i].node, tree[2 * i + 1].node };
+				value.node = create_node(get_irn_dbg_info(root),
+				                         get_nodes_block(root),
+				                         get_irn_op(root), get_irn_mode(root),
+				                         ARRAY_SIZE(in), in);
+			}
+			next = insert_value(next, value);
+		}
+		DEL_ARR_F(tree);
+		tree = next;
+		++cycle;
+	}
+
+	chain_value_t const res = tree[0];
+	DEL_ARR_F(tree);
+	return res;
+}
+
+/**
+ * Rebalances the chain rooted at @p root if that shortens its critical path
+ * or the path from a loop-carried value to the root.
+ */
+static void balance_chain(ir_node *root)
+{
+	/* collect the leaves. Loop-carried values and constants stay at the top,
+	 * so both are combined last */
+	ir_node       *const block        = get_nodes_block(root);
+	chain_value_t       *values       = NEW_ARR_F(chain_value_t, 0);
+	ir_node            **consts       = NEW_ARR_F(ir_node*, 0);
+	ir_node            **phis         = NEW_ARR_F(ir_node*, 0);
+	ir_node            **stack        = NEW_ARR_F(ir_node*, 0);
+	unsigned            *levels       = NEW_ARR_F(unsigned, 0);
+	unsigned             old_phi_path = 0;
+	ARR_APP1(ir_node*, stack, root);
+	ARR_APP1(unsigned, levels, 0);
+	while (ARR_LEN(stack) > 0) {
+		ir_node *const node  = stack[ARR_LEN(stack) - 1];
+		unsigned const level = levels[ARR_LEN(levels) - 1] + 1;
+		ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+		ARR_SHRINKLEN(levels, ARR_LEN(levels) - 1);
+		for (int i = get_irn_arity(node); i-- > 0;) {
+			ir_node *const pred = get_irn_n(node, i);
+			if (is_chain_inner(pred, node)) {
+				ARR_APP1(ir_node*, stack, pred);
+				ARR_APP1(unsigned, levels, level);
+			} else if (is_loop_carried(pred, block)) {
+				ARR_APP1(ir_node*, phis, pred);
+				old_phi_path = MAX(old_phi_path, level);
+			} else if (is_Const(pred)) {
+				ARR_APP1(ir_node*, consts, pred);
+			} else {
+				chain_value_t const value = { pred, get_depth(pred, block) };
+				values = insert_value(values, value);
+			}
+		}
+	}
+	DEL_ARR_F(levels);
+	DEL_ARR_F(stack);
+
+	size_t const n_phis   = ARR_LEN(phis);
+	size_t const n_late   = ARR_LEN(consts) + n_phis;
+	size_t const n_leaves = ARR_LEN(values) + n_late;
+	if (n_leaves < 3 || ARR_LEN(values) == 0)
+		goto end;
+
+	/* only rebuild if neither path gets longer and one gets shorter */
+	unsigned const old_depth = get_depth(root, block);
+	unsigned const new_depth = combine_values(values, NULL).ready + n_late;
+	if (new_depth > old_depth || n_phis > old_phi_path
+	    || (new_depth == old_depth && n_phis == old_phi_path))
+		goto end;
+
+	DBG((dbg, LEVEL_3, "balancing %+F: %zu leaves, depth %u -> %u\n", root,
+	     n_leaves, old_depth, new_depth));
+
+	ir_node *res = combine_values(values, root).node;
+	for (size_t i = 0; i < n_late; ++i) {
+		ir_node *const late = i < ARR_LEN(consts) ? consts[i]
+		                                          : phis[i - ARR_LEN(consts)];
+		ir_node *in[] = { res, late };
+		res = create_node(get_irn_dbg_info(root), block, get_irn_op(root),
+		                  get_irn_mode(root), ARRAY_SIZE(in), in);
+	}
+	if (res != root)
+		exchange(root, res);
+
+end:
+	DEL_ARR_F(phis);
+	DEL_ARR_F(consts);
+	DEL_ARR_F(values);
+}
+
+/**
+ * Tree height reduction: Rebalances chains of an associative operation like
+ * a + b + c + d into (a + b) + (c + d), so that the target can execute the
+ * operations in parallel. The leaves are combined in the order in which they
+ * become available, at most as many at once as the target issues per cycle.
+ */
+static void do_tree_height_reduction(ir_graph *irg)
+{
+	if (ir_target.issue_width < 2)
+		return;
+
+	thr_env_t env;
+	env.heights = heights_new(irg);
+	env.roots   = NEW_ARR_F(ir_node*, 0);
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	irg_walk_graph(irg, firm_clear_link, collect_chain_roots, &env);
+	heights_free(env.heights);
+
+	for (size_t i = 0, n = ARR_LEN(env.roots); i < n; ++i)
+		balance_chain(env.roots[i]);
+
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	DEL_ARR_F(env.roots);
+}
+
 /*
  * do the reassociation
  */
 void optimize_reassociation(ir_graph *irg)
 {
+	ir_pass_timing_push("optimize_reassociation", irg);
 	assert(get_irg_pinned(irg) != op_pin_state_floats &&
 	       "Reassociation needs pinned graph to work properly");
 
@@ -2110,7 +2400,11 @@ void optimize_reassociation(ir_graph *irg)
 
 	deq_free(&wq);
 
+	DBG((dbg, LEVEL_5, "tree height reduction start...\n"));
+	do_tree_height_reduction(irg);
+
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	ir_pass_timing_pop();
 }
 
 void ir_register_reassoc_node_ops(void)
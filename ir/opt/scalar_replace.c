@@ -8,6 +8,7 @@
  * @brief   Scalar replacement of compounds.
  * @author  Beyhan Veliev, Michael Beck
  */
+#include "passtiming.h"
 #include "scalar_replace.h"
 
 #include "array.h"
@@ -562,6 +563,7 @@ static void do_scalar_replacements(ir_graph *irg, pset *members, unsigned nvals,
  */
 void scalar_replacement_opt(ir_graph *irg)
 {
+	ir_pass_timing_push("scalar_replacement_opt", irg);
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
 	                         | IR_GRAPH_PROPERTY_CONSISTENT_OUTS
 	                         | IR_GRAPH_PROPERTY_NO_TUPLES);
@@ -640,6 +642,7 @@ void scalar_replacement_opt(ir_graph *irg)
 
 	confirm_irg_properties(irg, changed ? IR_GRAPH_PROPERTIES_NONE
 	                                    : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_timing_pop();
 }
 
 void firm_init_scalar_replace(void)
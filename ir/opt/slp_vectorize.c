@@ -0,0 +1,696 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Superword level parallelism: packing of straight-line code.
+ *
+ * Seeds are groups of Stores in one block which write n_lanes consecutive
+ * elements relative to the same base address, for example the fields of a
+ * small vector struct. Starting at the stored values we try to build a tree
+ * of packs:
+ *
+ *  - lane-wise identical values become a VSplat,
+ *  - Loads of consecutive elements relative to a common base become one
+ *    vector Load,
+ *  - isomorphic, independent operations become one vector operation.
+ *
+ * Adjacency and reordering of memory operations is decided with the memory
+ * disambiguator, independence of the lanes of an operation with the heights
+ * of the block. The vector Load is placed at the first Load of its pack in
+ * the memory chain, the vector Store at the last Store of its pack. A tree is
+ * only rewritten if it consists of fewer vector than scalar operations.
+ */
+#include "array.h"
+#include "debug.h"
+#include "heights.h"
+#include "ircons_t.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irmemory_t.h"
+#include "irnode_t.h"
+#include "iroptimize.h"
+#include "irtools.h"
+#include "obst.h"
+#include "passtiming.h"
+#include "pmap.h"
+#include "target_t.h"
+#include "tv_t.h"
+#include "typerep.h"
+#include "util.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+typedef enum pack_kind_t {
+	PACK_SPLAT, /**< the same value in all lanes */
+	PACK_LOAD,  /**< Loads of consecutive elements */
+	PACK_OP,    /**< isomorphic operations */
+	PACK_STORE, /**< Stores of consecutive elements, the root of a tree */
+} pack_kind_t;
+
+typedef struct pack_t pack_t;
+struct pack_t {
+	pack_kind_t kind;
+	ir_node   **lanes;       /**< the scalar nodes, Loads for load packs */
+	ir_node   **values;      /**< the scalar values used by the user pack */
+	ir_node    *anchor;      /**< first Load/last Store in the memory chain */
+	pack_t     *operands[2];
+	ir_node    *vector;      /**< the vector value once built */
+};
+
+typedef struct store_ref_t {
+	ir_node *store;
+	ir_node *base;
+	long     offset;
+} store_ref_t;
+
+typedef struct slp_env_t {
+	ir_heights_t   *heights;
+	struct obstack  obst;
+	ir_node        *block;
+	ir_mode        *element;
+	ir_mode        *vmode;
+	unsigned        n_lanes;
+	pack_t        **packs;        /**< packs of the current tree, users first */
+	pmap           *value_packs;  /**< value of the first lane -> pack */
+	pmap           *splats;       /**< splatted value -> pack */
+	unsigned        scalar_cost;
+	unsigned        vector_cost;
+} slp_env_t;
+
+static ir_node *get_memop_ptr_(ir_node const *const node)
+{
+	return is_Load(node) ? get_Load_ptr(node) : get_Store_ptr(node);
+}
+
+static ir_node *get_memop_mem_(ir_node const *const node)
+{
+	return is_Load(node) ? get_Load_mem(node) : get_Store_mem(node);
+}
+
+static ir_type *get_memop_type_(ir_node const *const node)
+{
+	return is_Load(node) ? get_Load_type(node) : get_Store_type(node);
+}
+
+static unsigned get_memop_size(ir_node const *const node)
+{
+	ir_mode *const mode = is_Load(node) ? get_Load_mode(node)
+	                                    : get_irn_mode(get_Store_value(node));
+	return get_mode_size_bytes(mode);
+}
+
+static bool may_alias(ir_node const *const a, ir_node const *const b)
+{
+	return get_alias_relation(get_memop_ptr_(a), get_memop_type_(a),
+	                          get_memop_size(a), get_memop_ptr_(b),
+	                          get_memop_type_(b), get_memop_size(b))
+	    != ir_no_alias;
+}
+
+/**
+ * Returns the Load or Store in front of @p node in the memory chain of its
+ * block, NULL if there is none.
+ */
+static ir_node *get_chain_pred(ir_node const *const node)
+{
+	ir_node *const mem = get_memop_mem_(node);
+	if (!is_Proj(mem))
+		return NULL;
+	ir_node *const pred = get_Proj_pred(mem);
+	if ((!is_Load(pred) && !is_Store(pred))
+	    || get_nodes_block(pred) != get_nodes_block(node))
+		return NULL;
+	return pred;
+}
+
+/** Check whether @p from is behind @p to in the memory chain. */
+static bool chain_reaches(ir_node const *from, ir_node const *const to)
+{
+	for (; from != NULL; from = get_chain_pred(from)) {
+		if (from == to)
+			return true;
+	}
+	return false;
+}
+
+static ir_node *get_mem_proj(ir_node const *const node)
+{
+	foreach_out_edge(node, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (get_irn_mode(proj) == mode_M)
+			return proj;
+	}
+	return NULL;
+}
+
+static bool has_only_user(ir_node const *const node, ir_node const *const user)
+{
+	foreach_out_edge(node, edge) {
+		if (get_edge_src_irn(edge) != user)
+			return false;
+	}
+	return true;
+}
+
+static bool is_lane(slp_env_t const *const env, pack_t const *const pack,
+                    ir_node const *const node)
+{
+	for (unsigned i = 0; i < env->n_lanes; ++i) {
+		if (pack->lanes[i] == node)
+			return true;
+	}
+	return false;
+}
+
+static bool is_simple_memop(slp_env_t const *const env, ir_node const *const node)
+{
+	if (get_nodes_block(node) != env->block || ir_throws_exception(node))
+		return false;
+	if (is_Load(node))
+		return get_Load_volatility(node) == volatility_non_volatile;
+	return get_Store_volatility(node) == volatility_non_volatile;
+}
+
+/**
+ * The lanes must address consecutive elements of a common base in lane
+ * order.
+ */
+static bool check_adjacent(slp_env_t const *const env, ir_node **const lanes)
+{
+	unsigned const size = get_mode_size_bytes(env->element);
+	long           offset0;
+	ir_node *const base = get_base_address(get_memop_ptr_(lanes[0]), &offset0);
+	for (unsigned i = 1; i < env->n_lanes; ++i) {
+		long offset;
+		if (get_base_address(get_memop_ptr_(lanes[i]), &offset) != base
+		    || offset != offset0 + (long)(i * size))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * All Loads of the pack are moved to the first one in the memory chain, so
+ * no Store in between may write to them.
+ */
+static bool check_load_pack(slp_env_t const *const env, pack_t *const pack)
+{
+	ir_node **const lanes = pack->lanes;
+	ir_node        *first = NULL;
+	for (unsigned c = 0; c < env->n_lanes && first == NULL; ++c) {
+		first = lanes[c];
+		for (unsigned i = 0; i < env->n_lanes; ++i) {
+			if (!chain_reaches(lanes[i], lanes[c])) {
+				first = NULL;
+				break;
+			}
+		}
+	}
+	if (first == NULL)
+		return false;
+
+	for (unsigned i = 0; i < env->n_lanes; ++i) {
+		ir_node *const lane = lanes[i];
+		if (lane == first)
+			continue;
+		for (ir_node *op = get_chain_pred(lane); op != first;
+		     op = get_chain_pred(op)) {
+			if (is_Store(op) && may_alias(op, lane))
+				return false;
+		}
+	}
+	pack->anchor = first;
+	return true;
+}
+
+/**
+ * All Stores of the pack are moved to the last one in the memory chain, so
+ * no memory operation in between may access them and nothing else may
+ * observe the memory state in between.
+ */
+static bool check_store_pack(slp_env_t const *const env, pack_t *const pack)
+{
+	ir_node **const lanes = pack->lanes;
+	ir_node        *last  = NULL;
+	for (unsigned c = 0; c < env->n_lanes && last == NULL; ++c) {
+		last = lanes[c];
+		for (unsigned i = 0; i < env->n_lanes; ++i) {
+			if (!chain_reaches(lanes[c], lanes[i])) {
+				last = NULL;
+				break;
+			}
+		}
+	}
+	if (last == NULL)
+		return false;
+
+	for (unsigned i = 0; i < env->n_lanes; ++i) {
+		ir_node *const lane = lanes[i];
+		if (lane == last)
+			continue;
+		for (ir_node *op = get_chain_pred(last); ; op = get_chain_pred(op)) {
+			ir_node *const proj = get_mem_proj(op);
+			if (proj == NULL || get_irn_n_edges(proj) != 1)
+				return false;
+			if (op == lane)
+				break;
+			if (!is_lane(env, pack, op) && may_alias(op, lane))
+				return false;
+		}
+	}
+	if (get_mem_proj(last) == NULL)
+		return false;
+	pack->anchor = last;
+	return true;
+}
+
+static ir_op *get_vector_op(ir_node const *const node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Add: return op_VAdd;
+	case iro_And: return op_VAnd;
+	case iro_Eor: return op_VEor;
+	case iro_Mul: return op_VMul;
+	case iro_Or:  return op_VOr;
+	case iro_Sub: return op_VSub;
+	default:      return NULL;
+	}
+}
+
+static ir_node **copy_lanes(slp_env_t *const env, ir_node *const *const nodes)
+{
+	ir_node **const res = OALLOCN(&env->obst, ir_node*, env->n_lanes);
+	memcpy(res, nodes, env->n_lanes * sizeof(*nodes));
+	return res;
+}
+
+static pack_t *new_pack(slp_env_t *const env, pack_kind_t const kind,
+                        ir_node *const *const lanes,
+                        ir_node *const *const values)
+{
+	pack_t *const pack = OALLOCZ(&env->obst, pack_t);
+	pack->kind   = kind;
+	pack->lanes  = copy_lanes(env, lanes);
+	pack->values = copy_lanes(env, values);
+	ARR_APP1(pack_t*, env->packs, pack);
+	if (kind != PACK_SPLAT && kind != PACK_STORE)
+		pmap_insert(env->value_packs, values[0], pack);
+	return pack;
+}
+
+static pack_t *build_pack(slp_env_t *env, ir_node **values, ir_node **users);
+
+static pack_t *build_splat(slp_env_t *const env, ir_node *const value)
+{
+	pack_t *pack = pmap_get(pack_t, env->splats, value);
+	if (pack != NULL)
+		return pack;
+	if (!ir_target.allow_vector_op(op_VSplat, env->vmode))
+		return NULL;
+	ir_node **const lanes = ALLOCAN(ir_node*, env->n_lanes);
+	for (unsigned i = 0; i < env->n_lanes; ++i)
+		lanes[i] = value;
+	pack = new_pack(env, PACK_SPLAT, lanes, lanes);
+	pmap_insert(env->splats, value, pack);
+	/* moving the value into a vector register and broadcasting it */
+	env->vector_cost += 2;
+	return pack;
+}
+
+static pack_t *build_load_pack(slp_env_t *const env, ir_node **const values,
+                               ir_node **const users)
+{
+	unsigned  const n_lanes = env->n_lanes;
+	ir_node **const loads   = ALLOCAN(ir_node*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		ir_node *const value = values[i];
+		if (!is_Proj(value) || get_Proj_num(value) != pn_Load_res)
+			return NULL;
+		ir_node *const load = get_Proj_pred(value);
+		if (!is_Load(load) || !is_simple_memop(env, load)
+		    || get_Load_mode(load) != env->element
+		    || !has_only_user(value, users[i]))
+			return NULL;
+		loads[i] = load;
+	}
+	if (!check_adjacent(env, loads))
+		return NULL;
+
+	pack_t *const pack = new_pack(env, PACK_LOAD, loads, values);
+	if (!check_load_pack(env, pack))
+		return NULL;
+	env->scalar_cost += n_lanes;
+	env->vector_cost += 1;
+	return pack;
+}
+
+static pack_t *build_op_pack(slp_env_t *const env, ir_node **const values,
+                             ir_node **const users)
+{
+	unsigned const n_lanes = env->n_lanes;
+	ir_node *const value0  = values[0];
+	ir_op   *const vop     = get_vector_op(value0);
+	if (vop == NULL || get_irn_mode(value0) != env->element
+	    || !ir_target.allow_vector_op(vop, env->vmode))
+		return NULL;
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		ir_node *const value = values[i];
+		if (get_irn_op(value) != get_irn_op(value0)
+		    || get_nodes_block(value) != env->block
+		    || !has_only_user(value, users[i]))
+			return NULL;
+		for (unsigned j = 0; j < i; ++j) {
+			if (heights_reachable_in_block(env->heights, value, values[j])
+			    || heights_reachable_in_block(env->heights, values[j], value))
+				return NULL;
+		}
+	}
+
+	ir_node **const lefts  = ALLOCAN(ir_node*, n_lanes);
+	ir_node **const rights = ALLOCAN(ir_node*, n_lanes);
+	bool      const commutative = is_op_commutative(get_irn_op(value0));
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		lefts[i]  = get_binop_left(values[i]);
+		rights[i] = get_binop_right(values[i]);
+		/* line up operands of the same kind */
+		if (commutative && i > 0
+		    && get_irn_op(lefts[i]) != get_irn_op(lefts[0])
+		    && get_irn_op(rights[i]) == get_irn_op(lefts[0])) {
+			ir_node *const tmp = lefts[i];
+			lefts[i]  = rights[i];
+			rights[i] = tmp;
+		}
+	}
+
+	pack_t *const pack = new_pack(env, PACK_OP, values, values);
+	env->scalar_cost += n_lanes;
+	env->vector_cost += 1;
+	pack->operands[0] = build_pack(env, lefts, values);
+	if (pack->operands[0] == NULL)
+		return NULL;
+	pack->operands[1] = build_pack(env, rights, values);
+	if (pack->operands[1] == NULL)
+		return NULL;
+	return pack;
+}
+
+/**
+ * Build the pack for @p values, where @p users contains the user of each
+ * lane.
+ */
+static pack_t *build_pack(slp_env_t *const env, ir_node **const values,
+                          ir_node **const users)
+{
+	unsigned const n_lanes   = env->n_lanes;
+	bool           identical = true;
+	for (unsigned i = 1; i < n_lanes; ++i) {
+		if (values[i] != values[0])
+			identical = false;
+	}
+	if (identical)
+		return build_splat(env, values[0]);
+
+	/* a pack may be reached again through an operation using a value twice */
+	pack_t *const known = pmap_get(pack_t, env->value_packs, values[0]);
+	if (known != NULL) {
+		for (unsigned i = 0; i < n_lanes; ++i) {
+			if (known->values[i] != values[i])
+				return NULL;
+		}
+		return known;
+	}
+
+	if (is_Proj(values[0]))
+		return build_load_pack(env, values, users);
+	return build_op_pack(env, values, users);
+}
+
+static pack_t *build_store_pack(slp_env_t *const env, ir_node **const stores)
+{
+	unsigned  const n_lanes = env->n_lanes;
+	ir_node **const values  = ALLOCAN(ir_node*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i)
+		values[i] = get_Store_value(stores[i]);
+
+	pack_t *const pack = new_pack(env, PACK_STORE, stores, stores);
+	if (!check_store_pack(env, pack))
+		return NULL;
+	env->scalar_cost += n_lanes;
+	env->vector_cost += 1;
+	pack->operands[0] = build_pack(env, values, stores);
+	if (pack->operands[0] == NULL)
+		return NULL;
+	return pack;
+}
+
+static ir_node *build_vector(slp_env_t *const env, pack_t *const pack)
+{
+	if (pack->vector != NULL)
+		return pack->vector;
+
+	ir_node *const block = env->block;
+	ir_node *const lane0 = pack->lanes[0];
+	ir_node       *res;
+	switch (pack->kind) {
+	case PACK_SPLAT:
+		res = new_r_VSplat(block, lane0, env->vmode);
+		break;
+
+	case PACK_LOAD: {
+		/* The address of the first lane only depends on the base, which is
+		 * available at the first Load in the chain. */
+		ir_node *const first = pack->anchor;
+		/* the element type keeps type based alias analysis working */
+		ir_node *const load  = new_r_Load(block, get_Load_mem(first),
+		                                  get_Load_ptr(lane0), env->vmode,
+		                                  get_Load_type(lane0), cons_unaligned);
+		res = new_r_Proj(load, env->vmode, pn_Load_res);
+		for (unsigned i = 0; i < env->n_lanes; ++i) {
+			ir_node *const lane = pack->lanes[i];
+			ir_node *const proj = get_mem_proj(lane);
+			if (proj == NULL)
+				continue;
+			ir_node *const mem = lane == first
+				? new_r_Proj(load, mode_M, pn_Load_M) : get_Load_mem(lane);
+			exchange(proj, mem);
+		}
+		break;
+	}
+
+	case PACK_OP: {
+		ir_node *const left  = build_vector(env, pack->operands[0]);
+		ir_node *const right = build_vector(env, pack->operands[1]);
+		switch (get_irn_opcode(lane0)) {
+		case iro_Add: res = new_r_VAdd(block, left, right); break;
+		case iro_And: res = new_r_VAnd(block, left, right); break;
+		case iro_Eor: res = new_r_VEor(block, left, right); break;
+		case iro_Mul: res = new_r_VMul(block, left, right); break;
+		case iro_Or:  res = new_r_VOr(block, left, right);  break;
+		case iro_Sub: res = new_r_VSub(block, left, right); break;
+		default:      panic("unexpected vector operation %+F", lane0);
+		}
+		break;
+	}
+
+	case PACK_STORE: {
+		ir_node *const value = build_vector(env, pack->operands[0]);
+		ir_node *const last  = pack->anchor;
+		for (unsigned i = 0; i < env->n_lanes; ++i) {
+			ir_node *const lane = pack->lanes[i];
+			if (lane != last)
+				exchange(get_mem_proj(lane), get_Store_mem(lane));
+		}
+		ir_node *const store = new_r_Store(block, get_Store_mem(last),
+		                                   get_Store_ptr(lane0), value,
+		                                   get_Store_type(lane0),
+		                                   cons_unaligned);
+		res = new_r_Proj(store, mode_M, pn_Store_M);
+		exchange(get_mem_proj(last), res);
+		break;
+	}
+
+	default:
+		panic("invalid pack kind");
+	}
+	pack->vector = res;
+	return res;
+}
+
+/** Remove the scalar nodes replaced by the packs, users first. */
+static void kill_packs(slp_env_t const *const env)
+{
+	for (size_t p = 0, n = ARR_LEN(env->packs); p < n; ++p) {
+		pack_t const *const pack = env->packs[p];
+		if (pack->kind == PACK_SPLAT)
+			continue;
+		for (unsigned i = 0; i < env->n_lanes; ++i) {
+			ir_node *const lane = pack->lanes[i];
+			if (pack->kind == PACK_LOAD) {
+				foreach_out_edge_safe(lane, edge) {
+					kill_node(get_edge_src_irn(edge));
+				}
+			}
+			kill_node(lane);
+		}
+	}
+}
+
+static bool try_seed(slp_env_t *const env, ir_node **const stores)
+{
+	env->packs       = NEW_ARR_F(pack_t*, 0);
+	env->value_packs = pmap_create();
+	env->splats      = pmap_create();
+	env->scalar_cost = 0;
+	env->vector_cost = 0;
+
+	bool    changed = false;
+	pack_t *root    = build_store_pack(env, stores);
+	if (root != NULL && env->vector_cost < env->scalar_cost) {
+		DB((dbg, LEVEL_1, "packing %+F..%+F into %+F (%u instead of %u operations)\n",
+		    stores[0], stores[env->n_lanes - 1], env->vmode,
+		    env->vector_cost, env->scalar_cost));
+		build_vector(env, root);
+		kill_packs(env);
+		heights_recompute_block(env->heights, env->block);
+		changed = true;
+	} else if (root != NULL) {
+		DB((dbg, LEVEL_2, "rejecting %+F..%+F (%u instead of %u operations)\n",
+		    stores[0], stores[env->n_lanes - 1], env->vector_cost,
+		    env->scalar_cost));
+	}
+
+	pmap_destroy(env->splats);
+	pmap_destroy(env->value_packs);
+	DEL_ARR_F(env->packs);
+	obstack_free(&env->obst, NULL);
+	obstack_init(&env->obst);
+	return changed;
+}
+
+static void collect_stores(ir_node *const node, void *const data)
+{
+	if (!is_Store(node) || ir_throws_exception(node)
+	    || get_Store_volatility(node) == volatility_is_volatile)
+		return;
+	ir_mode *const mode = get_irn_mode(get_Store_value(node));
+	if (!mode_is_int(mode) && !mode_is_float(mode))
+		return;
+	unsigned const size = get_mode_size_bytes(mode);
+	if (size == 0 || ir_target.vector_size % size != 0
+	    || ir_target.vector_size / size < 2)
+		return;
+
+	store_ref_t **const refs = (store_ref_t**)data;
+	store_ref_t   const ref  = { .store = node };
+	ARR_APP1(store_ref_t, *refs, ref);
+	store_ref_t *const added = &(*refs)[ARR_LEN(*refs) - 1];
+	added->base = get_base_address(get_Store_ptr(node), &added->offset);
+}
+
+static int cmp_store_ref(void const *const a, void const *const b)
+{
+	store_ref_t const *const ra = (store_ref_t const*)a;
+	store_ref_t const *const rb = (store_ref_t const*)b;
+	ir_node     const *const sa = ra->store;
+	ir_node     const *const sb = rb->store;
+	unsigned const block_a = get_irn_idx(get_nodes_block(sa));
+	unsigned const block_b = get_irn_idx(get_nodes_block(sb));
+	if (block_a != block_b)
+		return block_a < block_b ? -1 : 1;
+	unsigned const base_a = get_irn_idx(ra->base);
+	unsigned const base_b = get_irn_idx(rb->base);
+	if (base_a != base_b)
+		return base_a < base_b ? -1 : 1;
+	ir_mode const *const mode_a = get_irn_mode(get_Store_value(sa));
+	ir_mode const *const mode_b = get_irn_mode(get_Store_value(sb));
+	if (mode_a != mode_b)
+		return strcmp(get_mode_name(mode_a), get_mode_name(mode_b));
+	if (ra->offset != rb->offset)
+		return ra->offset < rb->offset ? -1 : 1;
+	return 0;
+}
+
+static bool same_group(store_ref_t const *const a, store_ref_t const *const b)
+{
+	return get_nodes_block(a->store) == get_nodes_block(b->store)
+	    && a->base == b->base
+	    && get_irn_mode(get_Store_value(a->store))
+	       == get_irn_mode(get_Store_value(b->store));
+}
+
+static void set_element_mode(slp_env_t *const env, ir_mode *const mode)
+{
+	unsigned const n_lanes = ir_target.vector_size / get_mode_size_bytes(mode);
+	char name[32];
+	snprintf(name, sizeof(name), "V%u%s", n_lanes, get_mode_name(mode));
+	env->element = mode;
+	env->n_lanes = n_lanes;
+	env->vmode   = new_vector_mode(name, mode, n_lanes);
+}
+
+void slp_vectorize(ir_graph *const irg)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.slp");
+	if (ir_target.vector_size == 0)
+		return;
+
+	ir_pass_timing_push("slp_vectorize", irg);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_BADS
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+
+	store_ref_t *refs = NEW_ARR_F(store_ref_t, 0);
+	irg_walk_graph(irg, NULL, collect_stores, &refs);
+	size_t const n_refs = ARR_LEN(refs);
+	QSORT_ARR(refs, cmp_store_ref);
+
+	slp_env_t env;
+	memset(&env, 0, sizeof(env));
+	env.heights = heights_new(irg);
+	obstack_init(&env.obst);
+	/* byte elements give the most lanes */
+	ir_node **const stores = XMALLOCN(ir_node*, ir_target.vector_size);
+
+	bool changed = false;
+	for (size_t i = 0; i < n_refs;) {
+		ir_node *const store = refs[i].store;
+		ir_mode *const mode  = get_irn_mode(get_Store_value(store));
+		if (mode != env.element)
+			set_element_mode(&env, mode);
+		unsigned const n_lanes = env.n_lanes;
+		long     const size    = get_mode_size_bytes(mode);
+
+		/* look for n_lanes Stores to consecutive elements */
+		size_t n = 1;
+		while (n < n_lanes && i + n < n_refs
+		       && same_group(&refs[i], &refs[i + n])
+		       && refs[i + n].offset == refs[i].offset + (long)n * size)
+			++n;
+		if (n < n_lanes) {
+			++i;
+			continue;
+		}
+
+		for (unsigned l = 0; l < n_lanes; ++l)
+			stores[l] = refs[i + l].store;
+		env.block = get_nodes_block(store);
+		if (try_seed(&env, stores)) {
+			changed = true;
+			i += n_lanes;
+		} else {
+			++i;
+		}
+	}
+
+	free(stores);
+	obstack_free(&env.obst, NULL);
+	heights_free(env.heights);
+	DEL_ARR_F(refs);
+	confirm_irg_properties(irg, changed ? IR_GRAPH_PROPERTIES_CONTROL_FLOW
+	                                    : IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_timing_pop();
+}
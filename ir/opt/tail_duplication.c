@@ -0,0 +1,362 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Tail duplication driven by execution frequencies.
+ *
+ * A small block with several predecessors is copied into a hot predecessor
+ * that reaches it with a Jmp. The copy has this predecessor as its only one
+ * and can be merged with it by optimize_cf(), so the hot path no longer
+ * jumps into a merge point. If the copy itself ends with a Jmp into another
+ * join block, that block is duplicated as well, growing a straight-line
+ * superblock along the hot trace.
+ *
+ * Inside the copy the Phis of the original block are replaced by their
+ * operand for the hot predecessor, so the local optimizations can fold
+ * values and conditions that are only known on this path. Values defined in
+ * the duplicated block are merged with new Phis where the paths join again.
+ *
+ * The execution frequencies are taken from the profile if one was read and
+ * estimated otherwise.
+ */
+#include "array.h"
+#include "debug.h"
+#include "execfreq_t.h"
+#include "ircons.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irloop.h"
+#include "irnode_t.h"
+#include "iroptimize.h"
+#include "irprofile.h"
+#include "irtools.h"
+#include "passtiming.h"
+#include "util.h"
+#include <stdlib.h>
+
+/** Edges executed less often than the function entry are not worth the
+ * code growth. */
+#define TAILDUP_HOT_FREQ 1.0
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+typedef struct taildup_env_t {
+	unsigned max_size; /**< maximum number of nodes of a duplicated block */
+	unsigned budget;   /**< number of nodes that may still be copied */
+	double   hot_freq; /**< minimum frequency of a hot edge */
+	bool     changed;
+} taildup_env_t;
+
+static void count_node(ir_node *node, void *data)
+{
+	(void)node;
+	++*(unsigned*)data;
+}
+
+/**
+ * Adds the new predecessor @p pred to @p node, which is either a Block or a
+ * Phi.
+ */
+static void add_pred(ir_node *node, ir_node *pred)
+{
+	int       const arity = get_irn_arity(node);
+	ir_node **const ins   = ALLOCAN(ir_node*, arity + 1);
+	foreach_irn_in(node, i, in) {
+		ins[i] = in;
+	}
+	ins[arity] = pred;
+	set_irn_in(node, arity + 1, ins);
+}
+
+/**
+ * Removes the input @p pos from @p node, which is either a Block or a Phi.
+ */
+static void remove_pred(ir_node *node, int pos)
+{
+	int       const arity = get_irn_arity(node);
+	ir_node **const ins   = ALLOCAN(ir_node*, arity - 1);
+	int             n     = 0;
+	foreach_irn_in(node, i, in) {
+		if (i != pos)
+			ins[n++] = in;
+	}
+	set_irn_in(node, n, ins);
+}
+
+/**
+ * Checks whether @p block may be duplicated and returns the number of nodes
+ * to copy in @p size.
+ */
+static bool is_duplicatable(const ir_node *block, unsigned *size)
+{
+	ir_graph *const irg = get_irn_irg(block);
+	if (block == get_irg_start_block(irg) || block == get_irg_end_block(irg)
+	    || get_Block_entity(block) != NULL || get_Block_mark(block))
+		return false;
+
+	unsigned n_nodes = 0;
+	foreach_out_edge(block, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (is_End(node))
+			continue;
+		if (is_IJmp(node) || (is_Phi(node) && get_Phi_loop(node)))
+			return false;
+		if (!is_Phi(node))
+			++n_nodes;
+
+		/* kept nodes and booleans live across blocks would need Phis we
+		 * cannot create */
+		ir_mode *const mode = get_irn_mode(node);
+		foreach_out_edge(node, user_edge) {
+			ir_node *const user = get_edge_src_irn(user_edge);
+			if (is_End(user))
+				return false;
+			if (mode == mode_b && (is_Phi(node) || is_Phi(user)
+			                       || get_nodes_block(user) != block))
+				return false;
+		}
+	}
+	*size = n_nodes;
+	return true;
+}
+
+/**
+ * Returns the position of the hottest predecessor of @p block that reaches
+ * it with a Jmp, or -1 if there is no hot one.
+ */
+static int find_hot_pred(const taildup_env_t *env, const ir_node *block)
+{
+	int    best      = -1;
+	double best_freq = env->hot_freq;
+	for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+		if (!is_Jmp(get_Block_cfgpred(block, i)))
+			continue;
+		double const freq = get_block_execfreq(get_Block_cfgpred_block(block, i));
+		if (freq >= best_freq) {
+			best      = i;
+			best_freq = freq;
+		}
+	}
+	return best;
+}
+
+/**
+ * Copies @p block into a new block, which replaces the predecessor @p pos of
+ * @p block.
+ *
+ * @return the copy
+ */
+static ir_node *duplicate_block(ir_node *block, int pos)
+{
+	ir_graph *const irg        = get_irn_irg(block);
+	ir_node  *const pred       = get_Block_cfgpred(block, pos);
+	ir_node  *const pred_block = get_nodes_block(pred);
+	ir_node  *const copy_block = new_rd_Block(get_irn_dbg_info(block), irg, 1,
+	                                          &pred);
+	DB((dbg, LEVEL_2, "duplicating %+F into %+F\n", block, pred_block));
+
+	/* the link of each node points to its value in the copy, Phis are
+	 * replaced by their operand */
+	ir_node **nodes = NEW_ARR_F(ir_node*, 0);
+	foreach_out_edge(block, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (is_End(node)) {
+			keep_alive(copy_block);
+			continue;
+		}
+		ARR_APP1(ir_node*, nodes, node);
+		if (is_Phi(node)) {
+			set_irn_link(node, get_Phi_pred(node, pos));
+		} else {
+			ir_node *const copy = exact_copy(node);
+			set_nodes_block(copy, copy_block);
+			set_irn_link(node, copy);
+		}
+	}
+	for (size_t i = 0, n = ARR_LEN(nodes); i < n; ++i) {
+		ir_node *const node = nodes[i];
+		if (is_Phi(node))
+			continue;
+		ir_node *const copy = (ir_node*)get_irn_link(node);
+		foreach_irn_in(node, p, in) {
+			if (get_nodes_block(in) == block)
+				set_irn_n(copy, p, (ir_node*)get_irn_link(in));
+		}
+	}
+
+	/* remove the predecessor from the original block */
+	remove_pred(block, pos);
+	for (size_t i = 0, n = ARR_LEN(nodes); i < n; ++i) {
+		if (is_Phi(nodes[i]))
+			remove_pred(nodes[i], pos);
+	}
+
+	/* the successors get the copied control flow as new predecessor */
+	for (size_t i = 0, n = ARR_LEN(nodes); i < n; ++i) {
+		ir_node *const node = nodes[i];
+		if (get_irn_mode(node) != mode_X)
+			continue;
+		ir_node *const copy = (ir_node*)get_irn_link(node);
+		foreach_out_edge_safe(node, edge) {
+			ir_node *const succ = get_edge_src_irn(edge);
+			if (!is_Block(succ))
+				continue;
+			int const succ_pos = get_edge_src_pos(edge);
+			add_pred(succ, copy);
+			foreach_out_edge(succ, succ_edge) {
+				ir_node *const phi = get_edge_src_irn(succ_edge);
+				if (!is_Phi(phi))
+					continue;
+				ir_node *value = get_Phi_pred(phi, succ_pos);
+				if (get_nodes_block(value) == block)
+					value = (ir_node*)get_irn_link(value);
+				add_pred(phi, value);
+			}
+		}
+	}
+
+	/* merge the values of both blocks where their paths join */
+	for (size_t i = 0, n = ARR_LEN(nodes); i < n; ++i) {
+		ir_node *const node = nodes[i];
+		ir_mode *const mode = get_irn_mode(node);
+		if (mode == mode_X || mode == mode_T)
+			continue;
+		irn_construct_ssa(block, node, copy_block,
+		                  (ir_node*)get_irn_link(node));
+	}
+	DEL_ARR_F(nodes);
+
+	double const freq      = get_block_execfreq(block);
+	double const pred_freq = get_block_execfreq(pred_block);
+	set_block_execfreq(copy_block, pred_freq);
+	set_block_execfreq(block, MAX(freq - pred_freq, 0.0));
+	return copy_block;
+}
+
+/**
+ * Duplicates @p block into its predecessor @p pos if the budget allows it.
+ *
+ * @return the copy or NULL
+ */
+static ir_node *try_duplicate(taildup_env_t *env, ir_node *block, int pos)
+{
+	unsigned size;
+	if (get_Block_n_cfgpreds(block) < 2 || !is_duplicatable(block, &size)
+	    || size > env->max_size || size > env->budget)
+		return NULL;
+
+	env->budget  -= size;
+	env->changed  = true;
+	return duplicate_block(block, pos);
+}
+
+/**
+ * Duplicates the join block reached from @p block with a Jmp, to continue
+ * the superblock ending in @p block.
+ *
+ * @return the copy or NULL
+ */
+static ir_node *extend_trace(taildup_env_t *env, ir_node *block)
+{
+	if (get_block_execfreq(block) < env->hot_freq)
+		return NULL;
+
+	ir_node *jmp = NULL;
+	foreach_out_edge(block, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (get_irn_mode(node) != mode_X)
+			continue;
+		if (!is_Jmp(node) || jmp != NULL)
+			return NULL;
+		jmp = node;
+	}
+	if (jmp == NULL || get_irn_n_edges(jmp) != 1)
+		return NULL;
+
+	ir_edge_t const *const edge = get_irn_out_edge_first(jmp);
+	ir_node         *const succ = get_edge_src_irn(edge);
+	return try_duplicate(env, succ, get_edge_src_pos(edge));
+}
+
+/**
+ * Collects the blocks and marks the loop headers, as the backedge
+ * information is lost when predecessors are added.
+ */
+static void collect_blocks(ir_node *block, void *data)
+{
+	ir_node ***const blocks = (ir_node***)data;
+	ARR_APP1(ir_node*, *blocks, block);
+	set_Block_mark(block, has_backedges(block));
+}
+
+/** Sorts blocks by decreasing execution frequency. */
+static int cmp_block_freq(const void *a, const void *b)
+{
+	ir_node const *const block_a = *(ir_node const**)a;
+	ir_node const *const block_b = *(ir_node const**)b;
+	double const freq_a = get_block_execfreq(block_a);
+	double const freq_b = get_block_execfreq(block_b);
+	if (freq_a != freq_b)
+		return freq_a < freq_b ? 1 : -1;
+	return QSORT_CMP(get_irn_idx(block_a), get_irn_idx(block_b));
+}
+
+void opt_tail_duplication(ir_graph *irg, unsigned max_size,
+                          unsigned max_growth)
+{
+	ir_pass_timing_push("opt_tail_duplication", irg);
+	FIRM_DBG_REGISTER(dbg, "firm.opt.tail_duplication");
+
+	ir_profile_set_execfreqs(irg);
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_NO_BADS
+		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+
+	unsigned n_nodes = 0;
+	irg_walk_graph(irg, NULL, count_node, &n_nodes);
+
+	taildup_env_t env;
+	env.max_size = max_size;
+	env.budget   = (unsigned)((unsigned long long)n_nodes * max_growth / 100);
+	env.hot_freq = TAILDUP_HOT_FREQ
+	             * get_block_execfreq(get_irg_start_block(irg));
+	env.changed  = false;
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED
+	                     | IR_RESOURCE_BLOCK_MARK);
+	ir_node **blocks = NEW_ARR_F(ir_node*, 0);
+	irg_block_walk_graph(irg, NULL, collect_blocks, &blocks);
+	qsort(blocks, ARR_LEN(blocks), sizeof(*blocks), cmp_block_freq);
+
+	for (size_t i = 0, n = ARR_LEN(blocks); i < n && env.budget > 0; ++i) {
+		ir_node *const block = blocks[i];
+		/* the last predecessor keeps the original block */
+		while (get_Block_n_cfgpreds(block) > 1) {
+			int const pos = find_hot_pred(&env, block);
+			if (pos < 0)
+				break;
+			ir_node *copy = try_duplicate(&env, block, pos);
+			if (copy == NULL)
+				break;
+			while (copy != NULL)
+				copy = extend_trace(&env, copy);
+		}
+	}
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED
+	                  | IR_RESOURCE_BLOCK_MARK);
+	DEL_ARR_F(blocks);
+
+	confirm_irg_properties(irg, env.changed
+		? IR_GRAPH_PROPERTY_NO_BADS | IR_GRAPH_PROPERTY_NO_TUPLES
+		  | IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+		  | IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		: IR_GRAPH_PROPERTIES_ALL);
+	ir_pass_timing_pop();
+}
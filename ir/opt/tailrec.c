@@ -23,6 +23,7 @@
 #include "irouts_t.h"
 #include "irprog_t.h"
 #include "panic.h"
+#include "passtiming.h"
 #include "scalar_replace.h"
 #include "util.h"
 #include <assert.h>
@@ -583,6 +584,7 @@ static unsigned find_tail_rec_possibilities(tr_env *env, ir_graph *irg)
 
 void opt_tail_rec_irg(ir_graph *irg)
 {
+	ir_pass_timing_push("opt_tail_rec_irg", irg);
 	FIRM_DBG_REGISTER(dbg, "firm.opt.tailrec");
 	assure_irg_properties(irg,
 		IR_GRAPH_PROPERTY_MANY_RETURNS
@@ -609,4 +611,5 @@ void opt_tail_rec_irg(ir_graph *irg)
 	free(env.variants);
 	free(env.parameter_projs);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	ir_pass_timing_pop();
 }
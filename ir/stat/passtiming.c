@@ -0,0 +1,341 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Per pass timing and counters.
+ */
+#include "passtiming.h"
+
+#include "array.h"
+#include "entity_t.h"
+#include "irgraph_t.h"
+#include "irhooks.h"
+#include "obst.h"
+#include "pmap.h"
+#include "timing.h"
+#include "util.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+/** Number of buckets of the duration histograms. */
+#define N_BUCKETS 32
+
+/** A recorded run of a pass. */
+typedef struct pass_event_t {
+	const char   *name;
+	ident        *graph;    /**< name of the graph or NULL */
+	unsigned long start;    /**< start time in microseconds */
+	unsigned long duration; /**< duration in microseconds */
+	long          nodes;    /**< number of nodes created */
+	long          replaced; /**< number of nodes replaced */
+	long          memory;   /**< growth of the graph obstack in bytes */
+	long          peak;     /**< peak growth of all obstacks in bytes */
+} pass_event_t;
+
+/** A running pass. */
+typedef struct pass_frame_t {
+	const char   *name;
+	ir_graph     *irg;
+	size_t        event;    /**< index of the event or (size_t)-1 */
+	unsigned long created;  /**< number of created nodes at the start */
+	unsigned long replaced; /**< number of replaced nodes at the start */
+	long          memory;   /**< graph obstack size at the start */
+	ptrdiff_t     total;    /**< size of all obstacks at the start */
+	ptrdiff_t     peak;     /**< obstack peak of the enclosing pass */
+} pass_frame_t;
+
+/** Aggregated data of all runs of a pass. */
+typedef struct pass_summary_t {
+	const char   *name;
+	unsigned long count;
+	unsigned long total;
+	unsigned long min;
+	unsigned long max;
+	long          nodes;
+	long          replaced;
+	long          memory;
+	long          peak;
+	unsigned long histogram[N_BUCKETS];
+} pass_summary_t;
+
+static bool                 recording;
+static ir_timer_t          *pass_clock;
+static pass_event_t        *events;
+static pass_frame_t        *frames;
+static ir_pass_marker_func *marker;
+static void                *marker_data;
+static size_t               obstack_budget;
+static hook_batch_t         new_node_batch;
+static hook_batch_t         replace_batch;
+static unsigned long        n_created;
+static unsigned long        n_replaced;
+
+/** Counts the node events while recording, delivered in bulk. */
+static void count_events(void *context, hook_type_t hook, size_t n_events,
+                         const hook_event_t *node_events)
+{
+	(void)hook;
+	(void)node_events;
+	*(unsigned long*)context += n_events;
+}
+
+/** Returns the number of nodes created while recording. */
+static unsigned long get_n_created(void)
+{
+	return n_created + new_node_batch.n_events;
+}
+
+/** Returns the number of nodes replaced while recording. */
+static unsigned long get_n_replaced(void)
+{
+	return n_replaced + replace_batch.n_events;
+}
+
+void ir_pass_timing_begin(void)
+{
+	assert(!recording);
+	recording  = true;
+	pass_clock = ir_timer_new();
+	ir_timer_start(pass_clock);
+	events = NEW_ARR_F(pass_event_t, 0);
+	if (frames == NULL)
+		frames = NEW_ARR_F(pass_frame_t, 0);
+
+	new_node_batch.flush   = count_events;
+	new_node_batch.context = &n_created;
+	register_hook_batch(hook_new_node, &new_node_batch);
+	replace_batch.flush    = count_events;
+	replace_batch.context  = &n_replaced;
+	register_hook_batch(hook_replace, &replace_batch);
+}
+
+void ir_pass_timing_set_marker(ir_pass_marker_func *func, void *data)
+{
+	marker      = func;
+	marker_data = data;
+	if (frames == NULL)
+		frames = NEW_ARR_F(pass_frame_t, 0);
+}
+
+void ir_set_obstack_budget(size_t budget)
+{
+	obstack_budget = budget;
+}
+
+int ir_obstack_budget_exceeded(void)
+{
+	return obstack_budget != 0
+	    && (size_t)obstack_total_memory_used() > obstack_budget;
+}
+
+static long get_graph_memory(ir_graph *irg)
+{
+	return (long)obstack_memory_used(&irg->obst);
+}
+
+void ir_pass_timing_push(const char *name, ir_graph *irg)
+{
+	if (!recording && marker == NULL)
+		return;
+
+	size_t const n_frames = ARR_LEN(frames);
+	if (irg == NULL && n_frames > 0)
+		irg = frames[n_frames - 1].irg;
+
+	pass_frame_t frame;
+	frame.name     = name;
+	frame.irg      = irg;
+	frame.event    = (size_t)-1;
+	frame.created  = get_n_created();
+	frame.replaced = get_n_replaced();
+	frame.memory   = irg != NULL ? get_graph_memory(irg) : 0;
+	frame.total    = obstack_total_memory_used();
+	frame.peak     = obstack_set_peak_memory_used(frame.total);
+	if (recording) {
+		ir_entity *const entity = irg != NULL ? get_irg_entity(irg) : NULL;
+		pass_event_t event;
+		memset(&event, 0, sizeof(event));
+		event.name  = name;
+		event.graph = entity != NULL ? get_entity_ident(entity) : NULL;
+		event.start = ir_timer_elapsed_usec(pass_clock);
+		frame.event = ARR_LEN(events);
+		ARR_APP1(pass_event_t, events, event);
+	}
+	ARR_APP1(pass_frame_t, frames, frame);
+
+	if (marker != NULL)
+		marker(marker_data, name, irg, 1);
+}
+
+void ir_pass_timing_pop(void)
+{
+	/* the pass started before the recording or the marker */
+	if (frames == NULL || ARR_LEN(frames) == 0)
+		return;
+
+	pass_frame_t const frame = frames[ARR_LEN(frames) - 1];
+	ARR_SHRINKLEN(frames, ARR_LEN(frames) - 1);
+
+	ptrdiff_t const peak = obstack_peak_memory_used();
+	obstack_set_peak_memory_used(MAX(peak, frame.peak));
+
+	if (recording && frame.event != (size_t)-1) {
+		pass_event_t *const event = &events[frame.event];
+		event->duration = ir_timer_elapsed_usec(pass_clock) - event->start;
+		event->peak     = (long)(peak - frame.total);
+		event->nodes    = (long)(get_n_created() - frame.created);
+		event->replaced = (long)(get_n_replaced() - frame.replaced);
+		if (frame.irg != NULL)
+			event->memory = get_graph_memory(frame.irg) - frame.memory;
+	}
+
+	if (marker != NULL)
+		marker(marker_data, frame.name, frame.irg, 0);
+}
+
+static void write_string(FILE *out, const char *str)
+{
+	fputc('"', out);
+	for (const char *c = str; *c != '\0'; ++c) {
+		if (*c == '"' || *c == '\\')
+			fprintf(out, "\\%c", *c);
+		else if ((unsigned char)*c < 0x20)
+			fprintf(out, "\\u%04x", (unsigned)*c);
+		else
+			fputc(*c, out);
+	}
+	fputc('"', out);
+}
+
+static void write_trace(FILE *out)
+{
+	fputs("{\"traceEvents\":[", out);
+	for (size_t i = 0, n = ARR_LEN(events); i < n; ++i) {
+		pass_event_t const *const event = &events[i];
+		fputs(i == 0 ? "\n" : ",\n", out);
+		fputs("{\"name\":", out);
+		write_string(out, event->name);
+		fprintf(out, ",\"cat\":\"pass\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,"
+		        "\"pid\":1,\"tid\":1,\"args\":{", event->start,
+		        event->duration);
+		if (event->graph != NULL) {
+			fputs("\"graph\":", out);
+			write_string(out, get_id_str(event->graph));
+			fputc(',', out);
+		}
+		fprintf(out, "\"nodes\":%ld,\"replaced\":%ld,\"memory\":%ld,"
+		        "\"peak\":%ld}}", event->nodes, event->replaced, event->memory,
+		        event->peak);
+	}
+	fputs("\n],\"displayTimeUnit\":\"ms\"}\n", out);
+}
+
+static unsigned get_bucket(unsigned long duration)
+{
+	unsigned bucket = 0;
+	for (; duration != 0 && bucket < N_BUCKETS - 1; duration >>= 1)
+		++bucket;
+	return bucket;
+}
+
+static void write_summary(FILE *out)
+{
+	/* aggregate the runs by pass name in the order of the first run */
+	pass_summary_t *summaries = NEW_ARR_F(pass_summary_t, 0);
+	pmap           *by_name   = pmap_create();
+	for (size_t i = 0, n = ARR_LEN(events); i < n; ++i) {
+		pass_event_t const *const event = &events[i];
+		size_t idx = (size_t)pmap_get(void, by_name, event->name);
+		if (idx == 0) {
+			/* the same name might be stored at different addresses */
+			for (size_t s = 0, n_summaries = ARR_LEN(summaries);
+			     s < n_summaries; ++s) {
+				if (streq(summaries[s].name, event->name)) {
+					idx = s + 1;
+					break;
+				}
+			}
+			if (idx == 0) {
+				pass_summary_t summary;
+				memset(&summary, 0, sizeof(summary));
+				summary.name = event->name;
+				summary.min  = event->duration;
+				ARR_APP1(pass_summary_t, summaries, summary);
+				idx = ARR_LEN(summaries);
+			}
+			pmap_insert(by_name, event->name, (void*)idx);
+		}
+
+		pass_summary_t *const summary = &summaries[idx - 1];
+		++summary->count;
+		summary->total    += event->duration;
+		summary->min       = MIN(summary->min, event->duration);
+		summary->max       = MAX(summary->max, event->duration);
+		summary->nodes    += event->nodes;
+		summary->replaced += event->replaced;
+		summary->memory   += event->memory;
+		summary->peak      = MAX(summary->peak, event->peak);
+		++summary->histogram[get_bucket(event->duration)];
+	}
+	pmap_destroy(by_name);
+
+	fputs("{\"passes\":[", out);
+	for (size_t s = 0, n = ARR_LEN(summaries); s < n; ++s) {
+		pass_summary_t const *const summary = &summaries[s];
+		fputs(s == 0 ? "\n" : ",\n", out);
+		fputs("{\"name\":", out);
+		write_string(out, summary->name);
+		fprintf(out, ",\"count\":%lu,\"total_us\":%lu,\"min_us\":%lu,"
+		        "\"max_us\":%lu,\"nodes\":%ld,\"replaced\":%ld,\"memory\":%ld,"
+		        "\"peak\":%ld,\"histogram\":[", summary->count, summary->total,
+		        summary->min, summary->max, summary->nodes, summary->replaced,
+		        summary->memory, summary->peak);
+		unsigned n_buckets = N_BUCKETS;
+		while (n_buckets > 1 && summary->histogram[n_buckets - 1] == 0)
+			--n_buckets;
+		for (unsigned b = 0; b < n_buckets; ++b)
+			fprintf(out, "%s%lu", b == 0 ? "" : ",", summary->histogram[b]);
+		fputs("]}", out);
+	}
+	fputs("\n]}\n", out);
+	DEL_ARR_F(summaries);
+}
+
+void ir_pass_timing_end(FILE *out, ir_pass_timing_format_t format)
+{
+	assert(recording);
+	/* close the passes that are still running */
+	ptrdiff_t peak = obstack_peak_memory_used();
+	for (size_t i = ARR_LEN(frames); i-- > 0;) {
+		pass_frame_t *const frame = &frames[i];
+		if (i + 1 < ARR_LEN(frames))
+			peak = MAX(peak, frames[i + 1].peak);
+		if (frame->event == (size_t)-1)
+			continue;
+		pass_event_t *const event = &events[frame->event];
+		event->duration = ir_timer_elapsed_usec(pass_clock) - event->start;
+		event->peak     = (long)(peak - frame->total);
+		event->nodes    = (long)(get_n_created() - frame->created);
+		event->replaced = (long)(get_n_replaced() - frame->replaced);
+		frame->event    = (size_t)-1;
+	}
+	unregister_hook_batch(hook_replace, &replace_batch);
+	unregister_hook_batch(hook_new_node, &new_node_batch);
+
+	if (out != NULL) {
+		switch (format) {
+		case ir_pass_timing_summary: write_summary(out); break;
+		case ir_pass_timing_trace:   write_trace(out);   break;
+		}
+	}
+
+	recording = false;
+	DEL_ARR_F(events);
+	events = NULL;
+	ir_timer_free(pass_clock);
+	pass_clock = NULL;
+}
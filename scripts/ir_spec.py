@@ -957,6 +957,58 @@ class Unknown(Node):
     flags = ["start_block", "constlike", "dump_noblock"]
 
 
+@op
+class VAdd(Binop):
+    """returns the lane-wise sum of its vector operands"""
+    mode = "get_irn_mode(irn_left)"
+    flags = ["commutative"]
+
+
+@op
+class VAnd(Binop):
+    """returns the lane-wise bitwise and of its vector operands"""
+    mode = "get_irn_mode(irn_left)"
+    flags = ["commutative"]
+
+
+@op
+class VEor(Binop):
+    """returns the lane-wise bitwise exclusive or of its vector operands"""
+    mode = "get_irn_mode(irn_left)"
+    flags = ["commutative"]
+
+
+@op
+class VMul(Binop):
+    """returns the lane-wise product of its vector operands"""
+    mode = "get_irn_mode(irn_left)"
+    flags = ["commutative"]
+
+
+@op
+class VOr(Binop):
+    """returns the lane-wise bitwise or of its vector operands"""
+    mode = "get_irn_mode(irn_left)"
+    flags = ["commutative"]
+
+
+@op
+class VSplat(Node):
+    """returns a vector with its scalar operand copied into every lane. The
+    mode of the operand must be the element mode of the vector mode."""
+    flags = []
+    ins = [
+        ("op", "operand")
+    ]
+
+
+@op
+class VSub(Binop):
+    """returns the lane-wise difference of its vector operands"""
+    mode = "get_irn_mode(irn_left)"
+    flags = []
+
+
 name = "ir"
 (nodes, abstract_nodes) = prepare_nodes(globals())
 export(nodes, "nodes")
@@ -0,0 +1,239 @@
+#!/usr/bin/env python
+#
+# This file is part of libFirm.
+# Copyright (C) 2012 Karlsruhe Institute of Technology.
+#
+# Converts binary traces written after ir_dump_trace_begin() into vcg, dot
+# or json.  See ir/ir/irdumptrace.c for a description of the format.
+import sys
+import argparse
+import json
+
+MAGIC = b"FIRMTRC1"
+TRACE_STRING = 1
+TRACE_SNAPSHOT = 2
+TRACE_NODE = 3
+TRACE_DELETE = 4
+TRACE_END = 5
+
+
+class Node(object):
+    def __init__(self, idx, op, mode, block, ins, attr):
+        self.idx = idx
+        self.op = op
+        self.mode = mode
+        self.block = block
+        self.ins = ins
+        self.attr = attr
+
+    def label(self):
+        label = self.op
+        if self.mode is not None:
+            label += " " + self.mode
+        if self.attr is not None:
+            label += " " + self.attr
+        return "%s %d" % (label, self.idx)
+
+
+class Snapshot(object):
+    def __init__(self, graph, name, suffix, nr, nodes):
+        self.graph = graph
+        self.name = name
+        self.suffix = suffix
+        self.nr = nr
+        self.nodes = nodes
+
+    def title(self):
+        title = "%s-%02d" % (self.name, self.nr)
+        if self.suffix is not None:
+            title += "-" + self.suffix
+        return title
+
+
+class Reader(object):
+    def __init__(self, data):
+        self.data = bytearray(data)
+        self.pos = 0
+
+    def at_end(self):
+        return self.pos >= len(self.data)
+
+    def byte(self):
+        if self.at_end():
+            raise EOFError()
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def number(self):
+        value = 0
+        shift = 0
+        while True:
+            byte = self.byte()
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    def bytes(self, length):
+        if self.pos + length > len(self.data):
+            raise EOFError()
+        value = self.data[self.pos:self.pos + length]
+        self.pos += length
+        return bytes(value)
+
+
+def read_trace(data):
+    """Yields a Snapshot with all nodes of the graph for every complete
+    snapshot in the trace.  A trace truncated by a crash ends with the last
+    complete snapshot."""
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError("not a firm trace")
+    reader = Reader(data[len(MAGIC):])
+    strings = {0: None}
+    graphs = {}
+    try:
+        while not reader.at_end():
+            tag = reader.byte()
+            if tag == TRACE_STRING:
+                sid = reader.number()
+                length = reader.number()
+                strings[sid] = reader.bytes(length).decode("utf-8", "replace")
+            elif tag == TRACE_SNAPSHOT:
+                graph = reader.number()
+                name = strings[reader.number()]
+                suffix = strings[reader.number()]
+                nr = reader.number()
+                # only commit the changes once the snapshot is complete
+                nodes = dict(graphs.get(graph, {}))
+                while True:
+                    tag = reader.byte()
+                    if tag == TRACE_STRING:
+                        sid = reader.number()
+                        length = reader.number()
+                        strings[sid] = reader.bytes(length).decode("utf-8",
+                                                                   "replace")
+                    elif tag == TRACE_NODE:
+                        idx = reader.number()
+                        op = strings[reader.number()]
+                        mode = strings[reader.number()]
+                        block = reader.number() - 1
+                        n_ins = reader.number()
+                        ins = [reader.number() for i in range(n_ins)]
+                        attr = strings[reader.number()]
+                        nodes[idx] = Node(idx, op, mode, block, ins, attr)
+                    elif tag == TRACE_DELETE:
+                        del nodes[reader.number()]
+                    elif tag == TRACE_END:
+                        break
+                    else:
+                        raise ValueError("unknown record %d" % tag)
+                graphs[graph] = nodes
+                yield Snapshot(graph, name, suffix, nr, nodes)
+            else:
+                raise ValueError("unknown record %d" % tag)
+    except EOFError:
+        pass
+
+
+def vcg_escape(string):
+    return string.replace("\\", "\\\\").replace("\"", "\\\"")
+
+
+def write_vcg(out, snapshot):
+    out.write("graph: { title: \"%s\"\n" % vcg_escape(snapshot.title()))
+    out.write("  layoutalgorithm: mindepth\n  display_edge_labels: yes\n")
+    for idx in sorted(snapshot.nodes):
+        node = snapshot.nodes[idx]
+        out.write("  node: { title: \"n%d\" label: \"%s\" }\n"
+                  % (idx, vcg_escape(node.label())))
+    for idx in sorted(snapshot.nodes):
+        node = snapshot.nodes[idx]
+        if node.block >= 0:
+            out.write("  edge: { sourcename: \"n%d\" targetname: \"n%d\" "
+                      "class: 2 color: red }\n" % (idx, node.block))
+        for pos, pred in enumerate(node.ins):
+            out.write("  edge: { sourcename: \"n%d\" targetname: \"n%d\" "
+                      "label: \"%d\" }\n" % (idx, pred, pos))
+    out.write("}\n")
+
+
+def write_dot(out, snapshot):
+    out.write("digraph \"%s\" {\n" % vcg_escape(snapshot.title()))
+    for idx in sorted(snapshot.nodes):
+        node = snapshot.nodes[idx]
+        out.write("  n%d [label=\"%s\"];\n" % (idx, vcg_escape(node.label())))
+    for idx in sorted(snapshot.nodes):
+        node = snapshot.nodes[idx]
+        if node.block >= 0:
+            out.write("  n%d -> n%d [color=red];\n" % (idx, node.block))
+        for pos, pred in enumerate(node.ins):
+            out.write("  n%d -> n%d [label=\"%d\"];\n" % (idx, pred, pos))
+    out.write("}\n")
+
+
+def snapshot_to_json(snapshot):
+    nodes = []
+    for idx in sorted(snapshot.nodes):
+        node = snapshot.nodes[idx]
+        nodes.append({
+            "idx": idx,
+            "op": node.op,
+            "mode": node.mode,
+            "block": node.block if node.block >= 0 else None,
+            "ins": node.ins,
+            "attr": node.attr,
+        })
+    return {
+        "graph": snapshot.name,
+        "suffix": snapshot.suffix,
+        "nr": snapshot.nr,
+        "nodes": nodes,
+    }
+
+
+def main(argv):
+    description = 'Convert a binary firm trace to vcg, dot or json'
+    parser = argparse.ArgumentParser(add_help=True, description=description)
+    parser.add_argument('-f', dest='format', choices=['vcg', 'dot', 'json'],
+                        default='vcg', help='output format')
+    parser.add_argument('-g', dest='graph', default=None,
+                        help='only convert snapshots of graphs containing '
+                             'this string')
+    parser.add_argument('-o', dest='outdir', default=None,
+                        help='write one file per snapshot into this '
+                             'directory instead of stdout')
+    parser.add_argument('trace', action='store', help='trace file')
+    config = parser.parse_args(argv[1:])
+
+    with open(config.trace, "rb") as f:
+        data = f.read()
+
+    snapshots = (s for s in read_trace(data)
+                 if config.graph is None or config.graph in s.name)
+    if config.format == 'json' and config.outdir is None:
+        json.dump([snapshot_to_json(s) for s in snapshots], sys.stdout,
+                  indent=1)
+        sys.stdout.write("\n")
+        return
+
+    for snapshot in snapshots:
+        if config.outdir is not None:
+            name = "%s/%s.%s" % (config.outdir, snapshot.title(),
+                                 config.format)
+            out = open(name, "w")
+        else:
+            out = sys.stdout
+        if config.format == 'vcg':
+            write_vcg(out, snapshot)
+        elif config.format == 'dot':
+            write_dot(out, snapshot)
+        else:
+            json.dump(snapshot_to_json(snapshot), out, indent=1)
+            out.write("\n")
+        if out is not sys.stdout:
+            out.close()
+
+
+if __name__ == "__main__":
+    main(sys.argv)
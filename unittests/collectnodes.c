@@ -0,0 +1,158 @@
+#include "firm.h"
+#include "iredges_t.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "irnodemap.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Builds graphs with random unreachable nodes, collects them with
+ * collect_dead_nodes() and checks that the reachable nodes are renumbered
+ * densely in their old order and that new nodes reuse the freed memory.
+ * With compact_node_indices() registered nodemaps have to follow the nodes.
+ * Collecting frees the outs, loop and dominance information, compacting keeps
+ * them. optimize_graph_df() compacts graphs with mostly unreachable nodes.
+ */
+
+#define N_DEAD 64
+
+static void count_node(ir_node *node, void *env)
+{
+	(void)node;
+	++*(unsigned*)env;
+}
+
+static void test_graph(unsigned seed)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "f%u", seed);
+	ir_type *const mtp = new_type_method(1, 1, false, cc_cdecl_set,
+	                                     mtp_no_property);
+	ir_type *const int_type = new_type_primitive(mode_Is);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	ir_entity *const ent = new_entity(get_glob_type(), new_id_from_str(name),
+	                                  mtp);
+	ir_graph  *const irg = new_ir_graph(ent, 0);
+	srand(seed);
+
+	ir_node *const block = get_r_cur_block(irg);
+	ir_node *const arg   = new_r_Proj(get_irg_args(irg), mode_Is, 0);
+	ir_node       *value = arg;
+	ir_node       *dead[N_DEAD];
+	for (unsigned i = 0; i < N_DEAD; ++i) {
+		ir_node *const c = new_r_Const_long(irg, mode_Is, rand() % 1000);
+		if (rand() % 2 == 0)
+			value = new_r_Add(block, value, c);
+		dead[i] = new_r_Sub(block, arg, c);
+	}
+	ir_node *const ret = new_r_Return(block, get_r_store(irg), 1, &value);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	irg_finalize_cons(irg);
+	if (seed % 2 == 0)
+		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+	ir_graph_properties_t const analyses = IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO
+		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE;
+	bool const with_analyses = seed % 3 == 0;
+	if (with_analyses)
+		assure_irg_properties(irg, analyses);
+
+	unsigned n_live = 0;
+	irg_walk_in_or_dep(get_irg_anchor(irg), count_node, NULL, &n_live);
+	unsigned const last_idx = get_irg_last_idx(irg);
+	assert(n_live < last_idx);
+
+	/* remember the old order of the reachable nodes */
+	ir_node **order = XMALLOCN(ir_node*, n_live);
+	unsigned  n     = 0;
+	for (unsigned idx = 0; idx < last_idx; ++idx) {
+		ir_node *const node = get_idx_irn(irg, idx);
+		if (node != NULL && irn_visited(node))
+			order[n++] = node;
+	}
+	assert(n == n_live);
+
+	ir_nodemap map;
+	ir_nodemap_init(&map, irg);
+	irg_add_renumber_listener(irg, ir_nodemap_renumber, &map);
+	for (unsigned i = 0; i < n_live; ++i)
+		ir_nodemap_insert(&map, order[i], order[(i + 1) % n_live]);
+
+	if (seed % 4 < 2)
+		collect_dead_nodes(irg);
+	else
+		compact_node_indices(irg);
+	assert(get_irg_last_idx(irg) == n_live);
+	for (unsigned idx = 0; idx < n_live; ++idx) {
+		assert(get_idx_irn(irg, idx) == order[idx]);
+		assert(get_irn_idx(order[idx]) == idx);
+		assert(ir_nodemap_get(ir_node, &map, order[idx])
+		       == order[(idx + 1) % n_live]);
+	}
+	irg_remove_renumber_listener(irg, ir_nodemap_renumber, &map);
+	ir_nodemap_destroy(&map);
+	assert(edges_activated(irg) == (seed % 2 == 0));
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES)
+	       == (seed % 2 == 0));
+	if (edges_activated(irg))
+		assert(edges_verify(irg));
+	if (with_analyses) {
+		/* collecting frees the analyses, they refer to the freed nodes */
+		bool const collected = seed % 4 < 2;
+		assert(irg_has_properties(irg, analyses) == !collected);
+		assert((get_irg_loop(irg) == NULL) == collected);
+		assure_irg_properties(irg, analyses);
+		assert(get_irg_loop(irg) != NULL);
+	}
+	irg_verify(irg);
+
+	/* new nodes of the same size reuse the memory of the dead ones */
+	ir_node *const sub = new_r_Sub(block, arg, value);
+	bool reused = false;
+	for (unsigned i = 0; i < N_DEAD; ++i)
+		reused |= sub == dead[i];
+	assert(reused == (seed % 4 < 2));
+	if (!reused) {
+		for (unsigned i = 0; i < N_DEAD; ++i)
+			assert(get_irn_idx(dead[i]) == IRG_NO_IDX);
+	}
+	assert(get_irn_idx(sub) == n_live);
+	free(order);
+}
+
+static void test_optimize_graph_df(void)
+{
+	ir_type *const mtp = new_type_method(0, 0, false, cc_cdecl_set,
+	                                     mtp_no_property);
+	ir_entity *const ent = new_entity(get_glob_type(), new_id_from_str("opt"),
+	                                  mtp);
+	ir_graph *const irg = new_ir_graph(ent, 0);
+	ir_node  *const ret = new_r_Return(get_r_cur_block(irg), get_r_store(irg),
+	                                   0, NULL);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	irg_finalize_cons(irg);
+	for (unsigned i = 0; i < 4 * N_DEAD * N_DEAD; ++i)
+		new_r_Const_long(irg, mode_Is, i);
+
+	/* the default threshold compacts graphs with mostly unreachable nodes */
+	unsigned n_live = 0;
+	irg_walk_in_or_dep(get_irg_anchor(irg), count_node, NULL, &n_live);
+	optimize_graph_df(irg);
+	assert(get_irg_last_idx(irg) == n_live);
+}
+
+int main(void)
+{
+	ir_init();
+	set_optimize(0);
+	for (unsigned seed = 1; seed <= 20; ++seed)
+		test_graph(seed);
+	test_optimize_graph_df();
+	ir_finish();
+	return 0;
+}
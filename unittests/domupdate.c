@@ -0,0 +1,214 @@
+#include "firm.h"
+#include "irdom_t.h"
+#include "iredges.h"
+#include "irnode_t.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Applies random batches of control flow changes to small graphs, updates the
+ * dominator tree with dom_update_cfg() and compares it with dominators
+ * computed by iterating the dataflow equations.
+ */
+
+#define N_BLOCKS (16 + 2)
+#define START    0
+#define END      (N_BLOCKS - 1)
+
+static ir_node *blocks[N_BLOCKS];
+static unsigned n_edges[N_BLOCKS][N_BLOCKS];
+static bool     kept[N_BLOCKS];
+
+static void add_edge(int from, int to)
+{
+	ir_node  *block = blocks[to];
+	int       n     = get_Block_n_cfgpreds(block);
+	ir_node **ins   = ALLOCAN(ir_node*, n + 1);
+	for (int i = 0; i < n; ++i)
+		ins[i] = get_Block_cfgpred(block, i);
+	ins[n] = new_r_Jmp(blocks[from]);
+	set_irn_in(block, n + 1, ins);
+	++n_edges[from][to];
+}
+
+static bool remove_edge(int from, int to)
+{
+	ir_node  *block = blocks[to];
+	int       n     = get_Block_n_cfgpreds(block);
+	ir_node **ins   = ALLOCAN(ir_node*, n);
+	int       found = -1;
+	for (int i = 0; i < n; ++i) {
+		ins[i] = get_Block_cfgpred(block, i);
+		if (found < 0 && is_Jmp(ins[i]) && get_nodes_block(ins[i]) == blocks[from])
+			found = i;
+	}
+	if (found < 0)
+		return false;
+	ins[found] = ins[n - 1];
+	set_irn_in(block, n - 1, ins);
+	--n_edges[from][to];
+	return true;
+}
+
+static bool has_edge(int from, int to)
+{
+	return n_edges[from][to] > 0 || (to == END && kept[from]);
+}
+
+/** Computes the dominators by iterating dom(b) = {b} + intersection of
+ * dom(p) over the predecessors p of b. */
+static void compute_reference(bool dom[N_BLOCKS][N_BLOCKS], bool *reachable)
+{
+	for (int b = 0; b < N_BLOCKS; ++b)
+		reachable[b] = b == START;
+	bool changed;
+	do {
+		changed = false;
+		for (int p = 0; p < N_BLOCKS; ++p) {
+			for (int b = 0; b < N_BLOCKS; ++b) {
+				if (reachable[p] && !reachable[b] && has_edge(p, b)) {
+					reachable[b] = true;
+					changed      = true;
+				}
+			}
+		}
+	} while (changed);
+
+	for (int b = 0; b < N_BLOCKS; ++b) {
+		for (int d = 0; d < N_BLOCKS; ++d)
+			dom[b][d] = b == START ? d == START : reachable[d];
+	}
+	do {
+		changed = false;
+		for (int b = 0; b < N_BLOCKS; ++b) {
+			if (b == START || !reachable[b])
+				continue;
+			for (int d = 0; d < N_BLOCKS; ++d) {
+				if (d == b || !dom[b][d])
+					continue;
+				for (int p = 0; p < N_BLOCKS; ++p) {
+					if (reachable[p] && has_edge(p, b) && !dom[p][d]) {
+						dom[b][d] = false;
+						changed   = true;
+						break;
+					}
+				}
+			}
+		}
+	} while (changed);
+}
+
+static int count_dominators(bool dom[N_BLOCKS][N_BLOCKS], int b)
+{
+	int n = 0;
+	for (int d = 0; d < N_BLOCKS; ++d)
+		n += dom[b][d];
+	return n;
+}
+
+static void check_doms(void)
+{
+	bool dom[N_BLOCKS][N_BLOCKS];
+	bool reachable[N_BLOCKS];
+	compute_reference(dom, reachable);
+
+	for (int b = 0; b < N_BLOCKS; ++b) {
+		ir_node *block = blocks[b];
+		if (!reachable[b]) {
+			assert(get_Block_dom_depth(block) <= 0);
+			continue;
+		}
+		int depth = count_dominators(dom, b);
+		assert(get_Block_dom_depth(block) == depth);
+		if (b == START)
+			continue;
+		/* the immediate dominator is the dominator with one less dominator */
+		ir_node *idom = get_Block_idom(block);
+		for (int d = 0; d < N_BLOCKS; ++d) {
+			if (dom[b][d] && count_dominators(dom, d) == depth - 1)
+				assert(idom == blocks[d]);
+		}
+		for (int d = 0; d < N_BLOCKS; ++d) {
+			if (reachable[d])
+				assert(block_dominates(blocks[d], block) == dom[b][d]);
+		}
+	}
+}
+
+static void test_graph(unsigned seed)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "f%u", seed);
+	ir_type   *mtp = new_type_method(0, 0, false, cc_cdecl_set, mtp_no_property);
+	ir_entity *ent = new_entity(get_glob_type(), new_id_from_str(name), mtp);
+	ir_graph  *irg = new_ir_graph(ent, 0);
+
+	memset(n_edges, 0, sizeof(n_edges));
+	memset(kept, 0, sizeof(kept));
+	srand(seed);
+
+	/* a chain from start to end, some blocks are kept alive */
+	blocks[START] = get_irg_start_block(irg);
+	for (int b = 1; b < END; ++b) {
+		blocks[b] = new_r_Block(irg, 0, NULL);
+		add_edge(b - 1, b);
+	}
+	blocks[END] = get_irg_end_block(irg);
+	ir_node *ret = new_r_Return(blocks[END - 1], get_irg_initial_mem(irg), 0,
+	                            NULL);
+	add_immBlock_pred(blocks[END], ret);
+	n_edges[END - 1][END] = 1;
+	for (int b = 1; b < END; ++b) {
+		if (rand() % 4 == 0) {
+			keep_alive(blocks[b]);
+			kept[b] = true;
+		}
+	}
+	irg_finalize_cons(irg);
+	assure_edges(irg);
+	compute_doms(irg);
+	check_doms();
+
+	for (unsigned round = 0; round < 300; ++round) {
+		ir_cfg_update_t updates[6];
+		size_t          n_updates = 0;
+		for (int i = 1 + rand() % 6; i-- > 0;) {
+			int from = 1 + rand() % (END - 1);
+			int to   = 1 + rand() % (END - 1);
+			int kind = rand() % 8;
+			if (kind == 0) {
+				/* toggle a keep-alive */
+				if (kept[from])
+					remove_End_keepalive(get_irg_end(irg), blocks[from]);
+				else
+					keep_alive(blocks[from]);
+				kept[from] = !kept[from];
+				ir_cfg_update_t const update = {
+					blocks[from], blocks[END], kept[from]
+				};
+				updates[n_updates++] = update;
+			} else if (kind < 4) {
+				add_edge(from, to);
+				ir_cfg_update_t const update = { blocks[from], blocks[to], true };
+				updates[n_updates++] = update;
+			} else if (remove_edge(from, to)) {
+				ir_cfg_update_t const update = { blocks[from], blocks[to], false };
+				updates[n_updates++] = update;
+			}
+		}
+		dom_update_cfg(irg, n_updates, updates);
+		check_doms();
+	}
+}
+
+int main(void)
+{
+	ir_init();
+	set_optimize(0);
+	for (unsigned seed = 1; seed <= 50; ++seed)
+		test_graph(seed);
+	ir_finish();
+	return 0;
+}
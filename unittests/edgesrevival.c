@@ -0,0 +1,52 @@
+#include "firm.h"
+#include "iredges_t.h"
+#include <assert.h>
+#include <stdio.h>
+
+/*
+ * Deactivates and activates the out edges several times while a node and one
+ * of its operands are unreachable, then connects the node again. The edges of
+ * both nodes have to be built when the node is connected.
+ */
+
+int main(void)
+{
+	ir_init();
+	set_optimize(0);
+	ir_type *const int_type = new_type_primitive(mode_Is);
+	ir_type *const mtp      = new_type_method(2, 1, false, cc_cdecl_set,
+	                                          mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_param_type(mtp, 1, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	ir_entity *const ent = new_entity(get_glob_type(), new_id_from_str("f"),
+	                                  mtp);
+	ir_graph *const irg   = new_ir_graph(ent, 0);
+	ir_node  *const block = get_r_cur_block(irg);
+	ir_node  *const args  = get_irg_args(irg);
+	ir_node  *const a     = new_r_Proj(args, mode_Is, 0);
+	ir_node  *const b     = new_r_Proj(args, mode_Is, 1);
+	ir_node  *const ret   = new_r_Return(block, get_r_store(irg), 1, &a);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	irg_finalize_cons(irg);
+
+	edges_activate(irg);
+	ir_node *const sub = new_r_Sub(block, a, b);
+	for (int r = 0; r < 3; ++r) {
+		edges_deactivate(irg);
+		/* reuse the memory of the freed edges */
+		for (int i = 0; i < 1000; ++i)
+			new_r_Const_long(irg, mode_Is, i + 1000 * r);
+		edges_activate(irg);
+	}
+	assert(get_irn_n_edges(sub) == 0 && get_irn_n_edges(b) == 0);
+
+	keep_alive(sub);
+	set_irn_n(sub, 0, b);
+	set_irn_n(sub, 1, a);
+	assert(get_irn_n_edges(b) == 1);
+	assert(edges_verify(irg));
+
+	ir_finish();
+	return 0;
+}
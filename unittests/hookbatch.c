@@ -0,0 +1,205 @@
+#include "firm.h"
+#include "irhooks.h"
+#include "irnode_t.h"
+#include "util.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Checks that batched hook entries receive all node events in order, when
+ * their buffer is full, on hook_flush_batches() and when they are
+ * unregistered, that dead node elimination delivers them before the old
+ * nodes are freed and that nodes killed right after their creation by CSE or
+ * constant folding are dropped. Pass timing counts the created and replaced
+ * nodes with batched entries and writes them in both output formats.
+ */
+
+#define N_NODES (2 * HOOK_BATCH_SIZE + 10)
+
+typedef struct collector_t {
+	ir_graph    *irg;
+	hook_event_t events[4 * HOOK_BATCH_SIZE];
+	size_t       n_events;
+	size_t       n_flushes;
+} collector_t;
+
+static void collect(void *context, hook_type_t hook, size_t n_events,
+                    const hook_event_t *events)
+{
+	collector_t *const collector = (collector_t*)context;
+	assert(n_events > 0 && n_events <= HOOK_BATCH_SIZE);
+	for (size_t i = 0; i < n_events; ++i) {
+		hook_event_t const *const event = &events[i];
+		/* the nodes must still be alive */
+		assert(get_irn_irg(event->node) == collector->irg);
+		assert((hook == hook_replace) == (event->new_node != NULL));
+		if (collector->n_events < ARRAY_SIZE(collector->events))
+			collector->events[collector->n_events] = *event;
+		++collector->n_events;
+	}
+	++collector->n_flushes;
+}
+
+static ir_graph *new_graph(const char *name)
+{
+	ir_type *const mtp = new_type_method(0, 0, false, cc_cdecl_set,
+	                                     mtp_no_property);
+	ir_entity *const ent = new_entity(get_glob_type(), new_id_from_str(name),
+	                                  mtp);
+	ir_graph *const irg = new_ir_graph(ent, 0);
+	ir_node *const ret = new_r_Return(get_r_cur_block(irg), get_r_store(irg),
+	                                  0, NULL);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static void test_delivery(void)
+{
+	ir_graph *const irg = new_graph("delivery");
+	static collector_t created;
+	static collector_t replaced;
+	created.irg  = irg;
+	replaced.irg = irg;
+	hook_batch_t new_node_batch = { .flush = collect, .context = &created };
+	hook_batch_t replace_batch  = { .flush = collect, .context = &replaced };
+	register_hook_batch(hook_new_node, &new_node_batch);
+	register_hook_batch(hook_replace, &replace_batch);
+
+	static ir_node *nodes[N_NODES];
+	for (unsigned i = 0; i < N_NODES; ++i)
+		nodes[i] = new_r_Const_long(irg, mode_Is, i);
+	/* full buffers are delivered right away */
+	assert(created.n_flushes == 2 && created.n_events == 2 * HOOK_BATCH_SIZE);
+	assert(new_node_batch.n_events == N_NODES - 2 * HOOK_BATCH_SIZE);
+	hook_flush_batches();
+	assert(created.n_flushes == 3 && created.n_events == N_NODES);
+	for (unsigned i = 0; i < N_NODES; ++i)
+		assert(created.events[i].node == nodes[i]);
+
+	for (unsigned i = 0; i + 1 < N_NODES; i += 2) {
+		keep_alive(nodes[i]);
+		exchange(nodes[i], nodes[i + 1]);
+	}
+	/* unregistering delivers the pending events */
+	unregister_hook_batch(hook_replace, &replace_batch);
+	assert(replace_batch.n_events == 0 && replaced.n_events == N_NODES / 2);
+	for (unsigned i = 0; i < N_NODES / 2; ++i) {
+		assert(replaced.events[i].node     == nodes[2 * i]);
+		assert(replaced.events[i].new_node == nodes[2 * i + 1]);
+	}
+
+	unregister_hook_batch(hook_new_node, &new_node_batch);
+	assert(new_node_batch.n_events == 0);
+}
+
+static void test_dead_node_elimination(void)
+{
+	static collector_t created;
+	hook_batch_t new_node_batch = { .flush = collect, .context = &created };
+	created.irg = new_graph("dead");
+	register_hook_batch(hook_new_node, &new_node_batch);
+	/* dead node elimination copies the few live nodes and frees the old ones,
+	 * the events of the old nodes must be delivered before */
+	ir_node *const dead = new_r_Const_long(created.irg, mode_Is, -1);
+	dead_node_elimination(created.irg);
+	unregister_hook_batch(hook_new_node, &new_node_batch);
+	assert(created.n_flushes > 0 && created.events[0].node == dead);
+}
+
+static void test_kill(void)
+{
+	static collector_t created;
+	hook_batch_t new_node_batch = { .flush = collect, .context = &created };
+	ir_graph *const irg = new_graph("kill");
+	created.irg = irg;
+	set_optimize(1);
+	register_hook_batch(hook_new_node, &new_node_batch);
+	/* the duplicate Const is killed by CSE, the Add by constant folding */
+	ir_node *const c7  = new_r_Const_long(irg, mode_Is, 7);
+	ir_node *const dup = new_r_Const_long(irg, mode_Is, 7);
+	ir_node *const c2  = new_r_Const_long(irg, mode_Is, 2);
+	ir_node *const sum = new_r_Add(get_irg_start_block(irg), c2, c7);
+	unregister_hook_batch(hook_new_node, &new_node_batch);
+	set_optimize(0);
+
+	assert(dup == c7 && is_Const(sum));
+	assert(created.n_events == 3);
+	assert(created.events[0].node == c7);
+	assert(created.events[1].node == c2);
+	assert(created.events[2].node == sum);
+}
+
+static void run_pass_timing(const char *graph, ir_pass_timing_format_t format,
+                            char *buf, size_t size)
+{
+	ir_graph *const irg = new_graph(graph);
+	FILE *const out = tmpfile();
+	assert(out != NULL);
+	ir_pass_timing_begin();
+	ir_pass_timing_push("test-pass", irg);
+	ir_node *prev = new_r_Const_long(irg, mode_Is, 0);
+	for (unsigned i = 1; i < N_NODES; ++i) {
+		ir_node *const node = new_r_Const_long(irg, mode_Is, i);
+		if (i % 4 == 0) {
+			keep_alive(prev);
+			exchange(prev, node);
+		}
+		prev = node;
+	}
+	ir_pass_timing_pop();
+	ir_pass_timing_end(out, format);
+
+	rewind(out);
+	size_t const len = fread(buf, 1, size - 1, out);
+	buf[len] = '\0';
+	fclose(out);
+	free_ir_graph(irg);
+}
+
+static bool ends_with(const char *str, const char *suffix)
+{
+	size_t const len        = strlen(str);
+	size_t const suffix_len = strlen(suffix);
+	return len >= suffix_len && strcmp(str + len - suffix_len, suffix) == 0;
+}
+
+static void test_pass_timing(void)
+{
+	char counts[64];
+	snprintf(counts, sizeof(counts), "\"nodes\":%u,\"replaced\":%u,",
+	         N_NODES, (N_NODES - 1) / 4);
+
+	char buf[1024];
+	run_pass_timing("summary", ir_pass_timing_summary, buf, sizeof(buf));
+	static const char summary_head[]
+		= "{\"passes\":[\n{\"name\":\"test-pass\",\"count\":1,\"total_us\":";
+	assert(strncmp(buf, summary_head, sizeof(summary_head) - 1) == 0);
+	assert(strstr(buf, counts) != NULL);
+	assert(strstr(buf, "\"histogram\":[") != NULL);
+	assert(ends_with(buf, "]}\n]}\n"));
+
+	run_pass_timing("trace", ir_pass_timing_trace, buf, sizeof(buf));
+	static const char trace_head[]
+		= "{\"traceEvents\":[\n{\"name\":\"test-pass\",\"cat\":\"pass\","
+		  "\"ph\":\"X\",\"ts\":";
+	assert(strncmp(buf, trace_head, sizeof(trace_head) - 1) == 0);
+	char args[128];
+	snprintf(args, sizeof(args), "\"args\":{\"graph\":\"trace\",%s", counts);
+	assert(strstr(buf, args) != NULL);
+	assert(ends_with(buf, "}}\n],\"displayTimeUnit\":\"ms\"}\n"));
+}
+
+int main(void)
+{
+	ir_init();
+	set_optimize(0);
+	test_delivery();
+	test_dead_node_elimination();
+	test_kill();
+	test_pass_timing();
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,132 @@
+#include "firm.h"
+#include "irdom.h"
+#include "iredges.h"
+#include "irlivechk.h"
+#include "irnode_t.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Builds random control flow graphs with loops and irreducible regions,
+ * defines values in random blocks and uses them in blocks they dominate and
+ * in Phis. The liveness check computing all reachability sets up front has to
+ * give the same answers as the one searching the graph on demand.
+ */
+
+#define MAX_BLOCKS 300
+#define MAX_VALUES (3 * MAX_BLOCKS)
+
+static ir_node *blocks[MAX_BLOCKS];
+static ir_node *values[MAX_VALUES];
+static unsigned n_values;
+
+static void add_value(ir_node *value)
+{
+	assert(n_values < MAX_VALUES);
+	values[n_values++] = value;
+}
+
+/** Returns a random value available at the end of @p block. */
+static ir_node *pick_value(ir_node *block)
+{
+	for (;;) {
+		ir_node *const value = values[rand() % n_values];
+		if (block_dominates(get_nodes_block(value), block))
+			return value;
+	}
+}
+
+static void test_graph(unsigned seed)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "f%u", seed);
+	ir_type *const int_type = new_type_primitive(mode_Is);
+	ir_type *const mtp      = new_type_method(1, 1, false, cc_cdecl_set,
+	                                          mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	ir_entity *const ent = new_entity(get_glob_type(), new_id_from_str(name),
+	                                  mtp);
+	ir_graph  *const irg = new_ir_graph(ent, 0);
+	srand(seed);
+
+	/* every block jumps to the next one, so all blocks are reachable, and
+	 * half of them branch to a random other block */
+	unsigned const n_blocks = 4 + rand() % (MAX_BLOCKS - 4);
+	ir_node *const arg      = new_r_Proj(get_irg_args(irg), mode_Is, 0);
+	blocks[0] = get_r_cur_block(irg);
+	for (unsigned i = 1; i < n_blocks; ++i)
+		blocks[i] = new_r_immBlock(irg);
+	for (unsigned i = 0; i + 1 < n_blocks; ++i) {
+		ir_node *const block = blocks[i];
+		if (rand() % 2 == 0) {
+			add_immBlock_pred(blocks[i + 1], new_r_Jmp(block));
+			continue;
+		}
+		ir_node *const c    = new_r_Const_long(irg, mode_Is, i);
+		ir_node *const cmp  = new_r_Cmp(block, arg, c, ir_relation_less);
+		ir_node *const cond = new_r_Cond(block, cmp);
+		unsigned const to   = 1 + rand() % (n_blocks - 1);
+		add_immBlock_pred(blocks[i + 1],
+		                  new_r_Proj(cond, mode_X, pn_Cond_false));
+		add_immBlock_pred(blocks[to], new_r_Proj(cond, mode_X, pn_Cond_true));
+	}
+	ir_node *const last = blocks[n_blocks - 1];
+	ir_node *const ret  = new_r_Return(last, get_r_store(irg), 1, &arg);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	for (unsigned i = 1; i < n_blocks; ++i)
+		mature_immBlock(blocks[i]);
+	irg_finalize_cons(irg);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+	                      | IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+
+	/* the CFG is fixed now, add the definitions and uses */
+	n_values = 0;
+	add_value(arg);
+	for (unsigned i = 0; i < n_blocks; ++i) {
+		ir_node *const block = blocks[i];
+		int      const arity = get_Block_n_cfgpreds(block);
+		if (i > 0 && arity > 1 && rand() % 2 == 0) {
+			ir_node **const ins = ALLOCAN(ir_node*, arity);
+			for (int p = 0; p < arity; ++p)
+				ins[p] = pick_value(get_Block_cfgpred_block(block, p));
+			ir_node *const phi = new_r_Phi(block, arity, ins, mode_Is);
+			keep_alive(phi);
+			add_value(phi);
+		}
+		for (int n = rand() % 3; n-- > 0;) {
+			ir_node *const value = new_r_Add(block, pick_value(block),
+			                                  pick_value(block));
+			keep_alive(value);
+			add_value(value);
+		}
+	}
+
+	lv_chk_set_eager_max_blocks(MAX_BLOCKS);
+	lv_chk_t *const eager = lv_chk_new(irg);
+	lv_chk_set_eager_max_blocks(0);
+	lv_chk_t *const lazy = lv_chk_new(irg);
+	unsigned n_live = 0;
+	for (unsigned v = 0; v < n_values; ++v) {
+		for (unsigned b = 0; b < n_blocks; ++b) {
+			unsigned const state = lv_chk_bl_xxx(eager, blocks[b], values[v]);
+			assert(lv_chk_bl_xxx(lazy, blocks[b], values[v]) == state);
+			n_live += state != 0;
+		}
+	}
+	assert(n_live > 0);
+	lv_chk_free(lazy);
+	lv_chk_free(eager);
+}
+
+int main(void)
+{
+	ir_init();
+	set_optimize(0);
+	for (unsigned seed = 1; seed <= 50; ++seed)
+		test_graph(seed);
+	ir_finish();
+	return 0;
+}
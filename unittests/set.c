@@ -0,0 +1,285 @@
+#include "hashptr.h"
+#include "pmap.h"
+#include "pset.h"
+#include "set.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Tests set, pset and pmap.  If called with an element count the lookup
+ * patterns of their main users are timed as well:
+ *   pmap  pointer keyed maps (node/entity maps in the optimizations)
+ *   ident find-or-insert of strings with variable size
+ *   tv    find-or-insert of small fixed size values (tarval table)
+ *   cse   find-or-insert and removal of pointers (CSE value table)
+ */
+
+typedef struct value_t {
+	unsigned kind;
+	unsigned len;
+	long     value;
+} value_t;
+
+typedef struct node_t {
+	char data[64];
+} node_t;
+
+static int value_cmp(void const *elt, void const *key, size_t size)
+{
+	(void)size;
+	value_t const *v0 = (value_t const*)elt;
+	value_t const *v1 = (value_t const*)key;
+	return v0->kind != v1->kind || v0->len != v1->len || v0->value != v1->value;
+}
+
+static unsigned value_hash(value_t const *value)
+{
+	return hash_combine(hash_combine(value->kind, value->len),
+	                    (unsigned)value->value);
+}
+
+static int str_cmp(void const *elt, void const *key, size_t size)
+{
+	return memcmp(elt, key, size);
+}
+
+static int node_cmp(void const *elt, void const *key)
+{
+	value_t const *v0 = (value_t const*)elt;
+	value_t const *v1 = (value_t const*)key;
+	return v0->kind != v1->kind || v0->value != v1->value;
+}
+
+static unsigned node_hash(value_t const *value)
+{
+	return hash_combine(value->kind, (unsigned)value->value);
+}
+
+static void test_set(size_t n)
+{
+	set      *s    = new_set(value_cmp, 4);
+	value_t **ptrs = malloc(n * sizeof(*ptrs));
+	for (size_t i = 0; i < n; ++i) {
+		value_t v = { (unsigned)i % 7, 3, (long)i };
+		ptrs[i] = set_insert(value_t, s, &v, sizeof(v), value_hash(&v));
+		assert(ptrs[i] != &v && ptrs[i]->value == (long)i);
+	}
+	assert(set_count(s) == n);
+
+	/* elements must not move while the set grows */
+	for (size_t i = 0; i < n; ++i) {
+		value_t v = { (unsigned)i % 7, 3, (long)i };
+		assert(set_find(value_t, s, &v, sizeof(v), value_hash(&v)) == ptrs[i]);
+		assert(set_insert(value_t, s, &v, sizeof(v), value_hash(&v)) == ptrs[i]);
+		v.len = 4;
+		assert(set_find(value_t, s, &v, sizeof(v), value_hash(&v)) == NULL);
+	}
+	assert(set_count(s) == n);
+
+	value_t    v     = { 1, 1, -1 };
+	set_entry *entry = set_hinsert(s, &v, sizeof(v), 42);
+	assert(entry->hash == 42 && entry->size == sizeof(v));
+	assert(set_find(value_t, s, &v, sizeof(v), 42) == (value_t*)entry->dptr);
+
+	size_t count = 0;
+	foreach_set(s, value_t, elt) {
+		assert(elt->value == -1 || ptrs[elt->value] == elt);
+		++count;
+	}
+	assert(count == n + 1);
+
+	/* iteration can be stopped and restarted */
+	assert(set_first(value_t, s) != NULL);
+	set_break(s);
+	assert(set_first(value_t, s) != NULL);
+	set_break(s);
+
+	free(ptrs);
+	del_set(s);
+
+	/* variable sized elements */
+	set *strs = new_set(str_cmp, 16);
+	char const *const words[] = { "a", "ab", "abc", "b", "" };
+	for (size_t i = 0; i < sizeof(words) / sizeof(*words); ++i) {
+		char const *w   = words[i];
+		size_t      len = strlen(w);
+		set_entry  *e   = set_hinsert0(strs, w, len, hash_str(w));
+		assert(e->size == len && ((char const*)e->dptr)[len] == '\0');
+		assert(strcmp((char const*)e->dptr, w) == 0);
+	}
+	assert(set_count(strs) == 5);
+	assert(set_find(char, strs, "ab", 2, hash_str("ab")) != NULL);
+	assert(set_find(char, strs, "ab", 1, hash_str("ab")) == NULL);
+	del_set(strs);
+}
+
+static void test_pset(size_t n)
+{
+	pset    *s    = pset_new_ptr(1);
+	value_t *vals = calloc(n, sizeof(*vals));
+	for (size_t i = 0; i < n; ++i) {
+		assert(pset_insert_ptr(s, &vals[i]) == &vals[i]);
+		assert(pset_insert_ptr(s, &vals[i]) == &vals[i]);
+	}
+	assert(pset_count(s) == n);
+
+	/* remove every second element */
+	for (size_t i = 0; i < n; i += 2)
+		assert(pset_remove_ptr(s, &vals[i]) == &vals[i]);
+	assert(pset_count(s) == n / 2);
+	for (size_t i = 0; i < n; ++i) {
+		void *found = pset_find_ptr(s, &vals[i]);
+		assert(found == (i % 2 == 0 ? NULL : &vals[i]));
+	}
+
+	size_t count = 0;
+	foreach_pset(s, value_t, elt) {
+		size_t i = elt - vals;
+		assert(i < n && i % 2 == 1 && elt->len == 0);
+		elt->len = 1;
+		++count;
+	}
+	assert(count == n / 2);
+
+	/* reinsert into the freed slots */
+	for (size_t i = 0; i < n; i += 2)
+		assert(pset_insert_ptr(s, &vals[i]) == &vals[i]);
+	assert(pset_count(s) == n);
+
+	pset_entry *entry = pset_hinsert_ptr(s, &vals[0]);
+	assert(entry->dptr == &vals[0] && entry->hash == hash_ptr(&vals[0]));
+
+	pset *copy = pset_new_ptr_default();
+	pset_insert_pset_ptr(copy, s);
+	assert(pset_count(copy) == n);
+	del_pset(copy);
+
+	free(vals);
+	del_pset(s);
+}
+
+static void test_pmap(size_t n)
+{
+	pmap *m    = pmap_create_ex(1);
+	char *keys = malloc(n);
+	for (size_t i = 0; i < n; ++i)
+		pmap_insert(m, &keys[i], &keys[n - i - 1]);
+	for (size_t i = 0; i < n; i += 3)
+		pmap_insert(m, &keys[i], NULL);
+	assert(pmap_count(m) == n);
+
+	for (size_t i = 0; i < n; ++i) {
+		assert(pmap_contains(m, &keys[i]));
+		void *value = pmap_get(void, m, &keys[i]);
+		assert(value == (i % 3 == 0 ? NULL : &keys[n - i - 1]));
+	}
+	assert(!pmap_contains(m, keys + n));
+	assert(pmap_find(m, m) == NULL);
+
+	size_t count = 0;
+	foreach_pmap(m, entry) {
+		size_t i = (char const*)entry->key - keys;
+		assert(i < n);
+		++count;
+	}
+	assert(count == n);
+
+	free(keys);
+	pmap_destroy(m);
+}
+
+static double seconds(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void bench_pmap(size_t n)
+{
+	clock_t start = clock();
+	pmap   *m     = pmap_create();
+	/* keys spaced like ir_nodes */
+	node_t *keys  = malloc(2 * n * sizeof(*keys));
+	for (size_t i = 0; i < n; ++i)
+		pmap_insert(m, &keys[2 * i], &keys[i]);
+	size_t hits = 0;
+	for (unsigned r = 0; r < 10; ++r) {
+		for (size_t i = 0; i < 2 * n; ++i)
+			hits += pmap_get(void, m, &keys[i]) != NULL;
+	}
+	assert(hits == 10 * n);
+	free(keys);
+	pmap_destroy(m);
+	printf("pmap:  %.3fs\n", seconds(start));
+}
+
+static void bench_ident(size_t n)
+{
+	clock_t start = clock();
+	set    *s     = new_set(str_cmp, 128);
+	char    buf[32];
+	for (unsigned r = 0; r < 10; ++r) {
+		for (size_t i = 0; i < n; ++i) {
+			int len = snprintf(buf, sizeof(buf), "ident_%zu", i * 2654435761u % n);
+			set_hinsert0(s, buf, len, hash_str(buf));
+		}
+	}
+	assert(set_count(s) <= n);
+	del_set(s);
+	printf("ident: %.3fs\n", seconds(start));
+}
+
+static void bench_tv(size_t n)
+{
+	clock_t start = clock();
+	set    *s     = new_set(value_cmp, 64);
+	for (unsigned r = 0; r < 10; ++r) {
+		for (size_t i = 0; i < n; ++i) {
+			value_t v = { (unsigned)(i % 5), 4, (long)(i * 7 % n) };
+			set_insert(value_t, s, &v, sizeof(v), value_hash(&v));
+		}
+	}
+	del_set(s);
+	printf("tv:    %.3fs\n", seconds(start));
+}
+
+static void bench_cse(size_t n)
+{
+	clock_t  start = clock();
+	pset    *s     = new_pset(node_cmp, 64);
+	value_t *nodes = malloc(n * sizeof(*nodes));
+	for (size_t i = 0; i < n; ++i) {
+		nodes[i].kind  = (unsigned)(i % 13);
+		nodes[i].len   = 0;
+		nodes[i].value = (long)(i % (n / 2 + 1));
+	}
+	for (unsigned r = 0; r < 10; ++r) {
+		for (size_t i = 0; i < n; ++i)
+			pset_insert(s, &nodes[i], node_hash(&nodes[i]));
+		for (size_t i = 0; i < n; i += 4) {
+			if (pset_find(s, &nodes[i], node_hash(&nodes[i])) == &nodes[i])
+				pset_remove(s, &nodes[i], node_hash(&nodes[i]));
+		}
+	}
+	free(nodes);
+	del_pset(s);
+	printf("cse:   %.3fs\n", seconds(start));
+}
+
+int main(int argc, char **argv)
+{
+	test_set(10000);
+	test_pset(10000);
+	test_pmap(10000);
+
+	if (argc > 1) {
+		size_t n = strtoul(argv[1], NULL, 0);
+		bench_pmap(n);
+		bench_ident(n);
+		bench_tv(n);
+		bench_cse(n);
+	}
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include "firm.h"
+#include "iredges_t.h"
+#include "irgwalk.h"
+#include <assert.h>
+#include <stdbool.h>
+
+/*
+ * Builds a loop whose body is a diamond. The arms of the diamond are hot, so
+ * opt_tail_duplication() copies the join block into one of them. The graph
+ * has to stay valid and the copy has to continue the loop.
+ */
+
+static void count_block(ir_node *block, void *env)
+{
+	(void)block;
+	++*(unsigned*)env;
+}
+
+static unsigned count_blocks(ir_graph *irg)
+{
+	unsigned n_blocks = 0;
+	irg_block_walk_graph(irg, NULL, count_block, &n_blocks);
+	return n_blocks;
+}
+
+int main(void)
+{
+	ir_init();
+	set_optimize(0);
+	ir_type *const int_type = new_type_primitive(mode_Is);
+	ir_type *const mtp      = new_type_method(1, 1, false, cc_cdecl_set,
+	                                          mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	ir_entity *const ent = new_entity(get_glob_type(), new_id_from_str("f"),
+	                                  mtp);
+	ir_graph *const irg = new_ir_graph(ent, 1);
+	set_current_ir_graph(irg);
+
+	/* i = x; do { if (i & 1) i += 3; else i -= 1; } while (i < 100); */
+	set_value(0, new_Proj(get_irg_args(irg), mode_Is, 0));
+	ir_node *const entry  = new_Jmp();
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, entry);
+	set_cur_block(header);
+	ir_node *const bit     = new_And(get_value(0, mode_Is),
+	                                 new_Const_long(mode_Is, 1));
+	ir_node *const odd     = new_Cmp(bit, new_Const_long(mode_Is, 0),
+	                                 ir_relation_less_greater);
+	ir_node *const cond    = new_Cond(odd);
+	ir_node *const to_odd  = new_Proj(cond, mode_X, pn_Cond_true);
+	ir_node *const to_even = new_Proj(cond, mode_X, pn_Cond_false);
+
+	ir_node *const join      = new_immBlock();
+	ir_node *const odd_block = new_immBlock();
+	add_immBlock_pred(odd_block, to_odd);
+	set_cur_block(odd_block);
+	set_value(0, new_Add(get_value(0, mode_Is), new_Const_long(mode_Is, 3)));
+	add_immBlock_pred(join, new_Jmp());
+	ir_node *const even_block = new_immBlock();
+	add_immBlock_pred(even_block, to_even);
+	set_cur_block(even_block);
+	set_value(0, new_Sub(get_value(0, mode_Is), new_Const_long(mode_Is, 1)));
+	add_immBlock_pred(join, new_Jmp());
+	mature_immBlock(odd_block);
+	mature_immBlock(even_block);
+
+	set_cur_block(join);
+	ir_node *const less  = new_Cmp(get_value(0, mode_Is),
+	                               new_Const_long(mode_Is, 100),
+	                               ir_relation_less);
+	ir_node *const latch = new_Cond(less);
+	add_immBlock_pred(header, new_Proj(latch, mode_X, pn_Cond_true));
+	ir_node *const exit_block = new_immBlock();
+	add_immBlock_pred(exit_block, new_Proj(latch, mode_X, pn_Cond_false));
+	mature_immBlock(join);
+	mature_immBlock(header);
+	mature_immBlock(exit_block);
+	set_cur_block(exit_block);
+	ir_node *const result = get_value(0, mode_Is);
+	ir_node *const ret    = new_Return(get_store(), 1, &result);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	irg_finalize_cons(irg);
+	irg_verify(irg);
+
+	unsigned const n_blocks = count_blocks(irg);
+	opt_tail_duplication(irg, 16, 100);
+	irg_verify(irg);
+	assert(edges_verify(irg));
+
+	/* the join was copied into one arm, the copy also branches back to the
+	 * loop header and to the exit */
+	assert(count_blocks(irg) == n_blocks + 1);
+	assert(get_Block_n_cfgpreds(join) == 1);
+	assert(get_Block_n_cfgpreds(header) == 3);
+	assert(get_Block_n_cfgpreds(exit_block) == 2);
+
+	set_optimize(1);
+	optimize_cf(irg);
+	optimize_graph_df(irg);
+	irg_verify(irg);
+
+	ir_finish();
+	return 0;
+}
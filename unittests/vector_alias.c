@@ -0,0 +1,174 @@
+#include "firm.h"
+#include "irmemory.h"
+#include <assert.h>
+#include <stdbool.h>
+
+/*
+ * Vectorizes a loop and a straight-line group of Stores followed by a scalar
+ * Load that may read one of the stored elements. With type based alias
+ * analysis the vector Store still has to alias the scalar Load.
+ */
+
+static ir_type *t_int;
+static ir_type *t_ptr;
+
+static ir_graph *new_graph(const char *name)
+{
+	ir_type *const mtp = new_type_method(3, 1, false, cc_cdecl_set,
+	                                     mtp_no_property);
+	set_method_param_type(mtp, 0, t_ptr);
+	set_method_param_type(mtp, 1, t_ptr);
+	set_method_param_type(mtp, 2, t_int);
+	set_method_res_type(mtp, 0, t_int);
+	ir_entity *const ent = new_entity(get_glob_type(), new_id_from_str(name),
+	                                  mtp);
+	set_entity_visibility(ent, ir_visibility_external);
+	ir_graph *const irg = new_ir_graph(ent, 1);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static ir_node *element(ir_node *base, ir_node *index)
+{
+	ir_mode *const offset_mode = get_reference_offset_mode(mode_P);
+	ir_node *const offset      = new_Mul(new_Conv(index, offset_mode),
+	                                     new_Const_long(offset_mode, 4));
+	return new_Add(base, offset);
+}
+
+static ir_node *load(ir_node *ptr)
+{
+	ir_node *const ld = new_Load(get_store(), ptr, mode_Is, t_int, cons_none);
+	set_store(new_Proj(ld, mode_M, pn_Load_M));
+	return new_Proj(ld, mode_Is, pn_Load_res);
+}
+
+static void store(ir_node *ptr, ir_node *value)
+{
+	ir_node *const st = new_Store(get_store(), ptr, value, t_int, cons_none);
+	set_store(new_Proj(st, mode_M, pn_Store_M));
+}
+
+/** Finishes the graph by returning a scalar Load of base[1]. */
+static void finish_graph(ir_graph *irg, ir_node *base)
+{
+	ir_node *const res = load(element(base, new_Const_long(mode_Is, 1)));
+	ir_node *const ret = new_Return(get_store(), 1, &res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	irg_finalize_cons(irg);
+	irg_verify(irg);
+}
+
+/** for (i = 0; i < n; ++i) a[i] = b[i] + n; return a[1]; */
+static ir_graph *build_loop(void)
+{
+	ir_graph *const irg  = new_graph("loop");
+	ir_node  *const args = get_irg_args(irg);
+	ir_node  *const dst  = new_Proj(args, mode_P, 0);
+	ir_node  *const src  = new_Proj(args, mode_P, 1);
+	ir_node  *const n    = new_Proj(args, mode_Is, 2);
+	set_value(0, new_Const_long(mode_Is, 0));
+	ir_node *const jmp = new_Jmp();
+
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, jmp);
+	set_cur_block(header);
+	ir_node *const cmp  = new_Cmp(get_value(0, mode_Is), n, ir_relation_less);
+	ir_node *const cond = new_Cond(cmp);
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *const i = get_value(0, mode_Is);
+	store(element(dst, i), new_Add(load(element(src, i)), n));
+	set_value(0, new_Add(i, new_Const_long(mode_Is, 1)));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	finish_graph(irg, dst);
+	return irg;
+}
+
+/**
+ * a[0..3] = b[0..3] + n with all Loads before the Stores, returns b[1], which
+ * is not known to be different from a[1]
+ */
+static ir_graph *build_straight(void)
+{
+	ir_graph *const irg  = new_graph("straight");
+	ir_node  *const args = get_irg_args(irg);
+	ir_node  *const dst  = new_Proj(args, mode_P, 0);
+	ir_node  *const src  = new_Proj(args, mode_P, 1);
+	ir_node  *const n    = new_Proj(args, mode_Is, 2);
+	ir_node *values[4];
+	for (long i = 0; i < 4; ++i)
+		values[i] = load(element(src, new_Const_long(mode_Is, i)));
+	for (long i = 0; i < 4; ++i) {
+		ir_node *const index = new_Const_long(mode_Is, i);
+		store(element(dst, index), new_Add(values[i], n));
+	}
+	finish_graph(irg, src);
+	return irg;
+}
+
+typedef struct accesses_t {
+	ir_node *vector_store;
+	ir_node *scalar_load;
+} accesses_t;
+
+static void find_accesses(ir_node *node, void *data)
+{
+	accesses_t *const accesses = (accesses_t*)data;
+	if (is_Store(node) && get_irn_mode(get_Store_value(node)) != mode_Is)
+		accesses->vector_store = node;
+	/* the Load of the result is the only one returning a Proj to Return */
+	if (is_Return(node)) {
+		ir_node *const res = get_Return_res(node, 0);
+		if (is_Proj(res) && is_Load(get_Proj_pred(res)))
+			accesses->scalar_load = get_Proj_pred(res);
+	}
+}
+
+static void check_alias(ir_graph *irg)
+{
+	accesses_t accesses = { NULL, NULL };
+	irg_walk_graph(irg, NULL, find_accesses, &accesses);
+	ir_node *const st = accesses.vector_store;
+	ir_node *const ld = accesses.scalar_load;
+	assert(st != NULL && ld != NULL);
+
+	ir_mode *const vmode = get_irn_mode(get_Store_value(st));
+	ir_alias_relation const rel = get_alias_relation(
+		get_Store_ptr(st), get_Store_type(st), get_mode_size_bytes(vmode),
+		get_Load_ptr(ld), get_Load_type(ld), get_mode_size_bytes(mode_Is));
+	assert(rel != ir_no_alias);
+	(void)rel;
+}
+
+int main(void)
+{
+	ir_init();
+	ir_target_set("x86_64-linux-gnu");
+	ir_target_init();
+	set_irp_memory_disambiguator_options(aa_opt_type_based);
+	t_int = new_type_primitive(mode_Is);
+	t_ptr = new_type_pointer(t_int);
+
+	ir_graph *const loop = build_loop();
+	vectorize_loops(loop);
+	irg_verify(loop);
+	check_alias(loop);
+
+	ir_graph *const straight = build_straight();
+	slp_vectorize(straight);
+	irg_verify(straight);
+	check_alias(straight);
+
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+ * Checks that sampled verification selects graphs only by the names of the
+ * graph and the pass: the selection is the same in a second program where
+ * the graphs are created in reverse order, and it matches the sampling
+ * fraction.
+ */
+
+#define N_GRAPHS 400
+
+static ir_graph *graphs[N_GRAPHS];
+
+static void create_graph(ir_type *owner, unsigned i)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "func%u", i);
+	ir_type *const mtp = new_type_method(0, 0, false, cc_cdecl_set,
+	                                     mtp_no_property);
+	ir_entity *const ent = new_entity(owner, new_id_from_str(name), mtp);
+	ir_graph *const irg = new_ir_graph(ent, 0);
+	ir_node *const ret = new_r_Return(get_r_cur_block(irg), get_r_store(irg),
+	                                  0, NULL);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	irg_finalize_cons(irg);
+	graphs[i] = irg;
+}
+
+static unsigned count_selected(const char *pass, bool *selected)
+{
+	unsigned n = 0;
+	for (unsigned i = 0; i < N_GRAPHS; ++i) {
+		selected[i] = ir_verify_selected(graphs[i], pass);
+		n += selected[i];
+	}
+	return n;
+}
+
+int main(void)
+{
+	ir_init();
+	for (unsigned i = 0; i < N_GRAPHS; ++i)
+		create_graph(get_glob_type(), i);
+
+	static bool first[N_GRAPHS];
+	static bool other[N_GRAPHS];
+	assert(ir_get_verify_sampling() == 1000);
+	assert(count_selected("pass", first) == N_GRAPHS);
+	ir_set_verify_sampling(0);
+	assert(count_selected("pass", first) == 0);
+
+	ir_set_verify_sampling(250);
+	unsigned const n_first = count_selected("pass", first);
+	assert(n_first > N_GRAPHS / 8 && n_first < N_GRAPHS * 3 / 8);
+	/* another pass selects other graphs */
+	unsigned const n_other = count_selected("other-pass", other);
+	unsigned       n_same  = 0;
+	for (unsigned i = 0; i < N_GRAPHS; ++i)
+		n_same += first[i] == other[i];
+	assert(n_other > 0 && n_same < N_GRAPHS);
+
+	/* the same names select the same graphs in another program */
+	new_ir_prog("second");
+	ir_type *const owner = new_type_struct(new_id_from_str("second"));
+	for (unsigned i = N_GRAPHS; i-- > 0;)
+		create_graph(owner, i);
+	assert(count_selected("pass", other) == n_first);
+	for (unsigned i = 0; i < N_GRAPHS; ++i) {
+		assert(other[i] == first[i]);
+		/* the selected graphs pass the verifier, the others are skipped */
+		assert(irg_verify_sampled(graphs[i], "pass"));
+	}
+	assert(irp_verify("pass"));
+
+	ir_finish();
+	return 0;
+}